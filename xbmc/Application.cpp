@@ -32,6 +32,7 @@
 #include "guilib/TextureManager.h"
 #include "cores/IPlayer.h"
 #include "cores/dvdplayer/DVDFileInfo.h"
+#include "cores/dvdplayer/DVDCodecs/DVDPictureKernels.h"
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "PlayListPlayer.h"
@@ -195,6 +196,7 @@
 #include "addons/GUIWindowAddonBrowser.h"
 #include "music/windows/GUIWindowVisualisation.h"
 #include "windows/GUIWindowDebugInfo.h"
+#include "windows/GUIWindowScrollBenchmark.h"
 #include "windows/GUIWindowPointer.h"
 #include "windows/GUIWindowSystemInfo.h"
 #include "windows/GUIWindowScreensaver.h"
@@ -1358,6 +1360,7 @@ bool CApplication::Initialize()
     g_windowManager.Add(new CGUIWindowAddonBrowser);
     g_windowManager.Add(new CGUIWindowScreensaverDim);
     g_windowManager.Add(new CGUIWindowDebugInfo);
+    g_windowManager.Add(new CGUIWindowScrollBenchmark);
     g_windowManager.Add(new CGUIWindowPointer);
     g_windowManager.Add(new CGUIDialogYesNo);
     g_windowManager.Add(new CGUIDialogProgress);
@@ -2300,8 +2303,8 @@ void CApplication::Render()
 
   // reset our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
-  // isn't called)
-  g_infoManager.ResetCache();
+  // isn't called). Only conditions whose info sources changed are re-evaluated.
+  g_infoManager.ResetFrameCache();
   lock.Leave();
 
   unsigned int now = XbmcThreads::SystemClockMillis();
@@ -3386,6 +3389,7 @@ bool CApplication::Cleanup()
     g_windowManager.Delete(WINDOW_SETTINGS_PROFILES);
     g_windowManager.Delete(WINDOW_SETTINGS_MYPICTURES);  // all the settings categories
     g_windowManager.Delete(WINDOW_TEST_PATTERN);
+    g_windowManager.Delete(WINDOW_SCROLL_BENCHMARK);
     g_windowManager.Delete(WINDOW_SCREEN_CALIBRATION);
     g_windowManager.Delete(WINDOW_SYSTEM_INFORMATION);
     g_windowManager.Delete(WINDOW_SCREENSAVER);
@@ -3523,6 +3527,7 @@ void CApplication::Stop(int exitCode)
 
     CLog::Log(LOGNOTICE, "stop player");
     m_pPlayer->ClosePlayer();
+    CDVDPictureKernels::StopWorkers();
 
     CAnnouncementManager::Get().Deinitialize();
 
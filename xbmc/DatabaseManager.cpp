@@ -20,6 +20,7 @@
 
 #include "DatabaseManager.h"
 #include "utils/log.h"
+#include "utils/LibraryIndex.h"
 #include "addons/AddonDatabase.h"
 #include "view/ViewDatabase.h"
 #include "TextureDatabase.h"
@@ -63,6 +64,8 @@ void CDatabaseManager::Initialize(bool addonsOnly)
   { CVideoDatabase db; UpdateDatabase(db, &g_advancedSettings.m_databaseVideo); }
   { CPVRDatabase db; UpdateDatabase(db, &g_advancedSettings.m_databaseTV); }
   { CEpgDatabase db; UpdateDatabase(db, &g_advancedSettings.m_databaseEpg); }
+  // the library may be another one now, e.g. after a profile change
+  CLibraryIndex::Get().Clear();
   CLog::Log(LOGDEBUG, "%s, updating databases... DONE", __FUNCTION__);
 }
 
@@ -125,6 +125,10 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowCodec = false;
   m_playerShowInfo = false;
   m_fps = 0.0f;
+  m_changedSources = INFO_SOURCE_ALL;
+  m_frameEvaluations = 0;
+  m_framePlaying = false;
+  m_frameTime = 0;
   ResetLibraryBools();
 }
 
@@ -136,17 +140,32 @@ CGUIInfoManager::~CGUIInfoManager(void)
 
 bool CGUIInfoManager::OnMessage(CGUIMessage &message)
 {
-  if (message.GetMessage() == GUI_MSG_NOTIFY_ALL)
+  switch (message.GetMessage())
   {
+  // playlists change while nothing plays, when player conditions aren't checked every frame
+  case GUI_MSG_PLAYBACK_STARTED:
+  case GUI_MSG_PLAYBACK_ENDED:
+  case GUI_MSG_PLAYBACK_STOPPED:
+  case GUI_MSG_PLAYLIST_CHANGED:
+  case GUI_MSG_PLAYLISTPLAYER_STARTED:
+  case GUI_MSG_PLAYLISTPLAYER_CHANGED:
+  case GUI_MSG_PLAYLISTPLAYER_STOPPED:
+  case GUI_MSG_PLAYLISTPLAYER_RANDOM:
+  case GUI_MSG_PLAYLISTPLAYER_REPEAT:
+    SetSourcesChanged(INFO_SOURCE_PLAYER);
+    break;
+  case GUI_MSG_NOTIFY_ALL:
     if (message.GetParam1() == GUI_MSG_UPDATE_ITEM && message.GetItem())
     {
       CFileItemPtr item = boost::static_pointer_cast<CFileItem>(message.GetItem());
       if (m_currentFile->IsSamePath(item.get()))
       {
         m_currentFile->UpdateInfo(*item);
+        SetSourcesChanged(INFO_SOURCE_PLAYER);
         return true;
       }
     }
+    break;
   }
   return false;
 }
@@ -263,6 +282,7 @@ const infomap system_labels[] =  {{ "hasnetwork",       SYSTEM_ETHERNET_LINK_ACT
                                   { "buildversionshort",SYSTEM_BUILD_VERSION_SHORT },
                                   { "builddate",        SYSTEM_BUILD_DATE },
                                   { "fps",              SYSTEM_FPS },
+                                  { "infoboolevaluations", SYSTEM_INFOBOOL_EVALUATIONS },
                                   { "dvdtraystate",     SYSTEM_DVD_TRAY_STATE },
                                   { "freememory",       SYSTEM_FREE_MEMORY },
                                   { "language",         SYSTEM_LANGUAGE },
@@ -1463,6 +1483,9 @@ CStdString CGUIInfoManager::GetLabel(int info, int contextWindow, std::string *f
   case SYSTEM_FPS:
     strLabel = StringUtils::Format("%02.2f", m_fps);
     break;
+  case SYSTEM_INFOBOOL_EVALUATIONS:
+    strLabel = StringUtils::Format("%u", m_frameEvaluations);
+    break;
   case PLAYER_VOLUME:
     strLabel = StringUtils::Format("%2.1f dB", CAEUtil::PercentToGain(g_application.GetVolume(false)));
     break;
@@ -5285,6 +5308,93 @@ void CGUIInfoManager::ResetCache()
     (*i)->SetDirty();
 }
 
+void CGUIInfoManager::ResetFrameCache()
+{
+  unsigned int sources = INFO_SOURCE_NONE;
+
+  // animation triggers only last a single frame
+  if (!m_containerMoves.empty())
+  {
+    m_containerMoves.clear();
+    sources |= INFO_SOURCE_GUI;
+  }
+
+  // player time, cache level etc. change continually, so check every frame while
+  // playing, and once more after playback has stopped
+  bool playing = g_application.m_pPlayer->IsPlaying();
+  if (playing || m_framePlaying)
+    sources |= INFO_SOURCE_PLAYER;
+  m_framePlaying = playing;
+
+  time_t now = time(NULL);
+  if (now != m_frameTime)
+  {
+    sources |= INFO_SOURCE_TIME;
+    m_frameTime = now;
+  }
+
+  {
+    CSingleLock lock(m_critSources);
+    sources |= m_changedSources;
+    m_changedSources = INFO_SOURCE_NONE;
+  }
+
+  CSingleLock lock(m_critInfo);
+  for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+  {
+    unsigned int boolSources = (*i)->GetSources();
+    if (boolSources == INFO_SOURCE_ALL || (boolSources & sources))
+      (*i)->SetDirty();
+  }
+
+  m_frameEvaluations = InfoBool::GetEvaluations();
+  InfoBool::ResetEvaluations();
+}
+
+void CGUIInfoManager::SetSourcesChanged(unsigned int sources)
+{
+  CSingleLock lock(m_critSources);
+  m_changedSources |= sources;
+}
+
+unsigned int CGUIInfoManager::GetInfoSources(int condition) const
+{
+  condition = abs(condition);
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END)
+  {
+    unsigned int index = condition - MULTI_INFO_START;
+    if (index < m_multiInfo.size())
+      return GetInfoSources(m_multiInfo[index].m_info);
+    return INFO_SOURCE_ALL;
+  }
+
+  if (condition == SYSTEM_ALWAYS_TRUE || condition == SYSTEM_ALWAYS_FALSE ||
+     (condition >= SYSTEM_PLATFORM_LINUX && condition <= SYSTEM_PLATFORM_LINUX_RASPBERRY_PI))
+    return INFO_SOURCE_NONE;
+  // volume and mute are changed outside of the player
+  if (condition == PLAYER_VOLUME || condition == PLAYER_MUTED)
+    return INFO_SOURCE_ALL;
+  if ((condition >= PLAYER_HAS_MEDIA && condition < WEATHER_CONDITIONS) ||
+      (condition >= MUSICPLAYER_TITLE && condition < CONTAINER_CAN_FILTER) ||
+      (condition >= MUSICPM_ENABLED && condition <= PLAYLIST_ISREPEATONE) ||
+      (condition >= VISUALISATION_LOCKED && condition <= VISUALISATION_ENABLED))
+    return INFO_SOURCE_PLAYER;
+  if (condition == SYSTEM_TIME || condition == SYSTEM_DATE)
+    return INFO_SOURCE_TIME;
+  if (condition >= SKIN_BOOL && condition <= SKIN_ASPECT_RATIO)
+    return INFO_SOURCE_SKIN;
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_MUSICVIDEOS)
+    return INFO_SOURCE_LIBRARY;
+  if ((condition >= CONTAINER_CAN_FILTER && condition <= CONTAINER_TOTALTIME) ||
+      (condition >= WINDOW_PROPERTY && condition <= WINDOW_IS_ACTIVE) ||
+      (condition >= CONTROL_GET_LABEL && condition <= CONTROL_HAS_FOCUS) ||
+      (condition >= LISTITEM_START && condition <= LISTITEM_END))
+    return INFO_SOURCE_GUI;
+
+  // weather, system state, string comparisons etc.
+  return INFO_SOURCE_ALL;
+}
+
 // Called from tuxbox service thread to update current status
 void CGUIInfoManager::UpdateFromTuxBox()
 {
@@ -5482,6 +5592,7 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
     default:
       break;
   }
+  SetSourcesChanged(INFO_SOURCE_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -5491,6 +5602,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasTVShows = -1;
   m_libraryHasMusicVideos = -1;
   m_libraryHasMovieSets = -1;
+  SetSourcesChanged(INFO_SOURCE_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
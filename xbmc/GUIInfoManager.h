@@ -136,6 +136,7 @@ namespace INFO
 #define SYSTEM_BUILD_DATE           121
 #define SYSTEM_ETHERNET_LINK_ACTIVE 122
 #define SYSTEM_FPS                  123
+#define SYSTEM_INFOBOOL_EVALUATIONS 124
 #define SYSTEM_ALWAYS_TRUE          125   // useful for <visible fade="10" start="hidden">true</visible>, to fade in a control
 #define SYSTEM_ALWAYS_FALSE         126   // used for <visible fade="10">false</visible>, to fade out a control (ie not particularly useful!)
 #define SYSTEM_MEDIA_DVD            127
@@ -814,7 +815,29 @@ public:
   void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
   void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
 
+  /*! \brief Mark all conditions dirty so they are re-evaluated on next use
+   \sa ResetFrameCache
+   */
   void ResetCache();
+
+  /*! \brief Mark dirty the conditions whose info sources changed during the last frame
+   Called once per frame after rendering. Conditions with unknown sources are always marked dirty.
+   \sa SetSourcesChanged, ResetCache
+   */
+  void ResetFrameCache();
+
+  /*! \brief Signal that information from the given sources has changed
+   May be called from any thread, the affected conditions are re-evaluated the next frame.
+   \param sources a combination of INFO::InfoSource flags
+   */
+  void SetSourcesChanged(unsigned int sources);
+
+  /*! \brief Get the info sources that a condition depends on
+   \param condition the condition as returned from TranslateSingleString
+   \return a combination of INFO::InfoSource flags
+   */
+  unsigned int GetInfoSources(int condition) const;
+
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   CStdString GetItemLabel(const CFileItem *item, int info, std::string *fallback = NULL);
   CStdString GetItemImage(const CFileItem *item, int info, std::string *fallback = NULL);
@@ -938,6 +961,13 @@ protected:
   unsigned int m_lastFPSTime;
 
   std::map<int, int> m_containerMoves;  // direction of list moving
+
+  // dependency tracking of conditions
+  unsigned int m_changedSources;    // sources signalled since the last frame
+  unsigned int m_frameEvaluations;  // conditions evaluated during the last frame
+  bool m_framePlaying;              // whether the player was active during the last frame
+  time_t m_frameTime;               // wall clock second of the last frame
+  CCriticalSection m_critSources;
   int m_nextWindowID;
   int m_prevWindowID;
 
@@ -21,6 +21,7 @@
 #include "threads/SystemClock.h"
 #include "GUILargeTextureManager.h"
 #include "settings/Settings.h"
+#include "settings/AdvancedSettings.h"
 #include "guilib/Texture.h"
 #include "threads/SingleLock.h"
 #include "utils/TimeUtils.h"
@@ -78,11 +79,14 @@ bool CImageLoader::DoWork()
   return true;
 }
 
-CGUILargeTextureManager::CLargeTexture::CLargeTexture(const CStdString &path)
+CGUILargeTextureManager::CLargeTexture::CLargeTexture(const CStdString &path, bool prefetch)
 {
   m_path = path;
-  m_refCount = 1;
+  m_refCount = prefetch ? 0 : 1;
+  m_prefetchCount = prefetch ? 1 : 0;
   m_timeToDelete = 0;
+  m_lastUsed = CTimeUtils::GetFrameTime();
+  m_memory = 0;
 }
 
 CGUILargeTextureManager::CLargeTexture::~CLargeTexture()
@@ -94,13 +98,33 @@ CGUILargeTextureManager::CLargeTexture::~CLargeTexture()
 void CGUILargeTextureManager::CLargeTexture::AddRef()
 {
   m_refCount++;
+  m_lastUsed = CTimeUtils::GetFrameTime();
 }
 
 bool CGUILargeTextureManager::CLargeTexture::DecrRef(bool deleteImmediately)
 {
   assert(m_refCount);
   m_refCount--;
-  if (m_refCount == 0)
+  return DeleteIfUnreferenced(deleteImmediately);
+}
+
+void CGUILargeTextureManager::CLargeTexture::AddPrefetchRef()
+{
+  m_prefetchCount++;
+  m_lastUsed = CTimeUtils::GetFrameTime();
+}
+
+bool CGUILargeTextureManager::CLargeTexture::DecrPrefetchRef(bool deleteImmediately)
+{
+  if (m_prefetchCount == 0)
+    return false; // we were evicted and queued again since
+  m_prefetchCount--;
+  return DeleteIfUnreferenced(deleteImmediately);
+}
+
+bool CGUILargeTextureManager::CLargeTexture::DeleteIfUnreferenced(bool deleteImmediately)
+{
+  if (m_refCount == 0 && m_prefetchCount == 0)
   {
     if (deleteImmediately)
       delete this;
@@ -113,7 +137,7 @@ bool CGUILargeTextureManager::CLargeTexture::DecrRef(bool deleteImmediately)
 
 bool CGUILargeTextureManager::CLargeTexture::DeleteIfRequired(bool deleteImmediately)
 {
-  if (m_refCount == 0 && (deleteImmediately || m_timeToDelete < CTimeUtils::GetFrameTime()))
+  if (m_refCount == 0 && m_prefetchCount == 0 && (deleteImmediately || m_timeToDelete < CTimeUtils::GetFrameTime()))
   {
     delete this;
     return true;
@@ -121,11 +145,21 @@ bool CGUILargeTextureManager::CLargeTexture::DeleteIfRequired(bool deleteImmedia
   return false;
 }
 
+void CGUILargeTextureManager::CLargeTexture::Evict()
+{
+  assert(m_refCount == 0);
+  m_prefetchCount = 0;
+  delete this;
+}
+
 void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture)
 {
   assert(!m_texture.size());
   if (texture)
+  {
+    m_memory = texture->GetPitch() * texture->GetRows();
     m_texture.Set(texture, texture->GetWidth(), texture->GetHeight());
+  }
 }
 
 CGUILargeTextureManager::CGUILargeTextureManager()
@@ -149,6 +183,42 @@ void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
     else
       ++it;
   }
+  EvictUnusedImages();
+}
+
+void CGUILargeTextureManager::EvictUnusedImages()
+{
+  if (g_advancedSettings.m_guiPrefetchMemory <= 0)
+    return;
+
+  unsigned int budget = g_advancedSettings.m_guiPrefetchMemory * 1024 * 1024;
+  unsigned int used = 0;
+  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  {
+    if ((*it)->IsUnused())
+      used += (*it)->GetMemoryUsage();
+  }
+
+  while (used > budget)
+  {
+    // drop the images waiting for deletion first, then the prefetched ones requested longest ago
+    listIterator victim = m_allocated.end();
+    for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+    {
+      CLargeTexture *image = *it;
+      if (!image->IsUnused())
+        continue;
+      if (victim == m_allocated.end() ||
+          ((*victim)->IsPrefetched() && !image->IsPrefetched()) ||
+          ((*victim)->IsPrefetched() == image->IsPrefetched() && image->GetLastUsed() < (*victim)->GetLastUsed()))
+        victim = it;
+    }
+    if (victim == m_allocated.end())
+      break;
+    used -= (*victim)->GetMemoryUsage();
+    (*victim)->Evict();
+    m_allocated.erase(victim);
+  }
 }
 
 // if available, increment reference count, and return the image.
@@ -201,6 +271,62 @@ void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediat
   }
 }
 
+void CGUILargeTextureManager::PrefetchImage(const CStdString &path, bool useCache)
+{
+  CSingleLock lock(m_listSection);
+  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  {
+    CLargeTexture *image = *it;
+    if (image->GetPath() == path)
+    {
+      image->AddPrefetchRef();
+      return;
+    }
+  }
+  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  {
+    CLargeTexture *image = it->second;
+    if (image->GetPath() == path)
+    {
+      image->AddPrefetchRef();
+      return;
+    }
+  }
+
+  // queue the item behind the images that are needed on screen
+  CLargeTexture *image = new CLargeTexture(path, true);
+  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path, useCache), this, CJob::PRIORITY_LOW);
+  m_queued.push_back(make_pair(jobID, image));
+}
+
+void CGUILargeTextureManager::ReleasePrefetchedImage(const CStdString &path)
+{
+  CSingleLock lock(m_listSection);
+  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  {
+    CLargeTexture *image = *it;
+    if (image->GetPath() == path)
+    {
+      image->DecrPrefetchRef(false);
+      return;
+    }
+  }
+  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  {
+    unsigned int id = it->first;
+    CLargeTexture *image = it->second;
+    if (image->GetPath() == path)
+    {
+      if (image->DecrPrefetchRef(true))
+      { // nobody wants it any more, so cancel the load
+        CJobManager::GetInstance().CancelJob(id);
+        m_queued.erase(it);
+      }
+      return;
+    }
+  }
+}
+
 // queue the image, and start the background loader if necessary
 void CGUILargeTextureManager::QueueImage(const CStdString &path, bool useCache)
 {
@@ -210,6 +336,9 @@ void CGUILargeTextureManager::QueueImage(const CStdString &path, bool useCache)
     CLargeTexture *image = it->second;
     if (image->GetPath() == path)
     {
+      // a prefetched image is needed on screen now, so stop it waiting behind the other prefetches
+      if (image->IsUnused())
+        CJobManager::GetInstance().ChangePriority(it->first, CJob::PRIORITY_NORMAL);
       image->AddRef();
       return; // already queued
     }
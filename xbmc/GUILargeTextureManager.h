@@ -101,6 +101,31 @@ public:
    */
   void ReleaseImage(const CStdString &path, bool immediately = false);
 
+  /*!
+   \brief Request a texture to be loaded ahead of being displayed.
+
+   Prefetched textures are loaded at low priority and held by a prefetch reference, which
+   is released with ReleasePrefetchedImage().  If a control asks for the texture through
+   GetImage() while it is still queued, the load is moved to normal priority.  Textures
+   that are only held by prefetch references count towards a memory budget, and the least
+   recently requested ones are dropped when it is exceeded.
+
+   \param path path of the image to load.
+   \param useCache whether or not to use any caching with this image
+   \sa ReleasePrefetchedImage, CleanupUnusedImages
+   */
+  void PrefetchImage(const CStdString &path, bool useCache = true);
+
+  /*!
+   \brief Release a prefetch reference taken with PrefetchImage().
+
+   If the texture is still queued for loading and nothing else references it, the load is
+   cancelled.
+
+   \param path path of the image to release.
+   */
+  void ReleasePrefetchedImage(const CStdString &path);
+
   /*!
    \brief Cleanup images that are no longer in use.
 
@@ -108,6 +133,9 @@ public:
    they are flagged as unused with the current time.  After a delay they may be unloaded, hence
    CleanupUnusedImages() should be called periodically to ensure this occurs.
 
+   Textures no control references, either awaiting deletion or prefetched, are also dropped
+   once they take more than the prefetch memory budget, oldest first.
+
    \param immediately set to true to cleanup images regardless of whether the delay has passed
    */
   void CleanupUnusedImages(bool immediately = false);
@@ -116,27 +144,40 @@ private:
   class CLargeTexture
   {
   public:
-    CLargeTexture(const CStdString &path);
+    CLargeTexture(const CStdString &path, bool prefetch = false);
     virtual ~CLargeTexture();
 
     void AddRef();
     bool DecrRef(bool deleteImmediately);
+    void AddPrefetchRef();
+    bool DecrPrefetchRef(bool deleteImmediately);
     bool DeleteIfRequired(bool deleteImmediately = false);
+    void Evict();
     void SetTexture(CBaseTexture* texture);
 
     const CStdString &GetPath() const { return m_path; };
     const CTextureArray &GetTexture() const { return m_texture; };
+    bool IsUnused() const { return m_refCount == 0; };
+    bool IsPrefetched() const { return m_prefetchCount > 0; };
+    unsigned int GetMemoryUsage() const { return m_memory; };
+    unsigned int GetLastUsed() const { return m_lastUsed; };
 
   private:
     static const unsigned int TIME_TO_DELETE = 2000;
 
+    bool DeleteIfUnreferenced(bool deleteImmediately);
+
     unsigned int m_refCount;
+    unsigned int m_prefetchCount;
     CStdString m_path;
     CTextureArray m_texture;
     unsigned int m_timeToDelete;
+    unsigned int m_lastUsed; ///< frame time of the last reference or prefetch request
+    unsigned int m_memory;   ///< size of the texture in bytes
   };
 
   void QueueImage(const CStdString &path, bool useCache = true);
+  void EvictUnusedImages();
 
   std::vector< std::pair<unsigned int, CLargeTexture *> > m_queued;
   std::vector<CLargeTexture *> m_allocated;
@@ -28,18 +28,21 @@
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
+#include "windowing/WindowingFactory.h"
 #include "URL.h"
 #include "utils/StringUtils.h"
 
 using namespace XFILE;
 
+#define UPDATE_INTERVAL 5000 ///< milliseconds between writes of the use counts and valid flags
+
 CTextureCache &CTextureCache::Get()
 {
   static CTextureCache s_cache;
   return s_cache;
 }
 
-CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE)
+CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE), m_pipeline(this), m_updateTimer(this)
 {
 }
 
@@ -52,11 +55,26 @@ void CTextureCache::Initialize()
   CSingleLock lock(m_databaseSection);
   if (!m_database.IsOpen())
     m_database.Open();
+  lock.Leave();
+
+  if (g_advancedSettings.m_imageCachePipeline)
+    m_pipeline.Start();
+  m_updateTimer.Start(UPDATE_INTERVAL, true);
 }
 
 void CTextureCache::Deinitialize()
 {
+  m_pipeline.Stop();
   CancelJobs();
+
+  // write anything still queued before the database goes away
+  m_updateTimer.Stop(true);
+  FlushDatabaseUpdates();
+  {
+    CSingleLock updateLock(m_updateSection);
+    m_updateDatabase.Close();
+  }
+
   CSingleLock lock(m_databaseSection);
   m_database.Close();
 }
@@ -114,7 +132,7 @@ CStdString CTextureCache::CheckCachedImage(const CStdString &url, bool returnDDS
       CStdString ddsPath = URIUtils::ReplaceExtension(path, ".dds");
       if (CFile::Exists(ddsPath))
         return ddsPath;
-      if (g_advancedSettings.m_useDDSFanart)
+      if (UseDDS(details))
         AddJob(new CTextureDDSJob(path));
     }
     return path;
@@ -130,7 +148,11 @@ void CTextureCache::BackgroundCacheImage(const CStdString &url)
     return; // image is already cached and doesn't need to be checked further
 
   // needs (re)caching
-  AddJob(new CTextureCacheJob(CTextureUtils::UnwrapImageURL(url), details.hash));
+  CTextureCacheJob *job = new CTextureCacheJob(CTextureUtils::UnwrapImageURL(url), details.hash);
+  if (m_pipeline.IsRunning())
+    m_pipeline.AddJob(job);
+  else
+    AddJob(job);
 }
 
 bool CTextureCache::CacheImage(const CStdString &image, CTextureDetails &details)
@@ -209,36 +231,94 @@ bool CTextureCache::ClearCachedImage(int id)
 bool CTextureCache::GetCachedTexture(const CStdString &url, CTextureDetails &details)
 {
   CSingleLock lock(m_databaseSection);
-  return m_database.GetCachedTexture(url, details);
+  if (!m_database.GetCachedTexture(url, details))
+    return false;
+  lock.Leave();
+
+  // a texture that is queued as valid was checked just now, whatever the database still says
+  CSingleLock useLock(m_useCountSection);
+  if (m_validTextures.find(url) != m_validTextures.end())
+    details.hash.clear();
+  return true;
 }
 
 bool CTextureCache::AddCachedTexture(const CStdString &url, const CTextureDetails &details)
 {
+  {
+    CSingleLock useLock(m_useCountSection);
+    m_validTextures.erase(url);
+  }
   CSingleLock lock(m_databaseSection);
   return m_database.AddCachedTexture(url, details);
 }
 
 void CTextureCache::IncrementUseCount(const CTextureDetails &details)
 {
-  static const size_t count_before_update = 100;
   CSingleLock lock(m_useCountSection);
-  m_useCounts.reserve(count_before_update);
-  m_useCounts.push_back(details);
-  if (m_useCounts.size() >= count_before_update)
+  m_useCounts[UseCountKey(details.id, std::make_pair(details.width, details.height))]++;
+}
+
+bool CTextureCache::SetCachedTextureValid(const CStdString &url, bool updateable)
+{
+  CSingleLock lock(m_useCountSection);
+  m_validTextures[url] = updateable;
+  return true;
+}
+
+void CTextureCache::FlushDatabaseUpdates()
+{
+  CSingleLock updateLock(m_updateSection);
+
+  // valid flags stay queued until written so that GetCachedTexture sees them meanwhile
+  std::map<UseCountKey, unsigned int> useCounts;
+  std::map<std::string, bool> validTextures;
+  {
+    CSingleLock lock(m_useCountSection);
+    useCounts.swap(m_useCounts);
+    validTextures = m_validTextures;
+  }
+  if (useCounts.empty() && validTextures.empty())
+    return;
+
+  if (!m_updateDatabase.IsOpen() && !m_updateDatabase.Open())
   {
-    AddJob(new CTextureUseCountJob(m_useCounts));
-    m_useCounts.clear();
+    CLog::Log(LOGERROR, "%s - unable to open the texture database, %u use counts lost", __FUNCTION__, (unsigned int)useCounts.size());
+    return;
+  }
+
+  m_updateDatabase.BeginTransaction();
+  for (std::map<std::string, bool>::const_iterator i = validTextures.begin(); i != validTextures.end(); ++i)
+    m_updateDatabase.SetCachedTextureValid(i->first, i->second);
+  for (std::map<UseCountKey, unsigned int>::const_iterator i = useCounts.begin(); i != useCounts.end(); ++i)
+  {
+    CTextureDetails details;
+    details.id = i->first.first;
+    details.width = i->first.second.first;
+    details.height = i->first.second.second;
+    m_updateDatabase.IncrementUseCount(details, i->second);
+  }
+  m_updateDatabase.CommitTransaction();
+
+  CSingleLock lock(m_useCountSection);
+  for (std::map<std::string, bool>::const_iterator i = validTextures.begin(); i != validTextures.end(); ++i)
+  {
+    std::map<std::string, bool>::iterator j = m_validTextures.find(i->first);
+    if (j != m_validTextures.end() && j->second == i->second)
+      m_validTextures.erase(j);
   }
 }
 
-bool CTextureCache::SetCachedTextureValid(const CStdString &url, bool updateable)
+void CTextureCache::OnTimeout()
 {
-  CSingleLock lock(m_databaseSection);
-  return m_database.SetCachedTextureValid(url, updateable);
+  FlushDatabaseUpdates();
 }
 
 bool CTextureCache::ClearCachedTexture(const CStdString &url, CStdString &cachedURL)
 {
+  {
+    CSingleLock useLock(m_useCountSection);
+    m_validTextures.erase(url);
+  }
   CSingleLock lock(m_databaseSection);
   return m_database.ClearCachedTexture(url, cachedURL);
 }
@@ -283,10 +363,39 @@ void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
   m_completeEvent.Set();
 
   // TODO: call back to the UI indicating that it can update it's image...
-  if (success && g_advancedSettings.m_useDDSFanart && !job->m_details.file.empty())
+  if (success && UseDDS(job->m_details) && !job->m_details.file.empty())
     AddJob(new CTextureDDSJob(GetCachedPath(job->m_details.file)));
 }
 
+bool CTextureCache::OnCachingStart(CTextureCacheJob *job)
+{
+  { // check our processing list
+    CSingleLock lock(m_processingSection);
+    if (m_processinglist.find(job->m_url) != m_processinglist.end())
+      return false;
+    m_processinglist.insert(job->m_url);
+  }
+
+  // check whether we need cache the job anyway
+  bool needsRecaching = false;
+  CStdString path(CheckCachedImage(job->m_url, false, needsRecaching));
+  if (!path.empty() && !needsRecaching)
+  {
+    OnCachingComplete(false, job);
+    return false;
+  }
+  return true;
+}
+
+bool CTextureCache::UseDDS(const CTextureDetails &details)
+{
+  if (!g_advancedSettings.m_useDDSFanart || !g_Windowing.SupportsDXT())
+    return false;
+  if (!details.width || !details.height)
+    return true; // not in the database, eg. a local image
+  return std::max(details.width, details.height) >= g_advancedSettings.m_ddsMinSize;
+}
+
 void CTextureCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   if (strcmp(job->GetType(), kJobTypeCacheImage) == 0)
@@ -20,11 +20,14 @@
 
 #pragma once
 
+#include <map>
 #include <set>
 #include "utils/StdString.h"
 #include "utils/JobManager.h"
 #include "TextureDatabase.h"
+#include "TextureCachePipeline.h"
 #include "threads/Event.h"
+#include "threads/Timer.h"
 
 class CURL;
 class CBaseTexture;
@@ -39,7 +42,7 @@ class CBaseTexture;
  unused for a set period of time.
 
  */
-class CTextureCache : public CJobQueue
+class CTextureCache : public CJobQueue, private ITextureCachePipelineCallback, private ITimerCallback
 {
 public:
   /*!
@@ -196,19 +199,39 @@ private:
   bool ClearCachedTexture(int textureID, CStdString &cacheFile);
 
   /*! \brief Increment the use count of a texture
-   Stores locally before calling CTextureDatabase::IncrementUseCount via a CUseCountJob
-   \sa CUseCountJob, CTextureDatabase::IncrementUseCount
+   Counted in memory and written by FlushDatabaseUpdates, so the GUI never waits on the database for it.
+   \sa FlushDatabaseUpdates, CTextureDatabase::IncrementUseCount
    */
   void IncrementUseCount(const CTextureDetails &details);
 
   /*! \brief Set a previously cached texture as valid in the database
-   Thread-safe wrapper of CTextureDatabase::SetCachedTextureValid
+   Queued in memory and written by FlushDatabaseUpdates, GetCachedTexture takes queued updates into account.
    \param image url of the original image
    \param updateable whether this image should be checked for updates
    \return true if successful, false otherwise.
+   \sa FlushDatabaseUpdates, CTextureDatabase::SetCachedTextureValid
    */
   bool SetCachedTextureValid(const CStdString &url, bool updateable);
 
+  /*! \brief Write the queued use counts and valid flags to the database in a single transaction
+   Runs periodically on our timer thread and on Deinitialize.  Uses its own connection to the database
+   so that lookups from the GUI aren't held up while it writes.
+   \sa IncrementUseCount, SetCachedTextureValid
+   */
+  void FlushDatabaseUpdates();
+
+  virtual void OnTimeout();
+
+  /*! \brief Decide whether a cached image should get a compressed .dds copy.
+   The copy holds DXT compressed levels down to 1x1 that load straight to texture without decoding,
+   which pays off for large artwork on GPUs that take DXT directly. Small images decode quickly
+   and show the 4x4 blocks of DXT the most, so are left as they are.
+   \param details details of the cached image, width and height are 0 if unknown.
+   \return true if a .dds copy should be made, false otherwise.
+   \sa CTextureDDSJob
+   */
+  static bool UseDDS(const CTextureDetails &details);
+
   virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
   virtual void OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job);
 
@@ -218,14 +241,28 @@ private:
    \param success whether the job was successful.
    \param job the caching job.
    */
-  void OnCachingComplete(bool success, CTextureCacheJob *job);
+  virtual void OnCachingComplete(bool success, CTextureCacheJob *job);
+
+  /*! \brief Called before a pipelined caching job starts.
+   Checks our processing list and whether the image still needs caching, as CTextureCacheJob::DoWork does.
+   \param job the caching job.
+   \return true if the job should go ahead, false otherwise.
+   \sa CTextureCachePipeline
+   */
+  virtual bool OnCachingStart(CTextureCacheJob *job);
 
   CCriticalSection m_databaseSection;
   CTextureDatabase m_database;
   std::set<CStdString> m_processinglist; ///< currently processing list to avoid 2 jobs being processed at once
   CCriticalSection     m_processingSection;
   CEvent               m_completeEvent; ///< Set whenever a job has finished
-  std::vector<CTextureDetails> m_useCounts; ///< Use count tracking
-  CCriticalSection             m_useCountSection;
+  typedef std::pair<int, std::pair<unsigned int, unsigned int> > UseCountKey; ///< texture id, width and height
+  std::map<UseCountKey, unsigned int> m_useCounts;  ///< use counts not yet written to the database
+  std::map<std::string, bool>         m_validTextures; ///< valid flags (url, updateable) not yet written to the database
+  CCriticalSection                    m_useCountSection;
+  CCriticalSection m_updateSection;  ///< serializes FlushDatabaseUpdates
+  CTextureDatabase m_updateDatabase; ///< connection used by FlushDatabaseUpdates
+  CTimer           m_updateTimer;
+  CTextureCachePipeline        m_pipeline; ///< background caching, if enabled
 };
 
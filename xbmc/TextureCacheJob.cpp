@@ -29,6 +29,7 @@
 #include "pictures/Picture.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
+#include "utils/Mime.h"
 #include "URL.h"
 #include "FileItem.h"
 #include "music/MusicThumbLoader.h"
@@ -42,10 +43,15 @@ CTextureCacheJob::CTextureCacheJob(const CStdString &url, const CStdString &oldH
   m_url = url;
   m_oldHash = oldHash;
   m_cachePath = CTextureCache::GetCacheFile(m_url);
+  m_width = m_height = 0;
+  m_texture = NULL;
+  m_scaled = NULL;
 }
 
 CTextureCacheJob::~CTextureCacheJob()
 {
+  delete m_texture;
+  delete[] m_scaled;
 }
 
 bool CTextureCacheJob::operator==(const CJob* job) const
@@ -76,55 +82,140 @@ bool CTextureCacheJob::DoWork()
 
 bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
 {
-  // unwrap the URL as required
-  std::string additional_info;
-  unsigned int width, height;
-  CStdString image = DecodeImageURL(m_url, width, height, additional_info);
-
-  m_details.updateable = additional_info != "music" && UpdateableURL(image);
-
-  // generate the hash
-  m_details.hash = GetImageHash(image);
-  if (m_details.hash.empty())
+  if (!Prepare())
     return false;
-  else if (m_details.hash == m_oldHash)
+  else if (!NeedsCaching())
     return true;
 
 #if defined(HAS_OMXPLAYER)
-  if (COMXImage::CreateThumb(image, width, height, additional_info, CTextureCache::GetCachedPath(m_cachePath + ".jpg")))
+  if (COMXImage::CreateThumb(m_image, m_width, m_height, m_additionalInfo, CTextureCache::GetCachedPath(m_cachePath + ".jpg")))
   {
-    m_details.width = width;
-    m_details.height = height;
+    m_details.width = m_width;
+    m_details.height = m_height;
     m_details.file = m_cachePath + ".jpg";
     if (out_texture)
-      *out_texture = LoadImage(CTextureCache::GetCachedPath(m_details.file), width, height, "" /* already flipped */);
-    CLog::Log(LOGDEBUG, "Fast %s image '%s' to '%s': %p", m_oldHash.empty() ? "Caching" : "Recaching", image.c_str(), m_details.file.c_str(), out_texture);
+      *out_texture = LoadImage(CTextureCache::GetCachedPath(m_details.file), m_width, m_height, "" /* already flipped */);
+    CLog::Log(LOGDEBUG, "Fast %s image '%s' to '%s': %p", m_oldHash.empty() ? "Caching" : "Recaching", m_image.c_str(), m_details.file.c_str(), out_texture);
     return true;
   }
 #endif
-  CBaseTexture *texture = LoadImage(image, width, height, additional_info, true);
-  if (texture)
+  if (!Fetch() || !Decode(out_texture != NULL) || !Encode())
+    return false;
+
+  if (out_texture) // caller wants the texture
   {
-    if (texture->HasAlpha())
-      m_details.file = m_cachePath + ".png";
-    else
-      m_details.file = m_cachePath + ".jpg";
+    *out_texture = m_texture;
+    m_texture = NULL;
+  }
+  return true;
+}
 
-    CLog::Log(LOGDEBUG, "%s image '%s' to '%s':", m_oldHash.empty() ? "Caching" : "Recaching", image.c_str(), m_details.file.c_str());
+bool CTextureCacheJob::Prepare()
+{
+  // unwrap the URL as required
+  m_image = DecodeImageURL(m_url, m_width, m_height, m_additionalInfo);
 
-    if (CPicture::CacheTexture(texture, width, height, CTextureCache::GetCachedPath(m_details.file)))
+  m_details.updateable = m_additionalInfo != "music" && UpdateableURL(m_image);
+
+  // generate the hash
+  m_details.hash = GetImageHash(m_image);
+  return !m_details.hash.empty();
+}
+
+bool CTextureCacheJob::Fetch()
+{
+  if (m_additionalInfo == "music")
+  { // special case for embedded music images
+    MUSIC_INFO::EmbeddedArt art;
+    if (CMusicThumbLoader::GetEmbeddedThumb(m_image, art))
     {
-      m_details.width = width;
-      m_details.height = height;
-      if (out_texture) // caller wants the texture
-        *out_texture = texture;
-      else
-        delete texture;
+      m_mimeType = art.mime;
+      memcpy(m_data.allocate(art.size).get(), &art.data[0], art.size);
       return true;
     }
   }
-  delete texture;
-  return false;
+
+  // Validate file URL to see if it is an image
+  CFileItem file(m_image, false);
+  file.FillInMimeType();
+  if (!(file.IsPicture() && !(file.IsZIP() || file.IsRAR() || file.IsCBR() || file.IsCBZ() ))
+      && !StringUtils::StartsWithNoCase(file.GetMimeType(), "image/") && !StringUtils::EqualsNoCase(file.GetMimeType(), "application/octet-stream")) // ignore non-pictures
+    return false;
+
+  // .dds and android app icons aren't decoded from memory, they're loaded from their path in Decode()
+  if (URIUtils::HasExtension(m_image, ".dds") || StringUtils::StartsWith(m_image, "androidapp://"))
+    return true;
+
+  m_mimeType = file.GetMimeType();
+  if (m_mimeType.empty())
+  {
+    CURL url(m_image);
+    m_mimeType = url.GetFileType().empty() ? CMime::GetMimeType(url) : "image/" + url.GetFileType();
+  }
+
+  XFILE::CFile image;
+  return image.LoadFile(m_image, m_data) > 0;
+}
+
+bool CTextureCacheJob::Decode(bool keepTexture)
+{
+  // no need to decode larger than we cache at, unless the texture is kept for a caller who
+  // expects it at the size asked for, as CacheTexture() always returned it
+  unsigned int width = m_width, height = m_height;
+  if ((!width || !height) && !keepTexture)
+    CPicture::GetMaxCacheSize(width, height);
+
+  if (m_data.size())
+  {
+    bool autoRotate = m_additionalInfo != "music" && CSettings::Get().GetBool("pictures.useexifrotation");
+    m_texture = CBaseTexture::LoadFromFileInMemory((unsigned char *)m_data.get(), m_data.size(), m_mimeType, width, height, autoRotate);
+    m_data.clear();
+    if (m_texture && m_additionalInfo == "flipped") // see LoadImage
+      m_texture->SetOrientation(m_texture->GetOrientation() ^ 1);
+  }
+  else
+    m_texture = LoadImage(m_image, width, height, m_additionalInfo, true);
+  if (!m_texture)
+    return false;
+
+  if (m_texture->HasAlpha())
+    m_details.file = m_cachePath + ".png";
+  else
+    m_details.file = m_cachePath + ".jpg";
+
+  m_details.width = m_width;
+  m_details.height = m_height;
+  if (CPicture::GetCacheSize(m_texture->GetWidth(), m_texture->GetHeight(), m_texture->GetOrientation(), m_details.width, m_details.height))
+  {
+    m_scaled = CPicture::ResizeTexture(m_texture->GetPixels(), m_texture->GetWidth(), m_texture->GetHeight(), m_texture->GetPitch(),
+                                       m_texture->GetOrientation(), m_details.width, m_details.height);
+    if (!keepTexture)
+    {
+      delete m_texture;
+      m_texture = NULL;
+    }
+    if (!m_scaled)
+      return false;
+  }
+  return true;
+}
+
+bool CTextureCacheJob::Encode()
+{
+  CLog::Log(LOGDEBUG, "%s image '%s' to '%s':", m_oldHash.empty() ? "Caching" : "Recaching", m_image.c_str(), m_details.file.c_str());
+
+  bool success;
+  if (m_scaled)
+  {
+    success = CPicture::CreateThumbnailFromSurface((unsigned char *)m_scaled, m_details.width, m_details.height, m_details.width * 4,
+                                                   CTextureCache::GetCachedPath(m_details.file));
+    delete[] m_scaled;
+    m_scaled = NULL;
+  }
+  else
+    success = CPicture::CreateThumbnailFromSurface(m_texture->GetPixels(), m_texture->GetWidth(), m_texture->GetHeight(), m_texture->GetPitch(),
+                                                   CTextureCache::GetCachedPath(m_details.file));
+  return success;
 }
 
 CStdString CTextureCacheJob::DecodeImageURL(const CStdString &url, unsigned int &width, unsigned int &height, std::string &additional_info)
@@ -233,37 +324,9 @@ bool CTextureDDSJob::DoWork()
   { // convert to DDS
     CDDSImage dds;
     CLog::Log(LOGDEBUG, "Creating DDS version of: %s", m_original.c_str());
-    bool ret = dds.Create(URIUtils::ReplaceExtension(m_original, ".dds"), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), 40);
+    bool ret = dds.Create(URIUtils::ReplaceExtension(m_original, ".dds"), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), 40, true);
     delete texture;
     return ret;
   }
   return false;
 }
-
-CTextureUseCountJob::CTextureUseCountJob(const std::vector<CTextureDetails> &textures) : m_textures(textures)
-{
-}
-
-bool CTextureUseCountJob::operator==(const CJob* job) const
-{
-  if (strcmp(job->GetType(),GetType()) == 0)
-  {
-    const CTextureUseCountJob* useJob = dynamic_cast<const CTextureUseCountJob*>(job);
-    if (useJob && useJob->m_textures == m_textures)
-      return true;
-  }
-  return false;
-}
-
-bool CTextureUseCountJob::DoWork()
-{
-  CTextureDatabase db;
-  if (db.Open())
-  {
-    db.BeginTransaction();
-    for (std::vector<CTextureDetails>::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
-      db.IncrementUseCount(*i);
-    db.CommitTransaction();
-  }
-  return true;
-}
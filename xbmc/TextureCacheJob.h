@@ -22,6 +22,7 @@
 
 #include "utils/StdString.h"
 #include "utils/Job.h"
+#include "utils/auto_buffer.h"
 
 class CBaseTexture;
 
@@ -75,6 +76,40 @@ public:
    */
   bool CacheTexture(CBaseTexture **texture = NULL);
 
+  /*! \name Caching stages
+   CacheTexture split into stages that may each run on a different thread, see CTextureCachePipeline.
+   Prepare, Fetch, Decode and Encode must be called in that order, stopping at the first failure.
+   */
+  //@{
+  /*! \brief Unwrap the URL and generate the hash of the image.
+   \return true if successful, false if the image is unavailable. Check NeedsCaching() to see if the remaining stages are needed.
+   */
+  bool Prepare();
+
+  /*! \brief Whether the image changed since it was last cached, valid after Prepare()
+   \return true if the image needs to be fetched, decoded and encoded, false otherwise.
+   */
+  bool NeedsCaching() const { return m_details.hash != m_oldHash; };
+
+  /*! \brief Read the image file (or embedded art) into memory.
+   \return true if successful, false otherwise.
+   */
+  bool Fetch();
+
+  /*! \brief Decode the fetched image and resize and orientate it to the size it is cached at.
+   The image is decoded no larger than it is cached at, so that libjpeg may downscale while decoding,
+   unless the texture is kept, in which case it is decoded at the size given in the URL as LoadImage() does.
+   \param keepTexture whether the decoded texture should be kept for the caller even if it is resized.
+   \return true if successful, false otherwise.
+   */
+  bool Decode(bool keepTexture = false);
+
+  /*! \brief Write the decoded image to the texture cache as a JPG or PNG.
+   \return true if successful, false otherwise.
+   */
+  bool Encode();
+  //@}
+
   CStdString m_url;
   CStdString m_oldHash;
   CTextureDetails m_details;
@@ -120,6 +155,16 @@ private:
   static CBaseTexture *LoadImage(const CStdString &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels = false);
 
   CStdString    m_cachePath;
+
+  // state passed between the caching stages
+  CStdString           m_image;          ///< the underlying image, from DecodeImageURL
+  std::string          m_additionalInfo; ///< additional info from DecodeImageURL
+  unsigned int         m_width;          ///< maximum width to cache at, 0 for no maximum
+  unsigned int         m_height;         ///< maximum height to cache at, 0 for no maximum
+  std::string          m_mimeType;       ///< mime type of m_data
+  XUTILS::auto_buffer  m_data;           ///< the fetched image file, empty if the image is loaded from its path instead
+  CBaseTexture        *m_texture;        ///< the decoded image
+  uint32_t            *m_scaled;         ///< the decoded image resized and orientated, NULL if no resize was needed
 };
 
 /* \brief Job class for creating .dds versions of textures
@@ -135,18 +180,3 @@ public:
 
   CStdString m_original;
 };
-
-/* \brief Job class for storing the use count of textures
- */
-class CTextureUseCountJob : public CJob
-{
-public:
-  CTextureUseCountJob(const std::vector<CTextureDetails> &textures);
-
-  virtual const char* GetType() const { return "usecount"; };
-  virtual bool operator==(const CJob *job) const;
-  virtual bool DoWork();
-
-private:
-  std::vector<CTextureDetails> m_textures;
-};
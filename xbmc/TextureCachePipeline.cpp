@@ -0,0 +1,266 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TextureCachePipeline.h"
+#include "TextureCacheJob.h"
+#include "threads/SingleLock.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+#define PAUSED_POLL_TIME 200 // ms between checks for CJobManager being unpaused
+
+CTextureCachePipeline::CWorker::CWorker(CTextureCachePipeline *pipeline, Stage stage)
+  : CThread(stage == STAGE_FETCH ? "TextureFetch" : stage == STAGE_DECODE ? "TextureDecode" : "TextureEncode"),
+    m_pipeline(pipeline), m_stage(stage)
+{
+}
+
+void CTextureCachePipeline::CWorker::Process()
+{
+  SetPriority(GetMinPriority());
+  m_pipeline->Run(m_stage);
+}
+
+CTextureCachePipeline::CTextureCachePipeline(ITextureCachePipelineCallback *callback)
+  : m_callback(callback)
+{
+  m_queueLimit = 0;
+  m_pending = 0;
+  m_stopping = false;
+}
+
+CTextureCachePipeline::~CTextureCachePipeline()
+{
+  Stop();
+}
+
+void CTextureCachePipeline::Start(unsigned int fetchers, unsigned int decoders, unsigned int encoders)
+{
+  CSingleLock lock(m_section);
+  if (!m_workers.empty())
+    return;
+
+  unsigned int cpus = std::max(g_cpuInfo.getCPUCount(), 1);
+  if (!fetchers)
+    fetchers = 2;
+  if (!decoders)
+    decoders = cpus;
+  if (!encoders)
+    encoders = std::max(cpus / 2, 1U);
+
+  // enough fetched images to keep every decoder busy, but no more as each holds a whole file in memory
+  m_queueLimit = 2 * std::max(decoders, encoders);
+  m_stopping = false;
+
+  for (unsigned int i = 0; i < fetchers; i++)
+    m_workers.push_back(new CWorker(this, STAGE_FETCH));
+  for (unsigned int i = 0; i < decoders; i++)
+    m_workers.push_back(new CWorker(this, STAGE_DECODE));
+  for (unsigned int i = 0; i < encoders; i++)
+    m_workers.push_back(new CWorker(this, STAGE_ENCODE));
+  for (std::vector<CWorker *>::iterator i = m_workers.begin(); i != m_workers.end(); ++i)
+    (*i)->Create();
+
+  CLog::Log(LOGDEBUG, "%s - started with %u fetch, %u decode and %u encode threads", __FUNCTION__, fetchers, decoders, encoders);
+}
+
+void CTextureCachePipeline::Stop()
+{
+  std::vector<CWorker *> workers;
+  {
+    CSingleLock lock(m_section);
+    m_stopping = true;
+    m_changed.notifyAll();
+    workers.swap(m_workers);
+  }
+
+  // workers drop the job they hold once they see we're stopping
+  for (std::vector<CWorker *>::iterator i = workers.begin(); i != workers.end(); ++i)
+  {
+    (*i)->StopThread();
+    delete *i;
+  }
+
+  std::vector<CTextureCacheJob *> started;
+  unsigned int dropped = 0;
+  {
+    CSingleLock lock(m_section);
+    for (unsigned int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+      for (std::deque<CTextureCacheJob *>::iterator i = m_queues[stage].begin(); i != m_queues[stage].end(); ++i)
+      {
+        if (stage == STAGE_FETCH)
+          delete *i;
+        else
+          started.push_back(*i);
+      }
+      dropped += m_queues[stage].size();
+      m_queues[stage].clear();
+    }
+  }
+
+  // jobs past the fetch stage were started, so the callback expects to hear they're done
+  for (std::vector<CTextureCacheJob *>::iterator i = started.begin(); i != started.end(); ++i)
+  {
+    m_callback->OnCachingComplete(false, *i);
+    delete *i;
+  }
+
+  CSingleLock lock(m_section);
+  m_pending -= dropped;
+  m_changed.notifyAll();
+}
+
+bool CTextureCachePipeline::IsRunning() const
+{
+  CSingleLock lock(m_section);
+  return !m_workers.empty() && !m_stopping;
+}
+
+bool CTextureCachePipeline::AddJob(CTextureCacheJob *job)
+{
+  CSingleLock lock(m_section);
+  if (m_workers.empty() || m_stopping)
+  {
+    delete job;
+    return false;
+  }
+
+  // check that we don't already have this job queued
+  std::deque<CTextureCacheJob *> &queue = m_queues[STAGE_FETCH];
+  for (std::deque<CTextureCacheJob *>::const_iterator i = queue.begin(); i != queue.end(); ++i)
+  {
+    if (*job == *i)
+    {
+      delete job;
+      return false;
+    }
+  }
+
+  queue.push_back(job);
+  m_pending++;
+  m_changed.notifyAll();
+  return true;
+}
+
+bool CTextureCachePipeline::WaitForIdle(unsigned int timeout)
+{
+  XbmcThreads::EndTime endTime(timeout);
+  CSingleLock lock(m_section);
+  while (m_pending)
+  {
+    unsigned int left = endTime.MillisLeft();
+    if (!left)
+      return false;
+    m_changed.wait(lock, left);
+  }
+  return true;
+}
+
+unsigned int CTextureCachePipeline::GetPendingJobs() const
+{
+  CSingleLock lock(m_section);
+  return m_pending;
+}
+
+void CTextureCachePipeline::Run(Stage stage)
+{
+  while (CTextureCacheJob *job = Pop(stage))
+  {
+    if (stage == STAGE_FETCH && !m_callback->OnCachingStart(job))
+      Finish(job, false, false);
+    else if (!Work(stage, job))
+      Finish(job, true, false);
+    else if (stage == STAGE_ENCODE || (stage == STAGE_FETCH && !job->NeedsCaching()))
+      Finish(job, true, true);
+    else
+      Push((Stage)(stage + 1), job);
+  }
+}
+
+bool CTextureCachePipeline::Work(Stage stage, CTextureCacheJob *job)
+{
+  switch (stage)
+  {
+  case STAGE_FETCH:
+    return job->Prepare() && (!job->NeedsCaching() || job->Fetch());
+  case STAGE_DECODE:
+    return job->Decode();
+  case STAGE_ENCODE:
+    return job->Encode();
+  default:
+    return false;
+  }
+}
+
+CTextureCacheJob *CTextureCachePipeline::Pop(Stage stage)
+{
+  CSingleLock lock(m_section);
+  while (!m_stopping)
+  {
+    std::deque<CTextureCacheJob *> &queue = m_queues[stage];
+    if (!queue.empty())
+    {
+      // new jobs are held back while paused, and while the decoders have enough to do
+      if (stage != STAGE_FETCH)
+        break;
+      if (m_queues[STAGE_DECODE].size() < m_queueLimit && !CJobManager::GetInstance().IsPaused())
+        break;
+    }
+    m_changed.wait(lock, PAUSED_POLL_TIME);
+  }
+  if (m_stopping)
+    return NULL;
+
+  CTextureCacheJob *job = m_queues[stage].front();
+  m_queues[stage].pop_front();
+  m_changed.notifyAll();
+  return job;
+}
+
+bool CTextureCachePipeline::Push(Stage stage, CTextureCacheJob *job)
+{
+  CSingleLock lock(m_section);
+  while (!m_stopping && m_queues[stage].size() >= m_queueLimit)
+    m_changed.wait(lock);
+  if (m_stopping)
+  {
+    lock.Leave();
+    Finish(job, true, false);
+    return false;
+  }
+  m_queues[stage].push_back(job);
+  m_changed.notifyAll();
+  return true;
+}
+
+void CTextureCachePipeline::Finish(CTextureCacheJob *job, bool callback, bool success)
+{
+  if (callback)
+    m_callback->OnCachingComplete(success, job);
+  delete job;
+
+  CSingleLock lock(m_section);
+  m_pending--;
+  m_changed.notifyAll();
+}
@@ -0,0 +1,152 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "threads/CriticalSection.h"
+#include "threads/Condition.h"
+#include "threads/Thread.h"
+
+class CTextureCacheJob;
+
+/*!
+ \ingroup textures
+ \brief Callback interface for the owner of a CTextureCachePipeline
+ */
+class ITextureCachePipelineCallback
+{
+public:
+  virtual ~ITextureCachePipelineCallback() {}
+
+  /*!
+   \brief Called on a fetch worker before a job is started.
+   \param job the caching job.
+   \return true to cache the image, false to drop the job (eg. it is already being cached).
+   */
+  virtual bool OnCachingStart(CTextureCacheJob *job) = 0;
+
+  /*!
+   \brief Called on a worker thread once a started job is done.
+   \param success whether the image was cached.
+   \param job the caching job, deleted by the pipeline once this returns.
+   */
+  virtual void OnCachingComplete(bool success, CTextureCacheJob *job) = 0;
+};
+
+/*!
+ \ingroup textures
+ \brief Caches images through separate fetch, decode and encode stages.
+
+ Each stage has its own pool of worker threads, with bounded queues between them, so that
+ reading the next images overlaps the decoding and resizing of the current ones and the
+ writing of the previous ones. Used by CTextureCache for background caching, where a single
+ CTextureCacheJob at a time leaves all but one core idle while a library's artwork is cached.
+
+ Workers run at minimum priority and no jobs are started while CJobManager::PauseJobs() is in effect.
+
+ \sa CTextureCacheJob::Prepare, CTextureCacheJob::Fetch, CTextureCacheJob::Decode, CTextureCacheJob::Encode
+ */
+class CTextureCachePipeline
+{
+public:
+  CTextureCachePipeline(ITextureCachePipelineCallback *callback);
+  ~CTextureCachePipeline();
+
+  /*!
+   \brief Start the worker threads.
+   \param fetchers number of threads reading images, 0 for the default.
+   \param decoders number of threads decoding and resizing images, 0 for one per CPU.
+   \param encoders number of threads writing images to the cache, 0 for the default.
+   */
+  void Start(unsigned int fetchers = 0, unsigned int decoders = 0, unsigned int encoders = 0);
+
+  /*!
+   \brief Stop the worker threads, dropping any queued jobs.
+   Jobs that are being worked on are dropped once their current stage is done. Dropped jobs
+   that were started are passed to OnCachingComplete() as failed.
+   */
+  void Stop();
+
+  bool IsRunning() const;
+
+  /*!
+   \brief Queue a job for caching.
+   \param job the job to cache, owned by the pipeline from here on.
+   \return true if the job was queued, false if an identical job was already queued or the pipeline isn't running.
+   */
+  bool AddJob(CTextureCacheJob *job);
+
+  /*!
+   \brief Wait until all queued jobs are done.
+   \param timeout the maximum time to wait in milliseconds.
+   \return true if all jobs are done, false if we timed out.
+   */
+  bool WaitForIdle(unsigned int timeout);
+
+  /*!
+   \brief Number of jobs queued or being worked on.
+   */
+  unsigned int GetPendingJobs() const;
+
+private:
+  enum Stage
+  {
+    STAGE_FETCH = 0,
+    STAGE_DECODE,
+    STAGE_ENCODE,
+    STAGE_COUNT
+  };
+
+  class CWorker : public CThread
+  {
+  public:
+    CWorker(CTextureCachePipeline *pipeline, Stage stage);
+  protected:
+    virtual void Process();
+  private:
+    CTextureCachePipeline *m_pipeline;
+    Stage m_stage;
+  };
+
+  void Run(Stage stage);
+  bool Work(Stage stage, CTextureCacheJob *job);
+
+  /*! \brief Get the next job for the given stage, blocking until one is available.
+   \return the job, NULL if the pipeline is stopping. */
+  CTextureCacheJob *Pop(Stage stage);
+
+  /*! \brief Pass a job on to the given stage, blocking while its queue is full.
+   \return false if the pipeline is stopping, in which case the job is finished as failed. */
+  bool Push(Stage stage, CTextureCacheJob *job);
+
+  /*! \brief Drop a job that is done, with or without calling back. */
+  void Finish(CTextureCacheJob *job, bool callback, bool success);
+
+  ITextureCachePipelineCallback *m_callback;
+  std::vector<CWorker *> m_workers;
+  std::deque<CTextureCacheJob *> m_queues[STAGE_COUNT];
+  unsigned int m_queueLimit;         ///< maximum size of the decode and encode queues
+  unsigned int m_pending;            ///< number of jobs queued or being worked on
+  bool m_stopping;
+  mutable CCriticalSection m_section;
+  XbmcThreads::ConditionVariable m_changed; ///< signalled whenever a queue or m_pending changes
+};
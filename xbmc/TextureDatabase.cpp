@@ -244,9 +244,9 @@ void CTextureDatabase::UpdateTables(int version)
   }
 }
 
-bool CTextureDatabase::IncrementUseCount(const CTextureDetails &details)
+bool CTextureDatabase::IncrementUseCount(const CTextureDetails &details, unsigned int count /* = 1 */)
 {
-  CStdString sql = PrepareSQL("UPDATE sizes SET usecount=usecount+1, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=%u AND width=%u AND height=%u", details.id, details.width, details.height);
+  CStdString sql = PrepareSQL("UPDATE sizes SET usecount=usecount+%u, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=%u AND width=%u AND height=%u", count, details.id, details.width, details.height);
   return ExecuteQuery(sql);
 }
 
@@ -77,7 +77,12 @@ public:
   bool SetCachedTextureValid(const CStdString &originalURL, bool updateable);
   bool ClearCachedTexture(const CStdString &originalURL, CStdString &cacheFile);
   bool ClearCachedTexture(int textureID, CStdString &cacheFile);
-  bool IncrementUseCount(const CTextureDetails &details);
+  /*! \brief Increment the use count of a texture size and set its last use time to now
+   \param details the texture id, width and height of the size to update
+   \param count the number of uses to add
+   \return true if successful, false otherwise.
+   */
+  bool IncrementUseCount(const CTextureDetails &details, unsigned int count = 1);
 
   /*! \brief Invalidate a previously cached texture
    Invalidates the texture hash, and sets the texture update time to the current time so that
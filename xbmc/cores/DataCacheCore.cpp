@@ -19,6 +19,7 @@
 */
 
 #include "cores/DataCacheCore.h"
+#include "threads/SingleLock.h"
 
 bool CDataCacheCore::HasAVInfoChanges()
 {
@@ -35,4 +36,24 @@ void CDataCacheCore::SignalVideoInfoChange()
 void CDataCacheCore::SignalAudioInfoChange()
 {
   m_hasAVInfoChanges = true;
-}
\ No newline at end of file
+}
+
+void CDataCacheCore::SetStreamCacheInfo(const void* owner, const SStreamCacheInfo& info)
+{
+  CSingleLock lock(m_streamCacheSection);
+  m_streamCacheInfo[owner] = info;
+}
+
+void CDataCacheCore::RemoveStreamCacheInfo(const void* owner)
+{
+  CSingleLock lock(m_streamCacheSection);
+  m_streamCacheInfo.erase(owner);
+}
+
+void CDataCacheCore::GetStreamCacheInfo(std::vector<SStreamCacheInfo>& info)
+{
+  CSingleLock lock(m_streamCacheSection);
+  info.clear();
+  for (std::map<const void*, SStreamCacheInfo>::const_iterator it = m_streamCacheInfo.begin(); it != m_streamCacheInfo.end(); ++it)
+    info.push_back(it->second);
+}
@@ -20,6 +20,24 @@
 *
 */
 
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "threads/CriticalSection.h"
+
+struct SStreamCacheInfo
+{
+  std::string source;   ///< redacted url of the cached stream
+  std::string protocol; ///< protocol of the source, e.g. http, smb, nfs
+  unsigned readers;     ///< number of concurrent readers on the source
+  uint64_t forward;     ///< bytes cached ahead of the read position
+  unsigned level;       ///< fill level of the forward buffer in percent
+  unsigned currate;     ///< average fill rate in bytes per second
+  unsigned maxrate;     ///< fill rate limit in bytes per second, 0 when unlimited
+  unsigned stalls;      ///< number of reads that had to wait for data
+};
+
 class CDataCacheCore
 {
 public:
@@ -27,8 +45,16 @@ public:
   void SignalVideoInfoChange();
   void SignalAudioInfoChange();
 
+  // stream cache statistics, keyed by the cache that owns them
+  void SetStreamCacheInfo(const void* owner, const SStreamCacheInfo& info);
+  void RemoveStreamCacheInfo(const void* owner);
+  void GetStreamCacheInfo(std::vector<SStreamCacheInfo>& info);
+
 protected:
   volatile bool m_hasAVInfoChanges;
+
+  CCriticalSection m_streamCacheSection;
+  std::map<const void*, SStreamCacheInfo> m_streamCacheInfo;
 };
 
 extern CDataCacheCore g_dataCacheCore;
\ No newline at end of file
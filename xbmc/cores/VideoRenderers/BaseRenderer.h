@@ -26,12 +26,17 @@
 #include "guilib/Geometry.h"
 #include "RenderFormats.h"
 #include "RenderFeatures.h"
+#include "settings/VideoSettings.h"
+#include "PlatformDefs.h"
 
 #define MAX_PLANES 3
 #define MAX_FIELDS 3
 #define NUM_BUFFERS 6
+#define AUTOSOURCE -1
 
 class CSetting;
+class CRenderCapture;
+class CDVDVideoBuffer;
 
 typedef struct YV12Image
 {
@@ -83,7 +88,27 @@ public:
   void GetVideoRect(CRect &source, CRect &dest);
   float GetAspectRatio() const;
 
+  // Interface used by CXBMCRenderManager
+  virtual bool         Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation) = 0;
+  virtual bool         IsConfigured() = 0;
+  virtual int          GetImage(YV12Image *image, int source = AUTOSOURCE, bool readonly = false) = 0;
+  virtual void         ReleaseImage(int source, bool preserve = false) = 0;
+  virtual void         FlipPage(int source) = 0;
+  virtual unsigned int PreInit() = 0;
+  virtual void         UnInit() = 0;
+  virtual void         Reset() = 0;
+  virtual void         Update() = 0;
+  virtual void         RenderUpdate(bool clear, DWORD flags = 0, DWORD alpha = 255) = 0;
+  virtual void         SetupScreenshot() = 0;
+  virtual bool         RenderCapture(CRenderCapture* capture) = 0;
+
   virtual bool AddVideoPicture(DVDVideoPicture* picture, int index) { return false; }
+
+  /**
+   * Render a software decoded frame as it is, without copying it into the image of the buffer.
+   * Called between GetImage and ReleaseImage, returns false if the picture should be copied
+   */
+  virtual bool AddVideoBuffer(CDVDVideoBuffer* buffer, int index) { return false; }
   virtual void Flush() {};
 
   /**
@@ -96,9 +121,14 @@ public:
   virtual bool         NeedBufferForRef(int idx) { return false; }
 
   virtual bool Supports(ERENDERFEATURE feature) { return false; }
+  virtual bool Supports(EDEINTERLACEMODE mode) = 0;
+  virtual bool Supports(EINTERLACEMETHOD method) = 0;
+  virtual bool Supports(ESCALINGMETHOD method) = 0;
+
+  virtual EINTERLACEMETHOD AutoInterlaceMethod() = 0;
 
   // Supported pixel formats, can be called before configure
-  std::vector<ERenderFormat> SupportedFormats()  { return std::vector<ERenderFormat>(); }
+  virtual std::vector<ERenderFormat> SupportedFormats()  { return std::vector<ERenderFormat>(); }
 
   virtual void RegisterRenderUpdateCallBack(const void *ctx, RenderUpdateCallBackFn fn);
   virtual void RegisterRenderFeaturesCallBack(const void *ctx, RenderFeaturesCallBackFn fn);
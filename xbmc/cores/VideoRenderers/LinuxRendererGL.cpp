@@ -40,6 +40,7 @@
 #include "guilib/Texture.h"
 #include "guilib/LocalizeStrings.h"
 #include "guilib/MatrixGLES.h"
+#include "guilib/GUIRenderBatchGL.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
@@ -48,6 +49,7 @@
 #include "RenderFormats.h"
 #include "cores/IPlayer.h"
 #include "cores/dvdplayer/DVDCodecs/DVDCodecUtils.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoBuffer.h"
 #include "cores/FFmpeg.h"
 
 extern "C" {
@@ -119,6 +121,7 @@ CLinuxRendererGL::YUVBUFFER::YUVBUFFER()
   memset(&image , 0, sizeof(image));
   memset(&pbo   , 0, sizeof(pbo));
   flipindex = 0;
+  videoBuffer = NULL;
 #ifdef HAVE_LIBVDPAU
   vdpau = NULL;
 #endif
@@ -346,7 +349,11 @@ int CLinuxRendererGL::GetImage(YV12Image *image, int source, bool readonly)
   if( readonly )
     im.flags |= IMAGE_FLAG_READING;
   else
+  {
     im.flags |= IMAGE_FLAG_WRITING;
+    // the image is written to, so render it rather than a frame added before
+    SAFE_RELEASE(m_buffers[source].videoBuffer);
+  }
 
   // copy the image - should be operator of YV12Image
   for (int p=0;p<MAX_PLANES;p++)
@@ -549,9 +556,8 @@ void CLinuxRendererGL::Flush()
 
 void CLinuxRendererGL::ReleaseBuffer(int idx)
 {
-#if defined(HAVE_LIBVDPAU) || defined(HAVE_LIBVA) || defined(TARGET_DARWIN)
   YUVBUFFER &buf = m_buffers[idx];
-#endif
+  SAFE_RELEASE(buf.videoBuffer);
 #ifdef HAVE_LIBVDPAU
   SAFE_RELEASE(buf.vdpau);
 #endif
@@ -565,6 +571,23 @@ void CLinuxRendererGL::ReleaseBuffer(int idx)
 #endif
 }
 
+bool CLinuxRendererGL::AddVideoBuffer(CDVDVideoBuffer* buffer, int index)
+{
+  // only the yuv shaders upload the planes as they are
+  if (m_textureUpload != &CLinuxRendererGL::UploadYV12Texture)
+    return false;
+
+  YUVBUFFER &buf = m_buffers[index];
+  const AVFrame *frame = buffer->GetFrame();
+  if ((unsigned)frame->width  < buf.image.width
+  ||  (unsigned)frame->height < buf.image.height)
+    return false;
+
+  SAFE_RELEASE(buf.videoBuffer);
+  buf.videoBuffer = buffer->Acquire();
+  return true;
+}
+
 void CLinuxRendererGL::Update()
 {
   if (!m_bConfigured) return;
@@ -576,6 +599,9 @@ void CLinuxRendererGL::RenderUpdate(bool clear, DWORD flags, DWORD alpha)
 {
   int index = m_iYV12RenderBuffer;
 
+  // the video goes on top of the GUI drawn so far
+  CGUIRenderBatchGL::Get().Flush();
+
   if (!ValidateRenderer())
   {
     if (clear) //if clear is set, we're expected to overwrite all backbuffer pixels, even if we have nothing to render
@@ -1716,6 +1742,18 @@ bool CLinuxRendererGL::UploadYV12Texture(int source)
 
   if (!(im->flags&IMAGE_FLAG_READY))
     return false;
+
+  // upload straight from a decoded frame if one was added, its planes aren't in the pbos
+  const AVFrame* frame = buf.videoBuffer ? buf.videoBuffer->GetFrame() : NULL;
+  BYTE*    planes[MAX_PLANES];
+  unsigned strides[MAX_PLANES];
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    planes[p]  = frame ? frame->data[p]     : im->plane[p];
+    strides[p] = frame ? frame->linesize[p] : im->stride[p];
+  }
+  GLuint  nopbo = 0;
+  GLuint* pbo   = frame ? &nopbo : NULL;
   bool deinterlacing;
   if (m_currentField == FIELD_FULL)
     deinterlacing = false;
@@ -1732,47 +1770,47 @@ bool CLinuxRendererGL::UploadYV12Texture(int source)
     // Load Even Y Field
     LoadPlane( fields[FIELD_TOP][0] , GL_LUMINANCE, buf.flipindex
              , im->width, im->height >> 1
-             , im->stride[0]*2, im->bpp, im->plane[0] );
+             , strides[0]*2, im->bpp, planes[0], pbo );
 
     //load Odd Y Field
     LoadPlane( fields[FIELD_BOT][0], GL_LUMINANCE, buf.flipindex
              , im->width, im->height >> 1
-             , im->stride[0]*2, im->bpp, im->plane[0] + im->stride[0]) ;
+             , strides[0]*2, im->bpp, planes[0] + strides[0], pbo );
 
     // Load Even U & V Fields
     LoadPlane( fields[FIELD_TOP][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[1]*2, im->bpp, im->plane[1] );
+             , strides[1]*2, im->bpp, planes[1], pbo );
 
     LoadPlane( fields[FIELD_TOP][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[2]*2, im->bpp, im->plane[2] );
+             , strides[2]*2, im->bpp, planes[2], pbo );
 
     // Load Odd U & V Fields
     LoadPlane( fields[FIELD_BOT][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[1]*2, im->bpp, im->plane[1] + im->stride[1] );
+             , strides[1]*2, im->bpp, planes[1] + strides[1], pbo );
 
     LoadPlane( fields[FIELD_BOT][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[2]*2, im->bpp, im->plane[2] + im->stride[2] );
+             , strides[2]*2, im->bpp, planes[2] + strides[2], pbo );
   }
   else
   {
     //Load Y plane
     LoadPlane( fields[FIELD_FULL][0], GL_LUMINANCE, buf.flipindex
              , im->width, im->height
-             , im->stride[0], im->bpp, im->plane[0] );
+             , strides[0], im->bpp, planes[0], pbo );
 
     //load U plane
     LoadPlane( fields[FIELD_FULL][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> im->cshift_y
-             , im->stride[1], im->bpp, im->plane[1] );
+             , strides[1], im->bpp, planes[1], pbo );
 
     //load V plane
     LoadPlane( fields[FIELD_FULL][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> im->cshift_y
-             , im->stride[2], im->bpp, im->plane[2] );
+             , strides[2], im->bpp, planes[2], pbo );
   }
 
   VerifyGLState();
@@ -1789,6 +1827,8 @@ void CLinuxRendererGL::DeleteYV12Texture(int index)
   YUVFIELDS &fields = m_buffers[index].fields;
   GLuint    *pbo    = m_buffers[index].pbo;
 
+  SAFE_RELEASE(m_buffers[index].videoBuffer);
+
   if( fields[FIELD_FULL][0].id == 0 ) return;
 
   /* finish up all textures, and delete them */
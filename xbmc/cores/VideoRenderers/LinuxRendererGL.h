@@ -133,6 +133,7 @@ public:
   virtual void         Reset(); /* resets renderer after seek for example */
   virtual void         Flush();
   virtual void         ReleaseBuffer(int idx);
+  virtual bool         AddVideoBuffer(CDVDVideoBuffer* buffer, int index);
   virtual void         SetBufferSize(int numBuffers) { m_NumYV12Buffers = numBuffers; }
   virtual unsigned int GetMaxBufferSize() { return NUM_BUFFERS; }
   virtual unsigned int GetOptimalBufferSize();
@@ -275,6 +276,7 @@ protected:
     YV12Image image;
     unsigned  flipindex; /* used to decide if this has been uploaded */
     GLuint    pbo[MAX_PLANES];
+    CDVDVideoBuffer *videoBuffer; /* decoded frame to upload from instead of image, see AddVideoBuffer */
 
 #ifdef HAVE_LIBVDPAU
     VDPAU::CVdpauRenderPicture *vdpau;
@@ -0,0 +1,202 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "NullRenderer.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoCodec.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoBuffer.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+CNullRenderer::CNullRenderer()
+{
+  memset(m_buffers, 0, sizeof(m_buffers));
+  m_numBuffers    = NUM_BUFFERS;
+  m_currentBuffer = 0;
+  m_bConfigured   = false;
+}
+
+CNullRenderer::~CNullRenderer()
+{
+  UnInit();
+}
+
+unsigned int CNullRenderer::PreInit()
+{
+  UnInit();
+
+  m_formats.clear();
+  m_formats.push_back(RENDER_FMT_YUV420P);
+  m_formats.push_back(RENDER_FMT_YUV420P10);
+  m_formats.push_back(RENDER_FMT_YUV420P16);
+  m_formats.push_back(RENDER_FMT_NV12);
+  m_formats.push_back(RENDER_FMT_YUYV422);
+  m_formats.push_back(RENDER_FMT_UYVY422);
+  return 0;
+}
+
+void CNullRenderer::UnInit()
+{
+  for (int i = 0; i < NUM_BUFFERS; i++)
+    DeleteImage(i);
+  m_currentBuffer = 0;
+  m_bConfigured   = false;
+}
+
+bool CNullRenderer::Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation)
+{
+  m_sourceWidth  = width;
+  m_sourceHeight = height;
+  m_fps          = fps;
+  m_iFlags       = flags;
+  m_format       = format;
+  m_renderOrientation = orientation;
+
+  CalculateFrameAspectRatio(d_width, d_height);
+
+  for (int i = 0; i < NUM_BUFFERS; i++)
+  {
+    DeleteImage(i);
+    CreateImage(i);
+  }
+  m_currentBuffer = 0;
+  m_bConfigured   = true;
+
+  CLog::Log(LOGDEBUG, "CNullRenderer::Configure - %ux%u, format %d", width, height, format);
+  return true;
+}
+
+void CNullRenderer::CreateImage(int index)
+{
+  YV12Image &im = m_buffers[index].image;
+
+  im.width    = m_sourceWidth;
+  im.height   = m_sourceHeight;
+  im.cshift_x = 1;
+  im.cshift_y = 1;
+  im.bpp      = 1;
+  im.flags    = 0;
+
+  switch (m_format)
+  {
+  case RENDER_FMT_YUV420P10:
+  case RENDER_FMT_YUV420P16:
+    im.bpp = 2;
+    // fall through
+  case RENDER_FMT_YUV420P:
+    im.stride[0] = im.bpp *   im.width;
+    im.stride[1] = im.bpp * ( im.width >> im.cshift_x );
+    im.stride[2] = im.bpp * ( im.width >> im.cshift_x );
+    im.planesize[0] = im.stride[0] *   im.height;
+    im.planesize[1] = im.stride[1] * ( im.height >> im.cshift_y );
+    im.planesize[2] = im.stride[2] * ( im.height >> im.cshift_y );
+    break;
+  case RENDER_FMT_NV12:
+    im.stride[0] = im.width;
+    im.stride[1] = im.width;
+    im.stride[2] = 0;
+    im.planesize[0] = im.stride[0] *   im.height;
+    im.planesize[1] = im.stride[1] * ( im.height >> im.cshift_y );
+    im.planesize[2] = 0;
+    break;
+  case RENDER_FMT_YUYV422:
+  case RENDER_FMT_UYVY422:
+    im.stride[0] = im.width * 2;
+    im.stride[1] = 0;
+    im.stride[2] = 0;
+    im.planesize[0] = im.stride[0] * im.height;
+    im.planesize[1] = 0;
+    im.planesize[2] = 0;
+    break;
+  default:
+    // pictures of any other format never reach the images
+    memset(im.stride, 0, sizeof(im.stride));
+    memset(im.planesize, 0, sizeof(im.planesize));
+    break;
+  }
+
+  for (int p = 0; p < MAX_PLANES; p++)
+    im.plane[p] = im.planesize[p] ? new uint8_t[im.planesize[p]] : NULL;
+}
+
+void CNullRenderer::DeleteImage(int index)
+{
+  SBuffer &buf = m_buffers[index];
+  SAFE_RELEASE(buf.videoBuffer);
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    delete[] buf.image.plane[p];
+    buf.image.plane[p] = NULL;
+  }
+}
+
+int CNullRenderer::GetImage(YV12Image *image, int source, bool readonly)
+{
+  if (!image || !m_bConfigured)
+    return -1;
+
+  if (source == AUTOSOURCE)
+    source = (m_currentBuffer + 1) % m_numBuffers;
+
+  // the image is written to, so it replaces a frame added before
+  if (!readonly)
+    SAFE_RELEASE(m_buffers[source].videoBuffer);
+
+  *image = m_buffers[source].image;
+  return source;
+}
+
+void CNullRenderer::ReleaseImage(int source, bool preserve)
+{
+}
+
+bool CNullRenderer::AddVideoPicture(DVDVideoPicture* picture, int index)
+{
+  // take anything that doesn't get copied into an image, hardware decoded pictures included
+  return std::find(m_formats.begin(), m_formats.end(), picture->format) == m_formats.end();
+}
+
+bool CNullRenderer::AddVideoBuffer(CDVDVideoBuffer* buffer, int index)
+{
+  SBuffer &buf = m_buffers[index];
+  SAFE_RELEASE(buf.videoBuffer);
+  buf.videoBuffer = buffer->Acquire();
+  return true;
+}
+
+void CNullRenderer::FlipPage(int source)
+{
+  if (source >= 0 && source < m_numBuffers)
+    m_currentBuffer = source;
+  else
+    m_currentBuffer = (m_currentBuffer + 1) % m_numBuffers;
+}
+
+void CNullRenderer::ReleaseBuffer(int idx)
+{
+  SAFE_RELEASE(m_buffers[idx].videoBuffer);
+}
+
+void CNullRenderer::Flush()
+{
+  for (int i = 0; i < NUM_BUFFERS; i++)
+    ReleaseBuffer(i);
+}
@@ -0,0 +1,85 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "BaseRenderer.h"
+
+/**
+ * Renderer without any output, used for headless playback.
+ *
+ * Software decoded pictures are copied into (or held as) its images exactly as the
+ * platform renderer would get them, so the decode to present path costs the same
+ * apart from the upload and drawing. All other pictures are accepted as they are.
+ * Selected by CXBMCRenderManager::SetNullRenderer.
+ */
+class CNullRenderer : public CBaseRenderer
+{
+public:
+  CNullRenderer();
+  virtual ~CNullRenderer();
+
+  virtual bool         Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation);
+  virtual bool         IsConfigured() { return m_bConfigured; }
+  virtual int          GetImage(YV12Image *image, int source = AUTOSOURCE, bool readonly = false);
+  virtual void         ReleaseImage(int source, bool preserve = false);
+  virtual void         FlipPage(int source);
+  virtual unsigned int PreInit();
+  virtual void         UnInit();
+  virtual void         Reset() {}
+  virtual void         Update() {}
+  virtual void         RenderUpdate(bool clear, DWORD flags = 0, DWORD alpha = 255) {}
+  virtual void         SetupScreenshot() {}
+  virtual bool         RenderCapture(CRenderCapture* capture) { return false; }
+
+  virtual bool         AddVideoPicture(DVDVideoPicture* picture, int index);
+  virtual bool         AddVideoBuffer(CDVDVideoBuffer* buffer, int index);
+  virtual void         Flush();
+
+  virtual unsigned int GetOptimalBufferSize() { return 3; }
+  virtual unsigned int GetMaxBufferSize() { return NUM_BUFFERS; }
+  virtual void         SetBufferSize(int numBuffers) { m_numBuffers = numBuffers; }
+  virtual void         ReleaseBuffer(int idx);
+
+  virtual bool         Supports(ERENDERFEATURE feature) { return false; }
+  virtual bool         Supports(EDEINTERLACEMODE mode) { return mode == VS_DEINTERLACEMODE_OFF; }
+  virtual bool         Supports(EINTERLACEMETHOD method) { return false; }
+  virtual bool         Supports(ESCALINGMETHOD method) { return method == VS_SCALINGMETHOD_NEAREST; }
+
+  virtual EINTERLACEMETHOD AutoInterlaceMethod() { return VS_INTERLACEMETHOD_NONE; }
+
+  virtual std::vector<ERenderFormat> SupportedFormats() { return m_formats; }
+
+protected:
+  void CreateImage(int index);
+  void DeleteImage(int index);
+
+  struct SBuffer
+  {
+    YV12Image        image;
+    CDVDVideoBuffer *videoBuffer;
+  };
+
+  SBuffer m_buffers[NUM_BUFFERS];
+  int     m_numBuffers;
+  int     m_currentBuffer;
+  bool    m_bConfigured;
+  std::vector<ERenderFormat> m_formats;
+};
@@ -42,15 +42,21 @@
 
 #if defined(HAS_GL)
   #include "LinuxRendererGL.h"
+  typedef CLinuxRendererGL CPlatformRenderer;
 #elif defined(HAS_MMAL)
   #include "MMALRenderer.h"
+  typedef CMMALRenderer CPlatformRenderer;
 #elif HAS_GLES == 2
   #include "LinuxRendererGLES.h"
+  typedef CLinuxRendererGLES CPlatformRenderer;
 #elif defined(HAS_DX)
   #include "WinRenderer.h"
+  typedef CWinRenderer CPlatformRenderer;
 #elif defined(HAS_SDL)
   #include "LinuxRenderer.h"
+  typedef CLinuxRenderer CPlatformRenderer;
 #endif
+#include "NullRenderer.h"
 
 #include "RenderCapture.h"
 
@@ -96,6 +102,13 @@ private:
   CCriticalSection &m_owned;
 };
 
+/* hardware decoded pictures are only ever added to the platform renderer, *
+ * CNullRenderer takes all pictures in AddVideoPicture                     */
+static inline CPlatformRenderer* PlatformRenderer(CBaseRenderer *renderer)
+{
+  return static_cast<CPlatformRenderer*>(renderer);
+}
+
 static void requeue(std::deque<int> &trg, std::deque<int> &src)
 {
   trg.push_back(src.front());
@@ -106,6 +119,7 @@ CXBMCRenderManager::CXBMCRenderManager()
 {
   m_pRenderer = NULL;
   m_bIsStarted = false;
+  m_bNullRenderer = false;
 
   m_presentstep = PRESENT_IDLE;
   m_rendermethod = 0;
@@ -119,6 +133,7 @@ CXBMCRenderManager::CXBMCRenderManager()
   m_errorindex = 0;
   m_QueueSize   = 2;
   m_QueueSkip   = 0;
+  m_QueuePresented = 0;
   m_format      = RENDER_FMT_NONE;
 }
 
@@ -359,6 +374,7 @@ void CXBMCRenderManager::FrameMove()
     if(m_presentstep == PRESENT_FLIP)
     {
       m_pRenderer->FlipPage(m_presentsource);
+      m_QueuePresented++;
       m_presentstep = PRESENT_FRAME;
       m_presentevent.notifyAll();
     }
@@ -424,29 +440,35 @@ unsigned int CXBMCRenderManager::PreInit()
   memset(m_errorbuff, 0, sizeof(m_errorbuff));
 
   m_bIsStarted = false;
+  if (m_pRenderer && m_bNullRenderer != (dynamic_cast<CNullRenderer*>(m_pRenderer) != NULL))
+  {
+    delete m_pRenderer;
+    m_pRenderer = NULL;
+  }
+
   if (!m_pRenderer)
   {
-#if defined(HAS_GL)
-    m_pRenderer = new CLinuxRendererGL();
-#elif defined(HAS_MMAL)
-    m_pRenderer = new CMMALRenderer();
-#elif HAS_GLES == 2
-    m_pRenderer = new CLinuxRendererGLES();
-#elif defined(HAS_DX)
-    m_pRenderer = new CWinRenderer();
-#elif defined(HAS_SDL)
-    m_pRenderer = new CLinuxRenderer();
-#endif
+    if (m_bNullRenderer)
+      m_pRenderer = new CNullRenderer();
+    else
+      m_pRenderer = new CPlatformRenderer();
   }
 
   UpdateDisplayLatency();
 
   m_QueueSize   = 2;
   m_QueueSkip   = 0;
+  m_QueuePresented = 0;
 
   return m_pRenderer->PreInit();
 }
 
+void CXBMCRenderManager::SetNullRenderer(bool enable)
+{
+  CRetakeLock<CExclusiveLock> lock(m_sharedSection);
+  m_bNullRenderer = enable;
+}
+
 void CXBMCRenderManager::UnInit()
 {
   CRetakeLock<CExclusiveLock> lock(m_sharedSection);
@@ -920,7 +942,8 @@ int CXBMCRenderManager::AddVideoPicture(DVDVideoPicture& pic)
   || pic.format == RENDER_FMT_YUV420P10
   || pic.format == RENDER_FMT_YUV420P16)
   {
-    CDVDCodecUtils::CopyPicture(&image, &pic);
+    if (!pic.videoBuffer || !m_pRenderer->AddVideoBuffer(pic.videoBuffer, index))
+      CDVDCodecUtils::CopyPicture(&image, &pic);
   }
   else if(pic.format == RENDER_FMT_NV12)
   {
@@ -938,40 +961,40 @@ int CXBMCRenderManager::AddVideoPicture(DVDVideoPicture& pic)
 #ifdef HAVE_LIBVDPAU
   else if(pic.format == RENDER_FMT_VDPAU
        || pic.format == RENDER_FMT_VDPAU_420)
-    m_pRenderer->AddProcessor(pic.vdpau, index);
+    PlatformRenderer(m_pRenderer)->AddProcessor(pic.vdpau, index);
 #endif
 #ifdef HAVE_LIBOPENMAX
   else if(pic.format == RENDER_FMT_OMXEGL)
-    m_pRenderer->AddProcessor(pic.openMax, &pic, index);
+    PlatformRenderer(m_pRenderer)->AddProcessor(pic.openMax, &pic, index);
 #endif
 #ifdef TARGET_DARWIN
   else if(pic.format == RENDER_FMT_CVBREF)
-    m_pRenderer->AddProcessor(pic.cvBufferRef, index);
+    PlatformRenderer(m_pRenderer)->AddProcessor(pic.cvBufferRef, index);
 #endif
 #ifdef HAVE_LIBVA
   else if(pic.format == RENDER_FMT_VAAPI)
-    m_pRenderer->AddProcessor(pic.vaapi, index);
+    PlatformRenderer(m_pRenderer)->AddProcessor(pic.vaapi, index);
   else if(pic.format == RENDER_FMT_VAAPINV12)
   {
-    m_pRenderer->AddProcessor(pic.vaapi, index);
+    PlatformRenderer(m_pRenderer)->AddProcessor(pic.vaapi, index);
     CDVDCodecUtils::CopyNV12Picture(&image, &pic.vaapi->DVDPic);
   }
 #endif
 #ifdef HAS_LIBSTAGEFRIGHT
   else if(pic.format == RENDER_FMT_EGLIMG)
-    m_pRenderer->AddProcessor(pic.stf, pic.eglimg, index);
+    PlatformRenderer(m_pRenderer)->AddProcessor(pic.stf, pic.eglimg, index);
 #endif
 #if defined(TARGET_ANDROID)
   else if(pic.format == RENDER_FMT_MEDIACODEC)
-    m_pRenderer->AddProcessor(pic.mediacodec, index);
+    PlatformRenderer(m_pRenderer)->AddProcessor(pic.mediacodec, index);
 #endif
 #ifdef HAS_IMXVPU
   else if(pic.format == RENDER_FMT_IMXMAP)
-    m_pRenderer->AddProcessor(pic.IMXBuffer, index);
+    PlatformRenderer(m_pRenderer)->AddProcessor(pic.IMXBuffer, index);
 #endif
 #ifdef HAS_MMAL
   else if(pic.format == RENDER_FMT_MMAL)
-    m_pRenderer->AddProcessor(pic.MMALBuffer, index);
+    PlatformRenderer(m_pRenderer)->AddProcessor(pic.MMALBuffer, index);
 #endif
 
   m_pRenderer->ReleaseImage(index, false);
@@ -41,12 +41,6 @@ struct DVDVideoPicture;
 
 #define ERRORBUFFSIZE 30
 
-class CWinRenderer;
-class CMMALRenderer;
-class CLinuxRenderer;
-class CLinuxRendererGL;
-class CLinuxRendererGLES;
-
 class CXBMCRenderManager
 {
 public:
@@ -128,6 +122,7 @@ public:
   inline bool IsStarted() { return m_bIsStarted;}
   double GetDisplayLatency() { return m_displayLatency; }
   int    GetSkippedFrames()  { return m_QueueSkip; }
+  int    GetPresentedFrames() { return m_QueuePresented; }
 
   bool Supports(ERENDERFEATURE feature);
   bool Supports(EDEINTERLACEMODE method);
@@ -145,17 +140,15 @@ public:
 
   bool RendererHandlesPresent() const;
 
-#ifdef HAS_GL
-  CLinuxRendererGL    *m_pRenderer;
-#elif defined(HAS_MMAL)
-  CMMALRenderer       *m_pRenderer;
-#elif HAS_GLES == 2
-  CLinuxRendererGLES  *m_pRenderer;
-#elif defined(HAS_DX)
-  CWinRenderer        *m_pRenderer;
-#elif defined(HAS_SDL)
-  CLinuxRenderer      *m_pRenderer;
-#endif
+  CBaseRenderer *m_pRenderer;
+
+  /**
+   * Render into a CNullRenderer instead of the platform renderer, so video can be
+   * played without a display, e.g. by benchmarks. Takes effect on the next PreInit.
+   * Nothing presents frames then, the caller has to drive FrameWait, FrameMove and
+   * FrameFinish in place of the GUI.
+   */
+  void SetNullRenderer(bool enable);
 
   unsigned int GetOptimalBufferSize();
 
@@ -201,6 +194,7 @@ protected:
   EINTERLACEMETHOD AutoInterlaceMethodInternal(EINTERLACEMETHOD mInt);
 
   bool m_bIsStarted;
+  bool m_bNullRenderer;
   CSharedSection m_sharedSection;
 
   bool m_bReconfigured;
@@ -229,6 +223,7 @@ protected:
 
   int m_QueueSize;
   int m_QueueSkip;
+  int m_QueuePresented;
 
   struct SPresent
   {
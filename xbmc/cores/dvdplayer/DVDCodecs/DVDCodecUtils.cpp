@@ -23,6 +23,8 @@
 #include "cores/VideoRenderers/RenderManager.h"
 #include "utils/log.h"
 #include "utils/fastmemcpy.h"
+#include "DVDPictureKernels.h"
+#include "threads/Atomics.h"
 #include "cores/FFmpeg.h"
 #include "Util.h"
 #ifdef HAS_DX
@@ -39,8 +41,115 @@
 #pragma comment(lib, "swscale.lib")
 #endif
 
-extern "C" {
-#include "libswscale/swscale.h"
+static volatile long g_frameCopyCount = 0;
+
+/* a plane to copy, rows of width bytes */
+struct CopyPlane
+{
+  uint8_t       *dst;
+  int            dstStride;
+  const uint8_t *src;
+  int            srcStride;
+  int            width;
+  int            rows;
+};
+
+struct CopyPlanes
+{
+  CopyPlane plane[3];
+  int       count;
+};
+
+static void CopyPlaneRows(const CopyPlane &plane, int first, int count)
+{
+  uint8_t *d = plane.dst + first * plane.dstStride;
+  const uint8_t *s = plane.src + first * plane.srcStride;
+  if (plane.width == plane.srcStride && plane.srcStride == plane.dstStride)
+  {
+    fast_memcpy(d, s, plane.width * count);
+  }
+  else
+  {
+    for (int y = 0; y < count; y++)
+    {
+      fast_memcpy(d, s, plane.width);
+      s += plane.srcStride;
+      d += plane.dstStride;
+    }
+  }
+}
+
+static void CopyPlanesBand(void *arg, int band, int bands)
+{
+  const CopyPlanes *planes = (const CopyPlanes *)arg;
+  for (int i = 0; i < planes->count; i++)
+  {
+    int first, count;
+    CDVDPictureKernels::GetBandRows(band, bands, planes->plane[i].rows, 1, first, count);
+    CopyPlaneRows(planes->plane[i], first, count);
+  }
+}
+
+static void AddCopyPlane(CopyPlanes &planes, uint8_t *dst, int dstStride, const uint8_t *src, int srcStride, int width, int rows)
+{
+  CopyPlane &plane = planes.plane[planes.count++];
+  plane.dst       = dst;
+  plane.dstStride = dstStride;
+  plane.src       = src;
+  plane.srcStride = srcStride;
+  plane.width     = width;
+  plane.rows      = rows;
+}
+
+// copies all planes, large pictures in bands on several threads
+static void CopyPicturePlanes(CopyPlanes &planes, int width, int height)
+{
+  AtomicIncrement(&g_frameCopyCount);
+  CDVDPictureKernels::ForEachBand(CopyPlanesBand, &planes, CDVDPictureKernels::GetBandCount(width, height));
+}
+
+struct ConvertPicture
+{
+  DVDVideoPicture          *dst;
+  const DVDVideoPicture    *src;
+  const CDVDPictureKernels *kernels;
+  ERenderFormat             format;
+};
+
+static void ConvertToNV12Band(void *arg, int band, int bands)
+{
+  const ConvertPicture *convert = (const ConvertPicture *)arg;
+  const DVDVideoPicture *src = convert->src;
+  DVDVideoPicture *dst = convert->dst;
+  int first, count;
+
+  // copy luma
+  CDVDPictureKernels::GetBandRows(band, bands, src->iHeight, 2, first, count);
+  for (int y = first; y < first + count; y++)
+    fast_memcpy(dst->data[0] + y * dst->iLineSize[0], src->data[0] + y * src->iLineSize[0], src->iWidth);
+
+  // interleave chroma
+  CDVDPictureKernels::GetBandRows(band, bands, src->iHeight / 2, 1, first, count);
+  for (int y = first; y < first + count; y++)
+    convert->kernels->InterleaveUV(dst->data[1] + y * dst->iLineSize[1],
+                                   src->data[1] + y * src->iLineSize[1],
+                                   src->data[2] + y * src->iLineSize[2], src->iWidth / 2);
+}
+
+static void ConvertToYUV422PackedBand(void *arg, int band, int bands)
+{
+  const ConvertPicture *convert = (const ConvertPicture *)arg;
+  const DVDVideoPicture *src = convert->src;
+  DVDVideoPicture *dst = convert->dst;
+  CDVDPictureKernels::PackFunc pack = convert->format == RENDER_FMT_UYVY422 ? convert->kernels->PackUYVY : convert->kernels->PackYUYV;
+
+  // each chroma row goes with two luma rows, it is repeated for both as the
+  // unscaled YUV420P to YUYV/UYVY converter of swscale does
+  int first, count;
+  CDVDPictureKernels::GetBandRows(band, bands, src->iHeight, 2, first, count);
+  for (int y = first; y < first + count; y++)
+    pack(dst->data[0] + y * dst->iLineSize[0], src->data[0] + y * src->iLineSize[0],
+         src->data[1] + (y >> 1) * src->iLineSize[1], src->data[2] + (y >> 1) * src->iLineSize[2], src->iWidth);
 }
 
 // allocate a new picture (PIX_FMT_YUV420P)
@@ -51,6 +160,7 @@ DVDVideoPicture* CDVDCodecUtils::AllocatePicture(int iWidth, int iHeight)
   {
     pPicture->iWidth = iWidth;
     pPicture->iHeight = iHeight;
+    pPicture->videoBuffer = NULL;
 
     int w = iWidth / 2;
     int h = iHeight / 2;
@@ -86,94 +196,31 @@ void CDVDCodecUtils::FreePicture(DVDVideoPicture* pPicture)
 
 bool CDVDCodecUtils::CopyPicture(DVDVideoPicture* pDst, DVDVideoPicture* pSrc)
 {
-  uint8_t *s, *d;
   int w = pSrc->iWidth;
   int h = pSrc->iHeight;
 
-  s = pSrc->data[0];
-  d = pDst->data[0];
-
-  for (int y = 0; y < h; y++)
-  {
-    fast_memcpy(d, s, w);
-    s += pSrc->iLineSize[0];
-    d += pDst->iLineSize[0];
-  }
-
-  w >>= 1;
-  h >>= 1;
-
-  s = pSrc->data[1];
-  d = pDst->data[1];
-  for (int y = 0; y < h; y++)
-  {
-    fast_memcpy(d, s, w);
-    s += pSrc->iLineSize[1];
-    d += pDst->iLineSize[1];
-  }
-
-  s = pSrc->data[2];
-  d = pDst->data[2];
-  for (int y = 0; y < h; y++)
-  {
-    fast_memcpy(d, s, w);
-    s += pSrc->iLineSize[2];
-    d += pDst->iLineSize[2];
-  }
+  CopyPlanes planes;
+  planes.count = 0;
+  AddCopyPlane(planes, pDst->data[0], pDst->iLineSize[0], pSrc->data[0], pSrc->iLineSize[0], w, h);
+  AddCopyPlane(planes, pDst->data[1], pDst->iLineSize[1], pSrc->data[1], pSrc->iLineSize[1], w >> 1, h >> 1);
+  AddCopyPlane(planes, pDst->data[2], pDst->iLineSize[2], pSrc->data[2], pSrc->iLineSize[2], w >> 1, h >> 1);
+  CopyPicturePlanes(planes, w, h);
   return true;
 }
 
 bool CDVDCodecUtils::CopyPicture(YV12Image* pImage, DVDVideoPicture *pSrc)
 {
-  uint8_t *s = pSrc->data[0];
-  uint8_t *d = pImage->plane[0];
   int w = pImage->width * pImage->bpp;
   int h = pImage->height;
-  if ((w == pSrc->iLineSize[0]) && ((unsigned int) pSrc->iLineSize[0] == pImage->stride[0]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[0];
-      d += pImage->stride[0];
-    }
-  }
-  s = pSrc->data[1];
-  d = pImage->plane[1];
-  w =(pImage->width  >> pImage->cshift_x) * pImage->bpp;
-  h =(pImage->height >> pImage->cshift_y);
-  if ((w==pSrc->iLineSize[1]) && ((unsigned int) pSrc->iLineSize[1]==pImage->stride[1]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[1];
-      d += pImage->stride[1];
-    }
-  }
-  s = pSrc->data[2];
-  d = pImage->plane[2];
-  if ((w==pSrc->iLineSize[2]) && ((unsigned int) pSrc->iLineSize[2]==pImage->stride[2]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[2];
-      d += pImage->stride[2];
-    }
-  }
+  int cw = (pImage->width  >> pImage->cshift_x) * pImage->bpp;
+  int ch = (pImage->height >> pImage->cshift_y);
+
+  CopyPlanes planes;
+  planes.count = 0;
+  AddCopyPlane(planes, pImage->plane[0], pImage->stride[0], pSrc->data[0], pSrc->iLineSize[0], w, h);
+  AddCopyPlane(planes, pImage->plane[1], pImage->stride[1], pSrc->data[1], pSrc->iLineSize[1], cw, ch);
+  AddCopyPlane(planes, pImage->plane[2], pImage->stride[2], pSrc->data[2], pSrc->iLineSize[2], cw, ch);
+  CopyPicturePlanes(planes, pImage->width, pImage->height);
   return true;
 }
 
@@ -184,6 +231,7 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToNV12Picture(DVDVideoPicture *pSrc)
   if (pPicture)
   {
     *pPicture = *pSrc;
+    pPicture->videoBuffer = NULL;
 
     int w = pPicture->iWidth / 2;
     int h = pPicture->iHeight / 2;
@@ -202,27 +250,10 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToNV12Picture(DVDVideoPicture *pSrc)
       pPicture->iLineSize[3] = 0;
       pPicture->format = RENDER_FMT_NV12;
       
-      // copy luma
-      uint8_t *s = pSrc->data[0];
-      uint8_t *d = pPicture->data[0];
-      for (int y = 0; y < (int)pSrc->iHeight; y++)
-      {
-        fast_memcpy(d, s, pSrc->iWidth);
-        s += pSrc->iLineSize[0];
-        d += pPicture->iLineSize[0];
-      }
-
-      //copy chroma
-      for (int y = 0; y < (int)pSrc->iHeight/2; y++) {
-        uint8_t *s_u = pSrc->data[1] + (y * pSrc->iLineSize[1]);
-        uint8_t *s_v = pSrc->data[2] + (y * pSrc->iLineSize[2]);
-        uint8_t *d_uv = pPicture->data[1] + (y * pPicture->iLineSize[1]);
-        for (int x = 0; x < (int)pSrc->iWidth/2; x++) {
-          *d_uv++ = *s_u++;
-          *d_uv++ = *s_v++;
-        }
-      }
-      
+      // copy luma and interleave chroma
+      ConvertPicture convert = { pPicture, pSrc, &CDVDPictureKernels::Get(), RENDER_FMT_NV12 };
+      CDVDPictureKernels::ForEachBand(ConvertToNV12Band, &convert, CDVDPictureKernels::GetBandCount(pSrc->iWidth, pSrc->iHeight));
+      AtomicIncrement(&g_frameCopyCount);
     }
     else
     {
@@ -241,6 +272,7 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToYUV422PackedPicture(DVDVideoPicture *p
   if (pPicture)
   {
     *pPicture = *pSrc;
+    pPicture->videoBuffer = NULL;
 
     int totalsize = pPicture->iWidth * pPicture->iHeight * 2;
     uint8_t* data = new uint8_t[totalsize];
@@ -257,27 +289,9 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToYUV422PackedPicture(DVDVideoPicture *p
       pPicture->iLineSize[3] = 0;
       pPicture->format = format;
 
-      //if this is going to be used for anything else than testing the renderer
-      //the library should not be loaded on every function call
-      {
-        // Perform the scaling.
-        uint8_t* src[] =       { pSrc->data[0],          pSrc->data[1],      pSrc->data[2],      NULL };
-        int      srcStride[] = { pSrc->iLineSize[0],     pSrc->iLineSize[1], pSrc->iLineSize[2], 0    };
-        uint8_t* dst[] =       { pPicture->data[0],      NULL,               NULL,               NULL };
-        int      dstStride[] = { pPicture->iLineSize[0], 0,                  0,                  0    };
-
-        int dstformat;
-        if (format == RENDER_FMT_UYVY422)
-          dstformat = PIX_FMT_UYVY422;
-        else
-          dstformat = PIX_FMT_YUYV422;
-
-        struct SwsContext *ctx = sws_getContext(pSrc->iWidth, pSrc->iHeight, PIX_FMT_YUV420P,
-                                                           pPicture->iWidth, pPicture->iHeight, (AVPixelFormat)dstformat,
-                                                           SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
-        sws_scale(ctx, src, srcStride, 0, pSrc->iHeight, dst, dstStride);
-        sws_freeContext(ctx);
-      }
+      ConvertPicture convert = { pPicture, pSrc, &CDVDPictureKernels::Get(), format };
+      CDVDPictureKernels::ForEachBand(ConvertToYUV422PackedBand, &convert, CDVDPictureKernels::GetBandCount(pSrc->iWidth, pSrc->iHeight));
+      AtomicIncrement(&g_frameCopyCount);
     }
     else
     {
@@ -291,69 +305,29 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToYUV422PackedPicture(DVDVideoPicture *p
 
 bool CDVDCodecUtils::CopyNV12Picture(YV12Image* pImage, DVDVideoPicture *pSrc)
 {
-  uint8_t *s = pSrc->data[0];
-  uint8_t *d = pImage->plane[0];
   int w = pSrc->iWidth;
   int h = pSrc->iHeight;
+
+  CopyPlanes planes;
+  planes.count = 0;
   // Copy Y
-  if ((w == pSrc->iLineSize[0]) && ((unsigned int) pSrc->iLineSize[0] == pImage->stride[0]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[0];
-      d += pImage->stride[0];
-    }
-  }
-  
-  s = pSrc->data[1];
-  d = pImage->plane[1];
-  w = pSrc->iWidth;
-  h = pSrc->iHeight >> 1;
+  AddCopyPlane(planes, pImage->plane[0], pImage->stride[0], pSrc->data[0], pSrc->iLineSize[0], w, h);
   // Copy packed UV (width is same as for Y as it's both U and V components)
-  if ((w==pSrc->iLineSize[1]) && ((unsigned int) pSrc->iLineSize[1]==pImage->stride[1]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[1];
-      d += pImage->stride[1];
-    }
-  }
-
+  AddCopyPlane(planes, pImage->plane[1], pImage->stride[1], pSrc->data[1], pSrc->iLineSize[1], w, h >> 1);
+  CopyPicturePlanes(planes, w, h);
   return true;
 }
 
 bool CDVDCodecUtils::CopyYUV422PackedPicture(YV12Image* pImage, DVDVideoPicture *pSrc)
 {
-  uint8_t *s = pSrc->data[0];
-  uint8_t *d = pImage->plane[0];
   int w = pSrc->iWidth;
   int h = pSrc->iHeight;
 
   // Copy YUYV
-  if ((w * 2 == pSrc->iLineSize[0]) && ((unsigned int) pSrc->iLineSize[0] == pImage->stride[0]))
-  {
-    fast_memcpy(d, s, w*h*2);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w*2);
-      s += pSrc->iLineSize[0];
-      d += pImage->stride[0];
-    }
-  }
-  
+  CopyPlanes planes;
+  planes.count = 0;
+  AddCopyPlane(planes, pImage->plane[0], pImage->stride[0], pSrc->data[0], pSrc->iLineSize[0], w * 2, h);
+  CopyPicturePlanes(planes, w, h);
   return true;
 }
 
@@ -415,6 +389,11 @@ bool CDVDCodecUtils::CopyDXVA2Picture(YV12Image* pImage, DVDVideoPicture *pSrc)
   return false;
 }
 
+long CDVDCodecUtils::GetFrameCopyCount()
+{
+  return g_frameCopyCount;
+}
+
 bool CDVDCodecUtils::IsVP3CompatibleWidth(int width)
 {
   // known hardware limitation of purevideo 3 (VP3). (the Nvidia 9400 is a purevideo 3 chip)
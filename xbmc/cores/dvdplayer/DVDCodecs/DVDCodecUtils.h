@@ -45,5 +45,8 @@ public:
 
   static ERenderFormat EFormatFromPixfmt(int fmt);
   static int           PixfmtFromEFormat(ERenderFormat format);
+
+  /*! \brief Number of pictures copied or converted so far, to verify which paths avoid copying frames. */
+  static long GetFrameCopyCount();
 };
 
@@ -0,0 +1,419 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDPictureKernels.h"
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+#if defined(TARGET_WINDOWS) && (defined(_M_X64) || _M_IX86_FP > 1) && !defined(__SSE2__)
+#define __SSE2__
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// AVX2 kernels are built with a target attribute, so need a compiler that allows intrinsics in them
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    ((defined(__clang__) && (__clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 8))) || \
+     (!defined(__clang__) && defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define HAS_AVX2_KERNELS
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define HAS_NEON_KERNELS
+#include <arm_neon.h>
+#endif
+
+#define BAND_MIN_PIXELS (2560 * 1440) // pictures smaller than this are done in one go
+#define BAND_MAX_COUNT  4             // more threads than this don't get any more memory bandwidth
+
+static void InterleaveUV_C(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  for (int x = 0; x < width; x++)
+  {
+    *dst++ = *u++;
+    *dst++ = *v++;
+  }
+}
+
+static void PackYUYV_C(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  for (int x = 0; x < width / 2; x++)
+  {
+    *dst++ = *y++;
+    *dst++ = *u++;
+    *dst++ = *y++;
+    *dst++ = *v++;
+  }
+}
+
+static void PackUYVY_C(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  for (int x = 0; x < width / 2; x++)
+  {
+    *dst++ = *u++;
+    *dst++ = *y++;
+    *dst++ = *v++;
+    *dst++ = *y++;
+  }
+}
+
+#ifdef __SSE2__
+static void InterleaveUV_SSE2(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    __m128i u0 = _mm_loadu_si128((const __m128i *)(u + x));
+    __m128i v0 = _mm_loadu_si128((const __m128i *)(v + x));
+    _mm_storeu_si128((__m128i *)(dst + 2 * x),      _mm_unpacklo_epi8(u0, v0));
+    _mm_storeu_si128((__m128i *)(dst + 2 * x + 16), _mm_unpackhi_epi8(u0, v0));
+  }
+  InterleaveUV_C(dst + 2 * x, u + x, v + x, width - x);
+}
+
+static void PackYUYV_SSE2(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32)
+  {
+    __m128i y0  = _mm_loadu_si128((const __m128i *)(y + x));
+    __m128i y1  = _mm_loadu_si128((const __m128i *)(y + x + 16));
+    __m128i u0  = _mm_loadu_si128((const __m128i *)(u + x / 2));
+    __m128i v0  = _mm_loadu_si128((const __m128i *)(v + x / 2));
+    __m128i uv0 = _mm_unpacklo_epi8(u0, v0);
+    __m128i uv1 = _mm_unpackhi_epi8(u0, v0);
+    _mm_storeu_si128((__m128i *)(dst + 2 * x),      _mm_unpacklo_epi8(y0, uv0));
+    _mm_storeu_si128((__m128i *)(dst + 2 * x + 16), _mm_unpackhi_epi8(y0, uv0));
+    _mm_storeu_si128((__m128i *)(dst + 2 * x + 32), _mm_unpacklo_epi8(y1, uv1));
+    _mm_storeu_si128((__m128i *)(dst + 2 * x + 48), _mm_unpackhi_epi8(y1, uv1));
+  }
+  PackYUYV_C(dst + 2 * x, y + x, u + x / 2, v + x / 2, width - x);
+}
+
+static void PackUYVY_SSE2(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32)
+  {
+    __m128i y0  = _mm_loadu_si128((const __m128i *)(y + x));
+    __m128i y1  = _mm_loadu_si128((const __m128i *)(y + x + 16));
+    __m128i u0  = _mm_loadu_si128((const __m128i *)(u + x / 2));
+    __m128i v0  = _mm_loadu_si128((const __m128i *)(v + x / 2));
+    __m128i uv0 = _mm_unpacklo_epi8(u0, v0);
+    __m128i uv1 = _mm_unpackhi_epi8(u0, v0);
+    _mm_storeu_si128((__m128i *)(dst + 2 * x),      _mm_unpacklo_epi8(uv0, y0));
+    _mm_storeu_si128((__m128i *)(dst + 2 * x + 16), _mm_unpackhi_epi8(uv0, y0));
+    _mm_storeu_si128((__m128i *)(dst + 2 * x + 32), _mm_unpacklo_epi8(uv1, y1));
+    _mm_storeu_si128((__m128i *)(dst + 2 * x + 48), _mm_unpackhi_epi8(uv1, y1));
+  }
+  PackUYVY_C(dst + 2 * x, y + x, u + x / 2, v + x / 2, width - x);
+}
+#endif
+
+#ifdef HAS_AVX2_KERNELS
+/* AVX2 unpacks work within each 128 bit lane, so the two halves of the
+   result are swapped back into order with a cross lane permute. */
+TARGET_AVX2 static inline void Interleave_AVX2(__m256i a, __m256i b, __m256i &lo, __m256i &hi)
+{
+  __m256i l = _mm256_unpacklo_epi8(a, b);
+  __m256i h = _mm256_unpackhi_epi8(a, b);
+  lo = _mm256_permute2x128_si256(l, h, 0x20);
+  hi = _mm256_permute2x128_si256(l, h, 0x31);
+}
+
+TARGET_AVX2 static void InterleaveUV_AVX2(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32)
+  {
+    __m256i lo, hi;
+    Interleave_AVX2(_mm256_loadu_si256((const __m256i *)(u + x)), _mm256_loadu_si256((const __m256i *)(v + x)), lo, hi);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x),      lo);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x + 32), hi);
+  }
+  InterleaveUV_C(dst + 2 * x, u + x, v + x, width - x);
+}
+
+TARGET_AVX2 static void PackYUYV_AVX2(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 64 <= width; x += 64)
+  {
+    __m256i uv0, uv1, lo, hi;
+    Interleave_AVX2(_mm256_loadu_si256((const __m256i *)(u + x / 2)), _mm256_loadu_si256((const __m256i *)(v + x / 2)), uv0, uv1);
+    Interleave_AVX2(_mm256_loadu_si256((const __m256i *)(y + x)), uv0, lo, hi);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x),      lo);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x + 32), hi);
+    Interleave_AVX2(_mm256_loadu_si256((const __m256i *)(y + x + 32)), uv1, lo, hi);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x + 64), lo);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x + 96), hi);
+  }
+  PackYUYV_C(dst + 2 * x, y + x, u + x / 2, v + x / 2, width - x);
+}
+
+TARGET_AVX2 static void PackUYVY_AVX2(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 64 <= width; x += 64)
+  {
+    __m256i uv0, uv1, lo, hi;
+    Interleave_AVX2(_mm256_loadu_si256((const __m256i *)(u + x / 2)), _mm256_loadu_si256((const __m256i *)(v + x / 2)), uv0, uv1);
+    Interleave_AVX2(uv0, _mm256_loadu_si256((const __m256i *)(y + x)), lo, hi);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x),      lo);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x + 32), hi);
+    Interleave_AVX2(uv1, _mm256_loadu_si256((const __m256i *)(y + x + 32)), lo, hi);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x + 64), lo);
+    _mm256_storeu_si256((__m256i *)(dst + 2 * x + 96), hi);
+  }
+  PackUYVY_C(dst + 2 * x, y + x, u + x / 2, v + x / 2, width - x);
+}
+#endif
+
+#ifdef HAS_NEON_KERNELS
+static void InterleaveUV_NEON(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    uint8x16x2_t uv;
+    uv.val[0] = vld1q_u8(u + x);
+    uv.val[1] = vld1q_u8(v + x);
+    vst2q_u8(dst + 2 * x, uv);
+  }
+  InterleaveUV_C(dst + 2 * x, u + x, v + x, width - x);
+}
+
+static void PackYUYV_NEON(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32)
+  {
+    uint8x16x2_t yy = vld2q_u8(y + x);
+    uint8x16x4_t yuyv;
+    yuyv.val[0] = yy.val[0];
+    yuyv.val[1] = vld1q_u8(u + x / 2);
+    yuyv.val[2] = yy.val[1];
+    yuyv.val[3] = vld1q_u8(v + x / 2);
+    vst4q_u8(dst + 2 * x, yuyv);
+  }
+  PackYUYV_C(dst + 2 * x, y + x, u + x / 2, v + x / 2, width - x);
+}
+
+static void PackUYVY_NEON(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32)
+  {
+    uint8x16x2_t yy = vld2q_u8(y + x);
+    uint8x16x4_t uyvy;
+    uyvy.val[0] = vld1q_u8(u + x / 2);
+    uyvy.val[1] = yy.val[0];
+    uyvy.val[2] = vld1q_u8(v + x / 2);
+    uyvy.val[3] = yy.val[1];
+    vst4q_u8(dst + 2 * x, uyvy);
+  }
+  PackUYVY_C(dst + 2 * x, y + x, u + x / 2, v + x / 2, width - x);
+}
+#endif
+
+static const CDVDPictureKernels g_kernelsC    = { "C",    InterleaveUV_C,    PackYUYV_C,    PackUYVY_C    };
+#ifdef __SSE2__
+static const CDVDPictureKernels g_kernelsSSE2 = { "SSE2", InterleaveUV_SSE2, PackYUYV_SSE2, PackUYVY_SSE2 };
+#endif
+#ifdef HAS_AVX2_KERNELS
+static const CDVDPictureKernels g_kernelsAVX2 = { "AVX2", InterleaveUV_AVX2, PackYUYV_AVX2, PackUYVY_AVX2 };
+#endif
+#ifdef HAS_NEON_KERNELS
+static const CDVDPictureKernels g_kernelsNEON = { "NEON", InterleaveUV_NEON, PackYUYV_NEON, PackUYVY_NEON };
+#endif
+
+std::vector<const CDVDPictureKernels *> CDVDPictureKernels::GetSupported(unsigned int cpuFeatures)
+{
+  std::vector<const CDVDPictureKernels *> kernels;
+  kernels.push_back(&g_kernelsC);
+#ifdef __SSE2__
+  if (cpuFeatures & CPU_FEATURE_SSE2)
+    kernels.push_back(&g_kernelsSSE2);
+#endif
+#ifdef HAS_AVX2_KERNELS
+  if (cpuFeatures & CPU_FEATURE_AVX2)
+    kernels.push_back(&g_kernelsAVX2);
+#endif
+#ifdef HAS_NEON_KERNELS
+  if (cpuFeatures & CPU_FEATURE_NEON)
+    kernels.push_back(&g_kernelsNEON);
+#endif
+  return kernels;
+}
+
+// function local statics aren't initialised thread safe by every compiler we support (MSVC 2010)
+static CCriticalSection g_kernelsSection;
+static const CDVDPictureKernels *g_kernels = NULL;
+
+const CDVDPictureKernels &CDVDPictureKernels::Get()
+{
+  CSingleLock lock(g_kernelsSection);
+  if (!g_kernels)
+  {
+    g_kernels = GetSupported(g_cpuInfo.GetCPUFeatures()).back();
+    CLog::Log(LOGDEBUG, "CDVDPictureKernels::Get - using %s kernels", g_kernels->name);
+  }
+  return *g_kernels;
+}
+
+/*! \brief Threads that work on the bands of a picture together with the caller of ForEachBand.
+ Started on first use and kept around until StopWorkers, as they are needed for every frame.
+ */
+class CBandWorkers : private IRunnable
+{
+public:
+  CBandWorkers() : m_func(NULL), m_arg(NULL), m_bands(0), m_next(0), m_done(0), m_stopping(false)
+  {
+  }
+
+  ~CBandWorkers()
+  {
+    {
+      CSingleLock lock(m_section);
+      m_stopping = true;
+      m_wake.notifyAll();
+    }
+    for (std::vector<CThread *>::iterator i = m_threads.begin(); i != m_threads.end(); ++i)
+    {
+      (*i)->StopThread();
+      delete *i;
+    }
+  }
+
+  void Work(CDVDPictureKernels::BandFunc func, void *arg, int bands)
+  {
+    CSingleLock lock(m_section);
+    while ((int)m_threads.size() < bands - 1)
+    {
+      CThread *thread = new CThread(this, "PictureBands");
+      thread->Create();
+      m_threads.push_back(thread);
+    }
+    m_func  = func;
+    m_arg   = arg;
+    m_bands = bands;
+    m_next  = 0;
+    m_done  = 0;
+    m_wake.notifyAll();
+
+    DoBands(lock);
+    while (m_done < m_bands)
+      m_finished.wait(lock);
+    m_bands = 0;
+  }
+
+private:
+  virtual void Run()
+  {
+    CSingleLock lock(m_section);
+    while (!m_stopping)
+    {
+      if (m_next < m_bands)
+        DoBands(lock);
+      else
+        m_wake.wait(lock);
+    }
+  }
+
+  void DoBands(CSingleLock &lock)
+  {
+    while (m_next < m_bands)
+    {
+      int band = m_next++;
+      CDVDPictureKernels::BandFunc func = m_func;
+      void *arg = m_arg;
+      int bands = m_bands;
+
+      lock.Leave();
+      func(arg, band, bands);
+      lock.Enter();
+
+      if (++m_done == m_bands)
+        m_finished.notifyAll();
+    }
+  }
+
+  CDVDPictureKernels::BandFunc m_func;
+  void *m_arg;
+  int m_bands;
+  int m_next;    ///< next band to work on
+  int m_done;    ///< number of bands done
+  bool m_stopping;
+  std::vector<CThread *> m_threads;
+  CCriticalSection m_section;
+  XbmcThreads::ConditionVariable m_wake;
+  XbmcThreads::ConditionVariable m_finished;
+};
+
+// held while a picture is worked on, so one picture at a time and the workers aren't stopped under it
+static CCriticalSection g_bandWorkersSection;
+static CBandWorkers *g_bandWorkers = NULL;
+
+int CDVDPictureKernels::GetBandCount(int width, int height)
+{
+  if (width * height < BAND_MIN_PIXELS)
+    return 1;
+  return std::max(1, std::min(g_cpuInfo.getCPUCount(), BAND_MAX_COUNT));
+}
+
+void CDVDPictureKernels::ForEachBand(BandFunc func, void *arg, int bands)
+{
+  if (bands <= 1)
+  {
+    func(arg, 0, 1);
+    return;
+  }
+
+  CSingleLock lock(g_bandWorkersSection);
+  if (!g_bandWorkers)
+    g_bandWorkers = new CBandWorkers;
+  g_bandWorkers->Work(func, arg, bands);
+}
+
+void CDVDPictureKernels::StopWorkers()
+{
+  CSingleLock lock(g_bandWorkersSection);
+  delete g_bandWorkers;
+  g_bandWorkers = NULL;
+}
+
+void CDVDPictureKernels::GetBandRows(int band, int bands, int rows, int align, int &first, int &count)
+{
+  int units = (rows + align - 1) / align;
+  int begin = units * band / bands * align;
+  int end   = units * (band + 1) / bands * align;
+  first = std::min(begin, rows);
+  count = std::min(end, rows) - first;
+}
@@ -0,0 +1,84 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+/*!
+ \brief Row kernels used by CDVDCodecUtils to convert pictures between layouts.
+
+ Every set of kernels gives the same output, byte for byte.  Besides the plain C
+ set there are SSE2, AVX2 and NEON sets, depending on what the compiler can build,
+ and Get() picks the fastest one the CPU supports.
+
+ Large pictures can be split into bands of rows that are worked on in parallel,
+ see GetBandCount and ForEachBand.
+ */
+class CDVDPictureKernels
+{
+public:
+  /*! \brief Interleave a row of U and V samples to UVUV...
+   \param width number of U (and V) samples
+   */
+  typedef void (*InterleaveFunc)(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width);
+
+  /*! \brief Pack a row of Y samples and the U and V samples that go with them to YUYV or UYVY
+   \param width number of Y samples, U and V hold width / 2 samples each
+   */
+  typedef void (*PackFunc)(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width);
+
+  typedef void (*BandFunc)(void *arg, int band, int bands);
+
+  const char    *name;
+  InterleaveFunc InterleaveUV;
+  PackFunc       PackYUYV;
+  PackFunc       PackUYVY;
+
+  /*! \brief The fastest kernels the CPU we run on supports */
+  static const CDVDPictureKernels &Get();
+
+  /*! \brief All kernels built in that are supported by the given CPU features, slowest (plain C) first
+   \param cpuFeatures CPU_FEATURE_* flags as returned by CCPUInfo::GetCPUFeatures
+   */
+  static std::vector<const CDVDPictureKernels *> GetSupported(unsigned int cpuFeatures);
+
+  /*! \brief Number of bands to split a picture of the given size into, 1 unless the picture is large.
+   Copies of large pictures are bound by memory bandwidth, which a single core doesn't use up.
+   */
+  static int GetBandCount(int width, int height);
+
+  /*! \brief Call func(arg, band, bands) once for every band, the calling thread included.
+   Returns when all bands are done.
+   */
+  static void ForEachBand(BandFunc func, void *arg, int bands);
+
+  /*! \brief Stop the threads ForEachBand started, they are started again when needed.
+   Called on shutdown, before static destruction.
+   */
+  static void StopWorkers();
+
+  /*! \brief First row and number of rows of a band of a plane
+   \param rows number of rows of the plane
+   \param align rows per band are a multiple of this, e.g. 2 so both luma rows of a chroma row go together
+   */
+  static void GetBandRows(int band, int bands, int rows, int align, int &first, int &count);
+};
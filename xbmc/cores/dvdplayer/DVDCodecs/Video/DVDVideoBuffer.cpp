@@ -0,0 +1,177 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDVideoBuffer.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
+
+extern "C" {
+#include "libavutil/imgutils.h"
+#include "libavutil/pixdesc.h"
+}
+
+#define BUFFER_ALIGN 64 // bytes rows and planes are aligned to
+#define BUFFER_PADDING (FF_INPUT_BUFFER_PADDING_SIZE + BUFFER_ALIGN - 1) // slack libavcodec may read past the last row, plus room to align the plane
+
+CDVDVideoBuffer::CDVDVideoBuffer(AVFrame *frame)
+  : m_frame(frame), m_refCount(1)
+{
+}
+
+CDVDVideoBuffer::~CDVDVideoBuffer()
+{
+  av_frame_free(&m_frame);
+}
+
+CDVDVideoBuffer* CDVDVideoBuffer::Create(const AVFrame *frame)
+{
+  if (!frame || !frame->buf[0])
+    return NULL;
+
+  AVFrame *ref = av_frame_alloc();
+  if (!ref)
+    return NULL;
+  if (av_frame_ref(ref, frame) < 0)
+  {
+    av_frame_free(&ref);
+    return NULL;
+  }
+  return new CDVDVideoBuffer(ref);
+}
+
+CDVDVideoBuffer* CDVDVideoBuffer::Acquire()
+{
+  AtomicIncrement(&m_refCount);
+  return this;
+}
+
+long CDVDVideoBuffer::Release()
+{
+  long count = AtomicDecrement(&m_refCount);
+  if (count == 0)
+    delete this;
+  return count;
+}
+
+CDVDVideoBufferPool::CDVDVideoBufferPool()
+{
+  for (int i = 0; i < 3; i++)
+  {
+    m_pools[i] = NULL;
+    m_linesize[i] = 0;
+  }
+  m_format = AV_PIX_FMT_NONE;
+  m_width = 0;
+  m_height = 0;
+}
+
+CDVDVideoBufferPool::~CDVDVideoBufferPool()
+{
+  Reset();
+}
+
+void CDVDVideoBufferPool::Reset()
+{
+  // buffers still referenced by frames return to the old pools, which are freed after the last one
+  for (int i = 0; i < 3; i++)
+    av_buffer_pool_uninit(&m_pools[i]);
+  m_format = AV_PIX_FMT_NONE;
+  m_width = 0;
+  m_height = 0;
+}
+
+bool CDVDVideoBufferPool::Supports(int format)
+{
+  switch (format)
+  {
+  case AV_PIX_FMT_YUV420P:
+  case AV_PIX_FMT_YUVJ420P:
+  case AV_PIX_FMT_YUV420P10:
+  case AV_PIX_FMT_YUV420P16:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool CDVDVideoBufferPool::GetBuffer(AVCodecContext *avctx, AVFrame *frame)
+{
+  if (!Supports(frame->format))
+    return false;
+
+  CSingleLock lock(m_section);
+
+  if (frame->format != m_format || frame->width != m_width || frame->height != m_height)
+  {
+    Reset();
+
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)frame->format);
+    if (!desc)
+      return false;
+
+    // the codec may write up to the aligned size, and needs its rows aligned as well
+    int w = frame->width;
+    int h = frame->height;
+    int align[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(avctx, &w, &h, align);
+
+    int linesize[4];
+    if (av_image_fill_linesizes(linesize, (AVPixelFormat)frame->format, w) < 0)
+      return false;
+
+    for (int i = 0; i < 3; i++)
+    {
+      int rows = i ? FF_CEIL_RSHIFT(h, desc->log2_chroma_h) : h;
+      m_linesize[i] = FFALIGN(linesize[i], FFMAX(BUFFER_ALIGN, align[i]));
+      m_pools[i] = av_buffer_pool_init(m_linesize[i] * rows + BUFFER_PADDING, NULL);
+      if (!m_pools[i])
+      {
+        Reset();
+        return false;
+      }
+    }
+
+    m_format = frame->format;
+    m_width = frame->width;
+    m_height = frame->height;
+  }
+
+  for (int i = 0; i < 3; i++)
+  {
+    frame->buf[i] = av_buffer_pool_get(m_pools[i]);
+    if (!frame->buf[i])
+    {
+      for (int j = 0; j < i; j++)
+        av_buffer_unref(&frame->buf[j]);
+      return false;
+    }
+    frame->data[i] = (uint8_t*)FFALIGN((uintptr_t)frame->buf[i]->data, BUFFER_ALIGN);
+    frame->linesize[i] = m_linesize[i];
+  }
+  for (int i = 3; i < AV_NUM_DATA_POINTERS; i++)
+  {
+    frame->buf[i] = NULL;
+    frame->data[i] = NULL;
+    frame->linesize[i] = 0;
+  }
+  frame->extended_data = frame->data;
+
+  return true;
+}
@@ -0,0 +1,97 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavutil/buffer.h"
+}
+
+/*!
+ \brief A software decoded frame shared by the decoder and the renderer.
+
+ Holds its own reference to the buffers of a reference counted AVFrame, so the renderer
+ can upload straight from the memory libavcodec decoded into rather than copying the
+ picture into one of its own images first. The planes are freed once the decoder and
+ every renderer buffer holding the frame released it.
+
+ \sa DVDVideoPicture::videoBuffer, CDVDVideoBufferPool
+ */
+class CDVDVideoBuffer
+{
+public:
+  /*!
+   \brief Create a buffer referencing the planes of the given frame.
+   \param frame a reference counted frame.
+   \return the buffer holding one reference, NULL if the frame isn't reference counted.
+   */
+  static CDVDVideoBuffer* Create(const AVFrame *frame);
+
+  CDVDVideoBuffer* Acquire();
+  long Release();
+
+  const AVFrame* GetFrame() const { return m_frame; }
+
+private:
+  CDVDVideoBuffer(AVFrame *frame);
+  ~CDVDVideoBuffer();
+
+  AVFrame      *m_frame;
+  volatile long m_refCount;
+};
+
+/*!
+ \brief Allocator for the pictures libavcodec decodes into, see AVCodecContext::get_buffer2.
+
+ Planar YUV 4:2:0 pictures are handed out from pools of equally sized planes, with rows
+ padded to a multiple of 64 bytes and planes starting on a 64 byte boundary, so a frame
+ can be passed on to the renderer as is. The pools are recreated whenever the size or
+ format of the pictures changes, frames still in use keep the old ones alive.
+ */
+class CDVDVideoBufferPool
+{
+public:
+  CDVDVideoBufferPool();
+  ~CDVDVideoBufferPool();
+
+  /*!
+   \brief Allocate the planes of a picture, may be called from any of the decoder threads.
+   \param avctx the codec context the picture is decoded by.
+   \param frame the frame to allocate, format and size already set by libavcodec.
+   \return true if the planes were allocated, false to use avcodec_default_get_buffer2 instead.
+   */
+  bool GetBuffer(AVCodecContext *avctx, AVFrame *frame);
+
+  /*! \brief Whether pictures of the given format are allocated from the pools. */
+  static bool Supports(int format);
+
+private:
+  void Reset();
+
+  CCriticalSection m_section;
+  AVBufferPool    *m_pools[3];
+  int              m_linesize[3];
+  int              m_format;
+  int              m_width;
+  int              m_height;
+};
@@ -57,6 +57,7 @@ class CDVDVideoCodecStageFright;
 class CDVDMediaCodecInfo;
 class CDVDVideoCodecIMXBuffer;
 class CMMALVideoBuffer;
+class CDVDVideoBuffer;
 typedef void* EGLImageKHR;
 
 
@@ -110,6 +111,8 @@ struct DVDVideoPicture
 
   };
 
+  CDVDVideoBuffer* videoBuffer; // software decoded frame data[] points into, NULL if none. Held by the decoder until ClearPicture, Acquire() to keep it longer
+
   unsigned int iFlags;
 
   double       iRepeatPicture;
@@ -338,4 +341,18 @@ public:
    *
    */
   virtual void SetCodecControl(int flags) {}
+
+  /*
+   * Time the codec spent filtering pictures since the last call, for codecs
+   * that deinterlace or convert pictures in software.
+   *
+   * pictures : number of pictures filtered
+   * ticks    : time spent filtering them, in CurrentHostFrequency() units
+   * maxTicks : longest time spent filtering one of them
+   */
+  virtual void GetFilterStats(unsigned int &pictures, int64_t &ticks, int64_t &maxTicks)
+  {
+    pictures = 0;
+    ticks = maxTicks = 0;
+  }
 };
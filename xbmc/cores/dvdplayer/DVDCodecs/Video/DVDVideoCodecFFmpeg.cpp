@@ -62,12 +62,11 @@
 #include "VDA.h"
 #endif
 #include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 
 extern "C" {
 #include "libavutil/opt.h"
 #include "libavfilter/avfilter.h"
-#include "libavfilter/buffersink.h"
-#include "libavfilter/buffersrc.h"
 }
 
 using namespace boost;
@@ -147,7 +146,7 @@ enum PixelFormat CDVDVideoCodecFFmpeg::GetFormat( struct AVCodecContext * avctx
   if (ctx->GetHardware())
   {
     ctx->SetHardware(NULL);
-    avctx->get_buffer2     = avcodec_default_get_buffer2;
+    avctx->get_buffer2     = avctx->codec->capabilities & CODEC_CAP_DR1 ? GetBuffer : avcodec_default_get_buffer2;
     avctx->slice_flags     = 0;
     avctx->hwaccel_context = 0;
   }
@@ -155,14 +154,21 @@ enum PixelFormat CDVDVideoCodecFFmpeg::GetFormat( struct AVCodecContext * avctx
   return avcodec_default_get_format(avctx, fmt);
 }
 
+int CDVDVideoCodecFFmpeg::GetBuffer(struct AVCodecContext * avctx, AVFrame * frame, int flags)
+{
+  CDVDVideoCodecFFmpeg* ctx  = (CDVDVideoCodecFFmpeg*)avctx->opaque;
+
+  if(ctx->m_bufferPool.GetBuffer(avctx, frame))
+    return 0;
+
+  return avcodec_default_get_buffer2(avctx, frame, flags);
+}
+
 CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
 {
   m_pCodecContext = NULL;
   m_pFrame = NULL;
-  m_pFilterGraph  = NULL;
-  m_pFilterIn     = NULL;
-  m_pFilterOut    = NULL;
-  m_pFilterFrame  = NULL;
+  m_pVideoBuffer = NULL;
 
   m_iPictureWidth = 0;
   m_iPictureHeight = 0;
@@ -253,18 +259,19 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pCodecContext->workaround_bugs = FF_BUG_AUTODETECT;
   m_pCodecContext->get_format = GetFormat;
   m_pCodecContext->codec_tag = hints.codec_tag;
-  /* Only allow slice threading, since frame threading is more
-   * sensitive to changes in frame sizes, and it causes crashes
-   * during HW accell - so we unset it in this case.
+
+  /* Decode into pooled reference counted buffers, pictures are passed on to
+   * the renderer as they are and it may keep them until they are presented.
+   * get_format only sets up hardware decoders when hardware decoding is
+   * selected, all other callbacks may be called from the decoding threads.
    * */
-  if ((EDECODEMETHOD) CSettings::Get().GetInt("videoplayer.decodingmethod") == VS_DECODEMETHOD_SOFTWARE || m_isSWCodec)
+  m_pCodecContext->refcounted_frames = 1;
+  if (pCodec->capabilities & CODEC_CAP_DR1)
   {
-    CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Keeping default threading %d",
-                        m_pCodecContext->thread_type);
+    m_pCodecContext->get_buffer2 = GetBuffer;
+    if ((EDECODEMETHOD) CSettings::Get().GetInt("videoplayer.decodingmethod") != VS_DECODEMETHOD_HARDWARE || m_bSoftware)
+      m_pCodecContext->thread_safe_callbacks = 1;
   }
-  else
-    m_pCodecContext->thread_type = FF_THREAD_SLICE;
-
 #if defined(TARGET_DARWIN_IOS)
   // ffmpeg with enabled neon will crash and burn if this is enabled
   m_pCodecContext->flags &= CODEC_FLAG_EMU_EDGE;
@@ -303,13 +310,12 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
       av_opt_set(m_pCodecContext, it->m_name.c_str(), it->m_value.c_str(), 0);
   }
 
-  int num_threads = std::min(8 /*MAX_THREADS*/, g_cpuInfo.getCPUCount());
-  if( num_threads > 1 && !hints.software && m_pHardware == NULL // thumbnail extraction fails when run threaded
-  && ( pCodec->id == AV_CODEC_ID_H264
-    || pCodec->id == AV_CODEC_ID_MPEG4
-    || pCodec->id == AV_CODEC_ID_HEVC
-    || pCodec->id == AV_CODEC_ID_VP9))
-    m_pCodecContext->thread_count = num_threads;
+  /* Only allow slice threading when hardware decoding may be used, since
+   * frame threading is more sensitive to changes in frame sizes, and it
+   * causes crashes during HW accell.
+   * */
+  bool allowFrameThreads = (EDECODEMETHOD) CSettings::Get().GetInt("videoplayer.decodingmethod") == VS_DECODEMETHOD_SOFTWARE || m_isSWCodec;
+  m_threading.Apply(hints, pCodec, allowFrameThreads, m_pCodecContext);
 
   if (avcodec_open2(m_pCodecContext, pCodec, NULL) < 0)
   {
@@ -320,19 +326,15 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pFrame = av_frame_alloc();
   if (!m_pFrame) return false;
 
-  m_pFilterFrame = av_frame_alloc();
-  if (!m_pFilterFrame) return false;
-
   UpdateName();
   return true;
 }
 
 void CDVDVideoCodecFFmpeg::Dispose()
 {
-  if (m_pFrame) av_free(m_pFrame);
-  m_pFrame = NULL;
-
-  av_frame_free(&m_pFilterFrame);
+  m_threading.Close();
+  SAFE_RELEASE(m_pVideoBuffer);
+  av_frame_free(&m_pFrame);
 
   if (m_pCodecContext)
   {
@@ -465,7 +467,7 @@ int CDVDVideoCodecFFmpeg::Decode(uint8_t* pData, int iSize, double dts, double p
       return result;
   }
 
-  if(m_pFilterGraph)
+  if(m_filterStage.IsOpen())
   {
     int result = 0;
     if(pData == NULL)
@@ -492,7 +494,12 @@ int CDVDVideoCodecFFmpeg::Decode(uint8_t* pData, int iSize, double dts, double p
   /* We lie, but this flag is only used by pngdec.c.
    * Setting it correctly would allow CorePNG decoding. */
   avpkt.flags = AV_PKT_FLAG_KEY;
+  av_frame_unref(m_pFrame);
+  int64_t start = CurrentHostCounter();
   len = avcodec_decode_video2(m_pCodecContext, m_pFrame, &iGotPicture, &avpkt);
+  // pictures that are dropped or decoded in hardware say nothing about the threading
+  if (len >= 0 && !m_pHardware && m_pCodecContext->skip_frame == AVDISCARD_DEFAULT)
+    m_threading.AddDecodeTime(CurrentHostCounter() - start, iGotPicture != 0);
 
   if(m_iLastKeyframe < m_pCodecContext->has_b_frames + 2)
     m_iLastKeyframe = m_pCodecContext->has_b_frames + 2;
@@ -531,16 +538,12 @@ int CDVDVideoCodecFFmpeg::Decode(uint8_t* pData, int iSize, double dts, double p
     if(m_filters != m_filters_next)
       need_reopen = true;
 
-    if(m_pFilterIn)
-    {
-      if(m_pFilterIn->outputs[0]->format != m_pCodecContext->pix_fmt
-      || m_pFilterIn->outputs[0]->w      != m_pCodecContext->width
-      || m_pFilterIn->outputs[0]->h      != m_pCodecContext->height)
-        need_reopen = true;
-    }
+    if(m_filterStage.IsOpen()
+    && !m_filterStage.Matches(m_pCodecContext->pix_fmt, m_pCodecContext->width, m_pCodecContext->height))
+      need_reopen = true;
 
     // try to setup new filters
-    if (need_reopen || (need_scale && m_pFilterGraph == NULL))
+    if (need_reopen || (need_scale && !m_filterStage.IsOpen()))
     {
       m_filters = m_filters_next;
 
@@ -552,7 +555,7 @@ int CDVDVideoCodecFFmpeg::Decode(uint8_t* pData, int iSize, double dts, double p
   int result;
   if(m_pHardware)
     result = m_pHardware->Decode(m_pCodecContext, m_pFrame);
-  else if(m_pFilterGraph)
+  else if(m_filterStage.IsOpen())
     result = FilterProcess(m_pFrame);
   else
     result = VC_PICTURE | VC_BUFFER;
@@ -575,8 +578,11 @@ void CDVDVideoCodecFFmpeg::Reset()
   if (m_pHardware)
     m_pHardware->Reset();
 
-  m_filters = "";
-  FilterClose();
+  if (m_filterStage.IsOpen() && !m_filterStage.Flush())
+  {
+    m_filters = "";
+    FilterClose();
+  }
 }
 
 bool CDVDVideoCodecFFmpeg::GetPictureCommon(DVDVideoPicture* pDvdVideoPicture)
@@ -725,14 +731,24 @@ bool CDVDVideoCodecFFmpeg::GetPicture(DVDVideoPicture* pDvdVideoPicture)
   pix_fmt = (PixelFormat)m_pFrame->format;
 
   pDvdVideoPicture->format = CDVDCodecUtils::EFormatFromPixfmt(pix_fmt);
+
+  // let the renderer keep the frame instead of copying it
+  SAFE_RELEASE(m_pVideoBuffer);
+  if(!(pDvdVideoPicture->iFlags & DVP_FLAG_DROPPED))
+    m_pVideoBuffer = CDVDVideoBuffer::Create(m_pFrame);
+  pDvdVideoPicture->videoBuffer = m_pVideoBuffer;
   return true;
 }
 
-int CDVDVideoCodecFFmpeg::FilterOpen(const std::string& filters, bool scale)
+bool CDVDVideoCodecFFmpeg::ClearPicture(DVDVideoPicture* pDvdVideoPicture)
 {
-  int result;
+  SAFE_RELEASE(m_pVideoBuffer);
+  return CDVDVideoCodec::ClearPicture(pDvdVideoPicture);
+}
 
-  if (m_pFilterGraph)
+int CDVDVideoCodecFFmpeg::FilterOpen(const std::string& filters, bool scale)
+{
+  if (m_filterStage.IsOpen())
     FilterClose();
 
   if (filters.empty() && !scale)
@@ -744,123 +760,51 @@ int CDVDVideoCodecFFmpeg::FilterOpen(const std::string& filters, bool scale)
     return 0;
   }
 
-  if (!(m_pFilterGraph = avfilter_graph_alloc()))
-  {
-    CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterOpen - unable to alloc filter graph");
-    return -1;
-  }
-
-  AVFilter* srcFilter = avfilter_get_by_name("buffer");
-  AVFilter* outFilter = avfilter_get_by_name("buffersink"); // should be last filter in the graph for now
-
-  std::string args = StringUtils::Format("%d:%d:%d:%d:%d:%d:%d",
-                                        m_pCodecContext->width,
-                                        m_pCodecContext->height,
-                                        m_pCodecContext->pix_fmt,
-                                        m_pCodecContext->time_base.num ? m_pCodecContext->time_base.num : 1,
-                                        m_pCodecContext->time_base.num ? m_pCodecContext->time_base.den : 1,
-                                        m_pCodecContext->sample_aspect_ratio.num != 0 ? m_pCodecContext->sample_aspect_ratio.num : 1,
-                                        m_pCodecContext->sample_aspect_ratio.num != 0 ? m_pCodecContext->sample_aspect_ratio.den : 1);
-
-  if ((result = avfilter_graph_create_filter(&m_pFilterIn, srcFilter, "src", args.c_str(), NULL, m_pFilterGraph)) < 0)
-  {
-    CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterOpen - avfilter_graph_create_filter: src");
-    return result;
-  }
-
-  if ((result = avfilter_graph_create_filter(&m_pFilterOut, outFilter, "out", NULL, NULL, m_pFilterGraph)) < 0)
-  {
-    CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterOpen - avfilter_graph_create_filter: out");
-    return result;
-  }
-  if ((result = av_opt_set_int_list(m_pFilterOut, "pix_fmts", &m_formats[0],  AV_PIX_FMT_NONE, AV_OPT_SEARCH_CHILDREN)) < 0)
-  {
-    CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterOpen - failed settings pix formats");
-    return result;
-  }
-
-  if (!filters.empty())
-  {
-    AVFilterInOut* outputs = avfilter_inout_alloc();
-    AVFilterInOut* inputs  = avfilter_inout_alloc();
-
-    outputs->name    = av_strdup("in");
-    outputs->filter_ctx = m_pFilterIn;
-    outputs->pad_idx = 0;
-    outputs->next    = NULL;
-
-    inputs->name    = av_strdup("out");
-    inputs->filter_ctx = m_pFilterOut;
-    inputs->pad_idx = 0;
-    inputs->next    = NULL;
-
-    if ((result = avfilter_graph_parse_ptr(m_pFilterGraph, (const char*)m_filters.c_str(), &inputs, &outputs, NULL)) < 0)
-    {
-      CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterOpen - avfilter_graph_parse");
-      return result;
-    }
-
-    avfilter_inout_free(&outputs);
-    avfilter_inout_free(&inputs);
-  }
-  else
-  {
-    if ((result = avfilter_link(m_pFilterIn, 0, m_pFilterOut, 0)) < 0)
-    {
-      CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterOpen - avfilter_link");
-      return result;
-    }
-  }
-
-  if ((result = avfilter_graph_config(m_pFilterGraph, NULL)) < 0)
-  {
-    CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterOpen - avfilter_graph_config");
-    return result;
-  }
-
-  return result;
+  // share the cores with the decoder's own threads
+  int threads = std::max(g_cpuInfo.getCPUCount() - std::max(m_pCodecContext->thread_count, 1), 1);
+  return m_filterStage.Open(filters, m_pCodecContext, &m_formats[0], threads);
 }
 
 void CDVDVideoCodecFFmpeg::FilterClose()
 {
-  if (m_pFilterGraph)
-  {
-    avfilter_graph_free(&m_pFilterGraph);
-
-    // Disposed by above code
-    m_pFilterIn   = NULL;
-    m_pFilterOut  = NULL;
-  }
+  m_filterStage.Close();
 }
 
 int CDVDVideoCodecFFmpeg::FilterProcess(AVFrame* frame)
 {
-  int result;
-
   if (frame)
   {
-    result = av_buffersrc_add_frame(m_pFilterIn, frame);
-    if (result < 0)
+    // filters may hold pictures back, so the dts goes along with the picture
+    frame->pkt_dts = m_dts == DVD_NOPTS_VALUE ? AV_NOPTS_VALUE : (int64_t)(m_dts / DVD_TIME_BASE * AV_TIME_BASE);
+    if (!m_filterStage.AddFrame(frame))
     {
-      CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterProcess - av_buffersrc_add_frame");
+      CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterProcess - unable to queue picture for filtering");
       return VC_ERROR;
     }
   }
 
-  result = av_buffersink_get_frame(m_pFilterOut, m_pFilterFrame);
-
-  if(result  == AVERROR(EAGAIN) || result == AVERROR_EOF)
-    return VC_BUFFER;
-  else if(result < 0)
+  // a new picture is filtered while the next one is decoded, so only take what is ready.
+  // without a new picture we are asked to drain, so wait for those still being filtered.
+  int result = m_filterStage.GetFrame(m_pFrame, frame == NULL);
+  if (result < 0)
   {
-    CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterProcess - av_buffersink_get_frame");
+    CLog::Log(LOGERROR, "CDVDVideoCodecFFmpeg::FilterProcess - filtering failed");
     return VC_ERROR;
   }
+  else if (result == 0)
+    return VC_BUFFER;
 
-  av_frame_unref(m_pFrame);
-  av_frame_move_ref(m_pFrame, m_pFilterFrame);
+  m_dts = m_pFrame->pkt_dts == AV_NOPTS_VALUE ? DVD_NOPTS_VALUE : (double)m_pFrame->pkt_dts * DVD_TIME_BASE / AV_TIME_BASE;
+
+  // have the pictures that are ready taken first, so they don't pile up behind the decoder
+  if (m_filterStage.HasFrame())
+    return VC_PICTURE;
+  return VC_PICTURE | VC_BUFFER;
+}
 
-  return VC_PICTURE;
+void CDVDVideoCodecFFmpeg::GetFilterStats(unsigned int &pictures, int64_t &ticks, int64_t &maxTicks)
+{
+  m_filterStage.TakeStats(pictures, ticks, maxTicks);
 }
 
 unsigned CDVDVideoCodecFFmpeg::GetConvergeCount()
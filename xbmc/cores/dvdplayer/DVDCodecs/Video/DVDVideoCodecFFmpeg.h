@@ -22,6 +22,9 @@
 
 #include "DVDVideoCodec.h"
 #include "DVDResource.h"
+#include "DVDVideoBuffer.h"
+#include "DVDVideoFilterStage.h"
+#include "DVDVideoThreadingPolicy.h"
 #include <string>
 #include <vector>
 
@@ -63,6 +66,7 @@ public:
   virtual void Reset();
   bool GetPictureCommon(DVDVideoPicture* pDvdVideoPicture);
   virtual bool GetPicture(DVDVideoPicture* pDvdVideoPicture);
+  virtual bool ClearPicture(DVDVideoPicture* pDvdVideoPicture);
   virtual void SetDropState(bool bDrop);
   virtual unsigned int SetFilters(unsigned int filters);
   virtual const char* GetName() { return m_name.c_str(); }; // m_name is never changed after open
@@ -70,6 +74,7 @@ public:
   virtual unsigned GetAllowedReferences();
   virtual bool GetCodecStats(double &pts, int &droppedPics);
   virtual void SetCodecControl(int flags);
+  virtual void GetFilterStats(unsigned int &pictures, int64_t &ticks, int64_t &maxTicks);
 
   bool               IsHardwareAllowed()                     { return !m_bSoftware; }
   IHardwareDecoder * GetHardware()                           { return m_pHardware; };
@@ -77,6 +82,7 @@ public:
 
 protected:
   static enum PixelFormat GetFormat(struct AVCodecContext * avctx, const PixelFormat * fmt);
+  static int GetBuffer(struct AVCodecContext * avctx, AVFrame * frame, int flags);
 
   int  FilterOpen(const std::string& filters, bool scale);
   void FilterClose();
@@ -97,12 +103,13 @@ protected:
   AVFrame* m_pFrame;
   AVCodecContext* m_pCodecContext;
 
+  CDVDVideoBufferPool m_bufferPool;
+  CDVDVideoBuffer*    m_pVideoBuffer; // reference to m_pFrame handed out with the last picture
+  CDVDVideoThreadingPolicy m_threading;
+
   std::string       m_filters;
   std::string       m_filters_next;
-  AVFilterGraph*   m_pFilterGraph;
-  AVFilterContext* m_pFilterIn;
-  AVFilterContext* m_pFilterOut;
-  AVFrame*         m_pFilterFrame;
+  CDVDVideoFilterStage m_filterStage;
 
   int m_iPictureWidth;
   int m_iPictureHeight;
@@ -0,0 +1,379 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDVideoFilterStage.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+
+#include <algorithm>
+
+extern "C" {
+#include "libavutil/opt.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+}
+
+#define QUEUE_SIZE  2   // pictures queued for filtering
+
+CDVDVideoFilterStage::CDVDVideoFilterStage()
+  : CThread("VideoFilter")
+{
+  m_graph = NULL;
+  m_in = NULL;
+  m_out = NULL;
+  m_format = -1;
+  m_width = 0;
+  m_height = 0;
+  m_stopping = false;
+  m_filtering = false;
+  m_threads = 1;
+  m_error = 0;
+  m_frames = 0;
+  m_ticks = 0;
+  m_maxTicks = 0;
+  m_totalFrames = 0;
+  m_totalTicks = 0;
+}
+
+CDVDVideoFilterStage::~CDVDVideoFilterStage()
+{
+  Close();
+}
+
+int CDVDVideoFilterStage::Open(const std::string &filters, const AVCodecContext *avctx, const PixelFormat *formats, int threads)
+{
+  Close();
+
+  m_filters = filters;
+  m_args = StringUtils::Format("%d:%d:%d:%d:%d:%d:%d",
+                               avctx->width,
+                               avctx->height,
+                               avctx->pix_fmt,
+                               avctx->time_base.num ? avctx->time_base.num : 1,
+                               avctx->time_base.num ? avctx->time_base.den : 1,
+                               avctx->sample_aspect_ratio.num != 0 ? avctx->sample_aspect_ratio.num : 1,
+                               avctx->sample_aspect_ratio.num != 0 ? avctx->sample_aspect_ratio.den : 1);
+  m_formats.clear();
+  for (const PixelFormat *format = formats; *format != PIX_FMT_NONE; format++)
+    m_formats.push_back(*format);
+  m_formats.push_back(PIX_FMT_NONE);
+  m_threads = std::max(threads, 1);
+
+  int result = BuildGraph();
+  if (result < 0)
+  {
+    Close();
+    return result;
+  }
+
+  m_format = avctx->pix_fmt;
+  m_width = avctx->width;
+  m_height = avctx->height;
+  m_stopping = false;
+  m_filtering = false;
+  m_error = 0;
+  m_frames = 0;
+  m_ticks = 0;
+  m_maxTicks = 0;
+  m_totalFrames = 0;
+  m_totalTicks = 0;
+  Create();
+
+  CLog::Log(LOGDEBUG, "CDVDVideoFilterStage::Open - filtering \"%s\" on %d threads", filters.c_str(), m_threads);
+  return 0;
+}
+
+int CDVDVideoFilterStage::BuildGraph()
+{
+  int result;
+
+  if (!(m_graph = avfilter_graph_alloc()))
+  {
+    CLog::Log(LOGERROR, "CDVDVideoFilterStage::BuildGraph - unable to alloc filter graph");
+    return -1;
+  }
+
+  // has to be set before the filters are created
+  m_graph->thread_type = AVFILTER_THREAD_SLICE;
+  m_graph->nb_threads  = m_threads;
+
+  AVFilter* srcFilter = avfilter_get_by_name("buffer");
+  AVFilter* outFilter = avfilter_get_by_name("buffersink"); // should be last filter in the graph for now
+
+  if ((result = avfilter_graph_create_filter(&m_in, srcFilter, "src", m_args.c_str(), NULL, m_graph)) < 0)
+  {
+    CLog::Log(LOGERROR, "CDVDVideoFilterStage::BuildGraph - avfilter_graph_create_filter: src");
+    return result;
+  }
+
+  if ((result = avfilter_graph_create_filter(&m_out, outFilter, "out", NULL, NULL, m_graph)) < 0)
+  {
+    CLog::Log(LOGERROR, "CDVDVideoFilterStage::BuildGraph - avfilter_graph_create_filter: out");
+    return result;
+  }
+  if ((result = av_opt_set_int_list(m_out, "pix_fmts", &m_formats[0], AV_PIX_FMT_NONE, AV_OPT_SEARCH_CHILDREN)) < 0)
+  {
+    CLog::Log(LOGERROR, "CDVDVideoFilterStage::BuildGraph - failed settings pix formats");
+    return result;
+  }
+
+  if (!m_filters.empty())
+  {
+    AVFilterInOut* outputs = avfilter_inout_alloc();
+    AVFilterInOut* inputs  = avfilter_inout_alloc();
+
+    outputs->name    = av_strdup("in");
+    outputs->filter_ctx = m_in;
+    outputs->pad_idx = 0;
+    outputs->next    = NULL;
+
+    inputs->name    = av_strdup("out");
+    inputs->filter_ctx = m_out;
+    inputs->pad_idx = 0;
+    inputs->next    = NULL;
+
+    result = avfilter_graph_parse_ptr(m_graph, m_filters.c_str(), &inputs, &outputs, NULL);
+    avfilter_inout_free(&outputs);
+    avfilter_inout_free(&inputs);
+    if (result < 0)
+    {
+      CLog::Log(LOGERROR, "CDVDVideoFilterStage::BuildGraph - avfilter_graph_parse");
+      return result;
+    }
+  }
+  else
+  {
+    if ((result = avfilter_link(m_in, 0, m_out, 0)) < 0)
+    {
+      CLog::Log(LOGERROR, "CDVDVideoFilterStage::BuildGraph - avfilter_link");
+      return result;
+    }
+  }
+
+  if ((result = avfilter_graph_config(m_graph, NULL)) < 0)
+  {
+    CLog::Log(LOGERROR, "CDVDVideoFilterStage::BuildGraph - avfilter_graph_config");
+    return result;
+  }
+
+  return 0;
+}
+
+void CDVDVideoFilterStage::FreeGraph()
+{
+  if (m_graph)
+  {
+    avfilter_graph_free(&m_graph);
+
+    // Disposed by above code
+    m_in  = NULL;
+    m_out = NULL;
+  }
+}
+
+void CDVDVideoFilterStage::Close()
+{
+  {
+    CSingleLock lock(m_section);
+    m_stopping = true;
+    m_changed.notifyAll();
+  }
+  StopThread();
+
+  FreeQueues();
+  FreeGraph();
+
+  if (m_totalFrames)
+  {
+    CLog::Log(LOGDEBUG, "CDVDVideoFilterStage::Close - filtered %u pictures, %.2f ms per picture",
+              m_totalFrames, m_totalTicks * 1000.0 / CurrentHostFrequency() / m_totalFrames);
+    m_totalFrames = 0;
+    m_totalTicks = 0;
+  }
+}
+
+bool CDVDVideoFilterStage::Flush()
+{
+  if (!m_graph)
+    return false;
+
+  CSingleLock lock(m_section);
+  // the thread uses the graph without holding the lock while it filters a picture
+  while (m_filtering)
+    m_changed.wait(lock);
+  FreeQueues();
+  m_error = 0;
+
+  // filters such as yadif keep pictures of their own, a new graph drops them
+  FreeGraph();
+  int result = BuildGraph();
+  m_changed.notifyAll();
+  if (result < 0)
+  {
+    CLog::Log(LOGERROR, "CDVDVideoFilterStage::Flush - unable to rebuild the filter graph");
+    FreeGraph();
+    return false;
+  }
+  return true;
+}
+
+bool CDVDVideoFilterStage::Matches(int format, int width, int height) const
+{
+  return m_format == format && m_width == width && m_height == height;
+}
+
+bool CDVDVideoFilterStage::AddFrame(AVFrame *frame)
+{
+  CSingleLock lock(m_section);
+  while (!m_stopping && m_input.size() >= QUEUE_SIZE)
+    m_changed.wait(lock);
+  if (!m_graph || m_stopping)
+    return false;
+
+  AVFrame *queued = av_frame_alloc();
+  if (!queued)
+    return false;
+  av_frame_move_ref(queued, frame);
+  m_input.push_back(queued);
+  m_changed.notifyAll();
+  return true;
+}
+
+int CDVDVideoFilterStage::GetFrame(AVFrame *frame, bool wait)
+{
+  AVFrame *filtered;
+  {
+    CSingleLock lock(m_section);
+    while (wait && !m_stopping && m_output.empty() && !m_input.empty() && !m_error)
+      m_changed.wait(lock);
+    if (m_error)
+    {
+      int error = m_error;
+      m_error = 0;
+      return error;
+    }
+    if (m_output.empty())
+      return 0;
+    filtered = m_output.front();
+    m_output.pop_front();
+  }
+
+  av_frame_unref(frame);
+  av_frame_move_ref(frame, filtered);
+  av_frame_free(&filtered);
+  return 1;
+}
+
+bool CDVDVideoFilterStage::HasFrame() const
+{
+  CSingleLock lock(m_section);
+  return !m_output.empty();
+}
+
+void CDVDVideoFilterStage::TakeStats(unsigned int &frames, int64_t &ticks, int64_t &maxTicks)
+{
+  CSingleLock lock(m_section);
+  frames = m_frames;
+  ticks = m_ticks;
+  maxTicks = m_maxTicks;
+  m_frames = 0;
+  m_ticks = 0;
+  m_maxTicks = 0;
+}
+
+void CDVDVideoFilterStage::Process()
+{
+  std::deque<AVFrame *> filtered;
+  while (true)
+  {
+    AVFrame *frame;
+    {
+      CSingleLock lock(m_section);
+      while (!m_stopping && m_input.empty())
+        m_changed.wait(lock);
+      if (m_stopping)
+        break;
+      frame = m_input.front();
+      m_filtering = true;
+    }
+
+    // the graph is only used from this thread once it is open
+    int64_t start = CurrentHostCounter();
+    int result = av_buffersrc_add_frame(m_in, frame);
+    if (result < 0)
+      CLog::Log(LOGERROR, "CDVDVideoFilterStage::Process - av_buffersrc_add_frame");
+    while (result >= 0)
+    {
+      AVFrame *out = av_frame_alloc();
+      if (!out)
+      {
+        result = AVERROR(ENOMEM);
+        break;
+      }
+      result = av_buffersink_get_frame(m_out, out);
+      if (result < 0)
+      {
+        av_frame_free(&out);
+        if (result == AVERROR(EAGAIN) || result == AVERROR_EOF)
+          result = 0;
+        else
+          CLog::Log(LOGERROR, "CDVDVideoFilterStage::Process - av_buffersink_get_frame");
+        break;
+      }
+      filtered.push_back(out);
+    }
+    int64_t ticks = CurrentHostCounter() - start;
+
+    CSingleLock lock(m_section);
+    // the picture stays queued while it is filtered so that AddFrame() keeps blocking on it
+    m_input.pop_front();
+    av_frame_free(&frame);
+    m_filtering = false;
+    m_output.insert(m_output.end(), filtered.begin(), filtered.end());
+    filtered.clear();
+    // only this picture is lost, the graph takes the next one as usual
+    if (result < 0)
+      m_error = result;
+    m_frames++;
+    m_ticks += ticks;
+    if (ticks > m_maxTicks)
+      m_maxTicks = ticks;
+    m_totalFrames++;
+    m_totalTicks += ticks;
+    m_changed.notifyAll();
+  }
+}
+
+void CDVDVideoFilterStage::FreeQueues()
+{
+  CSingleLock lock(m_section);
+  while (!m_input.empty())
+  {
+    av_frame_free(&m_input.front());
+    m_input.pop_front();
+  }
+  while (!m_output.empty())
+  {
+    av_frame_free(&m_output.front());
+    m_output.pop_front();
+  }
+}
@@ -0,0 +1,147 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+extern "C" {
+#include "libavfilter/avfilter.h"
+#include "libavcodec/avcodec.h"
+}
+
+/*!
+ \brief Runs the software video filters (deinterlacing, rotation, pixel format conversion)
+ of CDVDVideoCodecFFmpeg on a thread of its own.
+
+ The filters run slice parallel on libavfilter's thread pool where they support it, as yadif
+ does, so that a 1080i picture is deinterlaced by several cores rather than one. Pictures are
+ passed to the filter thread through a bounded queue; AddFrame() blocks while it is full, which
+ limits the pictures held up in the stage and the memory they take. The decoder keeps decoding
+ the next picture while the previous ones are filtered and takes them with GetFrame() once ready.
+
+ The time spent filtering each picture is measured, see TakeStats().
+ */
+class CDVDVideoFilterStage : private CThread
+{
+public:
+  CDVDVideoFilterStage();
+  virtual ~CDVDVideoFilterStage();
+
+  /*!
+   \brief Build the filter graph and start the filter thread.
+   \param filters the libavfilter graph description, empty to only convert the pixel format.
+   \param avctx the decoder, for the size, format, time base and aspect of its pictures.
+   \param formats the pixel formats the output may have, terminated by PIX_FMT_NONE.
+   \param threads the number of slice threads the filters may use.
+   \return 0 on success, a negative AVERROR otherwise in which case the stage is closed.
+   */
+  int Open(const std::string &filters, const AVCodecContext *avctx, const PixelFormat *formats, int threads);
+
+  /*!
+   \brief Stop the filter thread and free the graph, dropping any queued pictures.
+   */
+  void Close();
+
+  /*!
+   \brief Drop the queued and filtered pictures and the ones the filters hold, e.g. on a seek.
+   The filter thread keeps running and the stage takes new pictures right away.
+   \return false if the graph could not be rebuilt, in which case the stage has to be closed.
+   */
+  bool Flush();
+
+  bool IsOpen() const { return m_graph != NULL; }
+
+  /*!
+   \brief Whether the graph was built for pictures of the given size and format.
+   */
+  bool Matches(int format, int width, int height) const;
+
+  /*!
+   \brief Queue a picture for filtering, blocking while the queue is full.
+   \param frame the picture, its reference is taken over by the stage.
+   \return true if the picture was queued, false if the stage is closed.
+   */
+  bool AddFrame(AVFrame *frame);
+
+  /*!
+   \brief Take the next filtered picture.
+   \param frame the frame to move the picture to.
+   \param wait whether to wait for the queued pictures to be filtered if none is ready.
+   \return 1 if a picture was moved to frame, 0 if none is ready (filters such as yadif hold
+   pictures back until they get the next one), a negative AVERROR if filtering a picture failed
+   since the last call.
+   */
+  int GetFrame(AVFrame *frame, bool wait);
+
+  /*!
+   \brief Whether filtered pictures are ready to be taken.
+   */
+  bool HasFrame() const;
+
+  /*!
+   \brief Get the filtering time since the last call.
+   \param frames [out] number of pictures filtered.
+   \param ticks [out] time spent filtering them in CurrentHostFrequency() units.
+   \param maxTicks [out] longest time spent filtering one of them.
+   */
+  void TakeStats(unsigned int &frames, int64_t &ticks, int64_t &maxTicks);
+
+protected:
+  virtual void Process();
+
+private:
+  int  BuildGraph();
+  void FreeGraph();
+  void FreeQueues();
+
+  std::string      m_filters; ///< graph description, kept to rebuild the graph on Flush()
+  std::string      m_args;    ///< arguments of the buffer source
+  std::vector<PixelFormat> m_formats; ///< output formats, terminated by PIX_FMT_NONE
+  int              m_threads;
+
+  AVFilterGraph   *m_graph;
+  AVFilterContext *m_in;
+  AVFilterContext *m_out;
+  int              m_format;  ///< input format the graph was built for
+  int              m_width;   ///< input width the graph was built for
+  int              m_height;  ///< input height the graph was built for
+
+  std::deque<AVFrame *> m_input;  ///< pictures waiting to be filtered, the front one stays while it is filtered
+  std::deque<AVFrame *> m_output; ///< filtered pictures waiting to be taken
+  bool m_stopping;
+  bool m_filtering;               ///< the front input picture is being filtered, the graph is in use
+  int  m_error;                   ///< error filtering a picture not yet returned by GetFrame(), 0 if none
+
+  unsigned int m_frames;          ///< pictures filtered since TakeStats()
+  int64_t      m_ticks;           ///< time spent filtering since TakeStats()
+  int64_t      m_maxTicks;        ///< longest time spent filtering a picture since TakeStats()
+  unsigned int m_totalFrames;     ///< pictures filtered since Open()
+  int64_t      m_totalTicks;      ///< time spent filtering since Open()
+
+  mutable CCriticalSection m_section;
+  XbmcThreads::ConditionVariable m_changed; ///< signalled whenever a queue changes
+};
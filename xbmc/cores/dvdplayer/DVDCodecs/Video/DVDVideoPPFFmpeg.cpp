@@ -152,6 +152,7 @@ bool CDVDVideoPPFFmpeg::Process(DVDVideoPicture* pPicture)
   m_pTarget->iDisplayWidth = m_pSource->iDisplayWidth;
   m_pTarget->pts = m_pSource->pts;
   m_pTarget->format = RENDER_FMT_YUV420P;
+  m_pTarget->videoBuffer = NULL;
   return true;
 }
 
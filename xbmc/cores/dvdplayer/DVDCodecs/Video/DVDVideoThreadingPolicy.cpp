@@ -0,0 +1,210 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDVideoThreadingPolicy.h"
+#include "DVDStreamInfo.h"
+#include "threads/SingleLock.h"
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+#include "utils/TimeUtils.h"
+
+#include <algorithm>
+#include <math.h>
+
+#define MAX_THREADS        16     // libavcodec doesn't gain from more
+#define PIXELS_PER_THREAD  40e6   // weighted pixels per second a thread is expected to decode
+#define DEFAULT_FPS        25.0   // assumed when the stream doesn't tell
+#define DEFAULT_WIDTH      1920   // assumed when the stream doesn't tell
+#define DEFAULT_HEIGHT     1080
+#define MIN_PICTURES       100    // decoders that decoded fewer pictures don't tell us much
+#define LOAD_HIGH          0.8    // share of the time between pictures above which a decoder falls behind
+#define LOAD_LOW           0.25   // share of the time between pictures below which a live decoder has time to spare
+
+CCriticalSection CDVDVideoThreadingPolicy::m_historySection;
+std::map<CDVDVideoThreadingPolicy::SKey, CDVDVideoThreadingPolicy::SHistory> CDVDVideoThreadingPolicy::m_history;
+
+// cost of decoding a pixel relative to H.264
+static double CodecWeight(AVCodecID codec)
+{
+  switch (codec)
+  {
+  case AV_CODEC_ID_HEVC:
+  case AV_CODEC_ID_VP9:
+    return 2.0;
+  case AV_CODEC_ID_H264:
+    return 1.0;
+  default:
+    return 0.5;
+  }
+}
+
+// codecs whose pictures are sliced row by row, so slice threading scales as well as frame threading
+static bool SlicedByRow(AVCodecID codec)
+{
+  return codec == AV_CODEC_ID_MPEG1VIDEO || codec == AV_CODEC_ID_MPEG2VIDEO;
+}
+
+bool CDVDVideoThreadingPolicy::SKey::operator<(const SKey &right) const
+{
+  if (codec != right.codec)
+    return codec < right.codec;
+  if (width != right.width)
+    return width < right.width;
+  if (height != right.height)
+    return height < right.height;
+  return realtime < right.realtime;
+}
+
+CDVDVideoThreadingPolicy::CDVDVideoThreadingPolicy()
+{
+  m_key.codec = AV_CODEC_ID_NONE;
+  m_key.width = 0;
+  m_key.height = 0;
+  m_key.realtime = false;
+  m_applied = false;
+  m_type = 0;
+  m_count = 1;
+  m_budget = 1.0 / DEFAULT_FPS;
+  m_calls = 0;
+  m_pictures = 0;
+  m_ticks = 0;
+  m_maxTicks = 0;
+}
+
+void CDVDVideoThreadingPolicy::Apply(const CDVDStreamInfo &hints, const AVCodec *codec, bool allowFrameThreads, AVCodecContext *avctx)
+{
+  m_key.codec = hints.codec;
+  m_key.width = hints.width;
+  m_key.height = hints.height;
+  m_key.realtime = hints.realtime;
+  m_applied = true;
+  m_calls = 0;
+  m_pictures = 0;
+  m_ticks = 0;
+  m_maxTicks = 0;
+
+  double fps = DEFAULT_FPS;
+  if (hints.fpsrate > 0 && hints.fpsscale > 0)
+    fps = (double)hints.fpsrate / hints.fpsscale;
+  m_budget = 1.0 / fps;
+
+  int width = hints.width > 0 ? hints.width : DEFAULT_WIDTH;
+  int height = hints.height > 0 ? hints.height : DEFAULT_HEIGHT;
+  int cpus = std::min(std::max(g_cpuInfo.getCPUCount(), 1), MAX_THREADS);
+  bool canFrame = allowFrameThreads && (codec->capabilities & CODEC_CAP_FRAME_THREADS);
+  bool canSlice = (codec->capabilities & CODEC_CAP_SLICE_THREADS) != 0;
+  const char *reason;
+
+  m_type = 0;
+  m_count = 1;
+  if (hints.software)
+    reason = "single threaded decoding requested"; // thumbnail extraction fails when run threaded
+  else if (!canFrame && !canSlice)
+    reason = "no threading support";
+  else
+  {
+    // frame threading delays every picture by a picture per thread, which only matters when
+    // the stream is live. Slice threading adds no delay but scales with the number of slices.
+    if (canFrame && !(hints.realtime && canSlice && SlicedByRow(hints.codec)))
+      m_type = FF_THREAD_FRAME;
+    else
+      m_type = FF_THREAD_SLICE;
+
+    m_count = (int)ceil(width * height * fps * CodecWeight(hints.codec) / PIXELS_PER_THREAD);
+    if (!hints.realtime || m_type == FF_THREAD_SLICE)
+      m_count *= 2; // headroom for pictures that take longer than the average
+    reason = "pixel rate";
+
+    CSingleLock lock(m_historySection);
+    std::map<SKey, SHistory>::const_iterator it = m_history.find(m_key);
+    if (it != m_history.end() && it->second.pictures >= MIN_PICTURES)
+    {
+      const SHistory &last = it->second;
+      double load = last.pictureTime / m_budget;
+      if (load > LOAD_HIGH)
+      {
+        if (last.type == FF_THREAD_SLICE && canFrame)
+          m_type = FF_THREAD_FRAME;
+        m_count = std::max(m_count, last.count * 2);
+        reason = "last decoder fell behind";
+      }
+      else if (load < LOAD_LOW && hints.realtime && m_type == FF_THREAD_FRAME && last.count > 1)
+      {
+        m_count = std::min(m_count, std::max(last.count / 2, 1));
+        reason = "last decoder had time to spare";
+      }
+      else if (last.type == m_type)
+      {
+        m_count = last.count;
+        reason = "last decoder kept up";
+      }
+    }
+    m_count = std::max(std::min(m_count, cpus), 1);
+  }
+
+  if (m_count > 1)
+  {
+    avctx->thread_type = m_type;
+    avctx->thread_count = m_count;
+  }
+  else
+  {
+    m_type = 0;
+    avctx->thread_count = 1;
+  }
+
+  CLog::Log(LOGNOTICE, "CDVDVideoThreadingPolicy::Apply - %s threading with %d threads for %dx%d at %.3f fps%s (%s)",
+            m_type == FF_THREAD_FRAME ? "frame" : m_type == FF_THREAD_SLICE ? "slice" : "no", m_count,
+            hints.width, hints.height, fps, hints.realtime ? ", live" : "", reason);
+}
+
+void CDVDVideoThreadingPolicy::AddDecodeTime(int64_t ticks, bool picture)
+{
+  m_calls++;
+  if (picture)
+    m_pictures++;
+  m_ticks += ticks;
+  if (ticks > m_maxTicks)
+    m_maxTicks = ticks;
+}
+
+void CDVDVideoThreadingPolicy::Close()
+{
+  if (!m_applied)
+    return;
+  m_applied = false;
+  if (!m_pictures)
+    return;
+
+  double frequency = (double)CurrentHostFrequency();
+  double pictureTime = m_ticks / frequency / m_pictures;
+  CLog::Log(LOGNOTICE, "CDVDVideoThreadingPolicy::Close - decoded %u pictures in %u calls with %d threads, %.2f ms per picture, longest call %.2f ms, %.2f ms between pictures",
+            m_pictures, m_calls, m_count, pictureTime * 1000.0, m_maxTicks * 1000.0 / frequency, m_budget * 1000.0);
+
+  if (m_pictures < MIN_PICTURES)
+    return;
+
+  CSingleLock lock(m_historySection);
+  SHistory &history = m_history[m_key];
+  history.type = m_type;
+  history.count = m_count;
+  history.pictures = m_pictures;
+  history.pictureTime = pictureTime;
+}
@@ -0,0 +1,104 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <stdint.h>
+#include "threads/CriticalSection.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+class CDVDStreamInfo;
+
+/*!
+ \brief Chooses how libavcodec threads the decoding of a video stream.
+
+ The thread count follows from the pixel rate of the stream, weighted by how costly its codec
+ is to decode, and is limited by the number of CPUs. Frame threading decodes fastest but holds
+ back a picture per thread, so streams played live get no more threads than they need, and
+ slice threading where the codec slices every row of a picture.
+
+ The time spent in the decoder is measured while it is open and kept per codec and resolution,
+ so that the next decoder opened for the same kind of stream (after a stream change, on the next
+ channel or file) gets more threads if the last one fell behind, and a live stream gets fewer
+ if the last one had time to spare.
+ */
+class CDVDVideoThreadingPolicy
+{
+public:
+  CDVDVideoThreadingPolicy();
+
+  /*!
+   \brief Choose the threading for a decoder and set it on the codec context, before it is opened.
+   \param hints the stream to decode.
+   \param codec the decoder, for the kinds of threading it supports.
+   \param allowFrameThreads whether frame threading may be used, it is not safe with hardware decoding.
+   \param avctx the codec context to set thread_type and thread_count on.
+   */
+  void Apply(const CDVDStreamInfo &hints, const AVCodec *codec, bool allowFrameThreads, AVCodecContext *avctx);
+
+  /*!
+   \brief Add the time a call to the decoder took.
+   \param ticks duration of the call in CurrentHostFrequency() units.
+   \param picture whether the call returned a picture.
+   */
+  void AddDecodeTime(int64_t ticks, bool picture);
+
+  /*!
+   \brief Log the measured decode times and keep them for the next decoder of the same kind of stream.
+   Called as the decoder is closed, does nothing if Apply() wasn't.
+   */
+  void Close();
+
+private:
+  struct SKey
+  {
+    AVCodecID codec;
+    int width;
+    int height;
+    bool realtime;
+    bool operator<(const SKey &right) const;
+  };
+
+  struct SHistory
+  {
+    int type;                ///< the FF_THREAD_* type that was used
+    int count;               ///< the number of threads that were used
+    unsigned int pictures;   ///< the number of pictures decoded
+    double pictureTime;      ///< average decode time per picture in seconds
+  };
+
+  SKey   m_key;
+  bool   m_applied;
+  int    m_type;
+  int    m_count;
+  double m_budget;           ///< time between two pictures of the stream in seconds
+
+  unsigned int m_calls;
+  unsigned int m_pictures;
+  int64_t      m_ticks;      ///< total time spent in the decoder
+  int64_t      m_maxTicks;   ///< longest call to the decoder
+
+  static CCriticalSection m_historySection;
+  static std::map<SKey, SHistory> m_history;
+};
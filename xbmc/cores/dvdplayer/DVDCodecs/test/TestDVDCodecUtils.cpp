@@ -0,0 +1,250 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDCodecs/DVDCodecUtils.h"
+#include "cores/dvdplayer/DVDCodecs/DVDPictureKernels.h"
+#include "cores/VideoRenderers/BaseRenderer.h"
+#include "cores/FFmpeg.h"
+#include "utils/CPUInfo.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define LARGE_WIDTH  3840 // done in bands when there is more than one CPU
+#define LARGE_HEIGHT 2160
+
+static void FillRandom(std::vector<uint8_t> &data)
+{
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = (uint8_t)rand();
+}
+
+// a YUV420P picture whose rows are padded, as decoders give them
+static DVDVideoPicture *AllocatePaddedPicture(int width, int height, std::vector<uint8_t> &buffer)
+{
+  int stride = (width + 63) & ~63;
+  buffer.resize(stride * height * 2);
+  FillRandom(buffer);
+
+  DVDVideoPicture *picture = new DVDVideoPicture;
+  memset(picture, 0, sizeof(DVDVideoPicture));
+  picture->iWidth = width;
+  picture->iHeight = height;
+  picture->format = RENDER_FMT_YUV420P;
+  picture->data[0] = &buffer[0];
+  picture->data[1] = picture->data[0] + stride * height;
+  picture->data[2] = picture->data[1] + stride / 2 * height / 2 + 32;
+  picture->iLineSize[0] = stride;
+  picture->iLineSize[1] = stride / 2;
+  picture->iLineSize[2] = stride / 2;
+  return picture;
+}
+
+struct BandCopy
+{
+  std::vector<uint8_t> *dst;
+  std::vector<uint8_t> *src;
+};
+
+static void CopyBand(void *arg, int band, int bands)
+{
+  BandCopy *copy = (BandCopy *)arg;
+  int first, count;
+  CDVDPictureKernels::GetBandRows(band, bands, (int)copy->src->size(), 1, first, count);
+  if (count)
+    memcpy(&(*copy->dst)[first], &(*copy->src)[first], count);
+}
+
+TEST(TestDVDCodecUtils, KernelsMatchC)
+{
+  std::vector<const CDVDPictureKernels *> kernels = CDVDPictureKernels::GetSupported(g_cpuInfo.GetCPUFeatures());
+  ASSERT_FALSE(kernels.empty());
+  const CDVDPictureKernels *c = kernels[0];
+  EXPECT_STREQ("C", c->name);
+
+  std::vector<uint8_t> y(4000), u(2000), v(2000);
+  FillRandom(y);
+  FillRandom(u);
+  FillRandom(v);
+
+  // every width up to a few vector lengths, and sources that aren't aligned
+  for (std::vector<const CDVDPictureKernels *>::const_iterator k = kernels.begin(); k != kernels.end(); ++k)
+  {
+    for (int width = 0; width < 300; width += 2)
+    {
+      int offset = width % 7;
+      std::vector<uint8_t> expected(2 * width + 4, 0xcd), actual(2 * width + 4, 0xcd);
+
+      c->InterleaveUV(&expected[0], &u[offset], &v[offset], width / 2);
+      (*k)->InterleaveUV(&actual[0], &u[offset], &v[offset], width / 2);
+      ASSERT_TRUE(expected == actual) << (*k)->name << " InterleaveUV, width " << width;
+
+      c->PackYUYV(&expected[0], &y[offset], &u[offset], &v[offset], width);
+      (*k)->PackYUYV(&actual[0], &y[offset], &u[offset], &v[offset], width);
+      ASSERT_TRUE(expected == actual) << (*k)->name << " PackYUYV, width " << width;
+
+      c->PackUYVY(&expected[0], &y[offset], &u[offset], &v[offset], width);
+      (*k)->PackUYVY(&actual[0], &y[offset], &u[offset], &v[offset], width);
+      ASSERT_TRUE(expected == actual) << (*k)->name << " PackUYVY, width " << width;
+    }
+  }
+}
+
+TEST(TestDVDCodecUtils, BandsCoverAllRows)
+{
+  for (int bands = 1; bands <= 4; bands++)
+  {
+    for (int rows = 0; rows < 20; rows++)
+    {
+      int next = 0;
+      for (int band = 0; band < bands; band++)
+      {
+        int first, count;
+        CDVDPictureKernels::GetBandRows(band, bands, rows, 2, first, count);
+        EXPECT_EQ(next, first);
+        EXPECT_LE(0, count);
+        if (band < bands - 1)
+          EXPECT_EQ(0, count % 2);
+        next = first + count;
+      }
+      EXPECT_EQ(rows, next);
+    }
+  }
+
+  std::vector<uint8_t> src(1000003), dst(src.size());
+  FillRandom(src);
+  BandCopy copy = { &dst, &src };
+  CDVDPictureKernels::ForEachBand(CopyBand, &copy, 4);
+  EXPECT_TRUE(src == dst);
+}
+
+TEST(TestDVDCodecUtils, ConvertToNV12Picture)
+{
+  // 4K is done in bands when there is more than one CPU
+  std::vector<uint8_t> buffer;
+  DVDVideoPicture *src = AllocatePaddedPicture(LARGE_WIDTH, LARGE_HEIGHT, buffer);
+  DVDVideoPicture *nv12 = CDVDCodecUtils::ConvertToNV12Picture(src);
+  ASSERT_TRUE(nv12 != NULL);
+  EXPECT_EQ(RENDER_FMT_NV12, nv12->format);
+
+  for (unsigned int y = 0; y < src->iHeight; y++)
+    ASSERT_EQ(0, memcmp(nv12->data[0] + y * nv12->iLineSize[0], src->data[0] + y * src->iLineSize[0], src->iWidth)) << "row " << y;
+  for (unsigned int y = 0; y < src->iHeight / 2; y++)
+  {
+    const uint8_t *uv = nv12->data[1] + y * nv12->iLineSize[1];
+    for (unsigned int x = 0; x < src->iWidth / 2; x++)
+    {
+      ASSERT_EQ(src->data[1][y * src->iLineSize[1] + x], uv[2 * x]);
+      ASSERT_EQ(src->data[2][y * src->iLineSize[2] + x], uv[2 * x + 1]);
+    }
+  }
+
+  DVDVideoPicture *uyvy = CDVDCodecUtils::ConvertToYUV422PackedPicture(src, RENDER_FMT_UYVY422);
+  ASSERT_TRUE(uyvy != NULL);
+  for (unsigned int y = 0; y < src->iHeight; y += 7)
+  {
+    const uint8_t *p = uyvy->data[0] + y * uyvy->iLineSize[0];
+    for (unsigned int x = 0; x < src->iWidth; x += 2, p += 4)
+    {
+      ASSERT_EQ(src->data[1][y / 2 * src->iLineSize[1] + x / 2], p[0]);
+      ASSERT_EQ(src->data[0][y * src->iLineSize[0] + x], p[1]);
+      ASSERT_EQ(src->data[2][y / 2 * src->iLineSize[2] + x / 2], p[2]);
+      ASSERT_EQ(src->data[0][y * src->iLineSize[0] + x + 1], p[3]);
+    }
+  }
+
+  CDVDCodecUtils::FreePicture(uyvy);
+  CDVDCodecUtils::FreePicture(nv12);
+  delete src;
+}
+
+// what ConvertToYUV422PackedPicture gave when it went through swscale
+static void ConvertWithSwscale(const DVDVideoPicture *src, AVPixelFormat format, std::vector<uint8_t> &dst)
+{
+  dst.resize(src->iWidth * src->iHeight * 2);
+  const uint8_t *srcData[] = { src->data[0], src->data[1], src->data[2], NULL };
+  int srcStride[] = { src->iLineSize[0], src->iLineSize[1], src->iLineSize[2], 0 };
+  uint8_t *dstData[] = { &dst[0], NULL, NULL, NULL };
+  int dstStride[] = { src->iWidth * 2, 0, 0, 0 };
+
+  struct SwsContext *ctx = sws_getContext(src->iWidth, src->iHeight, PIX_FMT_YUV420P,
+                                          src->iWidth, src->iHeight, format,
+                                          SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+  ASSERT_TRUE(ctx != NULL);
+  sws_scale(ctx, srcData, srcStride, 0, src->iHeight, dstData, dstStride);
+  sws_freeContext(ctx);
+}
+
+TEST(TestDVDCodecUtils, YUV422PackedMatchesSwscale)
+{
+  // a width that leaves a tail for every kernel
+  std::vector<uint8_t> buffer;
+  DVDVideoPicture *src = AllocatePaddedPicture(1366, 768, buffer);
+
+  const ERenderFormat formats[] = { RENDER_FMT_YUYV422, RENDER_FMT_UYVY422 };
+  const AVPixelFormat swsFormats[] = { PIX_FMT_YUYV422, PIX_FMT_UYVY422 };
+  for (unsigned int i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+  {
+    std::vector<uint8_t> expected;
+    ConvertWithSwscale(src, swsFormats[i], expected);
+
+    DVDVideoPicture *packed = CDVDCodecUtils::ConvertToYUV422PackedPicture(src, formats[i]);
+    ASSERT_TRUE(packed != NULL);
+    for (int y = 0; y < src->iHeight; y++)
+      ASSERT_EQ(0, memcmp(packed->data[0] + y * packed->iLineSize[0], &expected[y * src->iWidth * 2], src->iWidth * 2)) << "format " << i << ", row " << y;
+    CDVDCodecUtils::FreePicture(packed);
+  }
+  delete src;
+}
+
+TEST(TestDVDCodecUtils, CopyPicture)
+{
+  std::vector<uint8_t> buffer;
+  DVDVideoPicture *src = AllocatePaddedPicture(LARGE_WIDTH, LARGE_HEIGHT, buffer);
+
+  YV12Image image;
+  memset(&image, 0, sizeof(image));
+  image.width = LARGE_WIDTH;
+  image.height = LARGE_HEIGHT;
+  image.cshift_x = 1;
+  image.cshift_y = 1;
+  image.bpp = 1;
+  image.stride[0] = LARGE_WIDTH + 32;
+  image.stride[1] = image.stride[2] = LARGE_WIDTH / 2;
+  std::vector<uint8_t> planes(image.stride[0] * LARGE_HEIGHT + LARGE_WIDTH * LARGE_HEIGHT / 2);
+  image.plane[0] = &planes[0];
+  image.plane[1] = image.plane[0] + image.stride[0] * LARGE_HEIGHT;
+  image.plane[2] = image.plane[1] + image.stride[1] * LARGE_HEIGHT / 2;
+
+  long copies = CDVDCodecUtils::GetFrameCopyCount();
+  EXPECT_TRUE(CDVDCodecUtils::CopyPicture(&image, src));
+  EXPECT_EQ(copies + 1, CDVDCodecUtils::GetFrameCopyCount());
+  for (int p = 0; p < 3; p++)
+  {
+    int width = p ? LARGE_WIDTH / 2 : LARGE_WIDTH;
+    int height = p ? LARGE_HEIGHT / 2 : LARGE_HEIGHT;
+    for (int y = 0; y < height; y++)
+      ASSERT_EQ(0, memcmp(image.plane[p] + y * image.stride[p], src->data[p] + y * src->iLineSize[p], width)) << "plane " << p << " row " << y;
+  }
+  delete src;
+}
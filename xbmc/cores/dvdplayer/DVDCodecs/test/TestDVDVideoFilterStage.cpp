@@ -0,0 +1,163 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoFilterStage.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+#define TEST_WIDTH  320
+#define TEST_HEIGHT 240
+#define TEST_FRAMES 24
+
+class TestDVDVideoFilterStage : public testing::TestWithParam<const char*>
+{
+protected:
+  TestDVDVideoFilterStage()
+  {
+    avfilter_register_all();
+    m_context = avcodec_alloc_context3(NULL);
+    m_context->width = TEST_WIDTH;
+    m_context->height = TEST_HEIGHT;
+    m_context->pix_fmt = PIX_FMT_YUV420P;
+    m_context->time_base.num = 1;
+    m_context->time_base.den = 25;
+    m_context->sample_aspect_ratio.num = 1;
+    m_context->sample_aspect_ratio.den = 1;
+  }
+
+  ~TestDVDVideoFilterStage()
+  {
+    m_stage.Close();
+    avcodec_free_context(&m_context);
+  }
+
+  // a grey picture with the given timestamps
+  static AVFrame *AllocateFrame(int64_t pts, int64_t dts)
+  {
+    AVFrame *frame = av_frame_alloc();
+    frame->width = TEST_WIDTH;
+    frame->height = TEST_HEIGHT;
+    frame->format = PIX_FMT_YUV420P;
+    if (av_frame_get_buffer(frame, 32) < 0)
+    {
+      av_frame_free(&frame);
+      return NULL;
+    }
+    memset(frame->data[0], 0x80, frame->linesize[0] * TEST_HEIGHT);
+    memset(frame->data[1], 0x80, frame->linesize[1] * TEST_HEIGHT / 2);
+    memset(frame->data[2], 0x80, frame->linesize[2] * TEST_HEIGHT / 2);
+    frame->pkt_pts = pts;
+    frame->pkt_dts = dts;
+    return frame;
+  }
+
+  AVCodecContext *m_context;
+  CDVDVideoFilterStage m_stage;
+};
+
+TEST_P(TestDVDVideoFilterStage, AllFramesOut)
+{
+  const PixelFormat formats[] = { PIX_FMT_YUV420P, PIX_FMT_NONE };
+  ASSERT_EQ(0, m_stage.Open(GetParam(), m_context, formats, 2));
+  EXPECT_TRUE(m_stage.Matches(PIX_FMT_YUV420P, TEST_WIDTH, TEST_HEIGHT));
+
+  AVFrame *out = av_frame_alloc();
+  int received = 0;
+  for (int i = 0; i < TEST_FRAMES; i++)
+  {
+    AVFrame *frame = AllocateFrame(i * 40000, i * 40000 - 80000);
+    ASSERT_TRUE(frame != NULL);
+    EXPECT_TRUE(m_stage.AddFrame(frame));
+    av_frame_free(&frame);
+
+    // the stage must not hold pictures back once they are filtered
+    int result = m_stage.GetFrame(out, true);
+    ASSERT_GE(result, 0);
+    if (result > 0)
+    {
+      EXPECT_EQ(TEST_WIDTH, out->width);
+      EXPECT_EQ(TEST_HEIGHT, out->height);
+      EXPECT_EQ(PIX_FMT_YUV420P, out->format);
+      // dts travels with its picture
+      EXPECT_EQ(received * 40000 - 80000, out->pkt_dts);
+      received++;
+      av_frame_unref(out);
+    }
+  }
+  // drain whatever is left
+  while (m_stage.GetFrame(out, true) > 0)
+  {
+    received++;
+    av_frame_unref(out);
+  }
+  av_frame_free(&out);
+
+  EXPECT_EQ(TEST_FRAMES, received);
+  EXPECT_FALSE(m_stage.HasFrame());
+
+  unsigned int frames;
+  int64_t ticks, maxTicks;
+  m_stage.TakeStats(frames, ticks, maxTicks);
+  EXPECT_EQ((unsigned int)TEST_FRAMES, frames);
+  EXPECT_LE(maxTicks, ticks);
+  m_stage.TakeStats(frames, ticks, maxTicks);
+  EXPECT_EQ(0u, frames);
+}
+
+TEST_P(TestDVDVideoFilterStage, FlushDropsPictures)
+{
+  const PixelFormat formats[] = { PIX_FMT_YUV420P, PIX_FMT_NONE };
+  ASSERT_EQ(0, m_stage.Open(GetParam(), m_context, formats, 2));
+
+  for (int i = 0; i < 2; i++)
+  {
+    AVFrame *frame = AllocateFrame(i * 40000, i * 40000);
+    ASSERT_TRUE(frame != NULL);
+    EXPECT_TRUE(m_stage.AddFrame(frame));
+    av_frame_free(&frame);
+  }
+  EXPECT_TRUE(m_stage.Flush());
+  EXPECT_TRUE(m_stage.IsOpen());
+
+  AVFrame *out = av_frame_alloc();
+  EXPECT_EQ(0, m_stage.GetFrame(out, true));
+
+  // the stage keeps working after a flush
+  AVFrame *frame = AllocateFrame(1000000, 960000);
+  ASSERT_TRUE(frame != NULL);
+  EXPECT_TRUE(m_stage.AddFrame(frame));
+  av_frame_free(&frame);
+  ASSERT_EQ(1, m_stage.GetFrame(out, true));
+  EXPECT_EQ(960000, out->pkt_dts);
+  av_frame_free(&out);
+}
+
+TEST_F(TestDVDVideoFilterStage, ClosedStageRefusesFrames)
+{
+  AVFrame *frame = AllocateFrame(0, 0);
+  ASSERT_TRUE(frame != NULL);
+  EXPECT_FALSE(m_stage.AddFrame(frame));
+  av_frame_free(&frame);
+}
+
+// "" only converts the pixel format, "null" passes the pictures through
+INSTANTIATE_TEST_CASE_P(Graphs, TestDVDVideoFilterStage, testing::Values("", "null"));
@@ -0,0 +1,286 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if (defined HAVE_CONFIG_H) && (!defined TARGET_WINDOWS)
+  #include "config.h"
+#endif
+#include "DVDDemuxPacketPool.h"
+#include "DVDClock.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
+#include "threads/ThreadLocal.h"
+#include "utils/log.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+// don't hold on to more than this in the free lists of a single pool
+#define DEMUX_POOL_MAX_CACHED (32 * 1024 * 1024)
+
+// every packet block is laid out as [header][DemuxPacket][payload][padding]
+// unless the payload is a reference to an ffmpeg buffer
+struct SPacketBlockHeader
+{
+  CDVDDemuxPacketPool* pool;
+  AVBufferRef* buffer;
+  int sizeClass; // -1 for blocks that don't belong to a size class
+};
+
+#define ALIGN16(x) (((x) + 15) & ~15)
+#define BLOCK_HEADER_SIZE  ALIGN16(sizeof(SPacketBlockHeader))
+#define BLOCK_PAYLOAD_OFFS ALIGN16(BLOCK_HEADER_SIZE + sizeof(DemuxPacket))
+
+static XbmcThreads::ThreadLocal<CDVDDemuxPacketPool> g_currentPool;
+
+static inline SPacketBlockHeader* BlockHeader(DemuxPacket* pPacket)
+{
+  return (SPacketBlockHeader*)((uint8_t*)pPacket - BLOCK_HEADER_SIZE);
+}
+
+static inline int SizeClass(int iDataSize)
+{
+  int sizeClass = 0;
+  while (sizeClass < DEMUX_POOL_CLASSES && (1 << (sizeClass + DEMUX_POOL_MIN_SHIFT)) < iDataSize)
+    sizeClass++;
+  return sizeClass < DEMUX_POOL_CLASSES ? sizeClass : -1;
+}
+
+static inline int ClassCapacity(int sizeClass)
+{
+  return 1 << (sizeClass + DEMUX_POOL_MIN_SHIFT);
+}
+
+static inline int BlockSize(int capacity)
+{
+  return BLOCK_PAYLOAD_OFFS + capacity + FF_INPUT_BUFFER_PADDING_SIZE;
+}
+
+CDVDDemuxPacketPool::CDVDDemuxPacketPool()
+{
+  m_refs    = 1;
+  m_dropped = false;
+  m_stats.hits          = 0;
+  m_stats.misses        = 0;
+  m_stats.referenced    = 0;
+  m_stats.residentBytes = 0;
+  m_stats.cachedBytes   = 0;
+}
+
+CDVDDemuxPacketPool::~CDVDDemuxPacketPool()
+{
+  Drop();
+}
+
+void CDVDDemuxPacketPool::Acquire()
+{
+  AtomicIncrement(&m_refs);
+}
+
+void CDVDDemuxPacketPool::Release()
+{
+  if (AtomicDecrement(&m_refs) == 0)
+    delete this;
+}
+
+void CDVDDemuxPacketPool::Drop()
+{
+  CSingleLock lock(m_section);
+
+  m_dropped = true;
+  for (int i = 0; i < DEMUX_POOL_CLASSES; i++)
+  {
+    for (std::vector<void*>::iterator it = m_free[i].begin(); it != m_free[i].end(); ++it)
+      _aligned_free(*it);
+    m_stats.residentBytes -= (int64_t)m_free[i].size() * BlockSize(ClassCapacity(i));
+    m_free[i].clear();
+  }
+  m_stats.cachedBytes = 0;
+}
+
+void CDVDDemuxPacketPool::GetStats(SDemuxPacketPoolStats& stats)
+{
+  CSingleLock lock(m_section);
+  stats = m_stats;
+}
+
+void CDVDDemuxPacketPool::SetCurrent(CDVDDemuxPacketPool* pool)
+{
+  g_currentPool.set(pool);
+}
+
+CDVDDemuxPacketPool* CDVDDemuxPacketPool::GetCurrent()
+{
+  return g_currentPool.get();
+}
+
+void* CDVDDemuxPacketPool::Get(int sizeClass)
+{
+  int size = BlockSize(ClassCapacity(sizeClass));
+  {
+    CSingleLock lock(m_section);
+    if (!m_free[sizeClass].empty())
+    {
+      void* block = m_free[sizeClass].back();
+      m_free[sizeClass].pop_back();
+      m_stats.hits++;
+      m_stats.cachedBytes -= size;
+      return block;
+    }
+    m_stats.misses++;
+    m_stats.residentBytes += size;
+  }
+
+  void* block = _aligned_malloc(size, 16);
+  if (!block)
+  {
+    CSingleLock lock(m_section);
+    m_stats.residentBytes -= size;
+  }
+  return block;
+}
+
+void CDVDDemuxPacketPool::Put(void* block, int sizeClass)
+{
+  int size = BlockSize(ClassCapacity(sizeClass));
+  {
+    CSingleLock lock(m_section);
+    if (!m_dropped && m_stats.cachedBytes + size <= DEMUX_POOL_MAX_CACHED)
+    {
+      m_free[sizeClass].push_back(block);
+      m_stats.cachedBytes += size;
+      return;
+    }
+    m_stats.residentBytes -= size;
+  }
+  _aligned_free(block);
+}
+
+DemuxPacket* CDVDDemuxPacketPool::AllocatePacket(int iDataSize)
+{
+  CDVDDemuxPacketPool* pool = g_currentPool.get();
+  int sizeClass = SizeClass(iDataSize);
+  void* block;
+
+  if (pool && sizeClass >= 0)
+  {
+    block = pool->Get(sizeClass);
+    if (!block)
+      return NULL;
+    pool->Acquire();
+  }
+  else
+  {
+    pool      = NULL;
+    sizeClass = -1;
+    block     = _aligned_malloc(BlockSize(iDataSize > 0 ? iDataSize : 0), 16);
+    if (!block)
+      return NULL;
+  }
+
+  SPacketBlockHeader* header = (SPacketBlockHeader*)block;
+  header->pool      = pool;
+  header->buffer    = NULL;
+  header->sizeClass = sizeClass;
+
+  DemuxPacket* pPacket = (DemuxPacket*)((uint8_t*)block + BLOCK_HEADER_SIZE);
+  memset(pPacket, 0, sizeof(DemuxPacket));
+
+  if (iDataSize > 0)
+  {
+    pPacket->pData = (uint8_t*)block + BLOCK_PAYLOAD_OFFS;
+
+    // need to allocate a few bytes more.
+    // From avcodec.h (ffmpeg)
+    /**
+      * Required number of additionally allocated bytes at the end of the input bitstream for decoding.
+      * this is mainly needed because some optimized bitstream readers read
+      * 32 or 64 bit at once and could read over the end<br>
+      * Note, if the first 23 bits of the additional bytes are not 0 then damaged
+      * MPEG bitstreams could cause overread and segfault
+      */
+    memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+  }
+
+  // setup defaults
+  pPacket->dts       = DVD_NOPTS_VALUE;
+  pPacket->pts       = DVD_NOPTS_VALUE;
+  pPacket->iStreamId = -1;
+
+  return pPacket;
+}
+
+DemuxPacket* CDVDDemuxPacketPool::AllocatePacket(AVPacket* pkt)
+{
+  if (!pkt->buf)
+  {
+    // payload is owned by the demuxer, copy it
+    DemuxPacket* pPacket = AllocatePacket(pkt->size);
+    if (pPacket)
+    {
+      pPacket->iSize = pkt->size;
+      if (pkt->data)
+        memcpy(pPacket->pData, pkt->data, pkt->size);
+    }
+    return pPacket;
+  }
+
+  AVBufferRef* buffer = av_buffer_ref(pkt->buf);
+  if (!buffer)
+    return NULL;
+
+  DemuxPacket* pPacket = AllocatePacket(0);
+  if (!pPacket)
+  {
+    av_buffer_unref(&buffer);
+    return NULL;
+  }
+
+  // ffmpeg allocates packet buffers with FF_INPUT_BUFFER_PADDING_SIZE zeroed
+  // bytes at the end, so the payload can be handed on as it is
+  BlockHeader(pPacket)->buffer = buffer;
+  pPacket->pData = pkt->data;
+  pPacket->iSize = pkt->size;
+
+  if (CDVDDemuxPacketPool* pool = BlockHeader(pPacket)->pool)
+  {
+    CSingleLock lock(pool->m_section);
+    pool->m_stats.referenced++;
+  }
+
+  return pPacket;
+}
+
+void CDVDDemuxPacketPool::FreePacket(DemuxPacket* pPacket)
+{
+  SPacketBlockHeader* header = BlockHeader(pPacket);
+  CDVDDemuxPacketPool* pool = header->pool;
+
+  if (header->buffer)
+    av_buffer_unref(&header->buffer);
+
+  if (pool)
+  {
+    pool->Put(header, header->sizeClass);
+    pool->Release();
+  }
+  else
+    _aligned_free(header);
+}
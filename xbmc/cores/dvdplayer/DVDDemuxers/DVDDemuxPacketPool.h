@@ -0,0 +1,83 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDDemuxPacket.h"
+#include "threads/CriticalSection.h"
+#include <stdint.h>
+#include <vector>
+
+struct AVPacket;
+
+// 512 bytes up to 8MB, larger packets bypass the pool
+#define DEMUX_POOL_MIN_SHIFT 9
+#define DEMUX_POOL_CLASSES   15
+
+struct SDemuxPacketPoolStats
+{
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int referenced;    // packets that took over the ffmpeg buffer instead of copying
+  int64_t      residentBytes; // allocated through the pool, in use or cached
+  int64_t      cachedBytes;   // waiting in the free lists for reuse
+};
+
+/**
+ * Recycles demux packets in power of two size classes. Packet struct and
+ * payload live in a single block, so the DemuxPacket layout that add-ons see
+ * is unchanged. A pool is made current for a thread with SetCurrent(), from
+ * then on CDVDDemuxUtils::AllocateDemuxPacket on that thread draws from it.
+ * Packets may be freed from any thread, each one keeps its pool alive.
+ */
+class CDVDDemuxPacketPool
+{
+public:
+  CDVDDemuxPacketPool();
+
+  void Acquire();
+  void Release();
+
+  /**
+   * Release all cached blocks and stop caching, packets still in flight are
+   * returned to the system when they are freed.
+   */
+  void Drop();
+  void GetStats(SDemuxPacketPoolStats& stats);
+
+  static void SetCurrent(CDVDDemuxPacketPool* pool);
+  static CDVDDemuxPacketPool* GetCurrent();
+
+  static DemuxPacket* AllocatePacket(int iDataSize);
+  static DemuxPacket* AllocatePacket(AVPacket* pkt);
+  static void FreePacket(DemuxPacket* pPacket);
+
+private:
+  ~CDVDDemuxPacketPool();
+
+  void* Get(int sizeClass);
+  void  Put(void* block, int sizeClass);
+
+  long m_refs;
+  bool m_dropped;
+  CCriticalSection m_section;
+  std::vector<void*> m_free[DEMUX_POOL_CLASSES];
+  SDemuxPacketPoolStats m_stats;
+};
@@ -22,20 +22,15 @@
   #include "config.h"
 #endif
 #include "DVDDemuxUtils.h"
-#include "DVDClock.h"
+#include "DVDDemuxPacketPool.h"
 #include "utils/log.h"
 
-extern "C" {
-#include "libavcodec/avcodec.h"
-}
-
 void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 {
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
-      delete pPacket;
+      CDVDDemuxPacketPool::FreePacket(pPacket);
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -45,44 +40,30 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
-  if (!pPacket) return NULL;
-
+  DemuxPacket* pPacket = NULL;
   try
   {
-    memset(pPacket, 0, sizeof(DemuxPacket));
-
-    if (iDataSize > 0)
-    {
-      // need to allocate a few bytes more.
-      // From avcodec.h (ffmpeg)
-      /**
-        * Required number of additionally allocated bytes at the end of the input bitstream for decoding.
-        * this is mainly needed because some optimized bitstream readers read
-        * 32 or 64 bit at once and could read over the end<br>
-        * Note, if the first 23 bits of the additional bytes are not 0 then damaged
-        * MPEG bitstreams could cause overread and segfault
-        */
-      pPacket->pData =(uint8_t*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
-      if (!pPacket->pData)
-      {
-        FreeDemuxPacket(pPacket);
-        return NULL;
-      }
-
-      // reset the last 8 bytes to 0;
-      memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
-    }
+    // packets come from the pool of the calling thread's player, if any
+    pPacket = CDVDDemuxPacketPool::AllocatePacket(iDataSize);
+  }
+  catch(...)
+  {
+    CLog::Log(LOGERROR, "%s - Exception thrown", __FUNCTION__);
+    pPacket = NULL;
+  }
+  return pPacket;
+}
 
-    // setup defaults
-    pPacket->dts       = DVD_NOPTS_VALUE;
-    pPacket->pts       = DVD_NOPTS_VALUE;
-    pPacket->iStreamId = -1;
+DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(AVPacket* pkt)
+{
+  DemuxPacket* pPacket = NULL;
+  try
+  {
+    pPacket = CDVDDemuxPacketPool::AllocatePacket(pkt);
   }
   catch(...)
   {
     CLog::Log(LOGERROR, "%s - Exception thrown", __FUNCTION__);
-    FreeDemuxPacket(pPacket);
     pPacket = NULL;
   }
   return pPacket;
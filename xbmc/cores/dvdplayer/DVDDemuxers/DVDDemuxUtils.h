@@ -22,10 +22,18 @@
 
 #include "DVDDemuxPacket.h"
 
+struct AVPacket;
+
 class CDVDDemuxUtils
 {
 public:
   static void FreeDemuxPacket(DemuxPacket* pPacket);
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+  /**
+   * Allocate a packet carrying the payload of an ffmpeg packet. When the
+   * payload is reference counted the packet keeps a reference to it instead
+   * of copying, otherwise the data is copied as usual.
+   */
+  static DemuxPacket* AllocateDemuxPacket(AVPacket* pkt);
 };
 
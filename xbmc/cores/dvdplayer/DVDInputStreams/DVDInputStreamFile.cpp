@@ -75,7 +75,7 @@ bool CDVDInputStreamFile::Open(const char* strFile, const std::string& content)
   }
 
   if (!(flags & READ_CACHED))
-    flags |= READ_NO_CACHE; // Make sure CFile honors our no-cache hint
+    flags |= READ_NO_CACHE | READ_MMAP; // Make sure CFile honors our no-cache hint, map local files
 
   if (content == "video/mp4" ||
       content == "video/x-msvideo" ||
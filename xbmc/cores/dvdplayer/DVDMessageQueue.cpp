@@ -22,6 +22,7 @@
 #include "DVDDemuxers/DVDDemuxUtils.h"
 #include "utils/log.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
 
@@ -39,17 +40,48 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owne
   m_TimeFront     = DVD_NOPTS_VALUE;
   m_TimeSize      = 1.0 / 4.0; /* 4 seconds */
   m_iMaxDataSize  = 0;
+  m_accounting    = 0;
+  m_listSize      = 0;
+  m_sequence      = 0;
+
+  m_ringWrite     = 0;
+  m_ringRead      = 0;
+  m_ringUsed      = 0;
+  m_ringWaiting   = 0;
+  m_ringEpoch     = 0;
+  m_ringPackets   = 0;
 }
 
 CDVDMessageQueue::~CDVDMessageQueue()
 {
   // remove all remaining messages
   Flush(CDVDMsg::NONE);
+  DiscardRing();
+}
+
+void CDVDMessageQueue::SetPacketRingSize(unsigned int capacity)
+{
+  CSingleLock lock(m_section);
+
+  if (m_bInitialized)
+  {
+    CLog::Log(LOGERROR, "CDVDMessageQueue(%s)::SetPacketRingSize - queue is already initialized", m_owner.c_str());
+    return;
+  }
+
+  DiscardRing();
+
+  RingSlot empty = { NULL, 0, 0 };
+  m_ring.assign(capacity, empty);
+  m_ringWrite = 0;
+  m_ringRead  = 0;
 }
 
 void CDVDMessageQueue::Init()
 {
+  CAtomicSpinLock accounting(m_accounting);
   m_iDataSize     = 0;
+  m_ringPackets   = 0;
   m_bAbortRequest = false;
   m_bEmptied      = true;
   m_bInitialized  = true;
@@ -64,13 +96,21 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
   for(SList::iterator it = m_list.begin(); it != m_list.end();)
   {
     if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
+    {
       it = m_list.erase(it);
+      AtomicDecrement(&m_listSize);
+    }
     else
       ++it;
   }
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
+    // packets still sitting in the ring belong to an old epoch now, the
+    // consumer releases them without touching the counters
+    CAtomicSpinLock accounting(m_accounting);
+    m_ringEpoch++;
+    m_ringPackets = 0;
     m_iDataSize = 0;
     m_TimeBack  = DVD_NOPTS_VALUE;
     m_TimeFront = DVD_NOPTS_VALUE;
@@ -93,14 +133,120 @@ void CDVDMessageQueue::End()
 
   Flush(CDVDMsg::NONE);
 
+  // the consumer has stopped by now, so release what it left in the ring
+  DiscardRing();
+
   m_bInitialized  = false;
   m_iDataSize     = 0;
   m_bAbortRequest = false;
 }
 
+void CDVDMessageQueue::AddPacket(DemuxPacket* packet)
+{
+  m_iDataSize += packet->iSize;
+  if     (packet->dts != DVD_NOPTS_VALUE)
+    m_TimeFront = packet->dts;
+  else if(packet->pts != DVD_NOPTS_VALUE)
+    m_TimeFront = packet->pts;
+  if(m_TimeBack == DVD_NOPTS_VALUE)
+    m_TimeBack = m_TimeFront;
+}
+
+void CDVDMessageQueue::RemovePacket(DemuxPacket* packet)
+{
+  m_iDataSize -= packet->iSize;
+  if     (packet->dts != DVD_NOPTS_VALUE)
+    m_TimeBack = packet->dts;
+  else if(packet->pts != DVD_NOPTS_VALUE)
+    m_TimeBack = packet->pts;
+}
+
+bool CDVDMessageQueue::PutRing(CDVDMsg* pMsg)
+{
+  // producer side, only called from the single packet producer
+  if (AtomicAdd(&m_ringUsed, 0) >= (long)m_ring.size())
+    return false;
+
+  RingSlot& slot = m_ring[m_ringWrite];
+  slot.message  = pMsg;
+  slot.sequence = AtomicIncrement(&m_sequence);
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  {
+    CAtomicSpinLock accounting(m_accounting);
+    slot.epoch = m_ringEpoch;
+    m_ringPackets++;
+    if (packet)
+      AddPacket(packet);
+  }
+
+  m_ringWrite = (m_ringWrite + 1) % m_ring.size();
+
+  // publish the slot, then wake the consumer if it went to sleep
+  AtomicIncrement(&m_ringUsed);
+  if (AtomicAdd(&m_ringWaiting, 0))
+    m_hEvent.Set();
+
+  return true;
+}
+
+bool CDVDMessageQueue::PopRing(CDVDMsg** pMsg)
+{
+  // consumer side, ring must not be empty
+  RingSlot& slot = m_ring[m_ringRead];
+  CDVDMsg* msg = slot.message;
+  bool current;
+  {
+    CAtomicSpinLock accounting(m_accounting);
+    current = slot.epoch == m_ringEpoch;
+    if (current)
+    {
+      DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)msg)->GetPacket();
+      if (packet)
+        RemovePacket(packet);
+      m_ringPackets--;
+      if(m_bEmptied && m_iDataSize > 0)
+        m_bEmptied = false;
+    }
+  }
+
+  slot.message = NULL;
+  m_ringRead = (m_ringRead + 1) % m_ring.size();
+  AtomicDecrement(&m_ringUsed);
+
+  if (!current)
+  {
+    msg->Release();
+    return false;
+  }
+
+  *pMsg = msg;
+  return true;
+}
+
+void CDVDMessageQueue::DiscardRing()
+{
+  // only valid while neither producer nor consumer are active
+  while (AtomicAdd(&m_ringUsed, 0) > 0)
+  {
+    m_ring[m_ringRead].message->Release();
+    m_ring[m_ringRead].message = NULL;
+    m_ringRead = (m_ringRead + 1) % m_ring.size();
+    AtomicDecrement(&m_ringUsed);
+  }
+}
+
 
 MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 {
+  if (!m_ring.empty() && m_bInitialized && pMsg && priority == 0 &&
+      pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+  {
+    // the ring takes over our reference, fall back to the list when full
+    if (PutRing(pMsg))
+      return MSGQ_OK;
+  }
+
   CSingleLock lock(m_section);
 
   if (!m_bInitialized)
@@ -122,20 +268,16 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
       break;
     ++it;
   }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
+  m_list.insert(it, DVDMessageListItem(pMsg, priority, AtomicIncrement(&m_sequence)));
+  AtomicIncrement(&m_listSize);
 
   if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
   {
     DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
     if(packet)
     {
-      m_iDataSize += packet->iSize;
-      if     (packet->dts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->dts;
-      else if(packet->pts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->pts;
-      if(m_TimeBack == DVD_NOPTS_VALUE)
-        m_TimeBack = m_TimeFront;
+      CAtomicSpinLock accounting(m_accounting);
+      AddPacket(packet);
     }
   }
 
@@ -148,10 +290,19 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 
 MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
 {
-  CSingleLock lock(m_section);
-
   *pMsg = NULL;
 
+  // fast path, nothing but packets queued. the ring is checked before the
+  // list so a message put ahead of the packet by the producer is noticed
+  while (priority == 0 && m_bInitialized && !m_bAbortRequest &&
+         AtomicAdd(&m_ringUsed, 0) > 0 && AtomicAdd(&m_listSize, 0) == 0)
+  {
+    if (PopRing(pMsg))
+      return MSGQ_OK;
+  }
+
+  CSingleLock lock(m_section);
+
   int ret = 0;
 
   if (!m_bInitialized)
@@ -160,7 +311,7 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  if(m_list.empty() && AtomicAdd(&m_ringUsed, 0) == 0 && m_bEmptied == false && priority == 0 && m_owner != "teletext")
   {
 #if !defined(TARGET_RASPBERRY_PI)
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
@@ -170,7 +321,24 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    bool ring = AtomicAdd(&m_ringUsed, 0) > 0;
+
+    // a ring packet goes first unless the list holds something of higher
+    // priority or a priority 0 message that was put before it
+    if(ring && priority == 0 && !m_bCaching &&
+       (m_list.empty() || (m_list.back().priority == 0 &&
+                           m_list.back().sequence - m_ring[m_ringRead].sequence > 0)))
+    {
+      if (PopRing(pMsg))
+      {
+        priority = 0;
+        ret = MSGQ_OK;
+        break;
+      }
+      // stale packet from before a flush, look again
+      continue;
+    }
+    else if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
     {
       DVDMessageListItem& item(m_list.back());
       priority = item.priority;
@@ -178,14 +346,9 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
       if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
       {
         DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
+        CAtomicSpinLock accounting(m_accounting);
         if(packet)
-        {
-          m_iDataSize -= packet->iSize;
-          if     (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if(packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
-        }
+          RemovePacket(packet);
 
         if(m_bEmptied && m_iDataSize > 0)
           m_bEmptied = false;
@@ -193,6 +356,7 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
       *pMsg = item.message->Acquire();
       m_list.pop_back();
+      AtomicDecrement(&m_listSize);
 
       ret = MSGQ_OK;
       break;
@@ -205,10 +369,21 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     else
     {
       m_hEvent.Reset();
+
+      // announce that we are about to sleep, a packet that slipped into
+      // the ring before the producer could see the flag is caught here
+      AtomicIncrement(&m_ringWaiting);
+      if (AtomicAdd(&m_ringUsed, 0) > 0 && priority == 0)
+      {
+        AtomicDecrement(&m_ringWaiting);
+        continue;
+      }
       lock.Leave();
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
+      AtomicDecrement(&m_ringWaiting);
+      if (!signaled)
         return MSGQ_TIMEOUT;
 
       lock.Enter();
@@ -229,6 +404,12 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
     return 0;
 
   unsigned count = 0;
+  if (type == CDVDMsg::DEMUXER_PACKET)
+  {
+    CAtomicSpinLock accounting(m_accounting);
+    count = m_ringPackets;
+  }
+
   for(SList::iterator it = m_list.begin(); it != m_list.end();++it)
   {
     if(it->message->IsType(type))
@@ -247,9 +428,15 @@ void CDVDMessageQueue::WaitUntilEmpty()
     msg->Release();
 }
 
+int CDVDMessageQueue::GetDataSize() const
+{
+  CAtomicSpinLock accounting(m_accounting);
+  return m_iDataSize;
+}
+
 int CDVDMessageQueue::GetLevel() const
 {
-  CSingleLock lock(m_section);
+  CAtomicSpinLock accounting(m_accounting);
 
   if(m_iDataSize > m_iMaxDataSize)
     return 100;
@@ -264,7 +451,7 @@ int CDVDMessageQueue::GetLevel() const
 
 int CDVDMessageQueue::GetTimeSize() const
 {
-  CSingleLock lock(m_section);
+  CAtomicSpinLock accounting(m_accounting);
 
   if(IsDataBased())
     return 0;
@@ -23,20 +23,23 @@
 #include "DVDMessage.h"
 #include <string>
 #include <list>
+#include <vector>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 
 struct DVDMessageListItem
 {
-  DVDMessageListItem(CDVDMsg* msg, int prio)
+  DVDMessageListItem(CDVDMsg* msg, int prio, long seq = 0)
   {
     message  = msg->Acquire();
     priority = prio;
+    sequence = seq;
   }
   DVDMessageListItem()
   {
     message  = NULL;
     priority = 0;
+    sequence = 0;
   }
   DVDMessageListItem(const DVDMessageListItem& item)
   {
@@ -45,6 +48,7 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    sequence = item.sequence;
   }
  ~DVDMessageListItem()
   {
@@ -61,11 +65,13 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    sequence = item.sequence;
     return *this;
   }
 
   CDVDMsg* message;
   int      priority;
+  long     sequence; // put order, used to merge the packet ring with the list
 };
 
 enum MsgQueueReturnCode
@@ -105,7 +111,17 @@ public:
     return Get(pMsg, iTimeoutInMilliSeconds, priority);
   }
 
-  int GetDataSize() const               { return m_iDataSize; }
+  /**
+   * Route priority 0 demuxer packets through a bounded single producer /
+   * single consumer ring instead of the locked list. Only one thread may put
+   * packets and only one thread may get messages while the ring is in use,
+   * control messages keep going through the list and stay ordered relative
+   * to the packets. Must be called before Init(), capacity 0 disables it.
+   */
+  void SetPacketRingSize(unsigned int capacity);
+  bool HasPacketRing() const            { return !m_ring.empty(); }
+
+  int GetDataSize() const;
   int GetTimeSize() const;
   unsigned GetPacketCount(CDVDMsg::Message type);
   bool ReceivedAbortRequest()           { return m_bAbortRequest; }
@@ -124,8 +140,22 @@ public:
 
 private:
 
+  struct RingSlot
+  {
+    CDVDMsg* message;
+    long     sequence;
+    long     epoch;
+  };
+
+  bool PutRing(CDVDMsg* pMsg);
+  bool PopRing(CDVDMsg** pMsg);
+  void DiscardRing();
+  void AddPacket(DemuxPacket* packet);
+  void RemovePacket(DemuxPacket* packet);
+
   CEvent m_hEvent;
   mutable CCriticalSection m_section;
+  mutable long m_accounting; // spin lock protecting the data/time counters
 
   bool m_bAbortRequest;
   bool m_bInitialized;
@@ -142,5 +172,18 @@ private:
 
   typedef std::list<DVDMessageListItem> SList;
   SList m_list;
+  long m_listSize;
+
+  long m_sequence;
+
+  // packet ring, m_ringWrite is owned by the producer, m_ringRead by the
+  // consumer. m_ringUsed and m_ringWaiting are only touched atomically.
+  std::vector<RingSlot> m_ring;
+  unsigned int m_ringWrite;
+  unsigned int m_ringRead;
+  long m_ringUsed;
+  long m_ringWaiting;
+  long m_ringEpoch;
+  unsigned int m_ringPackets;
 };
 
@@ -30,6 +30,7 @@
 
 #include "DVDDemuxers/DVDDemux.h"
 #include "DVDDemuxers/DVDDemuxUtils.h"
+#include "DVDDemuxers/DVDDemuxPacketPool.h"
 #include "DVDDemuxers/DVDDemuxVobsub.h"
 #include "DVDDemuxers/DVDFactoryDemuxer.h"
 #include "DVDDemuxers/DVDDemuxFFmpeg.h"
@@ -550,6 +551,10 @@ CDVDPlayer::CDVDPlayer(IPlayerCallback& callback)
   m_pSubtitleDemuxer = NULL;
   m_pCCDemuxer = NULL;
   m_pInputStream = NULL;
+  m_pPacketPool = NULL;
+  m_demuxPackets = 0;
+  m_demuxBytes = 0;
+  m_demuxCpuTime = 0;
 
   m_dvd.Clear();
   m_State.Clear();
@@ -685,6 +690,13 @@ void CDVDPlayer::OnStartup()
 
   m_messenger.Init();
 
+  // demuxers allocate their packets on this thread, recycle them per player
+  {
+    CSingleLock lock(m_StateSection);
+    m_pPacketPool = new CDVDDemuxPacketPool();
+  }
+  CDVDDemuxPacketPool::SetCurrent(m_pPacketPool);
+
   CUtil::ClearTempFonts();
 }
 
@@ -923,6 +935,11 @@ bool CDVDPlayer::ReadPacket(DemuxPacket*& packet, CDemuxStream*& stream)
 
   if(packet)
   {
+    { CSingleLock lock(m_statsSection);
+      m_demuxPackets++;
+      m_demuxBytes += packet->iSize;
+    }
+
     // stream changed, update and open defaults
     if(packet->iStreamId == DMX_SPECIALID_STREAMCHANGE)
     {
@@ -2160,6 +2177,10 @@ void CDVDPlayer::OnExit()
 {
     CLog::Log(LOGNOTICE, "CDVDPlayer::OnExit()");
 
+    { CSingleLock lock(m_statsSection);
+      m_demuxCpuTime += CThread::GetAbsoluteUsage();
+    }
+
     // set event to inform openfile something went wrong in case openfile is still waiting for this event
     SetCaching(CACHESTATE_DONE);
 
@@ -2187,6 +2208,17 @@ void CDVDPlayer::OnExit()
 
     m_messenger.End();
 
+    CDVDDemuxPacketPool::SetCurrent(NULL);
+    {
+      CSingleLock lock(m_StateSection);
+      if (m_pPacketPool)
+      {
+        m_pPacketPool->Drop();
+        m_pPacketPool->Release();
+        m_pPacketPool = NULL;
+      }
+    }
+
     if (m_omxplayer_mode)
     {
       m_OmxPlayerState.av_clock.OMXStop();
@@ -2844,6 +2876,34 @@ void CDVDPlayer::GetVideoInfo(std::string& strVideoInfo)
   strVideoInfo += StringUtils::Format("\nP(%s)", m_dvdPlayerVideo->GetPlayerInfo().c_str());
 }
 
+void CDVDPlayer::GetStats(SDVDPlayerStats& stats)
+{
+  int64_t usage = CThread::GetAbsoluteUsage();
+  { CSingleLock lock(m_statsSection);
+    stats.demuxPackets = m_demuxPackets;
+    stats.demuxBytes   = m_demuxBytes;
+    stats.demuxCpuTime = (m_demuxCpuTime + usage) / 10000000.0;
+  }
+  m_dvdPlayerVideo->GetStats(stats.video);
+  m_dvdPlayerAudio->GetStats(stats.audio);
+}
+
+static std::string GetStreamCacheText()
+{
+  std::vector<SStreamCacheInfo> infos;
+  g_dataCacheCore.GetStreamCacheInfo(infos);
+
+  std::string text;
+  for (std::vector<SStreamCacheInfo>::const_iterator it = infos.begin(); it != infos.end(); ++it)
+    text += StringUtils::Format(" %s:%u %s/s %u%% st:%u"
+                                , it->protocol.c_str()
+                                , it->readers
+                                , StringUtils::SizeToString(it->currate).c_str()
+                                , it->level
+                                , it->stalls);
+  return text;
+}
+
 void CDVDPlayer::GetGeneralInfo(std::string& strGeneralInfo)
 {
   if (!m_bStop)
@@ -2872,6 +2932,16 @@ void CDVDPlayer::GetGeneralInfo(std::string& strGeneralInfo)
         if(m_playSpeed == 0 || m_caching == CACHESTATE_FULL)
           strBuf += StringUtils::Format(" %d sec", DVD_TIME_TO_SEC(m_StateInput.cache_delay));
       }
+      if(m_pPacketPool)
+      {
+        SDemuxPacketPoolStats stats;
+        m_pPacketPool->GetStats(stats);
+        strBuf += StringUtils::Format(" pkt:%s %u/%u"
+                                      , StringUtils::SizeToString(stats.residentBytes).c_str()
+                                      , stats.hits
+                                      , stats.misses);
+      }
+      strBuf += GetStreamCacheText();
 
       strGeneralInfo = StringUtils::Format("C( ad:% 6.3f, a/v:% 6.3f%s, dcpu:%2i%% acpu:%2i%% vcpu:%2i%%%s af:%d%% vf:%d%% amp:% 5.2f )"
           , dDelay
@@ -2908,6 +2978,16 @@ void CDVDPlayer::GetGeneralInfo(std::string& strGeneralInfo)
         if(m_playSpeed == 0 || m_caching == CACHESTATE_FULL)
           strBuf += StringUtils::Format(" %d sec", DVD_TIME_TO_SEC(m_StateInput.cache_delay));
       }
+      if(m_pPacketPool)
+      {
+        SDemuxPacketPoolStats stats;
+        m_pPacketPool->GetStats(stats);
+        strBuf += StringUtils::Format(" pkt:%s %u/%u"
+                                      , StringUtils::SizeToString(stats.residentBytes).c_str()
+                                      , stats.hits
+                                      , stats.misses);
+      }
+      strBuf += GetStreamCacheText();
 
       strGeneralInfo = StringUtils::Format("C( ad:% 6.3f, a/v:% 6.3f%s, dcpu:%2i%% acpu:%2i%% vcpu:%2i%%%s )"
                                            , dDelay
@@ -3278,6 +3358,11 @@ bool CDVDPlayer::OpenVideoStream(CDVDStreamInfo& hint, bool reset)
   if(pMenus && pMenus->IsInMenu())
     hint.stills = true;
 
+  if(m_pInputStream && (m_pInputStream->IsStreamType(DVDSTREAM_TYPE_TV)
+                     || m_pInputStream->IsStreamType(DVDSTREAM_TYPE_PVRMANAGER)
+                     || m_pInputStream->IsStreamType(DVDSTREAM_TYPE_HTSP)))
+    hint.realtime = true;
+
   if (hint.stereo_mode.empty())
     hint.stereo_mode = CStereoscopicsManager::Get().DetectStereoModeByString(m_filename);
 
@@ -93,6 +93,7 @@ class CDemuxStreamVideo;
 class CDemuxStreamAudio;
 class CStreamInfo;
 class CDVDDemuxCC;
+class CDVDDemuxPacketPool;
 
 namespace PVR
 {
@@ -207,6 +208,16 @@ public:
   void             Update  (CDVDInputStream* input, CDVDDemux* demuxer, std::string filename2 = "");
 };
 
+// playback statistics of a CDVDPlayer, counted from its creation
+struct SDVDPlayerStats
+{
+  SDVDPlayerStats() : demuxPackets(0), demuxBytes(0), demuxCpuTime(0.0) {}
+  unsigned int      demuxPackets; // packets read from the demuxers
+  int64_t           demuxBytes;
+  double            demuxCpuTime; // cpu seconds used by the demux thread
+  SPlayerVideoStats video;
+  SPlayerAudioStats audio;
+};
 
 #define DVDPLAYER_AUDIO    1
 #define DVDPLAYER_VIDEO    2
@@ -239,6 +250,7 @@ public:
   virtual void GetAudioInfo(std::string& strAudioInfo);
   virtual void GetVideoInfo(std::string& strVideoInfo);
   virtual void GetGeneralInfo(std::string& strVideoInfo);
+  void GetStats(SDVDPlayerStats& stats);
   virtual bool CanRecord();
   virtual bool IsRecording();
   virtual bool CanPause();
@@ -428,6 +440,7 @@ protected:
 
   CDVDInputStream* m_pInputStream;  // input stream for current playing file
   CDVDDemux* m_pDemuxer;            // demuxer for current playing file
+  CDVDDemuxPacketPool* m_pPacketPool; // packet buffers of the demuxers, protected by m_StateSection
   CDVDDemux* m_pSubtitleDemuxer;
   CDVDDemuxCC* m_pCCDemuxer;
 
@@ -523,6 +536,11 @@ protected:
   } m_State, m_StateInput;
   CCriticalSection m_StateSection;
 
+  CCriticalSection m_statsSection;
+  unsigned int m_demuxPackets;
+  int64_t      m_demuxBytes;
+  int64_t      m_demuxCpuTime; // cpu time of previous runs of the thread in 100ns units
+
   CEvent m_ready;
 
   CEdl m_Edl;
@@ -114,6 +114,7 @@ CDVDPlayerAudio::CDVDPlayerAudio(CDVDClock* pClock, CDVDMessageQueue& parent)
   m_silence = false;
   m_resampleratio = 1.0;
   m_synctype = SYNC_DISCON;
+  m_cpuTime = 0;
   m_setsynctype = SYNC_DISCON;
   m_prevsynctype = -1;
   m_error = 0;
@@ -125,6 +126,7 @@ CDVDPlayerAudio::CDVDPlayerAudio(CDVDClock* pClock, CDVDMessageQueue& parent)
 
   m_messageQueue.SetMaxDataSize(6 * 1024 * 1024);
   m_messageQueue.SetMaxTimeSize(8.0);
+  m_messageQueue.SetPacketRingSize(1024); // packets are only put by CDVDPlayer::Process
 }
 
 CDVDPlayerAudio::~CDVDPlayerAudio()
@@ -641,6 +643,17 @@ void CDVDPlayerAudio::HandleSyncError(double duration)
 
   m_errors.Add(error);
 
+  { CSingleLock lock(m_statsSection);
+    double seconds = error / DVD_TIME_BASE;
+    unsigned int bucket = 0;
+    while (bucket < SYNC_ERROR_BUCKETS - 1 && fabs(seconds) * 1000.0 >= SyncErrorBucketLimits[bucket])
+      bucket++;
+    m_stats.syncErrors[bucket]++;
+    m_stats.syncErrorSum     += seconds;
+    m_stats.syncErrorSquares += seconds * seconds;
+    m_stats.syncErrorMax      = std::max(m_stats.syncErrorMax, fabs(seconds));
+  }
+
   if (fabs(error) > DVD_MSEC_TO_TIME(100))
   {
     m_syncclock = true;
@@ -767,9 +780,21 @@ void CDVDPlayerAudio::OnExit()
   CoUninitialize();
 #endif
 
+  { CSingleLock lock(m_statsSection);
+    m_cpuTime += GetAbsoluteUsage();
+  }
   CLog::Log(LOGNOTICE, "thread end: CDVDPlayerAudio::OnExit()");
 }
 
+void CDVDPlayerAudio::GetStats(SPlayerAudioStats& stats)
+{
+  int64_t usage = GetAbsoluteUsage();
+
+  CSingleLock lock(m_statsSection);
+  stats = m_stats;
+  stats.cpuTime = (m_cpuTime + usage) / 10000000.0;
+}
+
 void CDVDPlayerAudio::SetSpeed(int speed)
 {
   if(m_messageQueue.IsInited())
@@ -143,6 +143,7 @@ public:
   bool IsPassthrough() const;
   double GetDelay() { return 0.0; }
   double GetCacheTotal() { return 0.0; }
+  void GetStats(SPlayerAudioStats& stats);
 protected:
 
   virtual void OnStartup();
@@ -246,5 +247,9 @@ protected:
 
   CCriticalSection m_info_section;
   SInfo            m_info;
+
+  CCriticalSection  m_statsSection;
+  SPlayerAudioStats m_stats;
+  int64_t           m_cpuTime; // cpu time of previous runs of the thread in 100ns units
 };
 
@@ -44,6 +44,7 @@
 #include <iterator>
 #include "guilib/GraphicContext.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
 
 using namespace std;
 using namespace RenderManager;
@@ -145,8 +146,13 @@ CDVDPlayerVideo::CDVDPlayerVideo( CDVDClock* pClock
   m_iNrOfPicturesNotToSkip = 0;
   m_messageQueue.SetMaxDataSize(40 * 1024 * 1024);
   m_messageQueue.SetMaxTimeSize(8.0);
+  m_messageQueue.SetPacketRingSize(1024); // packets are only put by CDVDPlayer::Process
 
   m_iDroppedFrames = 0;
+  m_decodeTicks = 0;
+  m_filterTicks = 0;
+  m_filterMaxTicks = 0;
+  m_cpuTime = 0;
   m_fFrameRate = 25;
   m_bCalcFrameRate = false;
   m_fStableFrameRate = 0.0;
@@ -571,7 +577,9 @@ void CDVDPlayerVideo::Process()
 
       mFilters = m_pVideoCodec->SetFilters(mFilters);
 
+      int64_t decodeStart = CurrentHostCounter();
       int iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      AddDecodeStats(decodeStart);
 
       // buffer packets so we can recover should decoder flush for some reason
       if(m_pVideoCodec->GetConvergeCount() > 0)
@@ -629,6 +637,10 @@ void CDVDPlayerVideo::Process()
           m_pVideoCodec->ClearPicture(&picture);
           if (m_pVideoCodec->GetPicture(&picture))
           {
+            { CSingleLock lock(m_statsSection);
+              m_stats.decoded++;
+            }
+
             sPostProcessType.clear();
 
             if(picture.iDuration == 0.0)
@@ -703,6 +715,13 @@ void CDVDPlayerVideo::Process()
 
             int iResult = OutputPicture(&picture, pts);
 
+            { CSingleLock lock(m_statsSection);
+              if (iResult & EOS_DROPPED)
+                m_stats.dropped++;
+              else if (!(iResult & EOS_ABORT))
+                m_stats.output++;
+            }
+
             frametime = (double)DVD_TIME_BASE/m_fFrameRate;
 
             if(m_started == false)
@@ -750,7 +769,9 @@ void CDVDPlayerVideo::Process()
         CalcDropRequirement(pts, true);
 
         // the decoder didn't need more data, flush the remaning buffer
+        decodeStart = CurrentHostCounter();
         iDecoderState = m_pVideoCodec->Decode(NULL, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+        AddDecodeStats(decodeStart);
       }
     }
 
@@ -764,9 +785,39 @@ void CDVDPlayerVideo::Process()
 
 void CDVDPlayerVideo::OnExit()
 {
+  { CSingleLock lock(m_statsSection);
+    m_cpuTime += GetAbsoluteUsage();
+  }
   CLog::Log(LOGNOTICE, "thread end: video_thread");
 }
 
+void CDVDPlayerVideo::AddDecodeStats(int64_t decodeStart)
+{
+  int64_t ticks = CurrentHostCounter() - decodeStart;
+
+  unsigned int filtered;
+  int64_t filterTicks, filterMaxTicks;
+  m_pVideoCodec->GetFilterStats(filtered, filterTicks, filterMaxTicks);
+
+  CSingleLock lock(m_statsSection);
+  m_decodeTicks += ticks;
+  m_stats.filtered += filtered;
+  m_filterTicks += filterTicks;
+  m_filterMaxTicks = std::max(m_filterMaxTicks, filterMaxTicks);
+}
+
+void CDVDPlayerVideo::GetStats(SPlayerVideoStats& stats)
+{
+  int64_t usage = GetAbsoluteUsage();
+
+  CSingleLock lock(m_statsSection);
+  stats = m_stats;
+  stats.decodeTime = (double)m_decodeTicks / CurrentHostFrequency();
+  stats.filterTime = (double)m_filterTicks / CurrentHostFrequency();
+  stats.filterTimeMax = (double)m_filterMaxTicks / CurrentHostFrequency();
+  stats.cpuTime    = (m_cpuTime + usage) / 10000000.0;
+}
+
 void CDVDPlayerVideo::SetSpeed(int speed)
 {
   if(m_messageQueue.IsInited())
@@ -873,6 +924,7 @@ void CDVDPlayerVideo::ProcessOverlays(DVDVideoPicture* pSource, double pts)
       CDVDCodecUtils::CopyPicture(m_pTempOverlayPicture, pSource);
       memcpy(pSource->data     , m_pTempOverlayPicture->data     , sizeof(pSource->data));
       memcpy(pSource->iLineSize, m_pTempOverlayPicture->iLineSize, sizeof(pSource->iLineSize));
+      pSource->videoBuffer = NULL;
     }
   }
 
@@ -1374,6 +1426,11 @@ std::string CDVDPlayerVideo::GetPlayerInfo()
   s << ", Mb/s:" << fixed << setprecision(2) << (double)GetVideoBitrate() / (1024.0*1024.0);
   s << ", drop:" << m_iDroppedFrames;
   s << ", skip:" << g_renderManager.GetSkippedFrames();
+  s << ", copy:" << CDVDCodecUtils::GetFrameCopyCount();
+  { CSingleLock lock(m_statsSection);
+    if (m_stats.filtered)
+      s << ", filt:" << fixed << setprecision(1) << m_filterTicks * 1000.0 / CurrentHostFrequency() / m_stats.filtered << "ms";
+  }
 
   int pc = m_pullupCorrection.GetPatternLength();
   if (pc > 0)
@@ -1549,6 +1606,9 @@ int CDVDPlayerVideo::CalcDropRequirement(double pts, bool updateOnly)
       m_droppingStats.m_totalGain += gain.gain;
       result |= EOS_DROPPED;
       m_droppingStats.m_dropRequests = 0;
+      { CSingleLock lock(m_statsSection);
+        m_stats.dropped += iDroppedPics;
+      }
       if (g_advancedSettings.CanLogComponent(LOGVIDEO))
         CLog::Log(LOGDEBUG,"CDVDPlayerVideo::CalcDropRequirement - dropped pictures, Sleeptime: %f, Bufferlevel: %d, Gain: %f", iSleepTime, iBufferLevel, iGain);
     }
@@ -1561,6 +1621,10 @@ int CDVDPlayerVideo::CalcDropRequirement(double pts, bool updateOnly)
       m_droppingStats.m_totalGain += iGain;
       result |= EOS_DROPPED;
       m_droppingStats.m_dropRequests = 0;
+      // the decoder skipped these without handing out a picture, count them from the pts gap
+      { CSingleLock lock(m_statsSection);
+        m_stats.dropped += std::max((int)(iGain * m_fFrameRate + 0.5), 1);
+      }
       if (g_advancedSettings.CanLogComponent(LOGVIDEO))
         CLog::Log(LOGDEBUG,"CDVDPlayerVideo::CalcDropRequirement - dropped in decoder, Sleeptime: %f, Bufferlevel: %d, Gain: %f", iSleepTime, iBufferLevel, iGain);
     }
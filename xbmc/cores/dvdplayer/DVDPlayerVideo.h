@@ -107,6 +107,7 @@ public:
   std::string GetStereoMode();
 
   void SetSpeed(int iSpeed);
+  void GetStats(SPlayerVideoStats& stats);
 
   // classes
   CDVDOverlayContainer* m_pOverlayContainer;
@@ -148,6 +149,7 @@ protected:
   void   ResetFrameRateCalc();
   void   CalcFrameRate();
   int    CalcDropRequirement(double pts, bool updateOnly);
+  void   AddDecodeStats(int64_t decodeStart);
 
   double m_fFrameRate;       //framerate of the video currently playing
   bool   m_bCalcFrameRate;  //if we should calculate the framerate from the timestamps
@@ -191,6 +193,13 @@ protected:
 
   BitstreamStats m_videoStats;
 
+  CCriticalSection  m_statsSection;
+  SPlayerVideoStats m_stats;
+  int64_t           m_decodeTicks; // host counter ticks spent in the decoder
+  int64_t           m_filterTicks; // host counter ticks spent in the decoder's filters
+  int64_t           m_filterMaxTicks;
+  int64_t           m_cpuTime;     // cpu time of previous runs of the thread in 100ns units
+
   // classes
   CDVDStreamInfo m_hints;
   CDVDVideoCodec* m_pVideoCodec;
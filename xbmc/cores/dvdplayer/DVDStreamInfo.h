@@ -52,6 +52,7 @@ public:
   StreamType type;
   int flags;
   bool software;  //force software decoding
+  bool realtime;  // stream is played as it is received, eg. live tv
   std::string filename;
 
 
@@ -28,6 +28,38 @@ typedef CRectGen<float>  CRect;
 
 class DVDNavResult;
 
+// playback statistics of a stream player, counted from its creation
+struct SPlayerVideoStats
+{
+  SPlayerVideoStats() : decoded(0), output(0), dropped(0), filtered(0), decodeTime(0.0), filterTime(0.0), filterTimeMax(0.0), cpuTime(0.0) {}
+  unsigned int decoded;       // pictures returned by the decoder
+  unsigned int output;        // pictures passed on to the renderer
+  unsigned int dropped;       // pictures dropped by the decoder or before output
+  unsigned int filtered;      // pictures deinterlaced or converted by the decoder's software filters
+  double       decodeTime;    // seconds spent in the decoder, including filtering
+  double       filterTime;    // seconds spent filtering
+  double       filterTimeMax; // longest time spent filtering a picture in seconds
+  double       cpuTime;       // cpu seconds used by the player thread
+};
+
+// upper bounds of the a/v sync error buckets in ms, the last bucket holds the rest
+static const int SyncErrorBucketLimits[] = { 5, 10, 20, 50, 100 };
+#define SYNC_ERROR_BUCKETS (sizeof(SyncErrorBucketLimits) / sizeof(SyncErrorBucketLimits[0]) + 1)
+
+struct SPlayerAudioStats
+{
+  SPlayerAudioStats() : syncErrorSum(0.0), syncErrorSquares(0.0), syncErrorMax(0.0), cpuTime(0.0)
+  {
+    for (unsigned int i = 0; i < SYNC_ERROR_BUCKETS; i++)
+      syncErrors[i] = 0;
+  }
+  unsigned int syncErrors[SYNC_ERROR_BUCKETS]; // measurements of the audio to clock error, by size
+  double       syncErrorSum;                   // seconds, positive when audio is ahead of the clock
+  double       syncErrorSquares;
+  double       syncErrorMax;                   // largest absolute error in seconds
+  double       cpuTime;                        // cpu seconds used by the player thread
+};
+
 class IDVDPlayer
 {
 public:
@@ -87,6 +119,7 @@ public:
   virtual int  GetDecoderFreeSpace() = 0;
   virtual bool IsEOS() = 0;
   virtual bool SubmittedEOS() const = 0;
+  virtual void GetStats(SPlayerVideoStats& stats) { stats = SPlayerVideoStats(); }
 };
 
 class CDVDAudioCodec;
@@ -119,4 +152,5 @@ public:
   virtual double GetCacheTotal() = 0;
   virtual float GetDynamicRangeAmplification() const = 0;
   virtual bool IsEOS() = 0;
+  virtual void GetStats(SPlayerAudioStats& stats) { stats = SPlayerAudioStats(); }
 };
@@ -0,0 +1,99 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxPacketPool.h"
+#include "cores/dvdplayer/DVDClock.h"
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+TEST(TestDVDDemuxPacketPool, Unpooled)
+{
+  CDVDDemuxPacketPool::SetCurrent(NULL);
+
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(1000);
+  ASSERT_TRUE(packet != NULL);
+  ASSERT_TRUE(packet->pData != NULL);
+  EXPECT_EQ(0, ((uintptr_t)packet->pData) & 15);
+  EXPECT_EQ(DVD_NOPTS_VALUE, packet->pts);
+  EXPECT_EQ(-1, packet->iStreamId);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+
+  packet = CDVDDemuxUtils::AllocateDemuxPacket(0);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_TRUE(packet->pData == NULL);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+}
+
+TEST(TestDVDDemuxPacketPool, Reuse)
+{
+  CDVDDemuxPacketPool* pool = new CDVDDemuxPacketPool();
+  CDVDDemuxPacketPool::SetCurrent(pool);
+
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(1000);
+  ASSERT_TRUE(packet != NULL);
+  memset(packet->pData, 0xff, 1000);
+  unsigned char* data = packet->pData;
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+
+  // same size class, so the block comes back with clean padding
+  packet = CDVDDemuxUtils::AllocateDemuxPacket(600);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_EQ(data, packet->pData);
+  for (int i = 0; i < FF_INPUT_BUFFER_PADDING_SIZE; i++)
+    EXPECT_EQ(0, packet->pData[600 + i]);
+
+  SDemuxPacketPoolStats stats;
+  pool->GetStats(stats);
+  EXPECT_EQ(1U, stats.hits);
+  EXPECT_EQ(1U, stats.misses);
+  EXPECT_GT(stats.residentBytes, 1024);
+  EXPECT_EQ(0, stats.cachedBytes);
+
+  // packets outlive the player closing its pool
+  CDVDDemuxPacketPool::SetCurrent(NULL);
+  pool->Drop();
+  pool->Release();
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+}
+
+TEST(TestDVDDemuxPacketPool, ReferencedPayload)
+{
+  CDVDDemuxPacketPool::SetCurrent(NULL);
+
+  AVPacket pkt;
+  ASSERT_EQ(0, av_new_packet(&pkt, 100));
+  memset(pkt.data, 0x42, 100);
+
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(&pkt);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_EQ(pkt.data, packet->pData);
+  EXPECT_EQ(100, packet->iSize);
+
+  // the demuxer drops its reference right away, the payload stays valid
+  av_free_packet(&pkt);
+  for (int i = 0; i < 100; i++)
+    EXPECT_EQ(0x42, packet->pData[i]);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+}
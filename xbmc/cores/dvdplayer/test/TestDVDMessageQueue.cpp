@@ -0,0 +1,157 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+static CDVDMsg* NewPacket(int index, int size = 64)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(size);
+  packet->iSize = size;
+  packet->pts   = index;
+  return new CDVDMsgDemuxerPacket(packet, false);
+}
+
+static double PacketIndex(CDVDMsg* msg)
+{
+  return ((CDVDMsgDemuxerPacket*)msg)->GetPacket()->pts;
+}
+
+class PacketProducer : public IRunnable
+{
+public:
+  PacketProducer(CDVDMessageQueue& queue, int count)
+  : m_queue(queue), m_count(count)
+  {
+  }
+
+  virtual void Run()
+  {
+    for (int i = 0; i < m_count; i++)
+    {
+      // like CDVDPlayer, hold back while the stream player is full
+      while (m_queue.GetDataSize() >= m_queue.GetMaxDataSize())
+        XbmcThreads::ThreadSleep(0);
+      m_queue.Put(NewPacket(i));
+    }
+  }
+
+  CDVDMessageQueue& m_queue;
+  int m_count;
+};
+
+TEST(TestDVDMessageQueue, RingKeepsPutOrder)
+{
+  CDVDMessageQueue queue("test");
+  queue.SetPacketRingSize(4);
+  queue.Init();
+  EXPECT_TRUE(queue.HasPacketRing());
+
+  // more packets than the ring holds, the rest overflows into the list
+  queue.Put(NewPacket(0));
+  queue.Put(NewPacket(1));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  for (int i = 2; i < 8; i++)
+    queue.Put(NewPacket(i));
+  queue.Put(new CDVDMsg(CDVDMsg::PLAYER_STARTED), 1);
+
+  EXPECT_EQ(8U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(8 * 64, queue.GetDataSize());
+
+  CDVDMsg* msg;
+  int priority = 0;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::PLAYER_STARTED));
+  EXPECT_EQ(1, priority);
+  msg->Release();
+
+  for (int i = 0; i < 8; i++)
+  {
+    if (i == 2)
+    {
+      ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+      EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+      msg->Release();
+    }
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    ASSERT_TRUE(msg->IsType(CDVDMsg::DEMUXER_PACKET));
+    EXPECT_EQ(i, PacketIndex(msg));
+    msg->Release();
+  }
+
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, RingFlush)
+{
+  CDVDMessageQueue queue("test");
+  queue.SetPacketRingSize(16);
+  queue.Init();
+
+  for (int i = 0; i < 8; i++)
+    queue.Put(NewPacket(i));
+  queue.Flush();
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  queue.Put(NewPacket(100));
+  EXPECT_EQ(64, queue.GetDataSize());
+
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_EQ(100, PacketIndex(msg));
+  msg->Release();
+
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, RingAcrossThreads)
+{
+  CDVDMessageQueue queue("test");
+  queue.SetPacketRingSize(64);
+  queue.SetMaxDataSize(128 * 64);
+  queue.Init();
+
+  // the producer fills the ring while the consumer empties it
+  PacketProducer producer(queue, 20000);
+  CThread thread(&producer, "TestProducer");
+  thread.Create();
+
+  int received = 0;
+  CDVDMsg* msg;
+  while (received < producer.m_count && queue.Get(&msg, 1000) == MSGQ_OK)
+  {
+    EXPECT_EQ(received, PacketIndex(msg));
+    msg->Release();
+    received++;
+  }
+  thread.WaitForThreadExit((unsigned int)-1);
+  EXPECT_EQ(producer.m_count, received);
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
@@ -24,6 +24,7 @@
 #include "filesystem/File.h"
 #include "profiles/ProfilesManager.h"
 #include "utils/AutoPtrHandle.h"
+#include "utils/LibraryIndex.h"
 #include "utils/log.h"
 #include "utils/SortUtils.h"
 #include "utils/URIUtils.h"
@@ -32,6 +33,9 @@
 #include "DatabaseManager.h"
 #include "DbUrl.h"
 
+#include <algorithm>
+#include <map>
+
 #ifdef HAS_MYSQL
 #include "mysqldataset.h"
 #endif
@@ -163,6 +167,26 @@ std::string CDatabase::GetSingleValue(const std::string &query, std::auto_ptr<Da
   return ret;
 }
 
+std::string CDatabase::GetSingleValue(const std::string &query, const BindList &params, std::auto_ptr<Dataset> &ds)
+{
+  std::string ret;
+  try
+  {
+    if (!m_pDB.get() || !ds.get())
+      return ret;
+
+    if (ds->query(query, params) && ds->num_rows() > 0)
+      ret = ds->fv(0).get_asString();
+
+    ds->close();
+  }
+  catch(...)
+  {
+    CLog::Log(LOGERROR, "%s - failed on query '%s'", __FUNCTION__, query.c_str());
+  }
+  return ret;
+}
+
 std::string CDatabase::GetSingleValue(const std::string &strTable, const std::string &strColumn, const std::string &strWhereClause /* = std::string() */, const std::string &strOrderBy /* = std::string() */)
 {
   std::string query = PrepareSQL("SELECT %s FROM %s", strColumn.c_str(), strTable.c_str());
@@ -720,6 +744,85 @@ bool CDatabase::BuildSQL(const std::string &strQuery, const Filter &filter, std:
   return true;
 }
 
+bool CDatabase::GetIndexedPage(const std::string &view, const MediaType &mediaType, const Filter &filter,
+                               const SortDescription &sorting, DatabaseResults &results, int &total)
+{
+  if (m_pDB.get() == NULL || m_pDS.get() == NULL || !m_pDB->tracks_writes())
+    return false;
+
+  // the index only knows complete rows of the view in its own order
+  if (!CLibraryIndex::CanServe(sorting) || !filter.order.empty() || !filter.limit.empty() ||
+      (!filter.fields.empty() && filter.fields != "*" && filter.fields != view + ".*"))
+    return false;
+
+  std::string idField = DatabaseUtils::GetField(FieldId, mediaType, DatabaseQueryPartSelect);
+  int idIndex = DatabaseUtils::GetFieldIndex(FieldId, mediaType);
+  if (idField.empty() || idIndex < 0)
+    return false;
+
+  try
+  {
+    // only the ids of the matching items are needed from the database to apply the filter
+    std::vector<int> matching;
+    bool filtered = !filter.join.empty() || !filter.where.empty();
+    if (filtered)
+    {
+      std::string strSQL;
+      BuildSQL(PrepareSQL("SELECT DISTINCT %s FROM %s ", idField.c_str(), view.c_str()), filter, strSQL);
+      if (!m_pDS->query(strSQL.c_str()))
+        return false;
+
+      matching.reserve(m_pDS->num_rows());
+      while (!m_pDS->eof())
+      {
+        matching.push_back(m_pDS->fv(0).get_asInt());
+        m_pDS->next();
+      }
+      m_pDS->close();
+      std::sort(matching.begin(), matching.end());
+    }
+
+    std::vector<int> ids;
+    if (!CLibraryIndex::Get().GetPage(m_pDB.get(), mediaType, view, sorting, filtered ? &matching : NULL, ids, total))
+      return false;
+
+    results.clear();
+    if (ids.empty())
+      return true;
+
+    std::string strSQL = PrepareSQL("SELECT * FROM %s WHERE %s IN (", view.c_str(), idField.c_str());
+    for (std::vector<int>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+      strSQL += StringUtils::Format("%i,", *it);
+    strSQL[strSQL.size() - 1] = ')';
+    if (!m_pDS->query(strSQL.c_str()))
+      return false;
+
+    // put the rows of the page back into the order of the index
+    std::map<int, unsigned int> rows;
+    const dbiplus::query_data &data = m_pDS->get_result_set().records;
+    for (unsigned int row = 0; row < data.size(); row++)
+      rows[data[row]->at(idIndex).get_asInt()] = row;
+
+    results.reserve(ids.size());
+    for (std::vector<int>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+    {
+      std::map<int, unsigned int>::const_iterator row = rows.find(*it);
+      if (row == rows.end())
+        continue;
+
+      DatabaseResult result;
+      result[FieldRow] = row->second;
+      results.push_back(result);
+    }
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to list %s", __FUNCTION__, view.c_str());
+  }
+  return false;
+}
+
 bool CDatabase::BuildSQL(const std::string &strBaseDir, const std::string &strQuery, Filter &filter, std::string &strSQL, CDbUrl &dbUrl)
 {
   SortDescription sorting;
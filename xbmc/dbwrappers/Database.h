@@ -23,12 +23,15 @@
 namespace dbiplus {
   class Database;
   class Dataset;
+  class field_value;
 }
 
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "utils/DatabaseUtils.h"
+
 class DatabaseSettings; // forward
 class CDbUrl;
 struct SortDescription;
@@ -92,6 +95,16 @@ public:
    */
   std::string GetSingleValue(const std::string &query, std::auto_ptr<dbiplus::Dataset> &ds);
 
+  /*! \brief Get a single value from a query with bound parameters on a dataset.
+   The compiled query is kept in the connection's statement cache, so prefer this
+   for lookups that are run often with different values.
+   \param query the query in question, with a '?' in place of each parameter.
+   \param params the values to bind to the query, in order.
+   \param ds the dataset to use for the query.
+   \return the value from the query, empty on failure.
+   */
+  std::string GetSingleValue(const std::string &query, const std::vector<dbiplus::field_value> &params, std::auto_ptr<dbiplus::Dataset> &ds);
+
   /*!
    * @brief Delete values from a table.
    * @param strTable The table to delete the values from.
@@ -204,6 +217,21 @@ protected:
 
   bool BuildSQL(const std::string &strQuery, const Filter &filter, std::string &strSQL);
 
+  /*! \brief Query a sorted page of a library view through the in-memory library index.
+   Only the rows of the requested page are queried into m_pDS, results holds their
+   row numbers in sort order like SortUtils::SortFromDataset() would.
+   \param view name of the view to list
+   \param mediaType media type of the items in the view
+   \param filter filter of the listing, the ids matching it are queried from the view
+   \param sorting sort description and page limits of the listing
+   \param results [out] row numbers of the rows of the page in sort order
+   \param total [out] number of items matching the filter
+   \return true if the page was served from the index, false if the listing has to be queried and sorted as usual
+   \sa CLibraryIndex
+   */
+  bool GetIndexedPage(const std::string &view, const MediaType &mediaType, const Filter &filter,
+                      const SortDescription &sorting, DatabaseResults &results, int &total);
+
   bool m_sqlite; ///< \brief whether we use sqlite (defaults to true)
 
   std::auto_ptr<dbiplus::Database> m_pDB;
@@ -28,7 +28,11 @@
 
 #include "dataset.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #include <cstring>
+#include <map>
 
 #ifndef __GNUC__
 #pragma warning (disable:4800)
@@ -48,6 +52,9 @@ Database::Database() {
   login = "";
   passwd = "";
   sequence_table = "db_sequence";
+  query_count = 0;
+  memset(query_latency, 0, sizeof(query_latency));
+  query_time_total = query_time_max = 0;
 }
 
 Database::~Database() {
@@ -81,6 +88,65 @@ string Database::prepare(const char *format, ...)
   return result;
 }
 
+void Database::add_query_time(int64_t ticks)
+{
+  int64_t us = ticks * 1000000 / CurrentHostFrequency();
+  unsigned int bucket = 0;
+  for (int64_t limit = 100; bucket < DB_LATENCY_BUCKETS - 1 && us >= limit; limit *= 10)
+    bucket++;
+
+  query_latency[bucket]++;
+  query_count++;
+  query_time_total += ticks;
+  if (ticks > query_time_max)
+    query_time_max = ticks;
+}
+
+void Database::log_query_stats()
+{
+  if (query_count == 0)
+    return;
+
+  double ms = CurrentHostFrequency() / 1000.0;
+  CLog::Log(LOGDEBUG, "Database %s: %u queries, avg %.3f ms, max %.3f ms "
+            "(<0.1ms: %u, <1ms: %u, <10ms: %u, <100ms: %u, <1s: %u, >=1s: %u)",
+            db.c_str(), query_count, query_time_total / ms / query_count, query_time_max / ms,
+            query_latency[0], query_latency[1], query_latency[2],
+            query_latency[3], query_latency[4], query_latency[5]);
+
+  query_count = 0;
+  memset(query_latency, 0, sizeof(query_latency));
+  query_time_total = query_time_max = 0;
+}
+
+static CCriticalSection s_writeGenerationSection;
+static map<string, unsigned int> s_writeGenerations;
+
+void Database::bump_write_generation()
+{
+  CSingleLock lock(s_writeGenerationSection);
+  s_writeGenerations[host + "/" + db]++;
+}
+
+unsigned int Database::get_write_generation() const
+{
+  CSingleLock lock(s_writeGenerationSection);
+  map<string, unsigned int>::const_iterator it = s_writeGenerations.find(host + "/" + db);
+  return it != s_writeGenerations.end() ? it->second : 0;
+}
+
+//************* query_timer implementation ***************
+
+query_timer::query_timer(Database *newDb) {
+  db = newDb;
+  start = CurrentHostCounter();
+}
+
+query_timer::~query_timer() {
+  if (db)
+    db->add_query_time(CurrentHostCounter() - start);
+}
+
 //************* Dataset implementation ***************
 
 Dataset::Dataset() {
@@ -199,6 +265,66 @@ void Dataset::parse_sql(string &sql) {
 }
 
 
+string Dataset::bind_sql(const string &sql, const BindList &params) {
+  if (db == NULL) throw DbErrors("No Database Connection");
+
+  string result;
+  result.reserve(sql.size() + params.size() * 8);
+  unsigned int next = 0;
+  char quote = 0;
+  for (string::const_iterator i = sql.begin(); i != sql.end(); ++i) {
+    if (quote) {
+      if (*i == quote)
+        quote = 0;
+    }
+    else if (*i == '\'' || *i == '"')
+      quote = *i;
+    else if (*i == '?') {
+      if (next >= params.size())
+        throw DbErrors("Not enough parameters for query: %s", sql.c_str());
+
+      const field_value &value = params[next++];
+      if (value.get_isNull()) {
+        result += "NULL";
+        continue;
+      }
+      switch (value.get_fType()) {
+      case ft_String:
+      case ft_Char:
+      case ft_WChar:
+      case ft_WideString:
+        result += db->prepare("'%s'", value.get_asString().c_str());
+        break;
+      case ft_Boolean:
+        result += value.get_asBool() ? "1" : "0";
+        break;
+      case ft_Float:
+      case ft_Double:
+      case ft_LongDouble: {
+        char t[32];
+        sprintf(t, "%.17g", value.get_asDouble());
+        result += t;
+        break;
+      }
+      default:
+        result += value.get_asString();
+        break;
+      }
+      continue;
+    }
+    result += *i;
+  }
+  return result;
+}
+
+bool Dataset::query(const string &sql, const BindList &params) {
+  return query(bind_sql(sql, params));
+}
+
+int Dataset::exec(const string &sql, const BindList &params) {
+  return exec(bind_sql(sql, params));
+}
+
 void Dataset::close(void) {
   haveError  = false;
   frecno = 0;
@@ -34,6 +34,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
 #include "qry_dat.h"
 #include <stdarg.h>
 
@@ -60,6 +61,8 @@ class Dataset;		// forward declaration of class Dataset
 #define DB_UNEXPECTED		7	// This shouldn't ever happen
 #define DB_UNEXPECTED_RESULT   -1       //For integer functions
 
+#define DB_LATENCY_BUCKETS      6       // <0.1ms, <1ms, <10ms, <100ms, <1s, >=1s
+
 /******************* Class Database definition ********************
 
    represents  connection with database server;
@@ -74,6 +77,11 @@ protected:
     default_charset, //Default character set
     key, cert, ca, capath, ciphers; //SSL - Encryption info
 
+/* query latency histogram */
+  unsigned int query_count;
+  unsigned int query_latency[DB_LATENCY_BUCKETS];
+  int64_t query_time_total, query_time_max;
+
 public:
 /* constructor */
   Database();
@@ -167,6 +175,33 @@ public:
 
   virtual bool in_transaction() {return false;};
 
+/* adds the duration of a query (in host counter ticks) to the latency histogram */
+  void add_query_time(int64_t ticks);
+/* writes the latency histogram to the log at debug level and resets it */
+  virtual void log_query_stats();
+
+/* marks the data of this database as changed for every connection of the process */
+  void bump_write_generation();
+/* returns a counter that changes whenever a connection of the process writes to this database */
+  unsigned int get_write_generation() const;
+/* true if all writes to this database go through this process, so the write generation can be trusted */
+  virtual bool tracks_writes() const { return false; }
+
+};
+
+
+/******************* Class query_timer definition *****************
+
+   adds its own lifetime to the latency histogram of a connection
+
+******************************************************************/
+class query_timer {
+public:
+  query_timer(Database *newDb);
+  ~query_timer();
+private:
+  Database *db;
+  int64_t start;
 };
 
 
@@ -185,6 +220,7 @@ enum sqlType {sqlSelect,sqlUpdate,sqlInsert,sqlDelete,sqlExec};
 
 typedef std::list<std::string> StringList;
 typedef std::map<std::string,field_value> ParamList;
+typedef std::vector<field_value> BindList;	// values for '?' placeholders, in order
 
 
 class Dataset  {
@@ -262,6 +298,9 @@ protected:
 /* Parse Sql - replacing fields with prefixes :OLD_ and :NEW_ with current values of OLD or NEW field. */
   void parse_sql(std::string &sql);
 
+/* Replaces each '?' outside of quotes in sql with the escaped literal of the next value of params */
+  std::string bind_sql(const std::string &sql, const BindList &params);
+
 /* Returns old field value (for :OLD) */
   virtual const field_value f_old(const char *f);
 
@@ -310,6 +349,11 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &sql) = 0;
+/* as query and exec, but with each '?' in sql bound to the next value of params.
+   Statements that only differ in their parameters have the same text, so drivers
+   can keep them compiled; the default implementation binds the values into the text */
+  virtual bool query(const std::string &sql, const BindList &params);
+  virtual int  exec (const std::string &sql, const BindList &params);
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -198,6 +198,7 @@ int MysqlDatabase::connect(bool create_new) {
 void MysqlDatabase::disconnect(void) {
   if (conn != NULL)
   {
+    log_query_stats();
     mysql_close(conn);
     conn = NULL;
   }
@@ -1430,6 +1431,7 @@ static size_t ci_find(const string& where, const string& what)
 
 int MysqlDataset::exec(const string &sql) {
   if (!handle()) throw DbErrors("No Database Connection");
+  query_timer timer(db);
   string qry = sql;
   int res = 0;
   exec_res.clear();
@@ -1480,6 +1482,7 @@ bool MysqlDataset::query(const std::string &query) {
     throw DbErrors("MUST be select SQL!");
 
   close();
+  query_timer timer(db);
 
   size_t loc;
 
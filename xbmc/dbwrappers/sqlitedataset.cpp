@@ -91,6 +91,8 @@ SqliteDatabase::SqliteDatabase() {
 
   active = false;  
   _in_transaction = false;    // for transaction
+  _transaction_writes = false;
+  stmt_hits = stmt_misses = 0;
 
   error = "Unknown database error";//S_NO_CONNECTION;
   host = "localhost";
@@ -258,10 +260,52 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  log_query_stats();
+  clear_statements();
   sqlite3_close(conn);
   active = false;
 }
 
+sqlite3_stmt *SqliteDatabase::get_statement(const string &sql) {
+  map<string, StatementList::iterator>::iterator i = stmt_index.find(sql);
+  if (i != stmt_index.end())
+  {
+    stmt_hits++;
+    stmt_cache.splice(stmt_cache.begin(), stmt_cache, i->second);
+    return i->second->second;
+  }
+
+  stmt_misses++;
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+    return NULL;
+
+  stmt_cache.push_front(make_pair(sql, stmt));
+  stmt_index[sql] = stmt_cache.begin();
+  if (stmt_index.size() > DB_STATEMENT_CACHE_SIZE)
+  {
+    sqlite3_finalize(stmt_cache.back().second);
+    stmt_index.erase(stmt_cache.back().first);
+    stmt_cache.pop_back();
+  }
+  return stmt;
+}
+
+void SqliteDatabase::clear_statements() {
+  for (StatementList::iterator i = stmt_cache.begin(); i != stmt_cache.end(); ++i)
+    sqlite3_finalize(i->second);
+  stmt_cache.clear();
+  stmt_index.clear();
+}
+
+void SqliteDatabase::log_query_stats() {
+  if (stmt_hits + stmt_misses > 0)
+    CLog::Log(LOGDEBUG, "Database %s: statement cache %u hits, %u misses, %u cached",
+              db.c_str(), stmt_hits, stmt_misses, (unsigned int)stmt_index.size());
+  stmt_hits = stmt_misses = 0;
+  Database::log_query_stats();
+}
+
 int SqliteDatabase::create() {
   return connect(true);
 }
@@ -395,13 +439,17 @@ void SqliteDatabase::start_transaction() {
   if (active) {
     sqlite3_exec(conn,"begin IMMEDIATE",NULL,NULL,NULL);
     _in_transaction = true;
+    _transaction_writes = false;
   }
 }
 
 void SqliteDatabase::commit_transaction() {
   if (active) {
-    sqlite3_exec(conn,"commit",NULL,NULL,NULL);
+    int res = sqlite3_exec(conn,"commit",NULL,NULL,NULL);
     _in_transaction = false;
+    if (res == SQLITE_OK && _transaction_writes)
+      bump_write_generation();
+    _transaction_writes = false;
   }
 }
 
@@ -409,9 +457,19 @@ void SqliteDatabase::rollback_transaction() {
   if (active) {
     sqlite3_exec(conn,"rollback",NULL,NULL,NULL);
     _in_transaction = false;
+    _transaction_writes = false;
   }  
 }
 
+void SqliteDatabase::note_changes(int changes_before) {
+  if (sqlite3_total_changes(conn) == changes_before)
+    return;
+  if (_in_transaction)
+    _transaction_writes = true;
+  else
+    bump_write_generation();
+}
+
 
 // methods for formatting
 // ---------------------------------------------
@@ -578,6 +636,7 @@ bool SqliteDataset::dropIndex(const char *table, const char *index)
 
 int SqliteDataset::exec(const string &sql) {
   if (!handle()) throw DbErrors("No Database Connection");
+  query_timer timer(db);
   string qry = sql;
   int res;
   exec_res.clear();
@@ -620,8 +679,13 @@ int SqliteDataset::exec(const string &sql) {
       qry = qry.substr(0, pos);
   }
 
-  if((res = db->setErr(sqlite3_exec(handle(),qry.c_str(),&callback,&exec_res,&errmsg),qry.c_str())) == SQLITE_OK)
+  int changes = sqlite3_total_changes(handle());
+  res = db->setErr(sqlite3_exec(handle(),qry.c_str(),&callback,&exec_res,&errmsg),qry.c_str());
+  if (res == SQLITE_OK)
+  {
+    static_cast<SqliteDatabase*>(db)->note_changes(changes);
     return res;
+  }
   else
     {
       throw DbErrors(db->getErrorMsg());
@@ -646,11 +710,105 @@ bool SqliteDataset::query(const std::string &query) {
          throw DbErrors("MUST be select SQL!"); 
 
   close();
+  query_timer timer(db);
 
   sqlite3_stmt *stmt = NULL;
   if (db->setErr(sqlite3_prepare_v2(handle(),query.c_str(),-1,&stmt, NULL),query.c_str()) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
 
+  fetch_rows(stmt);
+  if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
+  {
+    active = true;
+    ds_state = dsSelect;
+    this->first();
+    return true;
+  }
+  else
+  {
+    throw DbErrors(db->getErrorMsg());
+  }  
+}
+
+bool SqliteDataset::query(const std::string &sql, const BindList &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+  close();
+  query_timer timer(db);
+
+  sqlite3_stmt *stmt = bind_statement(sql, params);
+  fetch_rows(stmt);
+  // reset releases the statement's read lock, the compiled statement stays cached
+  if (db->setErr(sqlite3_reset(stmt), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+int SqliteDataset::exec(const std::string &sql, const BindList &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+  query_timer timer(db);
+
+  sqlite3_stmt *stmt = bind_statement(sql, params);
+  int changes = sqlite3_total_changes(handle());
+  while (sqlite3_step(stmt) == SQLITE_ROW)
+    ;
+  int res = db->setErr(sqlite3_reset(stmt), sql.c_str());
+  if (res != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  static_cast<SqliteDatabase*>(db)->note_changes(changes);
+  return res;
+}
+
+sqlite3_stmt *SqliteDataset::bind_statement(const std::string &sql, const BindList &params) {
+  SqliteDatabase *sqlite = static_cast<SqliteDatabase*>(db);
+  sqlite3_stmt *stmt = sqlite->get_statement(sql);
+  if (stmt == NULL)
+    throw DbErrors(db->getErrorMsg());
+
+  if ((int)params.size() != sqlite3_bind_parameter_count(stmt))
+    throw DbErrors("Wrong number of parameters for query: %s", sql.c_str());
+
+  for (unsigned int i = 0; i < params.size(); i++)
+  {
+    const field_value &value = params[i];
+    int res;
+    if (value.get_isNull())
+      res = sqlite3_bind_null(stmt, i + 1);
+    else
+    {
+      switch (value.get_fType())
+      {
+      case ft_Boolean:
+      case ft_Short:
+      case ft_UShort:
+      case ft_Int:
+      case ft_UInt:
+      case ft_Int64:
+        res = sqlite3_bind_int64(stmt, i + 1, value.get_asInt64());
+        break;
+      case ft_Float:
+      case ft_Double:
+        res = sqlite3_bind_double(stmt, i + 1, value.get_asDouble());
+        break;
+      default:
+      {
+        const std::string text = value.get_asString();
+        res = sqlite3_bind_text(stmt, i + 1, text.c_str(), text.size(), SQLITE_TRANSIENT);
+        break;
+      }
+      }
+    }
+    if (db->setErr(res, sql.c_str()) != SQLITE_OK)
+      throw DbErrors(db->getErrorMsg());
+  }
+  return stmt;
+}
+
+void SqliteDataset::fetch_rows(sqlite3_stmt *stmt) {
   // column headers
   const unsigned int numColumns = sqlite3_column_count(stmt);
   result.record_header.resize(numColumns);
@@ -688,17 +846,6 @@ bool SqliteDataset::query(const std::string &query) {
     }
     result.records.push_back(res);
   }
-  if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
-  {
-    active = true;
-    ds_state = dsSelect;
-    this->first();
-    return true;
-  }
-  else
-  {
-    throw DbErrors(db->getErrorMsg());
-  }  
 }
 
 void SqliteDataset::open(const string &sql) {
@@ -34,6 +34,9 @@
 #include <sqlite3.h>
 
 namespace dbiplus {
+
+#define DB_STATEMENT_CACHE_SIZE 64	// compiled statements kept per connection
+
 /***************** Class SqliteDatabase definition ******************
 
        class 'SqliteDatabase' connects with Sqlite-server
@@ -44,8 +47,15 @@ protected:
 /* connect descriptor */
   sqlite3 *conn;
   bool _in_transaction;
+  bool _transaction_writes;   // rows were changed in the open transaction
   int last_err;
 
+/* prepared statement cache, most recently used first */
+  typedef std::list< std::pair<std::string, sqlite3_stmt*> > StatementList;
+  StatementList stmt_cache;
+  std::map<std::string, StatementList::iterator> stmt_index;
+  unsigned int stmt_hits, stmt_misses;
+
 public:
 /* default constructor */
   SqliteDatabase();
@@ -97,6 +107,19 @@ public:
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* bumps the write generation if rows changed since changes_before, or on commit inside a transaction */
+  void note_changes(int changes_before);
+
+/* returns the compiled statement for sql from the statement cache, preparing
+   (and possibly evicting the least recently used one) on a miss. Returns NULL on error */
+  sqlite3_stmt *get_statement(const std::string &sql);
+/* finalizes all cached statements */
+  void clear_statements();
+
+  virtual void log_query_stats();
+/* a sqlite database is only ever written by this process */
+  virtual bool tracks_writes() const { return true; }
+
 };
 
 
@@ -122,6 +145,11 @@ protected:
 
   //static int sqlite_callback(void* res_ptr,int ncol, char** reslt, char** cols);
 
+/* Fills the result set from a prepared statement */
+  void fetch_rows(sqlite3_stmt *stmt);
+/* Gets a cached statement for sql and binds params to it */
+  sqlite3_stmt *bind_statement(const std::string &sql, const BindList &params);
+
 /* This function works only with MySQL database
   Filling the fields information from select statement */
   virtual void fill_fields();
@@ -149,6 +177,9 @@ or insert() operations default = false) */
   virtual const void* getExecRes();
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &query);
+/* as query and exec, using the connection's prepared statement cache */
+  virtual bool query(const std::string &sql, const BindList &params);
+  virtual int  exec (const std::string &sql, const BindList &params);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
@@ -61,6 +61,11 @@ void CCacheStrategy::ClearEndOfInput()
   m_bEndOfInput = false;
 }
 
+int64_t CCacheStrategy::GetFreeSize()
+{
+  return -1;
+}
+
 CSimpleFileCache::CSimpleFileCache()
   : m_cacheFileRead(new CacheLocalFile())
   , m_cacheFileWrite(new CacheLocalFile())
@@ -311,6 +316,11 @@ size_t CDoubleCache::GetMaxWriteSize(const size_t& iRequestSize)
   return m_pCache->GetMaxWriteSize(iRequestSize); // NOTE: Check the active cache only
 }
 
+int64_t CDoubleCache::GetFreeSize()
+{
+  return m_pCache->GetFreeSize();
+}
+
 int CDoubleCache::WriteToCache(const char *pBuffer, size_t iSize)
 {
   return m_pCache->WriteToCache(pBuffer, iSize);
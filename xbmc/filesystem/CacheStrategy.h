@@ -49,6 +49,12 @@ public:
   virtual int ReadFromCache(char *pBuffer, size_t iMaxSize) = 0;
   virtual int64_t WaitForData(unsigned int iMinAvail, unsigned int iMillis) = 0;
 
+  /*!
+   \brief Get the space left for new data in the cache
+   \return the number of bytes that can still be written, or -1 if the cache is unbounded
+   */
+  virtual int64_t GetFreeSize();
+
   virtual int64_t Seek(int64_t iFilePosition) = 0;
 
   /*!
@@ -124,6 +130,7 @@ public:
   virtual int WriteToCache(const char *pBuffer, size_t iSize) ;
   virtual int ReadFromCache(char *pBuffer, size_t iMaxSize) ;
   virtual int64_t WaitForData(unsigned int iMinAvail, unsigned int iMillis) ;
+  virtual int64_t GetFreeSize();
 
   virtual int64_t Seek(int64_t iFilePosition);
   virtual bool Reset(int64_t iSourcePosition, bool clearAnyway=true);
@@ -88,6 +88,15 @@ size_t CCircularCache::GetMaxWriteSize(const size_t& iRequestSize)
   return std::min(iRequestSize, limit);
 }
 
+int64_t CCircularCache::GetFreeSize()
+{
+  CSingleLock lock(m_sync);
+
+  size_t back  = (size_t)(m_cur - m_beg); // Backbuffer size
+  size_t front = (size_t)(m_end - m_cur); // Frontbuffer size
+  return (int64_t)(m_size - std::min(back, m_size_back) - front);
+}
+
 /**
  * Function will write to m_buf at m_end % m_size location
  * it will write at maximum m_size, but it will only write
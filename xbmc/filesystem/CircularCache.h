@@ -37,6 +37,7 @@ public:
     virtual void Close();
 
     virtual size_t GetMaxWriteSize(const size_t& iRequestSize) ;
+    virtual int64_t GetFreeSize();
     virtual int WriteToCache(const char *buf, size_t len) ;
     virtual int ReadFromCache(char *buf, size_t len) ;
     virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis) ;
@@ -27,6 +27,9 @@
 #include "DirectoryCache.h"
 #include "Directory.h"
 #include "FileCache.h"
+#ifdef TARGET_POSIX
+#include "posix/PosixMMapFile.h"
+#endif
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/BitstreamStats.h"
@@ -249,6 +252,11 @@ bool CFile::Open(const CURL& file, const unsigned int flags)
       }
     }
 
+#ifdef TARGET_POSIX
+    if ((m_flags & READ_MMAP) && (url.IsProtocol("file") || url.GetProtocol().empty()))
+      m_pFile = new CPosixMMapFile();
+    else
+#endif
     m_pFile = CFileFactory::CreateLoader(url);
     if (!m_pFile)
       return false;
@@ -70,6 +70,9 @@ public:
 /* indicate the caller will seek between multiple streams in the file frequently */
 #define READ_MULTI_STREAM 0x20
 
+/* serve reads of local files from a memory mapping of the file */
+#define READ_MMAP 0x40
+
 class CFileStreamBuffer;
 
 class CFile
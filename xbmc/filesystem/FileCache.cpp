@@ -30,11 +30,19 @@
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "settings/AdvancedSettings.h"
+#include "cores/DataCacheCore.h"
+
+#include <list>
 
 using namespace AUTOPTR;
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (64*1024)
+#define READ_CACHE_SEGMENT_SIZE      (1024*1024)
+#define READ_CACHE_SEGMENT_SIZE_HTTP (2*1024*1024)
+
+#define READAHEAD_FAILED  -1
+#define READAHEAD_PENDING -2
 
 class CWriteRate
 {
@@ -95,6 +103,271 @@ private:
 };
 
 
+namespace XFILE
+{
+/*
+ * Segmented readahead. A set of reader threads, each with its own handle on
+ * the source, fetch consecutive segments ahead of the cache write position so
+ * several range requests are in flight at once on high latency sources. The
+ * cache thread consumes the segments in order through Read().
+ */
+class CCacheReadahead
+{
+public:
+  CCacheReadahead(const std::string& path, int64_t length, unsigned readers, unsigned segmentSize, unsigned window);
+  ~CCacheReadahead();
+
+  void    Reset(int64_t pos);
+  ssize_t Read(char* buffer, size_t size, unsigned int timeout);
+
+private:
+  enum SegmentState
+  {
+    SEGMENT_QUEUED,
+    SEGMENT_RUNNING,
+    SEGMENT_DONE,
+    SEGMENT_FAILED
+  };
+
+  struct SSegment
+  {
+    int64_t      pos;
+    unsigned     size;
+    char*        data;
+    SegmentState state;
+    bool         abandoned;
+  };
+
+  class CReader : public CThread
+  {
+  public:
+    CReader(CCacheReadahead& owner)
+      : CThread("FileCacheReader")
+      , m_owner(owner)
+    {}
+  protected:
+    virtual void Process();
+    CCacheReadahead& m_owner;
+  };
+
+  void      Schedule();
+  SSegment* Take();
+  void      Complete(SSegment* segment, bool success);
+  void      Discard(SSegment* segment);
+
+  std::string            m_path;
+  int64_t                m_length;
+  unsigned               m_segmentSize;
+  unsigned               m_window;
+  int64_t                m_next;
+  unsigned               m_offset;
+  std::list<SSegment*>   m_segments;
+  std::vector<CReader*>  m_readers;
+  CEvent                 m_work;
+  CEvent                 m_done;
+  CCriticalSection       m_section;
+};
+}
+
+CCacheReadahead::CCacheReadahead(const std::string& path, int64_t length, unsigned readers, unsigned segmentSize, unsigned window)
+  : m_path(path)
+  , m_length(length)
+  , m_segmentSize(segmentSize)
+  , m_window(window)
+  , m_next(0)
+  , m_offset(0)
+{
+  for (unsigned i = 0; i < readers; i++)
+  {
+    CReader* reader = new CReader(*this);
+    reader->Create();
+    m_readers.push_back(reader);
+  }
+}
+
+CCacheReadahead::~CCacheReadahead()
+{
+  for (std::vector<CReader*>::iterator it = m_readers.begin(); it != m_readers.end(); ++it)
+    (*it)->StopThread(false);
+  m_work.Set();
+  for (std::vector<CReader*>::iterator it = m_readers.begin(); it != m_readers.end(); ++it)
+  {
+    (*it)->StopThread(true);
+    delete *it;
+  }
+
+  for (std::list<SSegment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+  {
+    delete[] (*it)->data;
+    delete *it;
+  }
+}
+
+void CCacheReadahead::Discard(SSegment* segment)
+{
+  // a running segment is owned by its reader until it completes
+  if (segment->state == SEGMENT_RUNNING)
+    segment->abandoned = true;
+  else
+  {
+    delete[] segment->data;
+    delete segment;
+  }
+}
+
+void CCacheReadahead::Reset(int64_t pos)
+{
+  CSingleLock lock(m_section);
+
+  // keep whatever is already in flight after pos
+  while (!m_segments.empty() && m_segments.front()->pos + m_segments.front()->size <= pos)
+  {
+    Discard(m_segments.front());
+    m_segments.pop_front();
+  }
+
+  if (!m_segments.empty() && m_segments.front()->pos <= pos)
+  {
+    m_offset = (unsigned)(pos - m_segments.front()->pos);
+    return;
+  }
+
+  while (!m_segments.empty())
+  {
+    Discard(m_segments.front());
+    m_segments.pop_front();
+  }
+  m_next = pos;
+  m_offset = 0;
+}
+
+void CCacheReadahead::Schedule()
+{
+  bool queued = false;
+  while (m_segments.size() < m_window && m_next < m_length)
+  {
+    SSegment* segment = new SSegment;
+    segment->pos       = m_next;
+    segment->size      = (unsigned)std::min<int64_t>(m_segmentSize, m_length - m_next);
+    segment->data      = new char[segment->size];
+    segment->state     = SEGMENT_QUEUED;
+    segment->abandoned = false;
+    m_segments.push_back(segment);
+    m_next += segment->size;
+    queued = true;
+  }
+
+  if (queued)
+    m_work.Set();
+}
+
+CCacheReadahead::SSegment* CCacheReadahead::Take()
+{
+  CSingleLock lock(m_section);
+  for (std::list<SSegment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+  {
+    if ((*it)->state == SEGMENT_QUEUED)
+    {
+      (*it)->state = SEGMENT_RUNNING;
+      // pass the wakeup on if there is more work left
+      for (std::list<SSegment*>::iterator next = it; ++next != m_segments.end();)
+      {
+        if ((*next)->state == SEGMENT_QUEUED)
+        {
+          m_work.Set();
+          break;
+        }
+      }
+      return *it;
+    }
+  }
+  return NULL;
+}
+
+void CCacheReadahead::Complete(SSegment* segment, bool success)
+{
+  CSingleLock lock(m_section);
+  if (segment->abandoned)
+  {
+    delete[] segment->data;
+    delete segment;
+    return;
+  }
+  segment->state = success ? SEGMENT_DONE : SEGMENT_FAILED;
+  m_done.Set();
+}
+
+ssize_t CCacheReadahead::Read(char* buffer, size_t size, unsigned int timeout)
+{
+  CSingleLock lock(m_section);
+  Schedule();
+
+  if (m_segments.empty())
+    return 0;
+
+  // segments are only ever removed by this thread, the head stays the same
+  SSegment* segment = m_segments.front();
+  if (segment->state == SEGMENT_QUEUED || segment->state == SEGMENT_RUNNING)
+  {
+    CSingleExit exit(m_section);
+    m_done.WaitMSec(timeout);
+  }
+
+  if (segment->state == SEGMENT_FAILED)
+    return READAHEAD_FAILED;
+  if (segment->state != SEGMENT_DONE)
+    return READAHEAD_PENDING;
+
+  size = std::min<size_t>(size, segment->size - m_offset);
+  memcpy(buffer, segment->data + m_offset, size);
+  m_offset += size;
+  if (m_offset == segment->size)
+  {
+    m_segments.pop_front();
+    delete[] segment->data;
+    delete segment;
+    m_offset = 0;
+    Schedule();
+  }
+  return size;
+}
+
+void CCacheReadahead::CReader::Process()
+{
+  CFile file;
+  bool  opened = false;
+
+  while (!m_bStop)
+  {
+    SSegment* segment = m_owner.Take();
+    if (!segment)
+    {
+      m_owner.m_work.WaitMSec(100);
+      continue;
+    }
+
+    unsigned total = 0;
+    if (!opened)
+      opened = file.Open(m_owner.m_path, READ_NO_CACHE | READ_TRUNCATED | READ_CHUNKED);
+    if (opened && file.Seek(segment->pos, SEEK_SET) == segment->pos)
+    {
+      while (total < segment->size && !m_bStop)
+      {
+        ssize_t iRead = file.Read(segment->data + total, segment->size - total);
+        if (iRead <= 0)
+          break;
+        total += iRead;
+      }
+    }
+
+    if (total < segment->size && !m_bStop)
+      CLog::Log(LOGWARNING, "CCacheReadahead::Process - failed to read segment at %" PRId64, segment->pos);
+
+    m_owner.Complete(segment, total == segment->size);
+  }
+}
+
+
 CFileCache::CFileCache(bool useDoubleCache)
   : CThread("FileCache")
   , m_seekPossible(0)
@@ -102,6 +375,10 @@ CFileCache::CFileCache(bool useDoubleCache)
   , m_writeRate(0)
   , m_writeRateActual(0)
   , m_cacheFull(false)
+  , m_readahead(NULL)
+  , m_readers(1)
+  , m_stalls(0)
+  , m_infoStamp(0)
 {
    m_bDeleteCache = true;
    m_nSeekResult = 0;
@@ -134,6 +411,10 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache)
   , m_writeRate(0)
   , m_writeRateActual(0)
   , m_cacheFull(false)
+  , m_readahead(NULL)
+  , m_readers(1)
+  , m_stalls(0)
+  , m_infoStamp(0)
 {
   m_pCache = pCache;
   m_bDeleteCache = bDeleteCache;
@@ -205,11 +486,31 @@ bool CFileCache::Open(const CURL& url)
   m_seekPossible = m_source.IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
   m_chunkSize = CFile::GetChunkSize(m_source.GetChunkSize(), READ_CACHE_CHUNK_SIZE);
 
+  // keep several range requests in flight on seekable network sources
+  m_readers = 1;
+  if (g_advancedSettings.m_cacheReadThreads > 1 && m_seekPossible > 0 && m_source.GetLength() > 0
+  && (url.IsProtocol("http") || url.IsProtocol("https") || url.IsProtocol("smb") || url.IsProtocol("nfs")))
+  {
+    // internet sources have a higher per-request latency, so ask for larger ranges
+    unsigned segmentSize = url.IsProtocol("http") || url.IsProtocol("https") ? READ_CACHE_SEGMENT_SIZE_HTTP : READ_CACHE_SEGMENT_SIZE;
+    segmentSize = std::max<unsigned>(m_chunkSize, segmentSize);
+
+    m_readers = g_advancedSettings.m_cacheReadThreads;
+    unsigned window = m_readers * 2;
+    // the segments in flight come on top of the memory cache, keep them within a quarter of it
+    if (g_advancedSettings.m_cacheMemBufferSize > 0)
+      window = std::max(m_readers, std::min(window, g_advancedSettings.m_cacheMemBufferSize / 4 / segmentSize));
+
+    m_readahead = new CCacheReadahead(m_sourcePath, m_source.GetLength(), m_readers, segmentSize, window);
+  }
+
   m_readPos = 0;
   m_writePos = 0;
   m_writeRate = 1024 * 1024;
   m_writeRateActual = 0;
   m_cacheFull = false;
+  m_stalls = 0;
+  m_infoStamp = 0;
   m_seekEvent.Reset();
   m_seekEnded.Reset();
 
@@ -240,6 +541,8 @@ void CFileCache::Process()
 
   while (!m_bStop)
   {
+    UpdateCacheInfo();
+
     // check for seek events
     if (m_seekEvent.WaitMSec(0))
     {
@@ -247,7 +550,12 @@ void CFileCache::Process()
       int64_t cacheMaxPos = m_pCache->CachedDataEndPosIfSeekTo(m_seekPos);
       cacheReachEOF = (cacheMaxPos == m_source.GetLength());
       bool sourceSeekFailed = false;
-      if (!cacheReachEOF)
+      if (!cacheReachEOF && m_readahead)
+      {
+        m_readahead->Reset(cacheMaxPos);
+        m_nSeekResult = cacheMaxPos;
+      }
+      else if (!cacheReachEOF)
       {
         m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
         if (m_nSeekResult != cacheMaxPos)
@@ -305,7 +613,23 @@ void CFileCache::Process()
     }
 
     ssize_t iRead = 0;
-    if (!cacheReachEOF)
+    if (!cacheReachEOF && m_readahead)
+    {
+      iRead = m_readahead->Read(buffer.get(), maxWrite, 100);
+      if (iRead == READAHEAD_PENDING)
+        continue;
+      if (iRead == READAHEAD_FAILED)
+      {
+        CLog::Log(LOGWARNING, "CFileCache::Process - readahead failed at %" PRId64 ", falling back to a single reader", m_writePos);
+        delete m_readahead;
+        m_readahead = NULL;
+        m_readers = 1;
+        iRead = -1;
+        if (m_source.Seek(m_writePos, SEEK_SET) == m_writePos)
+          iRead = m_source.Read(buffer.get(), maxWrite);
+      }
+    }
+    else if (!cacheReachEOF)
       iRead = m_source.Read(buffer.get(), maxWrite);
     if (iRead == 0)
     {
@@ -409,6 +733,7 @@ retry:
 
   if (iRc == CACHE_RC_WOULD_BLOCK)
   {
+    m_stalls++;
     // just wait for some data to show up
     iRc = m_pCache->WaitForData(1, 10000);
     if (iRc > 0)
@@ -494,9 +819,43 @@ void CFileCache::Close()
   if (m_pCache)
     m_pCache->Close();
 
+  if (!m_sourcePath.empty())
+    CLog::Log(LOGDEBUG, "CFileCache::Close - %u reader(s), %u stall(s), average rate %u bytes/s",
+              m_readers, m_stalls, m_writeRateActual);
+  g_dataCacheCore.RemoveStreamCacheInfo(this);
+
+  delete m_readahead;
+  m_readahead = NULL;
+
   m_source.Close();
 }
 
+void CFileCache::UpdateCacheInfo()
+{
+  const unsigned now = XbmcThreads::SystemClockMillis();
+  if (now - m_infoStamp < 1000)
+    return;
+  m_infoStamp = now;
+
+  CURL url(m_sourcePath);
+  SStreamCacheInfo info;
+  info.source   = url.GetRedacted();
+  info.protocol = url.GetProtocol();
+  info.readers  = m_readers;
+  info.forward  = m_pCache->WaitForData(0, 0);
+  info.currate  = m_writeRateActual;
+  info.maxrate  = m_writeRate;
+  info.stalls   = m_stalls;
+
+  int64_t space = m_pCache->GetFreeSize();
+  if (space < 0)
+    info.level = 0; // unbounded cache, it never fills up
+  else
+    info.level = (info.forward + space) ? (unsigned)(info.forward * 100 / (info.forward + space)) : 100;
+
+  g_dataCacheCore.SetStreamCacheInfo(this, info);
+}
+
 int64_t CFileCache::GetPosition()
 {
   return m_readPos;
@@ -27,6 +27,7 @@
 
 namespace XFILE
 {
+  class CCacheReadahead;
 
   class CFileCache : public IFile, public CThread
   {
@@ -62,6 +63,8 @@ namespace XFILE
     virtual std::string GetContentCharset(void);
 
   private:
+    void UpdateCacheInfo();
+
     CCacheStrategy *m_pCache;
     bool      m_bDeleteCache;
     int        m_seekPossible;
@@ -77,6 +80,10 @@ namespace XFILE
     unsigned     m_writeRate;
     unsigned     m_writeRateActual;
     bool         m_cacheFull;
+    CCacheReadahead* m_readahead;
+    unsigned     m_readers;
+    unsigned     m_stalls;
+    unsigned     m_infoStamp;
     CCriticalSection m_sync;
   };
 
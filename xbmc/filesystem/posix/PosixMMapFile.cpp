@@ -0,0 +1,302 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined(TARGET_POSIX)
+
+#include "PosixMMapFile.h"
+#include "URL.h"
+#include "utils/log.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h" // for HAVE_POSIX_FADVISE
+#endif // HAVE_CONFIG_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <algorithm>
+
+// short seek heavy reads (tag scanners, probing) are cheaper with pread, the
+// file is only mapped once this much has been read sequentially
+#define MMAP_MIN_SEQUENTIAL (256 * 1024)
+// the mapped window doubles while reads stay sequential, the maximum still
+// maps on 32bit platforms
+#define MMAP_MIN_WINDOW     (1024 * 1024)
+#define MMAP_MAX_WINDOW     (32 * 1024 * 1024)
+// how far ahead of the read position the kernel is asked to fetch pages
+#define MMAP_READAHEAD      (4 * 1024 * 1024)
+
+using namespace XFILE;
+
+CPosixMMapFile::CPosixMMapFile() :
+  m_map(NULL), m_mapOffset(0), m_mapSize(0), m_fileSize(-1), m_pos(0),
+  m_adviseEnd(0), m_window(MMAP_MIN_WINDOW), m_sequential(0), m_lastEnd(0)
+{ }
+
+CPosixMMapFile::~CPosixMMapFile()
+{
+  Unmap();
+}
+
+bool CPosixMMapFile::Open(const CURL& url)
+{
+  if (!CPosixFile::Open(url))
+    return false;
+
+  // only regular files can be mapped, anything else is read as usual
+  struct stat64 st;
+  if (fstat64(m_fd, &st) == 0 && S_ISREG(st.st_mode))
+    m_fileSize = st.st_size;
+  else
+    m_fileSize = -1;
+
+  m_pos = 0;
+  m_sequential = 0;
+  m_lastEnd = 0;
+  return true;
+}
+
+bool CPosixMMapFile::OpenForWrite(const CURL& url, bool bOverWrite /* = false*/ )
+{
+  return false;
+}
+
+void CPosixMMapFile::Close()
+{
+  Unmap();
+  m_fileSize = -1;
+  m_pos = 0;
+  CPosixFile::Close();
+}
+
+bool CPosixMMapFile::Map(int64_t pos)
+{
+  if (m_map && pos == m_mapOffset + (int64_t)m_mapSize)
+    m_window = std::min<size_t>(m_window * 2, MMAP_MAX_WINDOW);
+  else
+    m_window = MMAP_MIN_WINDOW;
+
+  Unmap();
+
+  static const int64_t pageSize = sysconf(_SC_PAGESIZE);
+  const int64_t offset = pos - pos % pageSize;
+  const off_t offsetOffT = (off_t) offset;
+  if (sizeof(int64_t) != sizeof(off_t) && offset != offsetOffT)
+    return false;
+
+  const size_t size = (size_t)std::min<int64_t>(m_window, m_fileSize - offset);
+  if (size == 0)
+    return false;
+
+  void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, m_fd, offsetOffT);
+  if (map == MAP_FAILED)
+  {
+    CLog::Log(LOGDEBUG, "CPosixMMapFile::Map - failed to map %" PRId64 " bytes at %" PRId64 ", reading instead", (int64_t)size, offset);
+    return false;
+  }
+
+  m_map = (uint8_t*)map;
+  m_mapOffset = offset;
+  m_mapSize = size;
+  m_adviseEnd = offset;
+  madvise(m_map, m_mapSize, MADV_SEQUENTIAL);
+  return true;
+}
+
+void CPosixMMapFile::FallBack()
+{
+  Unmap();
+  m_fileSize = -1;
+  CPosixFile::Seek(m_pos, SEEK_SET);
+}
+
+bool CPosixMMapFile::CheckSize()
+{
+  // pages past the end of a file truncated while it is mapped raise SIGBUS
+  // when touched, so the size is checked again before each new window is
+  // mapped, which is when a read or seek goes past the current one. Reads
+  // within a window make no syscall, files that change under us are read
+  // with read() from then on.
+  struct stat64 st;
+  if (fstat64(m_fd, &st) == 0 && st.st_size == m_fileSize)
+    return true;
+
+  CLog::Log(LOGDEBUG, "CPosixMMapFile::CheckSize - file size changed while mapped, reading instead");
+  FallBack();
+  return false;
+}
+
+ssize_t CPosixMMapFile::ReadAt(void* lpBuf, size_t uiBufSize, int64_t pos)
+{
+#ifdef TARGET_ANDROID
+  // Android doesn't substitute off64_t for off_t and similar functions
+  return pread64(m_fd, lpBuf, uiBufSize, (off64_t)pos);
+#else  // !TARGET_ANDROID
+  const off_t posOffT = (off_t) pos;
+  // check for parameter overflow
+  if (sizeof(int64_t) != sizeof(off_t) && pos != posOffT)
+  {
+    errno = EOVERFLOW;
+    return -1;
+  }
+  return pread(m_fd, lpBuf, uiBufSize, posOffT);
+#endif // !TARGET_ANDROID
+}
+
+void CPosixMMapFile::DropCache()
+{
+#if defined(HAVE_POSIX_FADVISE)
+  // as CPosixFile does, drop the cache between the last drop and 16 MB behind
+  // where we are now, never the first 16 MB and never less than 1 MB at once.
+  // Pages still mapped stay in the cache, the window is well within that.
+  const int64_t end_drop = m_pos - 16 * 1024 * 1024;
+  if (end_drop >= 17 * 1024 * 1024)
+  {
+    const int64_t start_drop = std::max<int64_t>(m_lastDropPos, 16 * 1024 * 1024);
+    if (end_drop - start_drop >= 1 * 1024 * 1024 &&
+        posix_fadvise(m_fd, start_drop, end_drop - start_drop, POSIX_FADV_DONTNEED) == 0)
+      m_lastDropPos = end_drop;
+  }
+#endif
+}
+
+void CPosixMMapFile::Unmap()
+{
+  if (m_map)
+  {
+    munmap(m_map, m_mapSize);
+    m_map = NULL;
+    m_mapOffset = 0;
+    m_mapSize = 0;
+  }
+}
+
+ssize_t CPosixMMapFile::Read(void* lpBuf, size_t uiBufSize)
+{
+  if (m_fd < 0)
+    return -1;
+
+  if (m_fileSize < 0)
+    return CPosixFile::Read(lpBuf, uiBufSize);
+
+  assert(lpBuf != NULL || uiBufSize == 0);
+  if (lpBuf == NULL && uiBufSize != 0)
+    return -1;
+
+  if (uiBufSize > SSIZE_MAX)
+    uiBufSize = SSIZE_MAX;
+
+  // the file may still be growing (e.g. a recording in progress), such files
+  // are read as CPosixFile does from then on
+  if (m_pos >= m_fileSize)
+  {
+    if (GetLength() == m_fileSize)
+      return 0;
+    FallBack();
+    return CPosixFile::Read(lpBuf, uiBufSize);
+  }
+
+  if (m_pos != m_lastEnd)
+    m_sequential = 0;
+
+  bool mapped = m_map && m_pos >= m_mapOffset && m_pos < m_mapOffset + (int64_t)m_mapSize;
+  if (!mapped && m_sequential >= MMAP_MIN_SEQUENTIAL)
+  {
+    if (!CheckSize())
+      return CPosixFile::Read(lpBuf, uiBufSize);
+    mapped = Map(m_pos);
+  }
+  if (!mapped)
+  {
+    const ssize_t res = ReadAt(lpBuf, uiBufSize, m_pos);
+    if (res < 0)
+      return -1;
+    m_pos += res;
+    m_sequential += res;
+    m_lastEnd = m_pos;
+    DropCache();
+    return res;
+  }
+
+  const int64_t mapEnd = m_mapOffset + m_mapSize;
+  if (m_pos + MMAP_READAHEAD / 2 > m_adviseEnd && m_adviseEnd < mapEnd)
+  {
+    static const int64_t pageSize = sysconf(_SC_PAGESIZE);
+    int64_t start = std::max(m_adviseEnd, m_pos);
+    start -= start % pageSize;
+    const int64_t end = std::min<int64_t>(start + MMAP_READAHEAD, mapEnd);
+    madvise(m_map + (start - m_mapOffset), (size_t)(end - start), MADV_WILLNEED);
+    m_adviseEnd = end;
+  }
+
+  const size_t size = (size_t)std::min<int64_t>(uiBufSize, mapEnd - m_pos);
+  memcpy(lpBuf, m_map + (m_pos - m_mapOffset), size);
+  m_pos += size;
+  m_sequential += size;
+  m_lastEnd = m_pos;
+  DropCache();
+  return size;
+}
+
+int64_t CPosixMMapFile::Seek(int64_t iFilePosition, int iWhence /* = SEEK_SET*/)
+{
+  if (m_fd < 0)
+    return -1;
+
+  if (m_fileSize < 0)
+    return CPosixFile::Seek(iFilePosition, iWhence);
+
+  int64_t target = iFilePosition;
+  if (iWhence == SEEK_CUR)
+    target += m_pos;
+  else if (iWhence == SEEK_END)
+    target += GetLength();
+  else if (iWhence != SEEK_SET)
+    return -1;
+
+  if (target < 0)
+    return -1;
+
+  m_pos = target;
+  return m_pos;
+}
+
+int64_t CPosixMMapFile::GetPosition()
+{
+  if (m_fileSize < 0)
+    return CPosixFile::GetPosition();
+
+  return m_fd < 0 ? -1 : m_pos;
+}
+
+int CPosixMMapFile::IoControl(EIoControl request, void* param)
+{
+  if (m_fd >= 0 && m_fileSize >= 0 && request == IOCTRL_SEEK_POSSIBLE)
+    return 1;
+
+  return CPosixFile::IoControl(request, param);
+}
+
+#endif // TARGET_POSIX
@@ -0,0 +1,68 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PosixFile.h"
+
+namespace XFILE
+{
+  /*
+   * Read only local file. Once reads turn sequential they are served from
+   * a sliding memory mapped window, copied straight out of the page cache
+   * without a read() syscall per chunk, while the kernel is told to read
+   * ahead of the current position. Short seek heavy reads use pread.
+   * Files that can't be mapped, and files that grow or shrink while they
+   * are read, are read as with CPosixFile.
+   */
+  class CPosixMMapFile : public CPosixFile
+  {
+  public:
+    CPosixMMapFile();
+    virtual ~CPosixMMapFile();
+
+    virtual bool Open(const CURL& url);
+    virtual bool OpenForWrite(const CURL& url, bool bOverWrite = false);
+    virtual void Close();
+
+    virtual ssize_t Read(void* lpBuf, size_t uiBufSize);
+    virtual int64_t Seek(int64_t iFilePosition, int iWhence = SEEK_SET);
+    virtual int64_t GetPosition();
+    virtual int IoControl(EIoControl request, void* param);
+
+  protected:
+    bool Map(int64_t pos);
+    void Unmap();
+    void FallBack();
+    bool CheckSize();
+    ssize_t ReadAt(void* lpBuf, size_t uiBufSize, int64_t pos);
+    void DropCache();
+
+    uint8_t* m_map;
+    int64_t  m_mapOffset;
+    size_t   m_mapSize;
+    int64_t  m_fileSize;
+    int64_t  m_pos;
+    int64_t  m_adviseEnd;
+    size_t   m_window;
+    int64_t  m_sequential;
+    int64_t  m_lastEnd;
+  };
+
+}
@@ -0,0 +1,153 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined(TARGET_POSIX)
+
+#include "filesystem/File.h"
+#include "filesystem/posix/PosixFile.h"
+#include "filesystem/posix/PosixMMapFile.h"
+#include "test/TestUtils.h"
+#include "URL.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#define TEST_FILE_SIZE (40 * 1024 * 1024) // more than the largest window
+
+class TestPosixMMapFile : public testing::Test
+{
+protected:
+  TestPosixMMapFile() : m_temp(NULL) {}
+
+  virtual void SetUp()
+  {
+    ASSERT_TRUE((m_temp = XBMC_CREATETEMPFILE(".mmap")) != NULL);
+    m_temp->Close();
+    m_path = XBMC_TEMPFILEPATH(m_temp);
+
+    std::vector<uint8_t> data(1024 * 1024);
+    XFILE::CPosixFile file;
+    ASSERT_TRUE(file.OpenForWrite(CURL(m_path), true));
+    for (int block = 0; block < TEST_FILE_SIZE / (int)data.size(); block++)
+    {
+      for (size_t i = 0; i < data.size(); i++)
+        data[i] = (uint8_t)(block * 7 + i * 13);
+      ASSERT_EQ((ssize_t)data.size(), file.Write(&data[0], data.size()));
+    }
+    file.Close();
+  }
+
+  virtual void TearDown()
+  {
+    EXPECT_TRUE(XBMC_DELETETEMPFILE(m_temp));
+  }
+
+  XFILE::CFile* m_temp;
+  std::string   m_path;
+};
+
+TEST_F(TestPosixMMapFile, ReadMatchesPosixFile)
+{
+  XFILE::CPosixFile posix;
+  XFILE::CPosixMMapFile mapped;
+  ASSERT_TRUE(posix.Open(CURL(m_path)));
+  ASSERT_TRUE(mapped.Open(CURL(m_path)));
+  EXPECT_EQ(TEST_FILE_SIZE, mapped.GetLength());
+  EXPECT_EQ(1, mapped.IoControl(XFILE::IOCTRL_SEEK_POSSIBLE, NULL));
+
+  // reads crossing the mapped windows, plus seeks back and past the end
+  const int64_t positions[] = { 0, 32 * 1024 * 1024 - 100, 12345, 41 * 1024 * 1024 - 7, 39 * 1024 * 1024 + 1 };
+  std::vector<char> a(3 * 1024 * 1024), b(3 * 1024 * 1024);
+  for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+  {
+    int64_t expect = posix.Seek(positions[i], SEEK_SET);
+    EXPECT_EQ(expect, mapped.Seek(positions[i], SEEK_SET));
+
+    ssize_t wantRead = 0, gotRead = 0, read;
+    while ((read = posix.Read(&a[wantRead], a.size() - wantRead)) > 0)
+      wantRead += read;
+    while ((read = mapped.Read(&b[gotRead], b.size() - gotRead)) > 0)
+      gotRead += read;
+
+    EXPECT_EQ(wantRead, gotRead);
+    EXPECT_EQ(posix.GetPosition(), mapped.GetPosition());
+    EXPECT_TRUE(memcmp(&a[0], &b[0], wantRead) == 0);
+  }
+
+  EXPECT_EQ(TEST_FILE_SIZE - 10, mapped.Seek(-10, SEEK_END));
+  EXPECT_EQ(-1, mapped.Seek(-1, SEEK_SET));
+  EXPECT_FALSE(mapped.OpenForWrite(CURL(m_path)));
+}
+
+TEST_F(TestPosixMMapFile, TruncatedWhileMapped)
+{
+  XFILE::CPosixMMapFile mapped;
+  ASSERT_TRUE(mapped.Open(CURL(m_path)));
+
+  // read far enough for the file to be mapped
+  std::vector<char> buf(1024 * 1024);
+  int64_t total = 0;
+  ssize_t read;
+  for (int i = 0; i < 2; i++)
+  {
+    ASSERT_EQ((ssize_t)buf.size(), read = mapped.Read(&buf[0], buf.size()));
+    total += read;
+  }
+
+  // truncated past the current window, noticed before the next one is mapped
+  ASSERT_EQ(0, truncate(m_path.c_str(), 3 * 1024 * 1024));
+  while ((read = mapped.Read(&buf[0], buf.size())) > 0)
+    total += read;
+  EXPECT_EQ(0, read);
+  EXPECT_EQ(3 * 1024 * 1024, total);
+  EXPECT_EQ(total, mapped.GetPosition());
+}
+
+TEST_F(TestPosixMMapFile, GrowingFile)
+{
+  XFILE::CPosixMMapFile mapped;
+  ASSERT_TRUE(mapped.Open(CURL(m_path)));
+
+  std::vector<char> buf(1024 * 1024);
+  int64_t total = 0;
+  ssize_t read;
+  while ((read = mapped.Read(&buf[0], buf.size())) > 0)
+    total += read;
+  EXPECT_EQ(TEST_FILE_SIZE, total);
+
+  // a recording in progress: data appended after the end was reached is read
+  XFILE::CPosixFile writer;
+  ASSERT_TRUE(writer.OpenForWrite(CURL(m_path), false));
+  ASSERT_EQ(TEST_FILE_SIZE, writer.Seek(0, SEEK_END));
+  memset(&buf[0], 0x5a, 4096);
+  ASSERT_EQ(4096, writer.Write(&buf[0], 4096));
+  writer.Close();
+
+  memset(&buf[0], 0, 4096);
+  EXPECT_EQ(4096, mapped.Read(&buf[0], buf.size()));
+  EXPECT_EQ(0x5a, buf[0]);
+  EXPECT_EQ(0x5a, buf[4095]);
+  EXPECT_EQ(TEST_FILE_SIZE + 4096, mapped.GetPosition());
+}
+
+#endif // TARGET_POSIX
@@ -23,6 +23,7 @@
 #include "libsquish/squish.h"
 #include "utils/log.h"
 #include <string.h>
+#include <vector>
 
 #ifndef NO_XBMC_FILESYSTEM
 #include "filesystem/File.h"
@@ -88,11 +89,43 @@ unsigned char *CDDSImage::GetData() const
   return m_data;
 }
 
+unsigned int CDDSImage::GetMipMapCount() const
+{
+  if ((m_desc.flags & ddsd_mipmapcount) && m_desc.mipmapcount > 1)
+    return m_desc.mipmapcount;
+  return 1;
+}
+
+unsigned int CDDSImage::GetDataSize() const
+{
+  unsigned int format = GetFormat();
+  unsigned int size = m_desc.linearSize;
+  unsigned int width = m_desc.width, height = m_desc.height;
+  for (unsigned int level = 1; level < GetMipMapCount(); level++)
+  {
+    width = max(width / 2, 1U);
+    height = max(height / 2, 1U);
+    size += GetStorageRequirements(width, height, format);
+  }
+  return size;
+}
+
+unsigned char *CDDSImage::Detach()
+{
+  unsigned char *data = m_data;
+  m_data = NULL;
+  return data;
+}
+
 bool CDDSImage::ReadFile(const std::string &inputFile)
 {
   // open the file
   CFile file;
+#ifndef NO_XBMC_FILESYSTEM
+  if (!file.Open(inputFile, READ_MMAP))
+#else
   if (!file.Open(inputFile))
+#endif
     return false;
 
   // read the header
@@ -103,21 +136,24 @@ bool CDDSImage::ReadFile(const std::string &inputFile)
     return false;
   if (!GetFormat())
     return false;  // not supported
+  if (GetMipMapCount() > 32)
+    return false;  // corrupt
 
   // allocate our data
-  m_data = new unsigned char[m_desc.linearSize];
+  unsigned int size = GetDataSize();
+  m_data = new unsigned char[size];
   if (!m_data)
     return false;
 
   // and read it in
-  if (file.Read(m_data, m_desc.linearSize) != m_desc.linearSize)
+  if (file.Read(m_data, size) != size)
     return false;
 
   file.Close();
   return true;
 }
 
-bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE)
+bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE, bool mipmaps)
 {
   if (!brga)
     return false;
@@ -127,6 +163,8 @@ bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsign
     for (unsigned int i = 0; i < height; i++)
       memcpy(m_data + i * width * 4, brga + i * pitch, min(width * 4, pitch));
   }
+  if (mipmaps)
+    AddMipMaps(width, height, pitch, brga);
   return WriteFile(outputFile);
 }
 
@@ -141,7 +179,7 @@ bool CDDSImage::WriteFile(const std::string &outputFile) const
   return file.Write("DDS ", 4) == 4 &&
     file.Write(&m_desc, sizeof(m_desc)) == sizeof(m_desc) &&
   // now the data
-    file.Write(m_data, m_desc.linearSize) == m_desc.linearSize;
+    file.Write(m_data, GetDataSize()) == GetDataSize();
 }
 
 unsigned int CDDSImage::GetStorageRequirements(unsigned int width, unsigned int height, unsigned int format)
@@ -217,6 +255,70 @@ bool CDDSImage::Compress(unsigned int width, unsigned int height, unsigned int p
   return false;
 }
 
+void CDDSImage::AddMipMaps(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga)
+{
+  unsigned int format = GetFormat();
+  int flags = squish::kSourceBGRA;
+  if (format == XB_FMT_DXT1)
+    flags |= squish::kDxt1;
+  else if (format == XB_FMT_DXT3)
+    flags |= squish::kDxt3;
+  else if (format == XB_FMT_DXT5)
+    flags |= squish::kDxt5;
+
+  m_desc.flags |= ddsd_mipmapcount;
+  m_desc.mipmapcount = 1;
+  for (unsigned int w = width, h = height; w > 1 || h > 1; w = max(w / 2, 1U), h = max(h / 2, 1U))
+    m_desc.mipmapcount++;
+  m_desc.caps.flags1 |= ddscaps_complex | ddscaps_mipmap;
+
+  unsigned char *data = new unsigned char[GetDataSize()];
+  memcpy(data, m_data, m_desc.linearSize);
+  delete[] m_data;
+  m_data = data;
+
+  // each level is filtered from the one above, and compressed the same way as the full size image
+  std::vector<unsigned char> level, previous;
+  unsigned char *dest = m_data + m_desc.linearSize;
+  unsigned char const *src = brga;
+  while (width > 1 || height > 1)
+  {
+    unsigned int levelWidth = max(width / 2, 1U);
+    unsigned int levelHeight = max(height / 2, 1U);
+    level.resize(levelWidth * levelHeight * 4);
+    HalveImage(src, width, height, pitch, &level[0], levelWidth, levelHeight);
+    if (format & XB_FMT_DXT_MASK)
+      squish::CompressImage(&level[0], levelWidth, levelHeight, levelWidth * 4, dest, flags);
+    else
+      memcpy(dest, &level[0], level.size());
+    dest += GetStorageRequirements(levelWidth, levelHeight, format);
+
+    previous.swap(level);
+    src = &previous[0];
+    width = levelWidth;
+    height = levelHeight;
+    pitch = levelWidth * 4;
+  }
+}
+
+void CDDSImage::HalveImage(unsigned char const *brga, unsigned int width, unsigned int height, unsigned int pitch,
+                           unsigned char *dest, unsigned int destWidth, unsigned int destHeight)
+{
+  for (unsigned int y = 0; y < destHeight; y++)
+  {
+    // odd sizes repeat the last row or column
+    unsigned char const *row1 = brga + min(y * 2, height - 1) * pitch;
+    unsigned char const *row2 = brga + min(y * 2 + 1, height - 1) * pitch;
+    for (unsigned int x = 0; x < destWidth; x++)
+    {
+      unsigned int x1 = min(x * 2, width - 1) * 4;
+      unsigned int x2 = min(x * 2 + 1, width - 1) * 4;
+      for (unsigned int c = 0; c < 4; c++)
+        *dest++ = (row1[x1 + c] + row1[x2 + c] + row2[x1 + c] + row2[x2 + c] + 2) / 4;
+    }
+  }
+}
+
 bool CDDSImage::Decompress(unsigned char *argb, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *dxt, unsigned int format)
 {
   if (!argb || !dxt || !(format & XB_FMT_DXT_MASK))
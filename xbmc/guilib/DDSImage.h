@@ -36,6 +36,22 @@ public:
   unsigned int GetSize() const;
   unsigned char *GetData() const;
 
+  /*! \brief Number of levels in the image, including the full size one
+   Levels are stored one after the other in GetData(), each half the width and height of the previous.
+   */
+  unsigned int GetMipMapCount() const;
+
+  /*! \brief Size of all levels of the image in bytes
+   \sa GetSize, GetMipMapCount
+   */
+  unsigned int GetDataSize() const;
+
+  /*! \brief Hand the data of all levels over to the caller, who has to delete[] it
+   The image is left without data.
+   \sa GetData, GetDataSize
+   */
+  unsigned char *Detach();
+
   bool ReadFile(const std::string &file);
 
   /*! \brief Create a DDS image file from the given an ARGB buffer
@@ -45,9 +61,10 @@ public:
    \param pitch pitch of the pixel buffer
    \param argb pixel buffer
    \param maxMSE maximum mean square error to allow, ignored if 0 (the default)
+   \param mipmaps whether to store a chain of downscaled levels down to 1x1 as well (defaults to false)
    \return true on successful image creation, false otherwise
    */
-  bool Create(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
+  bool Create(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0, bool mipmaps = false);
   
   /*! \brief Decompress a DXT1/3/5 image to the given buffer
    Assumes the buffer has been allocated to at least width*height*4
@@ -76,6 +93,19 @@ private:
    */
   bool Compress(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
 
+  /*! \brief Append the levels below the full size image, in the format it was compressed to
+   \param width width of the pixel buffer
+   \param height height of the pixel buffer
+   \param pitch pitch of the pixel buffer
+   \param argb pixel buffer of the full size image
+   */
+  void AddMipMaps(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb);
+
+  /*! \brief Box filter an ARGB buffer down to half its width and height
+   */
+  static void HalveImage(unsigned char const *argb, unsigned int width, unsigned int height, unsigned int pitch,
+                         unsigned char *dest, unsigned int destWidth, unsigned int destHeight);
+
   static unsigned int GetStorageRequirements(unsigned int width, unsigned int height, unsigned int format);
   enum {
     ddsd_caps        = 0x00000001,
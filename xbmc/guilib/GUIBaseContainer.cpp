@@ -33,6 +33,7 @@
 #include "utils/XBMCTinyXML.h"
 #include "listproviders/IListProvider.h"
 #include "settings/Settings.h"
+#include "settings/AdvancedSettings.h"
 
 using namespace std;
 
@@ -63,6 +64,10 @@ CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, fl
   m_autoScrollDelayTime = 0;
   m_autoScrollIsReversed = false;
   m_lastRenderTime = 0;
+  m_layoutGeneration = 0;
+  m_lastItemCount = 0;
+  m_prepareScrollValue = 0;
+  m_prepareTime = 0;
 }
 
 CGUIBaseContainer::~CGUIBaseContainer(void)
@@ -108,6 +113,9 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   if ((int)m_items.size() > m_itemsPerPage + cacheBefore + cacheAfter)
     FreeMemory(CorrectOffset(offset - cacheBefore, 0), CorrectOffset(offset + m_itemsPerPage + 1 + cacheAfter, 0));
 
+  // pick up the layouts prepared in the background since the last frame
+  m_preparer.Swap(m_layoutGeneration);
+
   CPoint origin = CPoint(m_posX, m_posY) + m_renderOffset;
   float pos = (m_orientation == VERTICAL) ? origin.y : origin.x;
   float end = (m_orientation == VERTICAL) ? m_posY + m_height : m_posX + m_width;
@@ -145,6 +153,17 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   // to have same behaviour when scrolling down, we need to set page control to offset+1
   UpdatePageControl(offset + (m_scroller.IsScrollingDown() ? 1 : 0));
 
+  PrepareLayouts(offset - cacheBefore, offset + m_itemsPerPage + 1 + cacheAfter, currentTime);
+
+  // ListItem and Container conditions look at the selected item and the number of items
+  CGUIListItemPtr selected = GetListItem(0);
+  if (selected != m_lastSelected || m_items.size() != m_lastItemCount)
+  {
+    m_lastSelected = selected;
+    m_lastItemCount = m_items.size();
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
+  }
+
   m_lastRenderTime = currentTime;
 
   CGUIControl::Process(currentTime, dirtyregions);
@@ -190,7 +209,9 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
       item->GetFocusedLayout()->SetFocusedItem(0);  // focus is not set
     if (!item->GetLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_layout);
+      CGUIListItemLayout *layout = m_preparer.Take(item.get());
+      if (!layout)
+        layout = new CGUIListItemLayout(*m_layout);
       item->SetLayout(layout);
     }
     if (item->GetFocusedLayout())
@@ -818,6 +839,7 @@ void CGUIBaseContainer::AllocResources()
 void CGUIBaseContainer::FreeResources(bool immediately)
 {
   CGUIControl::FreeResources(immediately);
+  m_preparer.Clear();
   if (m_listProvider)
   {
     if (immediately)
@@ -834,6 +856,7 @@ void CGUIBaseContainer::UpdateLayout(bool updateAllItems)
   { // free memory of items
     for (iItems it = m_items.begin(); it != m_items.end(); ++it)
       (*it)->FreeMemory();
+    InvalidatePreparedLayouts();
   }
   // and recalculate the layout
   CalculateLayout();
@@ -928,6 +951,8 @@ void CGUIBaseContainer::CalculateLayout()
   if (oldLayout == m_layout && oldFocusedLayout == m_focusedLayout)
     return; // nothing has changed, so don't update stuff
 
+  InvalidatePreparedLayouts();
+
   m_itemsPerPage = std::max((int)((Size() - m_focusedLayout->Size(m_orientation)) / m_layout->Size(m_orientation)) + 1, 1);
 
   // ensure that the scroll offset is a multiple of our size
@@ -1065,6 +1090,8 @@ void CGUIBaseContainer::Reset()
   m_wasReset = true;
   m_items.clear();
   m_lastItem.reset();
+  m_lastSelected.reset();
+  m_preparer.Clear();
   ResetAutoScrolling();
 }
 
@@ -1124,6 +1151,57 @@ void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
   }
 }
 
+void CGUIBaseContainer::PrepareLayouts(int keepStart, int keepEnd, unsigned int currentTime)
+{
+  if (!g_advancedSettings.m_guiPrepareContainers || !m_layout || m_items.empty())
+    return;
+
+  // look two pages ahead when we scroll more than a page a second
+  int pages = 1;
+  if (m_prepareTime && currentTime > m_prepareTime)
+  {
+    float rows = fabs(m_scroller.GetValue() - m_prepareScrollValue) / m_layout->Size(m_orientation);
+    if (rows * 1000 / (currentTime - m_prepareTime) > m_itemsPerPage)
+      pages = 2;
+  }
+  m_prepareScrollValue = m_scroller.GetValue();
+  m_prepareTime = currentTime;
+
+  // keepStart and keepEnd are the rows we hold layouts for, prepare the pages we scroll to next
+  int firstRow, lastRow;
+  if (m_scroller.IsScrollingUp())
+  {
+    firstRow = keepStart - pages * m_itemsPerPage;
+    lastRow = keepStart;
+  }
+  else
+  {
+    firstRow = keepEnd + 1;
+    lastRow = keepEnd + 1 + pages * m_itemsPerPage;
+  }
+
+  std::vector<CGUIListItemPtr> items;
+  for (int row = firstRow; row < lastRow; row++)
+  {
+    int start = CorrectOffset(row, 0);
+    int stop = CorrectOffset(row + 1, 0);
+    if (stop <= start) // wrapped around
+      stop = start + 1;
+    for (int i = std::max(start, 0); i < stop && i < (int)m_items.size(); i++)
+    {
+      if (!m_items[i]->GetLayout() && std::find(items.begin(), items.end(), m_items[i]) == items.end())
+        items.push_back(m_items[i]);
+    }
+  }
+  m_preparer.Request(*m_layout, m_layoutGeneration, items);
+}
+
+void CGUIBaseContainer::InvalidatePreparedLayouts()
+{
+  m_layoutGeneration++;
+  m_preparer.Clear();
+}
+
 bool CGUIBaseContainer::InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const
 {
   if (!layout) return false;
@@ -27,6 +27,7 @@
 
 #include "IGUIContainer.h"
 #include "GUIListItemLayout.h"
+#include "GUIContainerPreparer.h"
 #include "utils/Stopwatch.h"
 
 /*!
@@ -128,6 +129,8 @@ protected:
   inline float Size() const;
   void MoveToRow(int row);
   void FreeMemory(int keepStart, int keepEnd);
+  void PrepareLayouts(int keepStart, int keepEnd, unsigned int currentTime);
+  void InvalidatePreparedLayouts();
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -142,6 +145,8 @@ protected:
   std::vector< CGUIListItemPtr > m_items;
   typedef std::vector<CGUIListItemPtr> ::iterator iItems;
   CGUIListItemPtr m_lastItem;
+  CGUIListItemPtr m_lastSelected;     ///< selected item when last processed, to tell when ListItem conditions change
+  size_t m_lastItemCount;             ///< number of items when last processed
 
   int m_pageControl;
 
@@ -206,6 +211,11 @@ protected:
 
   unsigned int m_lastRenderTime;
 
+  CGUIContainerPreparer m_preparer;  ///< prepares the layouts of the items we scroll to next
+  unsigned int m_layoutGeneration;   ///< changed whenever m_layout changes, so prepared layouts are dropped
+  float m_prepareScrollValue;        ///< scroll position and time of the last PrepareLayouts() call, for the scroll speed
+  unsigned int m_prepareTime;
+
 private:
   int m_cursor;
   int m_offset;
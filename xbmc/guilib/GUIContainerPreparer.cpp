@@ -0,0 +1,229 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIContainerPreparer.h"
+#include "GUIListItem.h"
+#include "GraphicContext.h"
+#include "GUILargeTextureManager.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+CGUIContainerPreparer::CGUIContainerPreparer()
+  : m_shared(new Shared)
+{
+}
+
+CGUIContainerPreparer::CGUIContainerPreparer(const CGUIContainerPreparer &right)
+  : m_shared(new Shared)
+{
+}
+
+CGUIContainerPreparer &CGUIContainerPreparer::operator=(const CGUIContainerPreparer &right)
+{
+  if (this != &right)
+    Clear();
+  return *this;
+}
+
+CGUIContainerPreparer::~CGUIContainerPreparer()
+{
+  Clear();
+}
+
+void CGUIContainerPreparer::Request(const CGUIListItemLayout &layout, unsigned int generation, const vector<CGUIListItemPtr> &items)
+{
+  if (IsBusy())
+    return;
+
+  // drop the layouts of items we no longer expect to show
+  bool dropped = false;
+  for (PreparedLayouts::iterator it = m_front.begin(); it != m_front.end(); )
+  {
+    if (find(items.begin(), items.end(), it->item) == items.end())
+    {
+      delete it->layout;
+      it = m_front.erase(it);
+      dropped = true;
+    }
+    else
+      ++it;
+  }
+  if (dropped)
+    UpdatePrefetch();
+
+  // the copies are made here, so the job has nothing of the render thread's to copy or free
+  PreparedLayouts wanted;
+  for (vector<CGUIListItemPtr>::const_iterator it = items.begin(); it != items.end(); ++it)
+  {
+    bool prepared = false;
+    for (PreparedLayouts::const_iterator i = m_front.begin(); i != m_front.end() && !prepared; ++i)
+      prepared = i->item == *it;
+    if (!prepared)
+    {
+      PreparedLayout wantedLayout;
+      wantedLayout.item = *it;
+      wantedLayout.invalidations = 0;
+      wantedLayout.generation = generation;
+      wantedLayout.layout = new CGUIListItemLayout(layout);
+      wanted.push_back(wantedLayout);
+    }
+  }
+  if (wanted.empty())
+    return;
+
+  {
+    CSingleLock lock(m_shared->section);
+    m_shared->busy = true;
+  }
+  CJobManager::GetInstance().AddJob(new CPrepareJob(m_shared, wanted), NULL, CJob::PRIORITY_NORMAL);
+}
+
+void CGUIContainerPreparer::Swap(unsigned int generation)
+{
+  PreparedLayouts finished;
+  {
+    CSingleLock lock(m_shared->section);
+    if (m_shared->back.empty())
+      return;
+    finished.swap(m_shared->back);
+  }
+
+  for (PreparedLayouts::iterator it = finished.begin(); it != finished.end(); ++it)
+  {
+    if (it->generation == generation)
+      m_front.push_back(*it);
+    else
+      delete it->layout;
+  }
+  UpdatePrefetch();
+}
+
+CGUIListItemLayout *CGUIContainerPreparer::Take(const CGUIListItem *item)
+{
+  for (PreparedLayouts::iterator it = m_front.begin(); it != m_front.end(); ++it)
+  {
+    if (it->item.get() == item)
+    {
+      CGUIListItemLayout *layout = it->layout;
+      if (item->GetInvalidations() != it->invalidations)
+        layout->SetInvalid();
+      m_front.erase(it);
+      return layout;
+    }
+  }
+  return NULL;
+}
+
+void CGUIContainerPreparer::Clear()
+{
+  Free(m_front);
+  UpdatePrefetch();
+
+  CSingleLock lock(m_shared->section);
+  Free(m_shared->back);
+  if (m_shared->busy)
+  { // leave the running job its own state, so what it prepares is dropped
+    m_shared->abandoned = true;
+    lock.Leave();
+    m_shared.reset(new Shared);
+  }
+}
+
+bool CGUIContainerPreparer::IsBusy() const
+{
+  CSingleLock lock(m_shared->section);
+  return m_shared->busy;
+}
+
+void CGUIContainerPreparer::UpdatePrefetch()
+{
+  vector<CStdString> wanted;
+  if (g_advancedSettings.m_guiPrefetchMemory > 0)
+  {
+    for (PreparedLayouts::const_iterator it = m_front.begin(); it != m_front.end(); ++it)
+      it->layout->GetPrefetchImages(wanted);
+    sort(wanted.begin(), wanted.end());
+    wanted.erase(unique(wanted.begin(), wanted.end()), wanted.end());
+  }
+
+  vector<CStdString> changed;
+  set_difference(wanted.begin(), wanted.end(), m_prefetched.begin(), m_prefetched.end(), back_inserter(changed));
+  for (vector<CStdString>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+    g_largeTextureManager.PrefetchImage(*it);
+
+  changed.clear();
+  set_difference(m_prefetched.begin(), m_prefetched.end(), wanted.begin(), wanted.end(), back_inserter(changed));
+  for (vector<CStdString>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+    g_largeTextureManager.ReleasePrefetchedImage(*it);
+
+  m_prefetched.swap(wanted);
+}
+
+void CGUIContainerPreparer::Free(PreparedLayouts &layouts)
+{
+  for (PreparedLayouts::iterator it = layouts.begin(); it != layouts.end(); ++it)
+    delete it->layout;
+  layouts.clear();
+}
+
+CGUIContainerPreparer::CPrepareJob::CPrepareJob(SharedPtr shared, const PreparedLayouts &layouts)
+  : m_shared(shared), m_layouts(layouts)
+{
+}
+
+CGUIContainerPreparer::CPrepareJob::~CPrepareJob()
+{
+  // only when abandoned or cancelled, the layouts and items are GUI objects
+  if (!m_layouts.empty())
+  {
+    CSingleLock lock(g_graphicsContext);
+    Free(m_layouts);
+  }
+}
+
+bool CGUIContainerPreparer::CPrepareJob::DoWork()
+{
+  for (PreparedLayouts::iterator it = m_layouts.begin(); it != m_layouts.end(); ++it)
+  {
+    {
+      CSingleLock lock(m_shared->section);
+      if (m_shared->abandoned)
+        break;
+    }
+
+    it->invalidations = it->item->GetInvalidations();
+    it->layout->Prepare(it->item.get());
+  }
+
+  CSingleLock lock(m_shared->section);
+  if (!m_shared->abandoned)
+  {
+    m_shared->back.insert(m_shared->back.end(), m_layouts.begin(), m_layouts.end());
+    m_layouts.clear();
+  }
+  m_shared->busy = false;
+  return true;
+}
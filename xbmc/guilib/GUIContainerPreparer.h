@@ -0,0 +1,132 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "GUIListItemLayout.h"
+#include "IGUIContainer.h"
+#include "threads/CriticalSection.h"
+#include "utils/Job.h"
+
+#include <vector>
+#include "boost/shared_ptr.hpp"
+
+/*!
+ \ingroup controls
+ \brief Prepares the layouts of list items before a container scrolls to them.
+
+ Filling in the labels and images of an item's layout is the bulk of the work a container
+ does when new items scroll into view. The preparer does this work on a job worker for the
+ items the container expects to show next, so the render thread only has to pick up the
+ finished layouts. The layouts are copied on the render thread and handed to the job, which
+ works on them without the graphics context; fonts and textures lock what they share.
+
+ Finished layouts are handed over through two buffers. The worker appends to the back
+ buffer, and the render thread moves its contents to the front buffer with Swap() once per
+ frame, before it takes layouts from the front buffer with Take(). Only one job runs at a
+ time per container.
+
+ Layouts are tagged with a generation, which the container changes whenever its item
+ layout changes, and with the number of invalidations of their item. Layouts of another
+ generation are dropped. Layouts of items that changed since are handed out invalidated,
+ so they are updated again by Process().
+
+ The images of the prepared layouts are prefetched by the large texture manager, and
+ released again once their layouts are taken or dropped.
+ */
+class CGUIContainerPreparer
+{
+public:
+  CGUIContainerPreparer();
+  /*! \brief Copies of a container start out with nothing prepared
+   */
+  CGUIContainerPreparer(const CGUIContainerPreparer &right);
+  CGUIContainerPreparer &operator=(const CGUIContainerPreparer &right);
+  ~CGUIContainerPreparer();
+
+  /*! \brief Prepare layouts for items in the background
+   Layouts already prepared for items that are not in the list are dropped. Nothing is
+   queued while a previous job is still running.
+   \param layout the layout to copy for each item
+   \param generation the current generation of the container's layout
+   \param items the items the container will show next
+   */
+  void Request(const CGUIListItemLayout &layout, unsigned int generation, const std::vector<CGUIListItemPtr> &items);
+
+  /*! \brief Pick up the layouts finished by the worker
+   \param generation the current generation of the container's layout
+   */
+  void Swap(unsigned int generation);
+
+  /*! \brief Take the prepared layout for an item
+   \param item the item that needs a layout
+   \return the layout, owned by the caller, or NULL if there is none
+   */
+  CGUIListItemLayout *Take(const CGUIListItem *item);
+
+  /*! \brief Drop all prepared layouts, and the ones still being prepared
+   */
+  void Clear();
+
+  /*! \brief Whether a job is preparing layouts
+   */
+  bool IsBusy() const;
+
+private:
+  struct PreparedLayout
+  {
+    CGUIListItemPtr     item;
+    unsigned int        invalidations;
+    unsigned int        generation;
+    CGUIListItemLayout *layout;
+  };
+  typedef std::vector<PreparedLayout> PreparedLayouts;
+
+  /*! \brief State shared with the job, which may outlive the preparer
+   */
+  struct Shared
+  {
+    Shared() : busy(false), abandoned(false) {}
+    CCriticalSection section;
+    PreparedLayouts  back;
+    bool             busy;
+    bool             abandoned;
+  };
+  typedef boost::shared_ptr<Shared> SharedPtr;
+
+  class CPrepareJob : public CJob
+  {
+  public:
+    CPrepareJob(SharedPtr shared, const PreparedLayouts &layouts);
+    virtual ~CPrepareJob();
+    virtual bool DoWork();
+    virtual const char *GetType() const { return "containerprepare"; };
+  private:
+    SharedPtr       m_shared;
+    PreparedLayouts m_layouts; ///< layouts not handed back, freed with the job
+  };
+
+  static void Free(PreparedLayouts &layouts);
+  void UpdatePrefetch();
+
+  SharedPtr       m_shared;
+  PreparedLayouts m_front;
+  std::vector<CStdString> m_prefetched; ///< images we hold prefetch references to, sorted
+};
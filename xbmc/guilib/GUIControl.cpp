@@ -301,6 +301,8 @@ void CGUIControl::SetFocus(bool focus)
     QueueAnimation(ANIM_TYPE_UNFOCUS);
   else if (!m_bHasFocus && focus)
     QueueAnimation(ANIM_TYPE_FOCUS);
+  if (m_bHasFocus != focus)
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
   m_bHasFocus = focus;
 }
 
@@ -390,6 +392,7 @@ void CGUIControl::SetEnabled(bool bEnable)
   {
     m_enabled = bEnable;
     SetInvalid();
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
   }
 }
 
@@ -505,12 +508,14 @@ void CGUIControl::SetVisible(bool bVisible, bool setVisState)
     {
       m_visible = visible;
       SetInvalid();
+      g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
     }
   }
   if (m_forceHidden == bVisible)
   {
     m_forceHidden = !bVisible;
     SetInvalid();
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
   }
   if (m_forceHidden)
   { // reset any visible animations that are in process
@@ -572,6 +577,8 @@ void CGUIControl::UpdateVisibility(const CGUIListItem *item)
   //    CLog::Log(LOGDEBUG, "Visibility changed to hidden for control id %i", m_controlID);
       QueueAnimation(ANIM_TYPE_HIDDEN);
     }
+    if (bWasVisible != m_visibleFromSkinCondition)
+      g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
   }
   // check for conditional animations
   for (unsigned int i = 0; i < m_animations.size(); i++)
@@ -587,7 +594,10 @@ void CGUIControl::UpdateVisibility(const CGUIListItem *item)
     m_enabled = m_enableCondition->Get(item);
 
   if (m_enabled != enabled)
+  {
     MarkDirtyRegion();
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
+  }
 
   m_allowHiddenFocus.Update(item);
   if (UpdateColors())
@@ -740,6 +750,8 @@ bool CGUIControl::HasAnimation(ANIMATION_TYPE type)
 
 void CGUIControl::UpdateStates(ANIMATION_TYPE type, ANIMATION_PROCESS currentProcess, ANIMATION_STATE currentState)
 {
+  GUIVISIBLE visible = m_visible;
+
   // Make sure control is hidden or visible at the appropriate times
   // while processing a visible or hidden animation it needs to be visible,
   // but when finished a hidden operation it needs to be hidden
@@ -796,6 +808,9 @@ void CGUIControl::UpdateStates(ANIMATION_TYPE type, ANIMATION_PROCESS currentPro
     if (currentProcess == ANIM_PROCESS_NORMAL && currentState == ANIM_STATE_APPLIED)
       OnUnFocus();
   }
+
+  if (m_visible != visible)
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
 }
 
 bool CGUIControl::Animate(unsigned int currentTime)
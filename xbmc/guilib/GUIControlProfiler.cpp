@@ -19,6 +19,7 @@
  */
 
 #include "GUIControlProfiler.h"
+#include "GUITextLayout.h"
 #include "utils/XBMCTinyXML.h"
 #include "utils/TimeUtils.h"
 #include "utils/StringUtils.h"
@@ -237,7 +238,8 @@ CGUIControlProfilerItem *CGUIControlProfilerItem::FindOrAddControl(CGUIControl *
 }
 
 CGUIControlProfiler::CGUIControlProfiler(void)
-: m_ItemHead(NULL, NULL, NULL), m_pLastItem(NULL), m_iMaxFrameCount(200), m_iFrameCount(0)
+: m_ItemHead(NULL, NULL, NULL), m_pLastItem(NULL), m_iMaxFrameCount(200), m_iFrameCount(0),
+  m_textLayoutHits(0), m_textLayoutMisses(0)
 // m_bIsRunning(false), no isRunning because it is static
 {
   m_fPerfScale = 100000.0f / CurrentHostFrequency();
@@ -260,6 +262,8 @@ void CGUIControlProfiler::Start(void)
   m_bIsRunning = true;
   m_pLastItem = NULL;
   m_ItemHead.Reset(this);
+  unsigned int entries;
+  CGUITextLayout::GetCacheStats(m_textLayoutHits, m_textLayoutMisses, entries);
 }
 
 void CGUIControlProfiler::BeginVisibility(CGUIControl *pControl)
@@ -348,6 +352,19 @@ bool CGUIControlProfiler::SaveResults(void)
   root->SetAttribute("timeunit", "ms");
   doc.LinkEndChild(root);
 
+  // text layout cache usage during the profiled frames
+  unsigned int hits, misses, entries;
+  CGUITextLayout::GetCacheStats(hits, misses, entries);
+  hits -= m_textLayoutHits;
+  misses -= m_textLayoutMisses;
+  TiXmlElement *cache = new TiXmlElement("textlayoutcache");
+  cache->SetAttribute("hits", (int)hits);
+  cache->SetAttribute("misses", (int)misses);
+  cache->SetAttribute("entries", (int)entries);
+  str = StringUtils::Format("%.1f", hits + misses ? 100.0f * hits / (hits + misses) : 0.0f);
+  cache->SetAttribute("hitrate", str.c_str());
+  root->LinkEndChild(cache);
+
   m_ItemHead.SaveToXML(root);
   return doc.SaveFile(m_strOutputFile);
 }
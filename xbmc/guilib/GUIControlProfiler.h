@@ -91,6 +91,8 @@ private:
   CStdString m_strOutputFile;
   int m_iMaxFrameCount;
   int m_iFrameCount;
+  unsigned int m_textLayoutHits;    // text layout cache statistics at start
+  unsigned int m_textLayoutMisses;
 };
 
 #define GUIPROFILER_VISIBILITY_BEGIN(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().BeginVisibility(x); }
@@ -57,6 +57,8 @@ float CScrollInfo::GetPixelsPerFrame()
   return pixelSpeed * m_averageFrameTime;
 }
 
+unsigned int CGUIFont::m_nextUniqueId = 0;
+
 CGUIFont::CGUIFont(const CStdString& strFontName, uint32_t style, color_t textColor,
 		   color_t shadowColor, float lineSpacing, float origHeight, CGUIFontTTFBase *font)
 {
@@ -67,6 +69,7 @@ CGUIFont::CGUIFont(const CStdString& strFontName, uint32_t style, color_t textCo
   m_lineSpacing = lineSpacing;
   m_origHeight = origHeight;
   m_font = font;
+  m_uniqueId = ++m_nextUniqueId;
 
   if (m_font)
     m_font->AddReference();
@@ -325,4 +328,6 @@ void CGUIFont::SetFont(CGUIFontTTFBase *font)
   m_font = font;
   if (m_font)
     m_font->AddReference();
+  // layouts made with the old font no longer apply
+  m_uniqueId = ++m_nextUniqueId;
 }
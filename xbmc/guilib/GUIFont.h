@@ -150,6 +150,12 @@ public:
 
   void SetFont(CGUIFontTTFBase* font);
 
+  /*! \brief Identifies this font and its current metrics
+   The id changes whenever the underlying font file changes, and is never reused.
+   \return the unique id of the font
+   */
+  unsigned int GetUniqueId() const { return m_uniqueId; };
+
 protected:
   CStdString m_strFontName;
   uint32_t m_style;
@@ -161,6 +167,9 @@ protected:
 
 private:
   bool ClippedRegionIsEmpty(float x, float y, float width, uint32_t alignment) const;
+
+  unsigned int m_uniqueId;
+  static unsigned int m_nextUniqueId;
 };
 
 #endif
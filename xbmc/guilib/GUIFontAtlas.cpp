@@ -0,0 +1,183 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIFontAtlas.h"
+
+CGUIFontAtlas::CGUIFontAtlas()
+{
+  Reset(0, 0, 1, 0);
+}
+
+void CGUIFontAtlas::Reset(unsigned int pageWidth, unsigned int pageHeight, unsigned int rowHeight, unsigned int maxPages)
+{
+  m_pageWidth = pageWidth;
+  m_rowHeight = rowHeight ? rowHeight : 1;
+  m_rowsPerPage = pageHeight / m_rowHeight;
+  if (m_rowsPerPage == 0)
+    m_rowsPerPage = 1;
+  m_maxPages = maxPages;
+
+  m_pages.clear();
+  m_glyphs.clear();
+  m_freeHandles.clear();
+  m_glyphCount = 0;
+  m_evictions = 0;
+}
+
+int CGUIFontAtlas::Allocate(unsigned int width, uint32_t key, unsigned int protectFrom, Slot &slot, std::vector<uint32_t> &evicted)
+{
+  if (width > m_pageWidth)
+    return -1;
+
+  unsigned int page, row, x;
+  if (!FindSpace(width, page, row, x))
+  {
+    if (!EvictFor(width, protectFrom, evicted) || !FindSpace(width, page, row, x))
+      return -1;
+  }
+
+  slot.page = page;
+  slot.x = x;
+  slot.y = row * m_rowHeight;
+  return AddGlyph(page, row, x, width, key);
+}
+
+bool CGUIFontAtlas::FindSpace(unsigned int width, unsigned int &page, unsigned int &row, unsigned int &x)
+{
+  // reuse any gap in the rows we have
+  for (page = 0; page < m_pages.size(); page++)
+  {
+    for (row = 0; row < m_pages[page].rows.size(); row++)
+    {
+      if (FindSpaceInRow(page, row, width, x))
+        return true;
+    }
+  }
+
+  // open a new row, on a new page if need be
+  if (m_pages.empty() || m_pages.back().rows.size() >= m_rowsPerPage)
+  {
+    if (m_pages.size() >= m_maxPages)
+      return false;
+    m_pages.push_back(Page());
+  }
+  page = m_pages.size() - 1;
+  row = m_pages[page].rows.size();
+  m_pages[page].rows.push_back(Row());
+  x = 0;
+  return true;
+}
+
+bool CGUIFontAtlas::FindSpaceInRow(unsigned int page, unsigned int row, unsigned int width, unsigned int &x) const
+{
+  const std::vector<int> &glyphs = m_pages[page].rows[row].glyphs;
+  unsigned int cursor = 0;
+  for (std::vector<int>::const_iterator it = glyphs.begin(); it != glyphs.end(); ++it)
+  {
+    const Glyph &glyph = m_glyphs[*it];
+    if (glyph.x - cursor >= width)
+    {
+      x = cursor;
+      return true;
+    }
+    cursor = glyph.x + glyph.width;
+  }
+  if (m_pageWidth - cursor >= width)
+  {
+    x = cursor;
+    return true;
+  }
+  return false;
+}
+
+bool CGUIFontAtlas::EvictFor(unsigned int width, unsigned int protectFrom, std::vector<uint32_t> &evicted)
+{
+  // evict the least recently used glyphs until one of them leaves a gap that is wide enough
+  while (true)
+  {
+    int victim = -1;
+    for (unsigned int i = 0; i < m_glyphs.size(); i++)
+    {
+      const Glyph &glyph = m_glyphs[i];
+      if (glyph.used && glyph.lastUsed < protectFrom &&
+         (victim < 0 || glyph.lastUsed < m_glyphs[victim].lastUsed))
+        victim = i;
+    }
+    if (victim < 0)
+      return false;
+
+    unsigned int page = m_glyphs[victim].page;
+    unsigned int row = m_glyphs[victim].row;
+    const std::vector<int> &glyphs = m_pages[page].rows[row].glyphs;
+    unsigned int index = 0;
+    while (glyphs[index] != victim)
+      index++;
+    Evict(page, row, index, evicted);
+
+    unsigned int x;
+    if (FindSpaceInRow(page, row, width, x))
+      return true;
+  }
+}
+
+void CGUIFontAtlas::Evict(unsigned int page, unsigned int row, unsigned int index, std::vector<uint32_t> &evicted)
+{
+  std::vector<int> &glyphs = m_pages[page].rows[row].glyphs;
+  int handle = glyphs[index];
+  evicted.push_back(m_glyphs[handle].key);
+  m_glyphs[handle].used = false;
+  m_freeHandles.push_back(handle);
+  glyphs.erase(glyphs.begin() + index);
+  m_glyphCount--;
+  m_evictions++;
+}
+
+int CGUIFontAtlas::AddGlyph(unsigned int page, unsigned int row, unsigned int x, unsigned int width, uint32_t key)
+{
+  int handle;
+  if (!m_freeHandles.empty())
+  {
+    handle = m_freeHandles.back();
+    m_freeHandles.pop_back();
+  }
+  else
+  {
+    handle = m_glyphs.size();
+    m_glyphs.push_back(Glyph());
+  }
+
+  Glyph &glyph = m_glyphs[handle];
+  glyph.page = page;
+  glyph.row = row;
+  glyph.x = x;
+  glyph.width = width;
+  glyph.lastUsed = 0;
+  glyph.key = key;
+  glyph.used = true;
+
+  // keep the row sorted by position
+  std::vector<int> &glyphs = m_pages[page].rows[row].glyphs;
+  std::vector<int>::iterator it = glyphs.begin();
+  while (it != glyphs.end() && m_glyphs[*it].x < x)
+    ++it;
+  glyphs.insert(it, handle);
+  m_glyphCount++;
+  return handle;
+}
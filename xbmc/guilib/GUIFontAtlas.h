@@ -0,0 +1,117 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+/*!
+ \ingroup textures
+ \brief Allocates space for glyphs in a set of texture pages.
+
+ Each page is divided into rows of the same height, and glyphs are packed left to right
+ into the rows. Pages and rows are opened as they are needed. Once all pages are full the
+ least recently used glyphs are evicted to make room, except for glyphs used since a given
+ point in time, which may still be queued for rendering.
+ */
+class CGUIFontAtlas
+{
+public:
+  struct Slot
+  {
+    unsigned int page;
+    unsigned int x;
+    unsigned int y;
+  };
+
+  CGUIFontAtlas();
+
+  /*! \brief Free all glyphs and set the geometry of the pages
+   \param pageWidth width of each page
+   \param pageHeight maximal height of each page
+   \param rowHeight height of each row
+   \param maxPages maximal number of pages
+   */
+  void Reset(unsigned int pageWidth, unsigned int pageHeight, unsigned int rowHeight, unsigned int maxPages);
+
+  /*! \brief Find space for a glyph, evicting least recently used glyphs if needed
+   \param width width needed for the glyph
+   \param key identifies the glyph, reported back when the glyph is evicted
+   \param protectFrom glyphs used at or after this time are not evicted
+   \param slot [out] where to place the glyph
+   \param evicted [out] keys of the glyphs that were evicted
+   \return handle of the glyph, or -1 if there is no space
+   \sa Touch
+   */
+  int Allocate(unsigned int width, uint32_t key, unsigned int protectFrom, Slot &slot, std::vector<uint32_t> &evicted);
+
+  /*! \brief Mark a glyph as used
+   \param handle the handle returned by Allocate
+   \param time the current time, in any monotonic unit
+   */
+  void Touch(int handle, unsigned int time) { m_glyphs[handle].lastUsed = time; }
+
+  /*! \brief Height of a page that is in use by its rows
+   */
+  unsigned int GetUsedHeight(unsigned int page) const { return m_pages[page].rows.size() * m_rowHeight; }
+  unsigned int GetPageCount() const { return m_pages.size(); }
+  unsigned int GetGlyphCount() const { return m_glyphCount; }
+  unsigned int GetEvictions() const { return m_evictions; }
+
+private:
+  struct Glyph
+  {
+    unsigned int page;
+    unsigned int row;
+    unsigned int x;
+    unsigned int width;
+    unsigned int lastUsed;
+    uint32_t key;
+    bool used;
+  };
+
+  struct Row
+  {
+    std::vector<int> glyphs; ///< sorted by position
+  };
+
+  struct Page
+  {
+    std::vector<Row> rows;
+  };
+
+  bool FindSpace(unsigned int width, unsigned int &page, unsigned int &row, unsigned int &x);
+  bool FindSpaceInRow(unsigned int page, unsigned int row, unsigned int width, unsigned int &x) const;
+  bool EvictFor(unsigned int width, unsigned int protectFrom, std::vector<uint32_t> &evicted);
+  void Evict(unsigned int page, unsigned int row, unsigned int index, std::vector<uint32_t> &evicted);
+  int AddGlyph(unsigned int page, unsigned int row, unsigned int x, unsigned int width, uint32_t key);
+
+  unsigned int m_pageWidth;
+  unsigned int m_rowsPerPage;
+  unsigned int m_rowHeight;
+  unsigned int m_maxPages;
+
+  std::vector<Page>  m_pages;
+  std::vector<Glyph> m_glyphs;     ///< indexed by handle
+  std::vector<int>   m_freeHandles;
+  unsigned int m_glyphCount;
+  unsigned int m_evictions;
+};
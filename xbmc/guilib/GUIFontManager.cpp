@@ -29,7 +29,9 @@
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/lib/Setting.h"
+#include "utils/CharsetConverter.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
@@ -40,6 +42,14 @@
 
 using namespace std;
 
+// render the characters we commonly need up front, rather than while scrolling through lists
+static void PrewarmFontFile(CGUIFontTTFBase *font)
+{
+  CStdStringW characters;
+  g_charsetConverter.utf8ToW(g_advancedSettings.m_guiFontPrewarm, characters, false);
+  font->Prewarm(characters);
+}
+
 GUIFontManager::GUIFontManager(void)
 {
   m_canReload = true;
@@ -149,6 +159,7 @@ CGUIFont* GUIFontManager::LoadTTF(const CStdString& strFontName, const CStdStrin
       return NULL;
     }
 
+    PrewarmFontFile(pFontFile);
     m_vecFontFiles.push_back(pFontFile);
   }
 
@@ -232,6 +243,7 @@ void GUIFontManager::ReloadTTFFonts(void)
         return;
       }
 
+      PrewarmFontFile(pFontFile);
       m_vecFontFiles.push_back(pFontFile);
     }
 
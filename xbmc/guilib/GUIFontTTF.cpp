@@ -50,6 +50,7 @@ using namespace std;
 
 #define CHARS_PER_TEXTURE_LINE 20 // number of characters to cache per texture line
 #define CHAR_CHUNK    64      // 64 chars allocated at a time (1024 bytes)
+#define MAX_TEXTURE_PAGES 4   // number of texture pages before least recently used characters are evicted
 
 int CGUIFontTTFBase::justification_word_weight = 6;   // weight of word spacing over letter spacing when justifying.
                                                   // A larger number means more of the "dead space" is placed between
@@ -155,13 +156,12 @@ XBMC_GLOBAL_REF(CFreeTypeLibrary, g_freeTypeLibrary); // our freetype library
 
 CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
 {
-  m_texture = NULL;
   m_char = NULL;
   m_maxChars = 0;
   m_nestedBeginCount = 0;
-
-  m_vertex_size   = 4*1024;
-  m_vertex        = (SVertex*)malloc(m_vertex_size * sizeof(SVertex));
+  m_maxPages = MAX_TEXTURE_PAGES;
+  m_useCounter = 0;
+  m_cacheRebuilds = 0;
 
   m_face = NULL;
   m_stroker = NULL;
@@ -171,13 +171,10 @@ CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
   m_originX = m_originY = 0.0f;
   m_cellBaseLine = m_cellHeight = 0;
   m_numChars = 0;
-  m_posX = m_posY = 0;
-  m_textureHeight = m_textureWidth = 0;
-  m_textureScaleX = m_textureScaleY = 0.0;
+  m_textureWidth = 0;
+  m_textureScaleX = 0.0;
   m_ellipsesWidth = m_height = 0.0f;
   m_color = 0;
-  m_vertex_count = 0;
-  m_nTexture = 0;
 }
 
 CGUIFontTTFBase::~CGUIFontTTFBase(void)
@@ -201,33 +198,32 @@ void CGUIFontTTFBase::RemoveReference()
 
 void CGUIFontTTFBase::ClearCharacterCache()
 {
-  delete(m_texture);
+  for (unsigned int i = 0; i < m_pages.size(); i++)
+    delete m_pages[i].texture;
+  m_pages.clear();
 
   DeleteHardwareTexture();
 
-  m_texture = NULL;
   delete[] m_char;
   m_char = new Character[CHAR_CHUNK];
   memset(m_charquick, 0, sizeof(m_charquick));
   m_numChars = 0;
   m_maxChars = CHAR_CHUNK;
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
-  m_textureHeight = 0;
+  // pages are created on first character write.
+  m_atlas.Reset(m_textureWidth, g_Windowing.GetMaxTextureSize(), GetTextureLineHeight(), m_maxPages);
 }
 
 void CGUIFontTTFBase::Clear()
 {
-  delete(m_texture);
-  m_texture = NULL;
+  for (unsigned int i = 0; i < m_pages.size(); i++)
+    delete m_pages[i].texture;
+  m_pages.clear();
   delete[] m_char;
   memset(m_charquick, 0, sizeof(m_charquick));
   m_char = NULL;
   m_maxChars = 0;
   m_numChars = 0;
-  m_posX = 0;
-  m_posY = 0;
+  m_atlas.Reset(0, 0, 1, 0);
   m_nestedBeginCount = 0;
 
   if (m_face)
@@ -237,10 +233,6 @@ void CGUIFontTTFBase::Clear()
     g_freeTypeLibrary.ReleaseStroker(m_stroker);
   m_stroker = NULL;
 
-  free(m_vertex);
-  m_vertex = NULL;
-  m_vertex_count = 0;
-
   m_strFileName.clear();
   m_fontFileInMemory.clear();
 }
@@ -303,8 +295,9 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
   m_height = height;
 
-  delete(m_texture);
-  m_texture = NULL;
+  for (unsigned int i = 0; i < m_pages.size(); i++)
+    delete m_pages[i].texture;
+  m_pages.clear();
   delete[] m_char;
   m_char = NULL;
 
@@ -313,7 +306,6 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
   m_strFilename = strFilename;
 
-  m_textureHeight = 0;
   m_textureWidth = ((m_cellHeight * CHARS_PER_TEXTURE_LINE) & ~63) + 64;
 
   m_textureWidth = CBaseTexture::PadPow2(m_textureWidth);
@@ -322,9 +314,8 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
     m_textureWidth = g_Windowing.GetMaxTextureSize();
   m_textureScaleX = 1.0f / m_textureWidth;
 
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
+  // pages are created on first character write, and may each grow up to the maximal texture size.
+  m_atlas.Reset(m_textureWidth, g_Windowing.GetMaxTextureSize(), GetTextureLineHeight(), m_maxPages);
 
   // cache the ellipses width
   Character *ellipse = GetCharacter(L'.');
@@ -501,8 +492,13 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   if (letter < 255)
   {
     character_t ch = (style << 8) | letter;
-    if (m_charquick[ch])
-      return m_charquick[ch];
+    Character *c = m_charquick[ch];
+    if (c)
+    {
+      if (c->atlasHandle >= 0)
+        m_atlas.Touch(c->atlasHandle, ++m_useCounter);
+      return c;
+    }
   }
 
   // letters are stored based on style and letter
@@ -518,9 +514,54 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
     else if (ch < m_char[mid].letterAndStyle)
       high = mid - 1;
     else
+    {
+      if (m_char[mid].atlasHandle >= 0)
+        m_atlas.Touch(m_char[mid].atlasHandle, ++m_useCounter);
       return &m_char[mid];
+    }
+  }
+
+  // render the character to our texture
+  // must End() as we can't render text to our texture during a Begin(), End() block
+  // this also means no queued quad refers to a character that is evicted to make room
+  unsigned int nestedBeginCount = m_nestedBeginCount;
+  m_nestedBeginCount = 1;
+  if (nestedBeginCount) End();
+  Character newChar;
+  if (!CacheCharacter(letter, style, &newChar))
+  { // unable to cache character - try clearing them all out and starting over
+    CLog::Log(LOGDEBUG, "%s: Unable to cache character.  Clearing character cache of %i characters", __FUNCTION__, m_numChars);
+    ClearCharacterCache();
+    m_cacheRebuilds++;
+    if (!CacheCharacter(letter, style, &newChar))
+    {
+      CLog::Log(LOGERROR, "%s: Unable to cache character (out of memory?)", __FUNCTION__);
+      if (nestedBeginCount) Begin();
+      m_nestedBeginCount = nestedBeginCount;
+      return NULL;
+    }
   }
-  // if we get to here, then low is where we should insert the new character
+  if (nestedBeginCount) Begin();
+  m_nestedBeginCount = nestedBeginCount;
+
+  if (newChar.atlasHandle >= 0)
+    m_atlas.Touch(newChar.atlasHandle, ++m_useCounter);
+  return InsertCharacter(newChar);
+}
+
+CGUIFontTTFBase::Character* CGUIFontTTFBase::InsertCharacter(const Character &ch)
+{
+  int low = 0;
+  int high = m_numChars - 1;
+  while (low <= high)
+  {
+    int mid = (low + high) >> 1;
+    if (ch.letterAndStyle > m_char[mid].letterAndStyle)
+      low = mid + 1;
+    else
+      high = mid - 1;
+  }
+  // low is where we should insert the new character
 
   // increase the size of the buffer if we need it
   if (m_numChars >= m_maxChars)
@@ -540,28 +581,42 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   { // just move the data along as necessary
     memmove(m_char + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
   }
-  // render the character to our texture
-  // must End() as we can't render text to our texture during a Begin(), End() block
-  unsigned int nestedBeginCount = m_nestedBeginCount;
-  m_nestedBeginCount = 1;
-  if (nestedBeginCount) End();
-  if (!CacheCharacter(letter, style, m_char + low))
-  { // unable to cache character - try clearing them all out and starting over
-    CLog::Log(LOGDEBUG, "%s: Unable to cache character.  Clearing character cache of %i characters", __FUNCTION__, m_numChars);
-    ClearCharacterCache();
-    low = 0;
-    if (!CacheCharacter(letter, style, m_char + low))
+  m_char[low] = ch;
+  m_numChars++;
+
+  UpdateQuickAccess();
+  return m_char + low;
+}
+
+void CGUIFontTTFBase::RemoveCharacters(const std::vector<uint32_t> &letterAndStyles)
+{
+  if (letterAndStyles.empty())
+    return;
+
+  for (std::vector<uint32_t>::const_iterator it = letterAndStyles.begin(); it != letterAndStyles.end(); ++it)
+  {
+    int low = 0;
+    int high = m_numChars - 1;
+    while (low <= high)
     {
-      CLog::Log(LOGERROR, "%s: Unable to cache character (out of memory?)", __FUNCTION__);
-      if (nestedBeginCount) Begin();
-      m_nestedBeginCount = nestedBeginCount;
-      return NULL;
+      int mid = (low + high) >> 1;
+      if (*it > m_char[mid].letterAndStyle)
+        low = mid + 1;
+      else if (*it < m_char[mid].letterAndStyle)
+        high = mid - 1;
+      else
+      {
+        memmove(m_char + mid, m_char + mid + 1, (m_numChars - mid - 1) * sizeof(Character));
+        m_numChars--;
+        break;
+      }
     }
   }
-  if (nestedBeginCount) Begin();
-  m_nestedBeginCount = nestedBeginCount;
+  UpdateQuickAccess();
+}
 
-  // fixup quick access
+void CGUIFontTTFBase::UpdateQuickAccess()
+{
   memset(m_charquick, 0, sizeof(m_charquick));
   for(int i=0;i<m_numChars;i++)
   {
@@ -571,8 +626,6 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
       m_charquick[ch] = m_char+i;
     }
   }
-
-  return m_char + low;
 }
 
 bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
@@ -609,73 +662,80 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   FT_Bitmap bitmap = bitGlyph->bitmap;
   bool isEmptyGlyph = (bitmap.width == 0 || bitmap.rows == 0);
 
+  CGUIFontAtlas::Slot slot = { 0, 0, 0 };
+  int handle = -1;
   if (!isEmptyGlyph)
   {
-    if (bitGlyph->left < 0)
-      m_posX += -bitGlyph->left;
-
-    // check we have enough room for the character
-    if (m_posX + bitGlyph->left + bitmap.width > (int)m_textureWidth)
-    { // no space - gotta drop to the next line (which means creating a new texture and copying it across)
-      m_posX = 0;
-      m_posY += GetTextureLineHeight();
-      if (bitGlyph->left < 0)
-        m_posX += -bitGlyph->left;
-
-      if(m_posY + GetTextureLineHeight() >= m_textureHeight)
-      {
-        // create the new larger texture
-        unsigned int newHeight = m_posY + GetTextureLineHeight();
-        // check for max height
-        if (newHeight > g_Windowing.GetMaxTextureSize())
-        {
-          CLog::Log(LOGDEBUG, "%s: New cache texture is too large (%u > %u pixels long)", __FUNCTION__, newHeight, g_Windowing.GetMaxTextureSize());
-          FT_Done_Glyph(glyph);
-          return false;
-        }
-
-        CBaseTexture* newTexture = NULL;
-        newTexture = ReallocTexture(newHeight);
-        if(newTexture == NULL)
-        {
-          FT_Done_Glyph(glyph);
-          CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
-          return false;
-        }
-        m_texture = newTexture;
-      }
-    }
-
-    if(m_texture == NULL)
+    // find room for the character, evicting the least recently used ones if the pages are full.
+    // nothing is queued for rendering while we cache (see GetCharacter) so all of them may go.
+    std::vector<uint32_t> evicted;
+    handle = m_atlas.Allocate(bitmap.width + spacing_between_characters_in_texture, (style << 16) | letter,
+                              m_useCounter + 1, slot, evicted);
+    RemoveCharacters(evicted);
+    if (handle < 0)
     {
+      CLog::Log(LOGDEBUG, "%s: No room in the character cache for %x", __FUNCTION__, letter);
       FT_Done_Glyph(glyph);
-      CLog::Log(LOGDEBUG, "%s: no texture to cache character to", __FUNCTION__);
       return false;
     }
+
+    if (slot.page >= m_pages.size())
+      m_pages.resize(slot.page + 1);
+    TexturePage &page = m_pages[slot.page];
+
+    unsigned int newHeight = m_atlas.GetUsedHeight(slot.page);
+    if (page.texture == NULL || page.texture->GetHeight() < newHeight)
+    {
+      // create the new larger texture
+      CBaseTexture* newTexture = ReallocTexture(slot.page, newHeight);
+      if(newTexture == NULL)
+      {
+        FT_Done_Glyph(glyph);
+        CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
+        return false;
+      }
+      page.texture = newTexture;
+      page.scaleY = 1.0f / newTexture->GetHeight();
+    }
   }
   // set the character in our table
   ch->letterAndStyle = (style << 16) | letter;
   ch->offsetX = (short)bitGlyph->left;
   ch->offsetY = (short)m_cellBaseLine - bitGlyph->top;
-  ch->left = isEmptyGlyph ? 0 : ((float)m_posX + ch->offsetX);
-  ch->top = isEmptyGlyph ? 0 : ((float)m_posY + ch->offsetY);
+  ch->left = isEmptyGlyph ? 0 : (float)slot.x;
+  ch->top = isEmptyGlyph ? 0 : ((float)slot.y + ch->offsetY);
   ch->right = ch->left + bitmap.width;
   ch->bottom = ch->top + bitmap.rows;
   ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
+  ch->page = slot.page;
+  ch->atlasHandle = handle;
 
   // we need only render if we actually have some pixels
   if (!isEmptyGlyph)
   {
-    // ensure our rect will stay inside the texture (it *should* but we need to be certain)
-    unsigned int x1 = max(m_posX + ch->offsetX, 0);
-    unsigned int y1 = max(m_posY + ch->offsetY, 0);
-    unsigned int x2 = min(x1 + bitmap.width, m_textureWidth);
-    unsigned int y2 = min(y1 + bitmap.rows, m_textureHeight);
-    CopyCharToTexture(bitGlyph, x1, y1, x2, y2);
-  
-    m_posX += spacing_between_characters_in_texture + (unsigned short)max(ch->right - ch->left + ch->offsetX, ch->advance);
+    /* the slot may have held evicted characters, so we fill the whole cell, clipping the glyph
+       to it.  Glyphs fit in their cell by construction, but we need to be certain. */
+    TexturePage &page = m_pages[slot.page];
+    unsigned int x1 = slot.x;
+    unsigned int y1 = slot.y;
+    unsigned int x2 = min(x1 + bitmap.width + spacing_between_characters_in_texture, m_textureWidth);
+    unsigned int y2 = min(y1 + GetTextureLineHeight(), page.texture->GetHeight());
+
+    FT_BitmapGlyphRec cell = *bitGlyph;
+    cell.bitmap.width = x2 - x1;
+    cell.bitmap.rows = y2 - y1;
+    cell.bitmap.pitch = cell.bitmap.width;
+    m_glyphBuffer.assign(cell.bitmap.width * cell.bitmap.rows, 0);
+    cell.bitmap.buffer = &m_glyphBuffer[0];
+
+    for (int y = 0; y < (int)bitmap.rows; y++)
+    {
+      int row = ch->offsetY + y;
+      if (row >= 0 && row < (int)cell.bitmap.rows)
+        memcpy(cell.bitmap.buffer + row * cell.bitmap.pitch, bitmap.buffer + y * bitmap.pitch, min((int)bitmap.width, cell.bitmap.pitch));
+    }
+    CopyCharToTexture(slot.page, &cell, x1, y1, x2, y2);
   }
-  m_numChars++;
 
   // free the glyph
   FT_Done_Glyph(glyph);
@@ -744,27 +804,21 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
   z[3] = (float)MathUtils::round_int(g_graphicsContext.ScaleFinalZCoord(vertex.x1, vertex.y2));
 
   // tex coords converted to 0..1 range
+  TexturePage &page = m_pages[ch->page];
   float tl = texture.x1 * m_textureScaleX;
   float tr = texture.x2 * m_textureScaleX;
-  float tt = texture.y1 * m_textureScaleY;
-  float tb = texture.y2 * m_textureScaleY;
+  float tt = texture.y1 * page.scaleY;
+  float tb = texture.y2 * page.scaleY;
 
-  // grow the vertex buffer if required
-  if(m_vertex_count >= m_vertex_size)
+  m_color = color;
+  if (m_vertexRuns.empty() || m_vertexRuns.back().page != ch->page)
   {
-    m_vertex_size *= 2;
-    void* old      = m_vertex;
-    m_vertex       = (SVertex*)realloc(m_vertex, m_vertex_size * sizeof(SVertex));
-    if (!m_vertex)
-    {
-      free(old);
-      CLog::Log(LOGSEVERE, "%s: can't allocate %" PRIdS" bytes for texture", __FUNCTION__ , m_vertex_size * sizeof(SVertex));
-      return;
-    }
+    VertexRun run = { ch->page, (unsigned int)m_vertices.size(), 0 };
+    m_vertexRuns.push_back(run);
   }
-
-  m_color = color;
-  SVertex* v = m_vertex + m_vertex_count;
+  m_vertexRuns.back().count += 4;
+  m_vertices.resize(m_vertices.size() + 4);
+  SVertex* v = &m_vertices[m_vertices.size() - 4];
 
   unsigned char r = GET_R(color)
               , g = GET_G(color)
@@ -831,8 +885,26 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
   v[3].y = y[2];
   v[3].z = z[2];
 #endif
+}
+
+void CGUIFontTTFBase::ClearVertices()
+{
+  m_vertices.clear();
+  m_vertexRuns.clear();
+}
+
+void CGUIFontTTFBase::Prewarm(const CStdStringW &characters)
+{
+  for (unsigned int i = 0; i < characters.size(); i++)
+    GetCharacter(characters[i]);
+}
 
-  m_vertex_count+=4;
+void CGUIFontTTFBase::GetCacheStats(unsigned int &pages, unsigned int &glyphs, unsigned int &evictions, unsigned int &rebuilds) const
+{
+  pages = m_atlas.GetPageCount();
+  glyphs = m_atlas.GetGlyphCount();
+  evictions = m_atlas.GetEvictions();
+  rebuilds = m_cacheRebuilds;
 }
 
 // Oblique code - original taken from freetype2 (ftsynth.c)
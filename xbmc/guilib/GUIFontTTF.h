@@ -28,6 +28,7 @@
  */
 
 #include "utils/auto_buffer.h"
+#include "GUIFontAtlas.h"
 
 // forward definition
 class CBaseTexture;
@@ -84,6 +85,19 @@ public:
 
   const CStdString& GetFileName() const { return m_strFileName; };
 
+  /*! \brief Render a set of characters to the cache ahead of their first use
+   \param characters the characters to cache, in the regular style
+   */
+  void Prewarm(const CStdStringW &characters);
+
+  /*! \brief Statistics of the character cache
+   \param pages number of texture pages in use
+   \param glyphs number of glyphs held in the pages
+   \param evictions number of glyphs evicted to make room for others
+   \param rebuilds number of times the whole cache had to be cleared
+   */
+  void GetCacheStats(unsigned int &pages, unsigned int &glyphs, unsigned int &evictions, unsigned int &rebuilds) const;
+
 protected:
   struct Character
   {
@@ -91,6 +105,8 @@ protected:
     float left, top, right, bottom;
     float advance;
     character_t letterAndStyle;
+    unsigned short page;       // texture page holding the glyph
+    int atlasHandle;           // handle in m_atlas, -1 for glyphs without pixels
   };
   void AddReference();
   void RemoveReference();
@@ -111,23 +127,54 @@ protected:
   // Stuff for pre-rendering for speed
   inline Character *GetCharacter(character_t letter);
   bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
+  Character *InsertCharacter(const Character &ch);
+  void RemoveCharacters(const std::vector<uint32_t> &letterAndStyles);
+  void UpdateQuickAccess();
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
   void ClearCharacterCache();
+  void ClearVertices();
 
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
+  /*! \brief Create a larger texture for a page, copying across the characters of the old one
+   \param page the page to grow, its texture is NULL if the page is new
+   \param newHeight [in/out] the height needed, updated to the height allocated
+   \return the new texture, the old one is deleted
+   */
+  virtual CBaseTexture* ReallocTexture(unsigned int page, unsigned int& newHeight) = 0;
+  virtual bool CopyCharToTexture(unsigned int page, FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
   virtual void DeleteHardwareTexture() = 0;
 
   // modifying glyphs
   void EmboldenGlyph(FT_GlyphSlot slot);
   static void ObliqueGlyph(FT_GlyphSlot slot);
 
-  CBaseTexture* m_texture;        // texture that holds our rendered characters (8bit alpha only)
+  struct TexturePage
+  {
+    TexturePage() : texture(NULL), scaleY(0.0f) {}
+    CBaseTexture* texture;           // texture that holds our rendered characters (8bit alpha only)
+    float scaleY;
+  };
+  std::vector<TexturePage> m_pages;
+
+  /*! \brief Consecutive quads of m_vertices textured from the same page.
+   The quads are drawn in the order they were laid out, so that shadows stay
+   beneath their text, with a new draw whenever the page changes.
+   */
+  struct VertexRun
+  {
+    unsigned int page;               // page the quads are textured from
+    unsigned int start;              // first vertex of the run in m_vertices
+    unsigned int count;              // number of vertices in the run
+  };
+  std::vector<SVertex>   m_vertices;   // quads queued for rendering
+  std::vector<VertexRun> m_vertexRuns;
 
-  unsigned int m_textureWidth;       // width of our texture
-  unsigned int m_textureHeight;      // heigth of our texture
-  int m_posX;                        // current position in the texture
-  int m_posY;
+  CGUIFontAtlas m_atlas;             // where the characters are placed in the pages
+  unsigned int m_maxPages;           // maximal number of pages before characters are evicted
+  unsigned int m_useCounter;         // incremented on every character lookup, for LRU eviction
+  unsigned int m_cacheRebuilds;      // number of times the character cache was cleared
+  std::vector<unsigned char> m_glyphBuffer;
+
+  unsigned int m_textureWidth;       // width of our texture pages
 
   /*! \brief the height of each line in the texture.
    Accounts for spacing between lines to avoid characters overlapping.
@@ -156,14 +203,7 @@ protected:
   float m_originX;
   float m_originY;
 
-  unsigned int m_nTexture;
-
-  SVertex* m_vertex;
-  int      m_vertex_count;
-  int      m_vertex_size;
-
   float    m_textureScaleX;
-  float    m_textureScaleY;
 
   static int justification_word_weight;
 
@@ -40,14 +40,13 @@ using namespace std;
 CGUIFontTTFDX::CGUIFontTTFDX(const CStdString& strFileName)
 : CGUIFontTTFBase(strFileName)
 {
-  m_speedupTexture = NULL;
   m_index      = NULL;
   m_index_size = 0;
 }
 
 CGUIFontTTFDX::~CGUIFontTTFDX(void)
 {
-  SAFE_DELETE(m_speedupTexture);
+  DeleteHardwareTexture();
   free(m_index);
 }
 
@@ -58,11 +57,10 @@ void CGUIFontTTFDX::Begin()
   if (pD3DDevice == NULL)
     CLog::Log(LOGERROR, __FUNCTION__" - failed to get Direct3D device");
 
-  if (m_nestedBeginCount == 0 && pD3DDevice != NULL && m_texture != NULL)
+  if (m_nestedBeginCount == 0 && pD3DDevice != NULL && !m_pages.empty())
   {
     int unit = 0;
-    // just have to blit from our texture.
-    m_texture->BindToUnit(unit);
+    // just have to blit from our texture, which is bound for each page in End()
     pD3DDevice->SetTextureStageState( unit, D3DTSS_COLOROP, D3DTOP_SELECTARG1 ); // only use diffuse
     pD3DDevice->SetTextureStageState( unit, D3DTSS_COLORARG1, D3DTA_DIFFUSE);
     pD3DDevice->SetTextureStageState( unit, D3DTSS_ALPHAOP, D3DTOP_MODULATE );
@@ -93,7 +91,7 @@ void CGUIFontTTFDX::Begin()
     pD3DDevice->SetRenderState( D3DRS_LIGHTING, FALSE);
 
     pD3DDevice->SetFVF(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1);
-    m_vertex_count = 0;
+    ClearVertices();
   }
 
   // Keep track of the nested begin/end calls.
@@ -110,17 +108,21 @@ void CGUIFontTTFDX::End()
   if (--m_nestedBeginCount > 0)
     return;
 
-  if (m_vertex_count == 0)
+  unsigned vertex_count = 0;
+  for (unsigned int i = 0; i < m_vertexRuns.size(); i++)
+    vertex_count = std::max<unsigned>(vertex_count, m_vertexRuns[i].count);
+
+  if (vertex_count == 0)
     return;
 
-  unsigned index_size = m_vertex_size * 6 / 4;
+  unsigned index_size = vertex_count * 6 / 4;
   if(m_index_size < index_size)
   {
     uint16_t* id  = (uint16_t*)calloc(index_size, sizeof(uint16_t));
     if(id == NULL)
       return;
 
-    for(int i = 0, b = 0; i < m_vertex_size; i += 4, b += 6)
+    for(unsigned i = 0, b = 0; i < vertex_count; i += 4, b += 6)
     {
       id[b+0] = i + 0;
       id[b+1] = i + 1;
@@ -147,31 +149,36 @@ void CGUIFontTTFDX::End()
 
   pD3DDevice->SetTransform(D3DTS_WORLD, &world);
 
-  pD3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST
-                                    , 0
-                                    , m_vertex_count
-                                    , m_vertex_count / 2
-                                    , m_index
-                                    , D3DFMT_INDEX16
-                                    , m_vertex
-                                    , sizeof(SVertex));
+  // one draw call for each run of quads from the same page, in the order they were laid out
+  for (unsigned int i = 0; i < m_vertexRuns.size(); i++)
+  {
+    const VertexRun &run = m_vertexRuns[i];
+    m_pages[run.page].texture->BindToUnit(0);
+    pD3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST
+                                      , 0
+                                      , run.count
+                                      , run.count / 2
+                                      , m_index
+                                      , D3DFMT_INDEX16
+                                      , &m_vertices[run.start]
+                                      , sizeof(SVertex));
+  }
   pD3DDevice->SetTransform(D3DTS_WORLD, &orig);
 
   pD3DDevice->SetTexture(0, NULL);
   pD3DDevice->SetTextureStageState( 0, D3DTSS_COLOROP, D3DTOP_MODULATE );
 }
 
-CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
+CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int page, unsigned int& newHeight)
 {
   assert(newHeight != 0);
   assert(m_textureWidth != 0);
-  if(m_textureHeight == 0)
-  {
-    delete m_texture;
-    m_texture = NULL;
-    delete m_speedupTexture;
-    m_speedupTexture = NULL;
-  }
+  if (page >= m_speedupTextures.size())
+    m_speedupTextures.resize(page + 1, NULL);
+
+  CBaseTexture* oldTexture = m_pages[page].texture;
+  CD3DTexture* oldSpeedupTexture = m_speedupTextures[page];
+  unsigned int oldHeight = oldTexture ? oldTexture->GetHeight() : 0;
 
   CDXTexture* pNewTexture = new CDXTexture(m_textureWidth, newHeight, XB_FMT_A8);
   pNewTexture->CreateTextureObject();
@@ -201,16 +208,16 @@ CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
 
   LPDIRECT3DSURFACE9 pSource, pTarget;
   // There might be data to copy from the previous texture
-  if ((newSpeedupTexture && m_speedupTexture) || (newTexture && m_texture))
+  if ((newSpeedupTexture && oldSpeedupTexture) || (newTexture && oldTexture))
   {
-    if (m_speedupTexture && newSpeedupTexture)
+    if (oldSpeedupTexture && newSpeedupTexture)
     {
-      m_speedupTexture->GetSurfaceLevel(0, &pSource);
+      oldSpeedupTexture->GetSurfaceLevel(0, &pSource);
       newSpeedupTexture->GetSurfaceLevel(0, &pTarget);
     }
     else
     {
-      ((CDXTexture *)m_texture)->GetTextureObject()->GetSurfaceLevel(0, &pSource);
+      ((CDXTexture *)oldTexture)->GetTextureObject()->GetSurfaceLevel(0, &pSource);
       newTexture->GetSurfaceLevel(0, &pTarget);
     }
 
@@ -234,11 +241,11 @@ CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
 
     if (srcPitch == dstPitch)
     {
-      memcpy(dst, src, srcPitch * m_textureHeight);
+      memcpy(dst, src, srcPitch * oldHeight);
     }
     else
     {
-      for (unsigned int y = 0; y < m_textureHeight; y++)
+      for (unsigned int y = 0; y < oldHeight; y++)
       {
         memcpy(dst, src, minPitch);
         src += srcPitch;
@@ -253,12 +260,12 @@ CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
   }
 
   // Upload from speedup texture to main texture
-  if (newSpeedupTexture && m_speedupTexture)
+  if (newSpeedupTexture && oldSpeedupTexture)
   {
     LPDIRECT3DSURFACE9 pSource, pTarget;
     newSpeedupTexture->GetSurfaceLevel(0, &pSource);
     newTexture->GetSurfaceLevel(0, &pTarget);
-    const RECT rect = { 0, 0, m_textureWidth, m_textureHeight };
+    const RECT rect = { 0, 0, m_textureWidth, oldHeight };
     const POINT point = { 0, 0 };
 
     HRESULT hr = g_Windowing.Get3DDevice()->UpdateSurface(pSource, &rect, pTarget, &point);
@@ -274,23 +281,22 @@ CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
     }
   }
 
-  SAFE_DELETE(m_texture);
-  SAFE_DELETE(m_speedupTexture);
-  m_textureHeight = newHeight;
-  m_textureScaleY = 1.0f / m_textureHeight;
-  m_speedupTexture = newSpeedupTexture;
+  SAFE_DELETE(oldTexture);
+  SAFE_DELETE(oldSpeedupTexture);
+  m_speedupTextures[page] = newSpeedupTexture;
 
   return pNewTexture;
 }
 
-bool CGUIFontTTFDX::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
+bool CGUIFontTTFDX::CopyCharToTexture(unsigned int page, FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
 {
   FT_Bitmap bitmap = bitGlyph->bitmap;
+  CD3DTexture* speedupTexture = page < m_speedupTextures.size() ? m_speedupTextures[page] : NULL;
 
-  LPDIRECT3DTEXTURE9 texture = ((CDXTexture *)m_texture)->GetTextureObject();
+  LPDIRECT3DTEXTURE9 texture = ((CDXTexture *)m_pages[page].texture)->GetTextureObject();
   LPDIRECT3DSURFACE9 target;
-  if (m_speedupTexture)
-    m_speedupTexture->GetSurfaceLevel(0, &target);
+  if (speedupTexture)
+    speedupTexture->GetSurfaceLevel(0, &target);
   else
     texture->GetSurfaceLevel(0, &target);
 
@@ -309,10 +315,10 @@ bool CGUIFontTTFDX::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1,
     return false;
   }
 
-  if (m_speedupTexture)
+  if (speedupTexture)
   {
     // Upload to GPU - the automatic dirty region tracking takes care of the rect.
-    HRESULT hr = g_Windowing.Get3DDevice()->UpdateTexture(m_speedupTexture->Get(), texture);
+    HRESULT hr = g_Windowing.Get3DDevice()->UpdateTexture(speedupTexture->Get(), texture);
     if (FAILED(hr))
     {
       CLog::Log(LOGERROR, __FUNCTION__": Failed to upload from sysmem to vidmem (0x%08X)", hr);
@@ -325,7 +331,9 @@ bool CGUIFontTTFDX::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1,
 
 void CGUIFontTTFDX::DeleteHardwareTexture()
 {
-  
+  for (unsigned int i = 0; i < m_speedupTextures.size(); i++)
+    SAFE_DELETE(m_speedupTextures[i]);
+  m_speedupTextures.clear();
 }
 
 
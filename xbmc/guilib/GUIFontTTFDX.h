@@ -45,11 +45,11 @@ public:
   virtual void End();
 
 protected:
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight);
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
+  virtual CBaseTexture* ReallocTexture(unsigned int page, unsigned int& newHeight);
+  virtual bool CopyCharToTexture(unsigned int page, FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
   virtual void DeleteHardwareTexture();
-  CD3DTexture *m_speedupTexture;  // extra texture to speed up reallocations when the main texture is in d3dpool_default.
-                                  // that's the typical situation of Windows Vista and above.
+  std::vector<CD3DTexture*> m_speedupTextures;  // extra texture per page to speed up reallocations when the main texture is in d3dpool_default.
+                                                // that's the typical situation of Windows Vista and above.
   uint16_t* m_index;
   unsigned  m_index_size;
 };
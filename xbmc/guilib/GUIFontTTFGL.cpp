@@ -21,6 +21,7 @@
 #include "system.h"
 #include "GUIFont.h"
 #include "GUIFontTTFGL.h"
+#include "GUIRenderBatchGL.h"
 #include "GUIFontManager.h"
 #include "Texture.h"
 #include "TextureManager.h"
@@ -44,104 +45,92 @@ using namespace std;
 CGUIFontTTFGL::CGUIFontTTFGL(const CStdString& strFileName)
 : CGUIFontTTFBase(strFileName)
 {
-  m_updateY1 = 0;
-  m_updateY2 = 0;
-  m_textureStatus = TEXTURE_VOID;
 }
 
 CGUIFontTTFGL::~CGUIFontTTFGL(void)
 {
 }
 
-void CGUIFontTTFGL::Begin()
+CGUIFontTTFGL::HardwarePage &CGUIFontTTFGL::GetHardwarePage(unsigned int page)
 {
-  if (m_nestedBeginCount == 0 && m_texture != NULL)
-  {
-    if (m_textureStatus == TEXTURE_REALLOCATED)
-    {
-      if (glIsTexture(m_nTexture))
-        g_TextureManager.ReleaseHwTexture(m_nTexture);
-      m_textureStatus = TEXTURE_VOID;
-    }
-    
-    if (m_textureStatus == TEXTURE_VOID)
-    {
-      // Have OpenGL generate a texture object handle for us
-      glGenTextures(1, (GLuint*) &m_nTexture);
+  if (page >= m_hardwarePages.size())
+    m_hardwarePages.resize(page + 1);
+  return m_hardwarePages[page];
+}
+
+void CGUIFontTTFGL::UploadPage(unsigned int page)
+{
+  CBaseTexture *texture = m_pages[page].texture;
+  HardwarePage &hwPage = GetHardwarePage(page);
+  if (texture == NULL)
+    return;
 
-      // Bind the texture object
-      glBindTexture(GL_TEXTURE_2D, m_nTexture);
 #ifdef HAS_GL
-      glEnable(GL_TEXTURE_2D);
+  // quads queued for rendering must see the page as it was when they were laid out
+  if (hwPage.status != TEXTURE_READY)
+    CGUIRenderBatchGL::Get().Flush();
 #endif
-      // Set the texture's stretching properties
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-      // Set the texture image -- THIS WORKS, so the pixels must be wrong.
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_texture->GetWidth(), m_texture->GetHeight(), 0,
-                   GL_ALPHA, GL_UNSIGNED_BYTE, 0);
-      
-      VerifyGLState();
-      m_textureStatus = TEXTURE_UPDATED;
-    }
+  if (hwPage.status == TEXTURE_REALLOCATED)
+  {
+    if (glIsTexture(hwPage.texture))
+      g_TextureManager.ReleaseHwTexture(hwPage.texture);
+    hwPage.status = TEXTURE_VOID;
+  }
 
-    if (m_textureStatus == TEXTURE_UPDATED)
-    {
-      glBindTexture(GL_TEXTURE_2D, m_nTexture);
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_updateY1, m_texture->GetWidth(), m_updateY2 - m_updateY1, GL_ALPHA, GL_UNSIGNED_BYTE,
-                      m_texture->GetPixels() + m_updateY1 * m_texture->GetPitch());
-      glDisable(GL_TEXTURE_2D);
-        
-      m_updateY1 = m_updateY2 = 0;
-      m_textureStatus = TEXTURE_READY;
-    }
+  if (hwPage.status == TEXTURE_VOID)
+  {
+    // Have OpenGL generate a texture object handle for us
+    glGenTextures(1, (GLuint*) &hwPage.texture);
 
-    // Turn Blending On
-    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
-    glEnable(GL_BLEND);
+    // Bind the texture object
+    glBindTexture(GL_TEXTURE_2D, hwPage.texture);
 #ifdef HAS_GL
     glEnable(GL_TEXTURE_2D);
 #endif
-    glBindTexture(GL_TEXTURE_2D, m_nTexture);
+    // Set the texture's stretching properties
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Set the texture image -- THIS WORKS, so the pixels must be wrong.
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, texture->GetWidth(), texture->GetHeight(), 0,
+                 GL_ALPHA, GL_UNSIGNED_BYTE, 0);
 
-#ifdef HAS_GL
-    glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_COMBINE);
-    glTexEnvi(GL_TEXTURE_ENV,GL_COMBINE_RGB,GL_REPLACE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE0);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     VerifyGLState();
+    hwPage.status = TEXTURE_UPDATED;
+  }
 
-    if(g_Windowing.UseLimitedColor())
-    {
-      glActiveTexture(GL_TEXTURE1);
-      glBindTexture(GL_TEXTURE_2D, m_nTexture); // dummy bind
-      glEnable(GL_TEXTURE_2D);
-
-      const GLfloat rgba[4] = {16.0f / 255.0f, 16.0f / 255.0f, 16.0f / 255.0f, 0.0f};
-      glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE , GL_COMBINE);
-      glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, rgba);
-      glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_RGB      , GL_ADD);
-      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_RGB      , GL_PREVIOUS);
-      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE1_RGB      , GL_CONSTANT);
-      glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND0_RGB     , GL_SRC_COLOR);
-      glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND1_RGB     , GL_SRC_COLOR);
-      glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_ALPHA    , GL_REPLACE);
-      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_ALPHA    , GL_PREVIOUS);
-      VerifyGLState();
-    }
+  if (hwPage.status == TEXTURE_UPDATED)
+  {
+    glBindTexture(GL_TEXTURE_2D, hwPage.texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, hwPage.updateY1, texture->GetWidth(), hwPage.updateY2 - hwPage.updateY1, GL_ALPHA, GL_UNSIGNED_BYTE,
+                    texture->GetPixels() + hwPage.updateY1 * texture->GetPitch());
+    glDisable(GL_TEXTURE_2D);
+
+    hwPage.updateY1 = hwPage.updateY2 = 0;
+    hwPage.status = TEXTURE_READY;
+  }
+}
 
+void CGUIFontTTFGL::Begin()
+{
+  if (m_nestedBeginCount == 0 && !m_pages.empty())
+  {
+    for (unsigned int i = 0; i < m_pages.size(); i++)
+      UploadPage(i);
+
+#ifdef HAS_GL
+    // texture and combiner state is set up by the GUI render batch as the quads are drawn
 #else
+    // Turn Blending On
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
+    glEnable(GL_BLEND);
+    glBindTexture(GL_TEXTURE_2D, m_hardwarePages[0].texture);
+
     g_Windowing.EnableGUIShader(SM_FONTS);
 #endif
 
-    m_vertex_count = 0;
+    ClearVertices();
   }
   // Keep track of the nested begin/end calls.
   m_nestedBeginCount++;
@@ -156,56 +145,67 @@ void CGUIFontTTFGL::End()
     return;
 
 #ifdef HAS_GL
-  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
-
-  glColorPointer   (4, GL_UNSIGNED_BYTE, sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, r));
-  glVertexPointer  (3, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, x));
-  glTexCoordPointer(2, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, u));
-  glEnableClientState(GL_COLOR_ARRAY);
-  glEnableClientState(GL_VERTEX_ARRAY);
-  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-  glDrawArrays(GL_QUADS, 0, m_vertex_count);
-  glPopClientAttrib();
-
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
+  // hand the quads to the GUI render batch in the order they were laid out, which
+  // draws them together with the textures and other fonts that share the page's state
+  CGUIRenderBatchGL &batch = CGUIRenderBatchGL::Get();
+  bool limitedColor = g_Windowing.UseLimitedColor();
+  for (std::vector<VertexRun>::const_iterator run = m_vertexRuns.begin(); run != m_vertexRuns.end(); ++run)
+  {
+    CGUIRenderBatchGL::Vertex *v = batch.AddQuads(CGUIRenderBatchGL::MODE_FONT, m_hardwarePages[run->page].texture, 0, limitedColor, run->count / 4);
+    for (unsigned int j = run->start; j < run->start + run->count; j++, v++)
+    {
+      const SVertex &vertex = m_vertices[j];
+      v->x = vertex.x;
+      v->y = vertex.y;
+      v->z = vertex.z;
+      v->r = vertex.r;
+      v->g = vertex.g;
+      v->b = vertex.b;
+      v->a = vertex.a;
+      v->u0 = v->u1 = vertex.u;
+      v->v0 = v->v1 = vertex.v;
+    }
+  }
 #else
   // GLES 2.0 version. Cannot draw quads. Convert to triangles.
   GLint posLoc  = g_Windowing.GUIShaderGetPos();
   GLint colLoc  = g_Windowing.GUIShaderGetCol();
   GLint tex0Loc = g_Windowing.GUIShaderGetCoord0();
 
-  // stack object until VBOs will be used
-  std::vector<SVertex> vecVertices( 6 * (m_vertex_count / 4) );
-  SVertex *vertices = &vecVertices[0];
+  glEnableVertexAttribArray(posLoc);
+  glEnableVertexAttribArray(colLoc);
+  glEnableVertexAttribArray(tex0Loc);
 
-  for (int i=0; i<m_vertex_count; i+=4)
+  // one draw call for each run of quads from the same page, in the order they were laid out
+  for (std::vector<VertexRun>::const_iterator run = m_vertexRuns.begin(); run != m_vertexRuns.end(); ++run)
   {
-    *vertices++ = m_vertex[i];
-    *vertices++ = m_vertex[i+1];
-    *vertices++ = m_vertex[i+2];
+    const SVertex *quads = &m_vertices[run->start];
 
-    *vertices++ = m_vertex[i+1];
-    *vertices++ = m_vertex[i+3];
-    *vertices++ = m_vertex[i+2];
-  }
+    // stack object until VBOs will be used
+    std::vector<SVertex> vecVertices( 6 * (run->count / 4) );
+    SVertex *vertices = &vecVertices[0];
 
-  vertices = &vecVertices[0];
+    for (unsigned int i=0; i<run->count; i+=4)
+    {
+      *vertices++ = quads[i];
+      *vertices++ = quads[i+1];
+      *vertices++ = quads[i+2];
 
-  glVertexAttribPointer(posLoc,  3, GL_FLOAT,         GL_FALSE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, x));
-  // Normalize color values. Does not affect Performance at all.
-  glVertexAttribPointer(colLoc,  4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, r));
-  glVertexAttribPointer(tex0Loc, 2, GL_FLOAT,         GL_FALSE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, u));
+      *vertices++ = quads[i+1];
+      *vertices++ = quads[i+3];
+      *vertices++ = quads[i+2];
+    }
 
-  glEnableVertexAttribArray(posLoc);
-  glEnableVertexAttribArray(colLoc);
-  glEnableVertexAttribArray(tex0Loc);
+    vertices = &vecVertices[0];
+
+    glBindTexture(GL_TEXTURE_2D, m_hardwarePages[run->page].texture);
+    glVertexAttribPointer(posLoc,  3, GL_FLOAT,         GL_FALSE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, x));
+    // Normalize color values. Does not affect Performance at all.
+    glVertexAttribPointer(colLoc,  4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, r));
+    glVertexAttribPointer(tex0Loc, 2, GL_FLOAT,         GL_FALSE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, u));
 
-  glDrawArrays(GL_TRIANGLES, 0, vecVertices.size());
+    glDrawArrays(GL_TRIANGLES, 0, vecVertices.size());
+  }
 
   glDisableVertexAttribArray(posLoc);
   glDisableVertexAttribArray(colLoc);
@@ -215,7 +215,7 @@ void CGUIFontTTFGL::End()
 #endif
 }
 
-CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int& newHeight)
+CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int page, unsigned int& newHeight)
 {
   newHeight = CBaseTexture::PadPow2(newHeight);
 
@@ -227,69 +227,69 @@ CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int& newHeight)
     delete newTexture;
     return NULL;
   }
-  m_textureHeight = newTexture->GetHeight();
-  m_textureScaleY = 1.0f / m_textureHeight;
-  m_textureWidth = newTexture->GetWidth();
-  m_textureScaleX = 1.0f / m_textureWidth;
-  if (m_textureHeight < newHeight)
-    CLog::Log(LOGWARNING, "%s: allocated new texture with height of %d, requested %d", __FUNCTION__, m_textureHeight, newHeight);
-
-  memset(newTexture->GetPixels(), 0, m_textureHeight * newTexture->GetPitch());
-  if (m_texture)
+  if (newTexture->GetHeight() < newHeight)
+    CLog::Log(LOGWARNING, "%s: allocated new texture with height of %d, requested %d", __FUNCTION__, newTexture->GetHeight(), newHeight);
+
+  HardwarePage &hwPage = GetHardwarePage(page);
+  CBaseTexture* oldTexture = m_pages[page].texture;
+  memset(newTexture->GetPixels(), 0, newTexture->GetHeight() * newTexture->GetPitch());
+  if (oldTexture)
   {
-    m_updateY1 = 0;
-    m_updateY2 = m_texture->GetHeight();
+    hwPage.updateY1 = 0;
+    hwPage.updateY2 = oldTexture->GetHeight();
 
-    unsigned char* src = (unsigned char*) m_texture->GetPixels();
+    unsigned char* src = (unsigned char*) oldTexture->GetPixels();
     unsigned char* dst = (unsigned char*) newTexture->GetPixels();
-    for (unsigned int y = 0; y < m_texture->GetHeight(); y++)
+    for (unsigned int y = 0; y < oldTexture->GetHeight(); y++)
     {
-      memcpy(dst, src, m_texture->GetPitch());
-      src += m_texture->GetPitch();
+      memcpy(dst, src, oldTexture->GetPitch());
+      src += oldTexture->GetPitch();
       dst += newTexture->GetPitch();
     }
-    delete m_texture;
+    delete oldTexture;
   }
 
-  m_textureStatus = TEXTURE_REALLOCATED;
+  hwPage.status = TEXTURE_REALLOCATED;
 
   return newTexture;
 }
 
-bool CGUIFontTTFGL::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
+bool CGUIFontTTFGL::CopyCharToTexture(unsigned int page, FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
 {
   FT_Bitmap bitmap = bitGlyph->bitmap;
+  CBaseTexture* texture = m_pages[page].texture;
 
   unsigned char* source = (unsigned char*) bitmap.buffer;
-  unsigned char* target = (unsigned char*) m_texture->GetPixels() + y1 * m_texture->GetPitch() + x1;
+  unsigned char* target = (unsigned char*) texture->GetPixels() + y1 * texture->GetPitch() + x1;
 
   for (unsigned int y = y1; y < y2; y++)
   {
     memcpy(target, source, x2-x1);
     source += bitmap.width;
-    target += m_texture->GetPitch();
+    target += texture->GetPitch();
   }
-  
-  switch (m_textureStatus)
+
+  HardwarePage &hwPage = GetHardwarePage(page);
+  switch (hwPage.status)
   {
   case TEXTURE_UPDATED:
     {
-      m_updateY1 = std::min(m_updateY1, y1);
-      m_updateY2 = std::max(m_updateY2, y2);
+      hwPage.updateY1 = std::min(hwPage.updateY1, y1);
+      hwPage.updateY2 = std::max(hwPage.updateY2, y2);
     }
     break;
       
   case TEXTURE_READY:
     {
-      m_updateY1 = y1;
-      m_updateY2 = y2;
-      m_textureStatus = TEXTURE_UPDATED;
+      hwPage.updateY1 = y1;
+      hwPage.updateY2 = y2;
+      hwPage.status = TEXTURE_UPDATED;
     }
     break;
       
   case TEXTURE_REALLOCATED:
     {
-      m_updateY2 = std::max(m_updateY2, y2);
+      hwPage.updateY2 = std::max(hwPage.updateY2, y2);
     }
     break;
 
@@ -304,14 +304,13 @@ bool CGUIFontTTFGL::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1,
 
 void CGUIFontTTFGL::DeleteHardwareTexture()
 {
-  if (m_textureStatus != TEXTURE_VOID)
+  for (unsigned int i = 0; i < m_hardwarePages.size(); i++)
   {
-    if (glIsTexture(m_nTexture))
-      g_TextureManager.ReleaseHwTexture(m_nTexture);
-
-    m_textureStatus = TEXTURE_VOID;
-    m_updateY1 = m_updateY2 = 0;
+    HardwarePage &hwPage = m_hardwarePages[i];
+    if (hwPage.status != TEXTURE_VOID && glIsTexture(hwPage.texture))
+      g_TextureManager.ReleaseHwTexture(hwPage.texture);
   }
+  m_hardwarePages.clear();
 }
 
 #endif
@@ -45,14 +45,11 @@ public:
   virtual void End();
 
 protected:
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight);
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
+  virtual CBaseTexture* ReallocTexture(unsigned int page, unsigned int& newHeight);
+  virtual bool CopyCharToTexture(unsigned int page, FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
   virtual void DeleteHardwareTexture();
     
 private:
-  unsigned int m_updateY1;
-  unsigned int m_updateY2;
-  
   enum TextureStatus
   {
     TEXTURE_VOID = 0,
@@ -60,8 +57,20 @@ private:
     TEXTURE_REALLOCATED,
     TEXTURE_UPDATED,
   };
-  
-  TextureStatus m_textureStatus;
+
+  struct HardwarePage
+  {
+    HardwarePage() : texture(0), updateY1(0), updateY2(0), status(TEXTURE_VOID) {}
+    unsigned int texture;
+    unsigned int updateY1;
+    unsigned int updateY2;
+    TextureStatus status;
+  };
+
+  HardwarePage &GetHardwarePage(unsigned int page);
+  void UploadPage(unsigned int page);
+
+  std::vector<HardwarePage> m_hardwarePages;
 };
 
 #endif
@@ -308,6 +308,11 @@ const CStdString &CGUIImage::GetFileName() const
   return m_texture.GetFileName();
 }
 
+bool CGUIImage::CanPrefetch() const
+{
+  return m_texture.CanPrefetch();
+}
+
 void CGUIImage::SetAspectRatio(const CAspectRatio &aspect)
 {
   m_texture.SetAspectRatio(aspect);
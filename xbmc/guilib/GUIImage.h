@@ -93,6 +93,7 @@ public:
   void SetCrossFade(unsigned int time);
 
   const CStdString& GetFileName() const;
+  bool CanPrefetch() const;
   float GetTextureWidth() const;
   float GetTextureHeight() const;
 
@@ -116,6 +116,24 @@ void CGUIListGroup::UpdateInfo(const CGUIListItem *item)
   }
 }
 
+void CGUIListGroup::GetPrefetchImages(std::vector<CStdString> &paths) const
+{
+  for (ciControls it = m_children.begin(); it != m_children.end(); it++)
+  {
+    const CGUIControl *child = *it;
+    if (!child->IsVisible())
+      continue;
+    if (child->GetControlType() == CGUIControl::GUICONTROL_IMAGE || child->GetControlType() == CGUIControl::GUICONTROL_BORDEREDIMAGE)
+    {
+      const CGUIImage *image = (const CGUIImage *)child;
+      if (image->CanPrefetch())
+        paths.push_back(image->GetFileName());
+    }
+    else if (child->GetControlType() == CGUIControl::GUICONTROL_LISTGROUP)
+      ((const CGUIListGroup *)child)->GetPrefetchImages(paths);
+  }
+}
+
 void CGUIListGroup::EnlargeWidth(float difference)
 {
   // Alters the width of the controls that have an ID of 1 to 14
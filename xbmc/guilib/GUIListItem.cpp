@@ -36,6 +36,7 @@ CGUIListItem::CGUIListItem(const CGUIListItem& item)
 {
   m_layout = NULL;
   m_focusedLayout = NULL;
+  m_invalidations = 0;
   *this = item;
   SetInvalid();
 }
@@ -50,6 +51,7 @@ CGUIListItem::CGUIListItem(void)
   m_overlayIcon = ICON_OVERLAY_NONE;
   m_layout = NULL;
   m_focusedLayout = NULL;
+  m_invalidations = 0;
 }
 
 CGUIListItem::CGUIListItem(const std::string& strLabel)
@@ -63,6 +65,7 @@ CGUIListItem::CGUIListItem(const std::string& strLabel)
   m_overlayIcon = ICON_OVERLAY_NONE;
   m_layout = NULL;
   m_focusedLayout = NULL;
+  m_invalidations = 0;
 }
 
 CGUIListItem::~CGUIListItem(void)
@@ -391,6 +394,7 @@ CGUIListItemLayout *CGUIListItem::GetFocusedLayout()
 
 void CGUIListItem::SetInvalid()
 {
+  m_invalidations++;
   if (m_layout) m_layout->SetInvalid();
   if (m_focusedLayout) m_focusedLayout->SetInvalid();
 }
@@ -145,6 +145,11 @@ public:
   void FreeMemory(bool immediately = false);
   void SetInvalid();
 
+  /*! \brief Number of times the item has been invalidated
+   Allows layouts that were prepared ahead of time to tell whether the item changed since.
+   */
+  unsigned int GetInvalidations() const { return m_invalidations; };
+
   bool m_bIsFolder;     ///< is item a folder or a file
 
   void SetProperty(const std::string &strKey, const CVariant &value);
@@ -177,6 +182,7 @@ protected:
 
   CGUIListItemLayout *m_layout;
   CGUIListItemLayout *m_focusedLayout;
+  unsigned int m_invalidations;
   bool m_bSelected;     // item is selected or not
 
   struct icompare
@@ -68,21 +68,29 @@ float CGUIListItemLayout::Size(ORIENTATION orientation) const
   return (orientation == HORIZONTAL) ? m_width : m_height;
 }
 
+void CGUIListItemLayout::Prepare(CGUIListItem *item)
+{
+  m_invalidated = false;
+  // could use a dynamic cast here if RTTI was enabled.  As it's not,
+  // let's use a static cast with a virtual base function
+  CFileItem *fileItem = item->IsFileItem() ? (CFileItem *)item : new CFileItem(*item);
+  m_isPlaying.Update(item);
+  m_group.SetInvalid();
+  m_group.UpdateInfo(fileItem);
+  // delete our temporary fileitem
+  if (!item->IsFileItem())
+    delete fileItem;
+}
+
+void CGUIListItemLayout::GetPrefetchImages(std::vector<CStdString> &paths) const
+{
+  m_group.GetPrefetchImages(paths);
+}
+
 void CGUIListItemLayout::Process(CGUIListItem *item, int parentID, unsigned int currentTime, CDirtyRegionList &dirtyregions)
 {
   if (m_invalidated)
-  { // need to update our item
-    m_invalidated = false;
-    // could use a dynamic cast here if RTTI was enabled.  As it's not,
-    // let's use a static cast with a virtual base function
-    CFileItem *fileItem = item->IsFileItem() ? (CFileItem *)item : new CFileItem(*item);
-    m_isPlaying.Update(item);
-    m_group.SetInvalid();
-    m_group.UpdateInfo(fileItem);
-    // delete our temporary fileitem
-    if (!item->IsFileItem())
-      delete fileItem;
-  }
+    Prepare(item); // need to update our item
 
   // update visibility, and render
   m_group.SetState(item->IsSelected() || m_isPlaying, m_focused);
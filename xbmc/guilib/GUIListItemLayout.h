@@ -35,6 +35,21 @@ public:
   CGUIListItemLayout(const CGUIListItemLayout &from);
   virtual ~CGUIListItemLayout();
   void LoadLayout(TiXmlElement *layout, int context, bool focused);
+
+  /*! \brief Fill the layout's labels and images with the information of an item
+   Process() does this whenever the layout has been invalidated. It may also be done ahead of
+   time on another thread, for a layout that thread owns. Fonts lock the graphics context
+   themselves when they measure text.
+   \param item the item to get the information from
+   \sa CGUIContainerPreparer
+   */
+  void Prepare(CGUIListItem *item);
+
+  /*! \brief Get the images of a prepared layout that the large texture manager may load ahead of time
+   \param paths the paths of the images are appended to this
+   \sa CGUILargeTextureManager::PrefetchImage
+   */
+  void GetPrefetchImages(std::vector<CStdString> &paths) const;
   void Process(CGUIListItem *item, int parentID, unsigned int currentTime, CDirtyRegionList &dirtyregions);
   void Render(CGUIListItem *item, int parentID);
   float Size(ORIENTATION orientation) const;
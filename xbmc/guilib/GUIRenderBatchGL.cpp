@@ -0,0 +1,345 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIRenderBatchGL.h"
+
+#if defined(HAS_GL)
+
+#include "utils/log.h"
+#include "utils/GLUtils.h"
+
+#include <stddef.h>
+
+// the units are used for the texture, the diffuse texture and the limited colour range stage
+#define BATCH_UNITS 3
+
+// the combiner setups a unit can have
+enum Combiner
+{
+  COMBINER_NONE = 0,         // unit disabled
+  COMBINER_MODULATE_PRIMARY, // texture * primary colour
+  COMBINER_MODULATE_PREVIOUS,// texture * previous unit
+  COMBINER_FONT,             // primary colour, alpha from texture * primary colour
+  COMBINER_LIMITED           // previous unit + 16/255 on the colour channels
+};
+
+struct UnitSetup
+{
+  GLuint   texture;
+  Combiner combiner;
+};
+
+static void GetUnitSetup(CGUIRenderBatchGL::Mode mode, GLuint texture, GLuint diffuse, bool limitedColor, UnitSetup *units)
+{
+  for (unsigned int i = 0; i < BATCH_UNITS; i++)
+  {
+    units[i].texture = 0;
+    units[i].combiner = COMBINER_NONE;
+  }
+
+  unsigned int unit = 0;
+  switch (mode)
+  {
+  case CGUIRenderBatchGL::MODE_COLOR:
+    // no texture to run the limited range stage on
+    return;
+  case CGUIRenderBatchGL::MODE_TEXTURE:
+    units[unit].texture = texture;
+    units[unit++].combiner = COMBINER_MODULATE_PRIMARY;
+    break;
+  case CGUIRenderBatchGL::MODE_TEXTURE_DIFFUSE:
+    units[unit].texture = texture;
+    units[unit++].combiner = COMBINER_MODULATE_PRIMARY;
+    units[unit].texture = diffuse;
+    units[unit++].combiner = COMBINER_MODULATE_PREVIOUS;
+    break;
+  case CGUIRenderBatchGL::MODE_FONT:
+    units[unit].texture = texture;
+    units[unit++].combiner = COMBINER_FONT;
+    break;
+  }
+
+  if (limitedColor)
+  {
+    units[unit].texture = texture; // dummy bind, the stage doesn't sample it
+    units[unit].combiner = COMBINER_LIMITED;
+  }
+}
+
+CGUIRenderBatchGL::CGUIRenderBatchGL()
+{
+  m_stateApplied = false;
+  m_bufferSupport = BUFFER_UNKNOWN;
+  m_buffer = 0;
+  m_bufferSize = 0;
+  m_drawCalls = 0;
+  m_stateChanges = 0;
+  m_lastDrawCalls = 0;
+  m_lastStateChanges = 0;
+}
+
+CGUIRenderBatchGL &CGUIRenderBatchGL::Get()
+{
+  static CGUIRenderBatchGL batch;
+  return batch;
+}
+
+CGUIRenderBatchGL::Vertex *CGUIRenderBatchGL::AddQuads(Mode mode, GLuint texture, GLuint diffuse, bool limitedColor, unsigned int quads)
+{
+  State state;
+  state.mode = mode;
+  state.texture = mode == MODE_COLOR ? 0 : texture;
+  state.diffuse = mode == MODE_TEXTURE_DIFFUSE ? diffuse : 0;
+  state.limitedColor = mode == MODE_COLOR ? false : limitedColor;
+
+  if (state != m_batchState)
+  {
+    DrawBatch();
+    m_batchState = state;
+  }
+
+  size_t size = m_vertices.size();
+  m_vertices.resize(size + 4 * quads);
+  return &m_vertices[size];
+}
+
+void CGUIRenderBatchGL::Flush()
+{
+  DrawBatch();
+
+  if (!m_stateApplied)
+    return;
+
+  // hand back the state the GUI had before the batching
+  for (int unit = BATCH_UNITS - 1; unit >= 0; unit--)
+    DisableUnit(unit);
+
+  glClientActiveTexture(GL_TEXTURE1);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glClientActiveTexture(GL_TEXTURE0);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  if (m_bufferSupport == BUFFER_VBO)
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  m_stateApplied = false;
+}
+
+void CGUIRenderBatchGL::BeginFrame()
+{
+  m_lastDrawCalls = m_drawCalls;
+  m_lastStateChanges = m_stateChanges;
+  m_drawCalls = 0;
+  m_stateChanges = 0;
+}
+
+void CGUIRenderBatchGL::Reset()
+{
+  Flush();
+  if (m_buffer)
+    glDeleteBuffers(1, &m_buffer);
+  m_buffer = 0;
+  m_bufferSize = 0;
+  m_bufferSupport = BUFFER_UNKNOWN;
+}
+
+void CGUIRenderBatchGL::GetFrameStats(unsigned int &drawCalls, unsigned int &stateChanges) const
+{
+  drawCalls = m_lastDrawCalls;
+  stateChanges = m_lastStateChanges;
+}
+
+void CGUIRenderBatchGL::DrawBatch()
+{
+  if (m_vertices.empty())
+    return;
+
+  ApplyState(m_batchState);
+
+  const char *base = UploadVertices();
+  glVertexPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, x));
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), base + offsetof(Vertex, r));
+  glClientActiveTexture(GL_TEXTURE1);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, u1));
+  glClientActiveTexture(GL_TEXTURE0);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, u0));
+
+  glDrawArrays(GL_QUADS, 0, m_vertices.size());
+  m_drawCalls++;
+
+  // keep the memory around for the next batch
+  m_vertices.clear();
+}
+
+const char *CGUIRenderBatchGL::UploadVertices()
+{
+  if (m_bufferSupport == BUFFER_UNKNOWN)
+  {
+    m_bufferSupport = GLEW_VERSION_1_5 ? BUFFER_VBO : BUFFER_NONE;
+    if (m_bufferSupport == BUFFER_VBO)
+      glGenBuffers(1, &m_buffer);
+    CLog::Log(LOGDEBUG, "CGUIRenderBatchGL: using %s for GUI vertices", m_bufferSupport == BUFFER_VBO ? "a vertex buffer" : "client memory");
+  }
+
+  if (m_bufferSupport != BUFFER_VBO)
+    return (const char *)&m_vertices[0];
+
+  size_t bytes = m_vertices.size() * sizeof(Vertex);
+  glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+  // orphan the storage of the previous batch so we don't wait for the GPU to finish with it
+  if (bytes > m_bufferSize)
+    m_bufferSize = bytes;
+  glBufferData(GL_ARRAY_BUFFER, m_bufferSize, NULL, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, &m_vertices[0]);
+  return NULL;
+}
+
+void CGUIRenderBatchGL::ApplyState(const State &state)
+{
+  if (m_stateApplied && state == m_appliedState)
+    return;
+
+  UnitSetup wanted[BATCH_UNITS], current[BATCH_UNITS];
+  GetUnitSetup(state.mode, state.texture, state.diffuse, state.limitedColor, wanted);
+
+  if (!m_stateApplied)
+  {
+    glEnable(GL_BLEND);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glClientActiveTexture(GL_TEXTURE1);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glClientActiveTexture(GL_TEXTURE0);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    // force everything below to be set up
+    for (unsigned int i = 0; i < BATCH_UNITS; i++)
+    {
+      current[i].texture = (GLuint)-1;
+      current[i].combiner = (Combiner)-1;
+    }
+  }
+  else
+    GetUnitSetup(m_appliedState.mode, m_appliedState.texture, m_appliedState.diffuse, m_appliedState.limitedColor, current);
+
+  bool font = state.mode == MODE_FONT;
+  if (!m_stateApplied || font != (m_appliedState.mode == MODE_FONT))
+  {
+    if (font)
+      glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
+    else
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  }
+
+  for (unsigned int unit = 0; unit < BATCH_UNITS; unit++)
+  {
+    if (wanted[unit].texture == current[unit].texture && wanted[unit].combiner == current[unit].combiner)
+      continue;
+
+    if (wanted[unit].combiner == COMBINER_NONE)
+    {
+      DisableUnit(unit);
+      continue;
+    }
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    if (current[unit].combiner == COMBINER_NONE || !m_stateApplied)
+      glEnable(GL_TEXTURE_2D);
+    if (wanted[unit].texture != current[unit].texture)
+      glBindTexture(GL_TEXTURE_2D, wanted[unit].texture);
+    if (wanted[unit].combiner != current[unit].combiner)
+    {
+      switch (wanted[unit].combiner)
+      {
+      case COMBINER_MODULATE_PRIMARY:
+        SetupCombiner(false);
+        break;
+      case COMBINER_MODULATE_PREVIOUS:
+        SetupCombiner(true);
+        break;
+      case COMBINER_FONT:
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_REPLACE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
+        glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+        glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+        glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
+        glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+        break;
+      case COMBINER_LIMITED:
+        SetupLimitedColor();
+        break;
+      default:
+        break;
+      }
+    }
+  }
+  glActiveTexture(GL_TEXTURE0);
+  VerifyGLState();
+
+  m_appliedState = state;
+  m_stateApplied = true;
+  m_stateChanges++;
+}
+
+void CGUIRenderBatchGL::SetupCombiner(bool texturePrevious)
+{
+  GLint source = texturePrevious ? GL_PREVIOUS : GL_PRIMARY_COLOR;
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+  glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+  glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
+  glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+  glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, source);
+  glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+
+  glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+  glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+  glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, source);
+  glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+  glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+}
+
+void CGUIRenderBatchGL::SetupLimitedColor()
+{
+  const GLfloat rgba[4] = {16.0f / 255.0f, 16.0f / 255.0f, 16.0f / 255.0f, 0.0f};
+  glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE , GL_COMBINE);
+  glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, rgba);
+  glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_RGB      , GL_ADD);
+  glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_RGB      , GL_PREVIOUS);
+  glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE1_RGB      , GL_CONSTANT);
+  glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND0_RGB     , GL_SRC_COLOR);
+  glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND1_RGB     , GL_SRC_COLOR);
+
+  glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_ALPHA    , GL_REPLACE);
+  glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_ALPHA    , GL_PREVIOUS);
+}
+
+void CGUIRenderBatchGL::DisableUnit(unsigned int unit)
+{
+  glActiveTexture(GL_TEXTURE0 + unit);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+}
+
+#endif
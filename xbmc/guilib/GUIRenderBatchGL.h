@@ -0,0 +1,140 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "system.h"
+
+#if defined(HAS_GL)
+
+#include "system_gl.h"
+
+#include <vector>
+
+/*!
+ \ingroup textures
+ \brief Collects the quads of GUI textures and fonts and draws them in as few calls as possible.
+
+ Quads are queued together with the texture, combiner and blend state they need. As long as
+ consecutive quads share that state they are appended to the same batch, and the batch is
+ only drawn once the state changes or somebody else is about to touch the GL state.
+
+ Code that draws with OpenGL directly must call Flush() first. The render system does so
+ whenever the viewport, scissors, transform or stereo mode change, and CGraphicContext does
+ so in BeginPaint(), which is used by the video renderers, visualisations and add-ons.
+ */
+class CGUIRenderBatchGL
+{
+public:
+  enum Mode
+  {
+    MODE_COLOR = 0,       ///< untextured, primary colour only
+    MODE_TEXTURE,         ///< texture modulated by primary colour
+    MODE_TEXTURE_DIFFUSE, ///< texture modulated by a diffuse texture and primary colour
+    MODE_FONT             ///< alpha from the glyph texture, colour from primary colour
+  };
+
+  struct Vertex
+  {
+    float x, y, z;
+    unsigned char r, g, b, a;
+    float u0, v0;
+    float u1, v1;
+  };
+
+  static CGUIRenderBatchGL &Get();
+
+  /*! \brief Reserve room for quads drawn with the given state
+   Draws the queued quads first if they need a different state.
+   \param mode combiner and blend setup of the quads
+   \param texture GL texture object bound to the first unit, 0 for MODE_COLOR
+   \param diffuse GL texture object bound to the second unit, only for MODE_TEXTURE_DIFFUSE
+   \param limitedColor whether to add the limited range offset to the colour
+   \param quads number of quads to add
+   \return pointer to the 4 * quads vertices to fill in
+   */
+  Vertex *AddQuads(Mode mode, GLuint texture, GLuint diffuse, bool limitedColor, unsigned int quads);
+
+  /*! \brief Draw all queued quads and hand the GL state back to the caller
+   Leaves all texture units unbound and disabled, and the client arrays disabled.
+   */
+  void Flush();
+
+  /*! \brief Start counting draw calls and state changes for a new frame
+   */
+  void BeginFrame();
+
+  /*! \brief Forget all GL objects, for when the GL context is going away
+   */
+  void Reset();
+
+  /*! \brief Draw calls and state changes issued during the last complete frame
+   */
+  void GetFrameStats(unsigned int &drawCalls, unsigned int &stateChanges) const;
+
+private:
+  CGUIRenderBatchGL();
+  CGUIRenderBatchGL(const CGUIRenderBatchGL &);
+  CGUIRenderBatchGL const& operator=(CGUIRenderBatchGL const&);
+
+  struct State
+  {
+    State() : mode(MODE_COLOR), texture(0), diffuse(0), limitedColor(false) {}
+    bool operator==(const State &right) const
+    {
+      return mode == right.mode && texture == right.texture && diffuse == right.diffuse && limitedColor == right.limitedColor;
+    }
+    bool operator!=(const State &right) const { return !(*this == right); }
+
+    Mode   mode;
+    GLuint texture;
+    GLuint diffuse;
+    bool   limitedColor;
+  };
+
+  void DrawBatch();
+  void ApplyState(const State &state);
+  void SetupCombiner(bool texturePrevious);
+  void SetupLimitedColor();
+  void DisableUnit(unsigned int unit);
+  const char *UploadVertices();
+
+  std::vector<Vertex> m_vertices;
+  State m_batchState;    ///< state of the queued quads
+  State m_appliedState;  ///< state currently set up in GL
+  bool  m_stateApplied;  ///< whether m_appliedState is valid
+
+  enum BufferSupport
+  {
+    BUFFER_UNKNOWN = 0,
+    BUFFER_NONE,
+    BUFFER_VBO
+  };
+  BufferSupport m_bufferSupport;
+  GLuint        m_buffer;
+  size_t        m_bufferSize;
+
+  unsigned int m_drawCalls;
+  unsigned int m_stateChanges;
+  unsigned int m_lastDrawCalls;
+  unsigned int m_lastStateChanges;
+};
+
+#endif
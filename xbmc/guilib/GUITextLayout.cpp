@@ -22,11 +22,111 @@
 #include "GUIFont.h"
 #include "GUIControl.h"
 #include "GUIColorManager.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #include "utils/CharsetConverter.h"
 #include "utils/StringUtils.h"
 
+#include <list>
+#include <map>
+
+#define LAYOUT_CACHE_SIZE 2048
+
 using namespace std;
 
+/*! \brief Least recently used cache of laid out text, shared by all text layouts.
+ List containers recycle their item layouts while scrolling, so the same labels are laid
+ out over and over again.
+ */
+class CGUITextLayoutCache
+{
+public:
+  struct Key
+  {
+    unsigned int font;
+    std::string utf8;
+    CStdStringW text;
+    float maxWidth;
+    float maxHeight;
+    color_t color;
+    bool forceLTRReadingOrder;
+    float scaleX; ///< GUI scale the text was measured at, the font metrics depend on it
+    float scaleY;
+
+    bool operator<(const Key &right) const
+    {
+      if (font != right.font) return font < right.font;
+      if (scaleX != right.scaleX) return scaleX < right.scaleX;
+      if (scaleY != right.scaleY) return scaleY < right.scaleY;
+      if (maxWidth != right.maxWidth) return maxWidth < right.maxWidth;
+      if (maxHeight != right.maxHeight) return maxHeight < right.maxHeight;
+      if (color != right.color) return color < right.color;
+      if (forceLTRReadingOrder != right.forceLTRReadingOrder) return right.forceLTRReadingOrder;
+      int compare = utf8.compare(right.utf8);
+      if (compare != 0) return compare < 0;
+      return text.compare(right.text) < 0;
+    }
+  };
+
+  struct Layout
+  {
+    vector<CGUIString> lines;
+    vecColors colors;
+    float width;
+    float height;
+  };
+
+  CGUITextLayoutCache() : m_hits(0), m_misses(0) {}
+
+  bool Get(const Key &key, Layout &layout)
+  {
+    CSingleLock lock(m_section);
+    map<Key, LayoutList::iterator>::iterator it = m_index.find(key);
+    if (it == m_index.end())
+    {
+      m_misses++;
+      return false;
+    }
+    // move to the front, it's now the most recently used
+    m_layouts.splice(m_layouts.begin(), m_layouts, it->second);
+    layout = it->second->second;
+    m_hits++;
+    return true;
+  }
+
+  void Add(const Key &key, const Layout &layout)
+  {
+    CSingleLock lock(m_section);
+    if (m_index.find(key) != m_index.end())
+      return;
+    m_layouts.push_front(make_pair(key, layout));
+    m_index.insert(make_pair(key, m_layouts.begin()));
+    if (m_layouts.size() > LAYOUT_CACHE_SIZE)
+    {
+      m_index.erase(m_layouts.back().first);
+      m_layouts.pop_back();
+    }
+  }
+
+  void GetStats(unsigned int &hits, unsigned int &misses, unsigned int &entries)
+  {
+    CSingleLock lock(m_section);
+    hits = m_hits;
+    misses = m_misses;
+    entries = m_index.size();
+  }
+
+private:
+  typedef list< pair<Key, Layout> > LayoutList;
+  LayoutList m_layouts; ///< most recently used first
+  map<Key, LayoutList::iterator> m_index;
+  unsigned int m_hits;
+  unsigned int m_misses;
+  CCriticalSection m_section;
+};
+
+static CGUITextLayoutCache g_textLayoutCache;
+
 CGUIString::CGUIString(iString start, iString end, bool carriageReturn)
 {
   m_text.assign(start, end);
@@ -221,9 +321,13 @@ bool CGUITextLayout::Update(const CStdString &text, float maxWidth, bool forceUp
 
   m_lastUtf8Text = text;
   m_lastUpdateW = false;
+  if (UpdateFromCache(text, CStdStringW(), maxWidth, forceLTRReadingOrder))
+    return true;
+
   CStdStringW utf16;
   g_charsetConverter.utf8ToW(text, utf16, false);
   UpdateCommon(utf16, maxWidth, forceLTRReadingOrder);
+  AddToCache(text, CStdStringW(), maxWidth, forceLTRReadingOrder);
   return true;
 }
 
@@ -234,10 +338,65 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
 
   m_lastText = text;
   m_lastUpdateW = true;
+  if (UpdateFromCache(StringUtils::EmptyString, text, maxWidth, forceLTRReadingOrder))
+    return true;
+
   UpdateCommon(text, maxWidth, forceLTRReadingOrder);
+  AddToCache(StringUtils::EmptyString, text, maxWidth, forceLTRReadingOrder);
+  return true;
+}
+
+static CGUITextLayoutCache::Key MakeCacheKey(CGUIFont *font, const std::string &utf8, const CStdStringW &text,
+                                             float maxWidth, float maxHeight, color_t color, bool forceLTRReadingOrder)
+{
+  CGUITextLayoutCache::Key key;
+  key.font = font->GetUniqueId();
+  key.utf8 = utf8;
+  key.text = text;
+  key.maxWidth = maxWidth;
+  key.maxHeight = maxHeight;
+  key.color = color;
+  key.forceLTRReadingOrder = forceLTRReadingOrder;
+  key.scaleX = g_graphicsContext.GetGUIScaleX();
+  key.scaleY = g_graphicsContext.GetGUIScaleY();
+  return key;
+}
+
+bool CGUITextLayout::UpdateFromCache(const std::string &utf8, const CStdStringW &text, float maxWidth, bool forceLTRReadingOrder)
+{
+  // nothing to lay out
+  if (!m_font || (utf8.empty() && text.empty()))
+    return false;
+
+  CGUITextLayoutCache::Layout layout;
+  if (!g_textLayoutCache.Get(MakeCacheKey(m_font, utf8, text, m_wrap ? maxWidth : 0, m_maxHeight, m_textColor, forceLTRReadingOrder), layout))
+    return false;
+
+  m_lines.swap(layout.lines);
+  m_colors.swap(layout.colors);
+  m_textWidth = layout.width;
+  m_textHeight = layout.height;
   return true;
 }
 
+void CGUITextLayout::AddToCache(const std::string &utf8, const CStdStringW &text, float maxWidth, bool forceLTRReadingOrder) const
+{
+  if (!m_font || (utf8.empty() && text.empty()))
+    return;
+
+  CGUITextLayoutCache::Layout layout;
+  layout.lines = m_lines;
+  layout.colors = m_colors;
+  layout.width = m_textWidth;
+  layout.height = m_textHeight;
+  g_textLayoutCache.Add(MakeCacheKey(m_font, utf8, text, m_wrap ? maxWidth : 0, m_maxHeight, m_textColor, forceLTRReadingOrder), layout);
+}
+
+void CGUITextLayout::GetCacheStats(unsigned int &hits, unsigned int &misses, unsigned int &entries)
+{
+  g_textLayoutCache.GetStats(hits, misses, entries);
+}
+
 void CGUITextLayout::UpdateCommon(const CStdStringW &text, float maxWidth, bool forceLTRReadingOrder)
 {
   // parse the text for style information
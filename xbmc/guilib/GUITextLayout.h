@@ -110,6 +110,13 @@ public:
   static void DrawText(CGUIFont *font, float x, float y, color_t color, color_t shadowColor, const CStdString &text, uint32_t align);
   static void Filter(CStdString &text);
 
+  /*! \brief Get statistics of the layout cache shared by all text layouts
+   \param hits [out] number of updates served from the cache
+   \param misses [out] number of updates that had to lay out the text
+   \param entries [out] number of layouts currently cached
+   */
+  static void GetCacheStats(unsigned int &hits, unsigned int &misses, unsigned int &entries);
+
 protected:
   void LineBreakText(const vecText &text, std::vector<CGUIString> &lines);
   void WrapText(const vecText &text, float maxWidth);
@@ -117,6 +124,14 @@ protected:
   static CStdStringW BidiFlip(const CStdStringW &text, bool forceLTRReadingOrder);
   void CalcTextExtent();
   void UpdateCommon(const CStdStringW &text, float maxWidth, bool forceLTRReadingOrder);
+
+  /*! \brief Fetch lines, colors and extent of a previously laid out text
+   Exactly one of utf8 and text is expected to be non-empty.
+   \return true if the layout was found in the cache
+   \sa AddToCache
+   */
+  bool UpdateFromCache(const std::string &utf8, const CStdStringW &text, float maxWidth, bool forceLTRReadingOrder);
+  void AddToCache(const std::string &utf8, const CStdStringW &text, float maxWidth, bool forceLTRReadingOrder) const;
   
   /*! \brief Returns the text, utf8 encoded
    \return utf8 text
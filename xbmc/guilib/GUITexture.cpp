@@ -287,6 +287,12 @@ void CGUITextureBase::Render(float left, float top, float right, float bottom, f
   Draw(x, y, z, texture, diffuse, orientation);
 }
 
+bool CGUITextureBase::CanPrefetch() const
+{
+  // only images from outside the skin are loaded by the large texture manager without further checks
+  return !m_info.filename.empty() && m_use_cache && !g_TextureManager.CanLoad(m_info.filename);
+}
+
 bool CGUITextureBase::AllocResources()
 {
   if (m_info.filename.empty())
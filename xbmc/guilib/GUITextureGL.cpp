@@ -21,6 +21,7 @@
 #include "system.h"
 #if defined(HAS_GL)
 #include "GUITextureGL.h"
+#include "GUIRenderBatchGL.h"
 #endif
 #include "Texture.h"
 #include "utils/log.h"
@@ -38,7 +39,7 @@ CGUITextureGL::CGUITextureGL(float posX, float posY, float width, float height,
 
 void CGUITextureGL::Begin(color_t color)
 {
-  int range, unit = 0;
+  int range;
   if(g_Windowing.UseLimitedColor())
     range = 235 - 16;
   else
@@ -53,175 +54,86 @@ void CGUITextureGL::Begin(color_t color)
   texture->LoadToGPU();
   if (m_diffuse.size())
     m_diffuse.m_textures[0]->LoadToGPU();
-
-  texture->BindToUnit(unit++);
-
-  glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_BLEND);          // Turn Blending On
-  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-  // diffuse coloring
-  glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
-
-  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
-  VerifyGLState();
-
-  if (m_diffuse.size())
-  {
-    m_diffuse.m_textures[0]->BindToUnit(unit++);
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PREVIOUS);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
-
-    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PREVIOUS);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
-    VerifyGLState();
-  }
-
-  if(g_Windowing.UseLimitedColor())
-  {
-    texture->BindToUnit(unit++); // dummy bind
-    const GLfloat rgba[4] = {16.0f / 255.0f, 16.0f / 255.0f, 16.0f / 255.0f, 0.0f};
-    glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE , GL_COMBINE);
-    glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, rgba);
-    glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_RGB      , GL_ADD);
-    glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_RGB      , GL_PREVIOUS);
-    glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE1_RGB      , GL_CONSTANT);
-    glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND0_RGB     , GL_SRC_COLOR);
-    glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND1_RGB     , GL_SRC_COLOR);
-
-    glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_ALPHA    , GL_REPLACE);
-    glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_ALPHA    , GL_PREVIOUS);
-    VerifyGLState();
-  }
-
-  //glDisable(GL_TEXTURE_2D); // uncomment these 2 lines to switch to wireframe rendering
-  //glBegin(GL_LINE_LOOP);
-  glBegin(GL_QUADS);
 }
 
 void CGUITextureGL::End()
 {
-  glEnd();
-  glActiveTexture(GL_TEXTURE2_ARB);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
-  glActiveTexture(GL_TEXTURE1_ARB);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
-  glActiveTexture(GL_TEXTURE0_ARB);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
+  // the quads are drawn together with the ones that follow if they share our state
 }
 
 void CGUITextureGL::Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation)
 {
-  // Top-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y1);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y1);
-  glVertex3f(x[0], y[0], z[0]);
+  CGLTexture* tex = (CGLTexture*)m_texture.m_textures[m_currentFrame];
+  CGLTexture* diffuseTex = m_diffuse.size() ? (CGLTexture*)m_diffuse.m_textures[0] : NULL;
+  CGUIRenderBatchGL::Vertex *v = CGUIRenderBatchGL::Get().AddQuads(diffuseTex ? CGUIRenderBatchGL::MODE_TEXTURE_DIFFUSE : CGUIRenderBatchGL::MODE_TEXTURE,
+                                                                   tex->GetTextureObject(), diffuseTex ? diffuseTex->GetTextureObject() : 0,
+                                                                   g_Windowing.UseLimitedColor(), 1);
 
-  // Top-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  if (m_diffuse.size())
+  for (int i = 0; i < 4; i++)
   {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
+    v[i].x = x[i];
+    v[i].y = y[i];
+    v[i].z = z[i];
+    v[i].r = m_col[0];
+    v[i].g = m_col[1];
+    v[i].b = m_col[2];
+    v[i].a = m_col[3];
   }
-  glVertex3f(x[1], y[1], z[1]);
+
+  // Top-left vertex (corner)
+  v[0].u0 = texture.x1;
+  v[0].v0 = texture.y1;
+  v[0].u1 = diffuse.x1;
+  v[0].v1 = diffuse.y1;
+
+  // Top-right vertex (corner)
+  v[1].u0 = (orientation & 4) ? texture.x1 : texture.x2;
+  v[1].v0 = (orientation & 4) ? texture.y2 : texture.y1;
+  v[1].u1 = (m_info.orientation & 4) ? diffuse.x1 : diffuse.x2;
+  v[1].v1 = (m_info.orientation & 4) ? diffuse.y2 : diffuse.y1;
 
   // Bottom-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y2);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y2);
-  glVertex3f(x[2], y[2], z[2]);
+  v[2].u0 = texture.x2;
+  v[2].v0 = texture.y2;
+  v[2].u1 = diffuse.x2;
+  v[2].v1 = diffuse.y2;
 
   // Bottom-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  if (m_diffuse.size())
-  {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
-  }
-  glVertex3f(x[3], y[3], z[3]);
+  v[3].u0 = (orientation & 4) ? texture.x2 : texture.x1;
+  v[3].v0 = (orientation & 4) ? texture.y1 : texture.y2;
+  v[3].u1 = (m_info.orientation & 4) ? diffuse.x2 : diffuse.x1;
+  v[3].v1 = (m_info.orientation & 4) ? diffuse.y1 : diffuse.y2;
 }
 
 void CGUITextureGL::DrawQuad(const CRect &rect, color_t color, CBaseTexture *texture, const CRect *texCoords)
 {
+  GLuint textureObject = 0;
   if (texture)
   {
     texture->LoadToGPU();
-    texture->BindToUnit(0);
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE1);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PREVIOUS);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+    textureObject = ((CGLTexture*)texture)->GetTextureObject();
   }
-  else
-  glDisable(GL_TEXTURE_2D);
-
-  glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_BLEND);          // Turn Blending On
-  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-  // diffuse coloring
-  glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE0);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
-  VerifyGLState();
 
-  glBegin(GL_QUADS);
-
-  glColor4ub((GLubyte)GET_R(color), (GLubyte)GET_G(color), (GLubyte)GET_B(color), (GLubyte)GET_A(color));
+  CGUIRenderBatchGL::Vertex *v = CGUIRenderBatchGL::Get().AddQuads(texture ? CGUIRenderBatchGL::MODE_TEXTURE : CGUIRenderBatchGL::MODE_COLOR,
+                                                                   textureObject, 0, false, 1);
 
   CRect coords = texCoords ? *texCoords : CRect(0.0f, 0.0f, 1.0f, 1.0f);
-  glTexCoord2f(coords.x1, coords.y1);
-  glVertex3f(rect.x1, rect.y1, 0);
-  glTexCoord2f(coords.x2, coords.y1);
-  glVertex3f(rect.x2, rect.y1, 0);
-  glTexCoord2f(coords.x2, coords.y2);
-  glVertex3f(rect.x2, rect.y2, 0);
-  glTexCoord2f(coords.x1, coords.y2);
-  glVertex3f(rect.x1, rect.y2, 0);
-
-  glEnd();
-  if (texture)
-    glDisable(GL_TEXTURE_2D);
+  const float vx[4] = { rect.x1, rect.x2, rect.x2, rect.x1 };
+  const float vy[4] = { rect.y1, rect.y1, rect.y2, rect.y2 };
+  const float tu[4] = { coords.x1, coords.x2, coords.x2, coords.x1 };
+  const float tv[4] = { coords.y1, coords.y1, coords.y2, coords.y2 };
+  for (int i = 0; i < 4; i++)
+  {
+    v[i].x = vx[i];
+    v[i].y = vy[i];
+    v[i].z = 0;
+    v[i].r = (GLubyte)GET_R(color);
+    v[i].g = (GLubyte)GET_G(color);
+    v[i].b = (GLubyte)GET_B(color);
+    v[i].a = (GLubyte)GET_A(color);
+    v[i].u0 = v[i].u1 = tu[i];
+    v[i].v0 = v[i].v1 = tv[i];
+  }
 }
 
 #endif
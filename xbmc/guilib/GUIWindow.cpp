@@ -548,6 +548,7 @@ bool CGUIWindow::OnMessage(CGUIMessage& message)
       CLog::Log(LOGDEBUG, "------ Window Init (%s) ------", GetProperty("xmlfile").c_str());
       if (m_dynamicResourceAlloc || !m_bAllocated) AllocResources();
       OnInitWindow();
+      g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
       return true;
     }
     break;
@@ -558,6 +559,7 @@ bool CGUIWindow::OnMessage(CGUIMessage& message)
       OnDeinitWindow(message.GetParam1());
       // now free the window
       if (m_dynamicResourceAlloc) FreeResources();
+      g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
       return true;
     }
     break;
@@ -1005,6 +1007,7 @@ void CGUIWindow::SetProperty(const CStdString &strKey, const CVariant &value)
 {
   CSingleLock lock(*this);
   m_mapProperties[strKey] = value;
+  g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
 }
 
 CVariant CGUIWindow::GetProperty(const CStdString &strKey) const
@@ -1021,6 +1024,7 @@ void CGUIWindow::ClearProperties()
 {
   CSingleLock lock(*this);
   m_mapProperties.clear();
+  g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
 }
 
 void CGUIWindow::SetRunActionsManually()
@@ -63,8 +63,47 @@ bool CGUIWindowManager::SendMessage(int message, int senderID, int destID, int p
   return SendMessage(msg);
 }
 
+// messages that change the content, focus or visibility of windows and controls
+static bool ChangesGUIState(const CGUIMessage& message)
+{
+  switch (message.GetMessage())
+  {
+  case GUI_MSG_WINDOW_INIT:
+  case GUI_MSG_WINDOW_DEINIT:
+  case GUI_MSG_WINDOW_RESET:
+  case GUI_MSG_SETFOCUS:
+  case GUI_MSG_LOSTFOCUS:
+  case GUI_MSG_FOCUSED:
+  case GUI_MSG_UNFOCUS_ALL:
+  case GUI_MSG_VISIBLE:
+  case GUI_MSG_HIDDEN:
+  case GUI_MSG_ENABLED:
+  case GUI_MSG_DISABLED:
+  case GUI_MSG_SET_SELECTED:
+  case GUI_MSG_SET_DESELECTED:
+  case GUI_MSG_LABEL_ADD:
+  case GUI_MSG_LABEL_SET:
+  case GUI_MSG_LABEL2_SET:
+  case GUI_MSG_LABEL_RESET:
+  case GUI_MSG_LABEL_BIND:
+  case GUI_MSG_SET_LABELS:
+  case GUI_MSG_SET_TEXT:
+  case GUI_MSG_ITEM_SELECT:
+  case GUI_MSG_SELCHANGED:
+  case GUI_MSG_PAGE_CHANGE:
+  case GUI_MSG_REFRESH_LIST:
+  case GUI_MSG_NOTIFY_ALL:
+    return true;
+  default:
+    return false;
+  }
+}
+
 bool CGUIWindowManager::SendMessage(CGUIMessage& message)
 {
+  if (ChangesGUIState(message))
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
+
   bool handled = false;
 //  CLog::Log(LOGDEBUG,"SendMessage: mess=%d send=%d control=%d param1=%d", message.GetMessage(), message.GetSenderId(), message.GetControlId(), message.GetParam1());
   // Send the message to all none window targets
@@ -159,6 +198,8 @@ bool CGUIWindowManager::SendMessage(CGUIMessage& message, int window)
   if (window == 0)
     // send to no specified windows.
     return SendMessage(message);
+  if (ChangesGUIState(message))
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_GUI);
   CGUIWindow* pWindow = GetWindow(window);
   if(pWindow)
     return pWindow->OnMessage(message);
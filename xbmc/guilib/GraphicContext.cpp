@@ -30,6 +30,7 @@
 #include "cores/VideoRenderers/RenderManager.h"
 #include "windowing/WindowingFactory.h"
 #include "TextureManager.h"
+#include "GUIRenderBatchGL.h"
 #include "input/MouseStat.h"
 #include "GUIWindowManager.h"
 #include "utils/JobManager.h"
@@ -953,6 +954,10 @@ float CGraphicContext::GetFPS() const
 void CGraphicContext::BeginPaint(bool lock)
 {
   if (lock) Lock();
+#if defined(HAS_GL)
+  // whoever paints next expects the queued GUI quads to be underneath
+  CGUIRenderBatchGL::Get().Flush();
+#endif
 }
 
 void CGraphicContext::EndPaint(bool lock)
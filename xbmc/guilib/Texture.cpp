@@ -42,6 +42,8 @@ CBaseTexture::CBaseTexture(unsigned int width, unsigned int height, unsigned int
  : m_hasAlpha( true )
 {
   m_pixels = NULL;
+  m_mipmaps = NULL;
+  m_mipmapCount = 0;
   m_loadedToGPU = false;
   Allocate(width, height, format);
 }
@@ -99,6 +101,7 @@ void CBaseTexture::Allocate(unsigned int width, unsigned int height, unsigned in
 
   delete[] m_pixels;
   m_pixels = NULL;
+  FreeMipMaps();
   if (GetPitch() * GetRows() > 0)
   {
     m_pixels = new unsigned char[GetPitch() * GetRows()];
@@ -110,7 +113,7 @@ void CBaseTexture::Update(unsigned int width, unsigned int height, unsigned int
   if (pixels == NULL)
     return;
 
-  if (format & XB_FMT_DXT_MASK && !g_Windowing.SupportsDXT())
+  if ((format & XB_FMT_DXT_MASK) && !g_Windowing.SupportsDXT())
   { // compressed format that we don't support
     Allocate(width, height, XB_FMT_A8R8G8B8);
     CDDSImage::Decompress(m_pixels, std::min(width, m_textureWidth), std::min(height, m_textureHeight), GetPitch(m_textureWidth), pixels, format);
@@ -144,6 +147,33 @@ void CBaseTexture::Update(unsigned int width, unsigned int height, unsigned int
     LoadToGPU();
 }
 
+bool CBaseTexture::TakeImageData(CDDSImage &image)
+{
+  unsigned int format = image.GetFormat();
+  if (!image.GetData() || ((format & XB_FMT_DXT_MASK) && !g_Windowing.SupportsDXT()))
+    return false;
+
+  Allocate(image.GetWidth(), image.GetHeight(), format);
+  if (m_textureWidth != image.GetWidth() || m_textureHeight != image.GetHeight())
+    return false; // padded or clamped, the rows have to be copied
+
+  // the levels follow the full size image in the same buffer
+  delete[] m_pixels;
+  m_pixels = image.Detach();
+  if (image.GetMipMapCount() > 1)
+  {
+    m_mipmaps = m_pixels + GetPitch() * GetRows();
+    m_mipmapCount = image.GetMipMapCount() - 1;
+  }
+  return true;
+}
+
+void CBaseTexture::FreeMipMaps()
+{
+  m_mipmaps = NULL;
+  m_mipmapCount = 0;
+}
+
 void CBaseTexture::ClampToEdge()
 {
   unsigned int imagePitch = GetPitch(m_imageWidth);
@@ -208,10 +238,10 @@ CBaseTexture *CBaseTexture::LoadFromFile(const CStdString& texturePath, unsigned
   return NULL;
 }
 
-CBaseTexture *CBaseTexture::LoadFromFileInMemory(unsigned char *buffer, size_t bufferSize, const std::string &mimeType, unsigned int idealWidth, unsigned int idealHeight)
+CBaseTexture *CBaseTexture::LoadFromFileInMemory(unsigned char *buffer, size_t bufferSize, const std::string &mimeType, unsigned int idealWidth, unsigned int idealHeight, bool autoRotate)
 {
   CTexture *texture = new CTexture();
-  if (texture->LoadFromFileInMem(buffer, bufferSize, mimeType, idealWidth, idealHeight))
+  if (texture->LoadFromFileInMem(buffer, bufferSize, mimeType, idealWidth, idealHeight, autoRotate))
     return texture;
   delete texture;
   return NULL;
@@ -224,7 +254,8 @@ bool CBaseTexture::LoadFromFileInternal(const CStdString& texturePath, unsigned
     CDDSImage image;
     if (image.ReadFile(texturePath))
     {
-      Update(image.GetWidth(), image.GetHeight(), 0, image.GetFormat(), image.GetData(), false);
+      if (!TakeImageData(image))
+        Update(image.GetWidth(), image.GetHeight(), 0, image.GetFormat(), image.GetData(), false);
       return true;
     }
     return false;
@@ -263,7 +294,7 @@ bool CBaseTexture::LoadFromFileInternal(const CStdString& texturePath, unsigned
   return true;
 }
 
-bool CBaseTexture::LoadFromFileInMem(unsigned char* buffer, size_t size, const std::string& mimeType, unsigned int maxWidth, unsigned int maxHeight)
+bool CBaseTexture::LoadFromFileInMem(unsigned char* buffer, size_t size, const std::string& mimeType, unsigned int maxWidth, unsigned int maxHeight, bool autoRotate)
 {
   if (!buffer || !size)
     return false;
@@ -272,7 +303,7 @@ bool CBaseTexture::LoadFromFileInMem(unsigned char* buffer, size_t size, const s
   unsigned int height = maxHeight ? std::min(maxHeight, g_Windowing.GetMaxTextureSize()) : g_Windowing.GetMaxTextureSize();
 
   IImage* pImage = ImageFactory::CreateLoaderFromMimeType(mimeType);
-  if(!LoadIImage(pImage, buffer, size, width, height))
+  if(!LoadIImage(pImage, buffer, size, width, height, autoRotate))
   {
     delete pImage;
     pImage = ImageFactory::CreateFallbackLoader(mimeType);
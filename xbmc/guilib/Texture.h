@@ -34,6 +34,7 @@ class CTexture;
 class CGLTexture;
 class CPiTexture;
 class CDXTexture;
+class CDDSImage;
 
 /*!
 \ingroup textures
@@ -68,10 +69,11 @@ public:
    \param mimeType the mime type of the file in buffer.
    \param idealWidth the ideal width of the texture (defaults to 0, no ideal width).
    \param idealHeight the ideal height of the texture (defaults to 0, no ideal height).
+   \param autoRotate whether the textures should be autorotated based on EXIF information (defaults to false).
    \return a CBaseTexture pointer to the created texture - NULL if the texture failed to load.
    */
   static CBaseTexture *LoadFromFileInMemory(unsigned char* buffer, size_t bufferSize, const std::string& mimeType,
-                                            unsigned int idealWidth = 0, unsigned int idealHeight = 0);
+                                            unsigned int idealWidth = 0, unsigned int idealHeight = 0, bool autoRotate = false);
 
   bool LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, unsigned char* pixels);
   bool LoadPaletted(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, const unsigned char *pixels, const COLOR *palette);
@@ -84,6 +86,8 @@ public:
   virtual void BindToUnit(unsigned int unit) = 0;
 
   unsigned char* GetPixels() const { return m_pixels; }
+  /*! \brief number of downscaled levels held below the full size image, see CDDSImage::GetMipMapCount */
+  unsigned int GetMipMapCount() const { return m_mipmapCount; }
   unsigned int GetPitch() const { return GetPitch(m_textureWidth); }
   unsigned int GetRows() const { return GetRows(m_textureHeight); }
   unsigned int GetTextureWidth() const { return m_textureWidth; }
@@ -111,7 +115,7 @@ private:
 
 protected:
   bool LoadFromFileInMem(unsigned char* buffer, size_t size, const std::string& mimeType,
-                         unsigned int maxWidth, unsigned int maxHeight);
+                         unsigned int maxWidth, unsigned int maxHeight, bool autoRotate = false);
   bool LoadFromFileInternal(const CStdString& texturePath, unsigned int maxWidth, unsigned int maxHeight, bool autoRotate, bool requirePixels, const std::string& strMimeType = "");
   bool LoadIImage(IImage* pImage, unsigned char* buffer, unsigned int bufSize, unsigned int width, unsigned int height, bool autoRotate=false);
   // helpers for computation of texture parameters for compressed textures
@@ -119,6 +123,14 @@ protected:
   unsigned int GetRows(unsigned int height) const;
   unsigned int GetBlockSize() const;
 
+  /*! \brief Take over the data of a DDS image, downscaled levels included, without copying it
+   Only possible if the texture can hold the image at its full size and in its own format.
+   \param image the image to take the data of, left empty on success
+   \return true if the data was taken, false if the image has to be loaded with Update instead
+   */
+  bool TakeImageData(CDDSImage &image);
+  void FreeMipMaps();
+
   unsigned int m_imageWidth;
   unsigned int m_imageHeight;
   unsigned int m_textureWidth;
@@ -127,6 +139,8 @@ protected:
   unsigned int m_originalHeight;  ///< original image height before scaling or cropping
 
   unsigned char* m_pixels;
+  unsigned char* m_mipmaps;     ///< levels below the full size image, points into m_pixels, see TakeImageData
+  unsigned int m_mipmapCount;
   bool m_loadedToGPU;
   unsigned int m_format;
   int m_orientation;
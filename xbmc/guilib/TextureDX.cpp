@@ -139,6 +139,7 @@ void CDXTexture::LoadToGPU()
 
   delete [] m_pixels;
   m_pixels = NULL;
+  FreeMipMaps();
 
   m_loadedToGPU = true;
 }
@@ -24,6 +24,7 @@
 #include "utils/log.h"
 #include "utils/GLUtils.h"
 #include "guilib/TextureManager.h"
+#include "guilib/GUIRenderBatchGL.h"
 
 #if defined(HAS_GL) || defined(HAS_GLES)
 
@@ -61,6 +62,10 @@ void CGLTexture::LoadToGPU()
     // nothing to load - probably same image (no change)
     return;
   }
+#if defined(HAS_GL)
+  // binding the texture below would upset the state of queued GUI quads
+  CGUIRenderBatchGL::Get().Flush();
+#endif
   if (m_texture == 0)
   {
     // Have OpenGL generate a texture object handle for us
@@ -78,6 +83,7 @@ void CGLTexture::LoadToGPU()
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
   unsigned int maxSize = g_Windowing.GetMaxTextureSize();
+  bool mipmaps = m_mipmaps && m_textureWidth <= maxSize && m_textureHeight <= maxSize;
   if (m_textureHeight > maxSize)
   {
     CLog::Log(LOGERROR, "GL: Image height %d too big to fit into single texture unit, truncating to %u", m_textureHeight, maxSize);
@@ -127,6 +133,24 @@ void CGLTexture::LoadToGPU()
       m_textureWidth, m_textureHeight, 0, GetPitch() * GetRows(), m_pixels);
   }
 
+  if (mipmaps)
+  { // artwork from the texture cache may come with its downscaled levels (see CDDSImage)
+    const unsigned char *pixels = m_mipmaps;
+    unsigned int width = m_textureWidth, height = m_textureHeight;
+    for (unsigned int level = 1; level <= m_mipmapCount; level++)
+    {
+      width = std::max(width / 2, 1U);
+      height = std::max(height / 2, 1U);
+      if ((m_format & XB_FMT_DXT_MASK) == 0)
+        glTexImage2D(GL_TEXTURE_2D, level, numcomponents, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+      else
+        glCompressedTexImage2DARB(GL_TEXTURE_2D, level, format, width, height, 0, GetPitch(width) * GetRows(height), pixels);
+      pixels += GetPitch(width) * GetRows(height);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_mipmapCount);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  }
+
   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 #else	// GLES version
     m_textureWidth = maxSize;
@@ -180,6 +204,7 @@ void CGLTexture::LoadToGPU()
 
   delete [] m_pixels;
   m_pixels = NULL;
+  FreeMipMaps();
 
   m_loadedToGPU = true;
 }
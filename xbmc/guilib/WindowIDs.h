@@ -56,6 +56,7 @@
 
 #define WINDOW_ADDON_BROWSER              10040
 
+#define WINDOW_SCROLL_BENCHMARK              96
 #define WINDOW_SCREENSAVER_DIM               97
 #define WINDOW_DEBUG_INFO                    98
 #define WINDOW_DIALOG_POINTER             10099
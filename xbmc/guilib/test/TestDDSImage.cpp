@@ -0,0 +1,122 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/DDSImage.h"
+#include "guilib/Texture.h"
+#include "guilib/XBTF.h"
+#include "filesystem/File.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+// texture in system memory only
+class CMemoryTexture : public CBaseTexture
+{
+public:
+  virtual void CreateTextureObject() {}
+  virtual void DestroyTextureObject() {}
+  virtual void LoadToGPU() {}
+  virtual void BindToUnit(unsigned int unit) {}
+
+  bool Load(const std::string &path) { return LoadFromFileInternal(path, 0, 0, false, false); }
+};
+
+// smooth gradients with a little noise, like artwork
+std::vector<unsigned char> MakeImage(unsigned int width, unsigned int height)
+{
+  std::vector<unsigned char> pixels(width * height * 4);
+  unsigned int seed = 1;
+  for (unsigned int y = 0; y < height; y++)
+  {
+    for (unsigned int x = 0; x < width; x++)
+    {
+      seed = seed * 1103515245 + 12345;
+      unsigned char *p = &pixels[(y * width + x) * 4];
+      p[0] = (x * 255 / width + ((seed >> 16) & 7)) & 0xff;
+      p[1] = (y * 255 / height + ((seed >> 20) & 7)) & 0xff;
+      p[2] = ((x + y) * 255 / (width + height)) & 0xff;
+      p[3] = 0xff;
+    }
+  }
+  return pixels;
+}
+}
+
+TEST(TestDDSImage, MipMapChain)
+{
+  std::string file = "special://temp/testddsimage.dds";
+  std::vector<unsigned char> pixels(300 * 200 * 4, 0);
+  for (size_t i = 0; i < pixels.size(); i += 4)
+  {
+    pixels[i] = 0x40;
+    pixels[i + 1] = 0x80;
+    pixels[i + 2] = 0xc0;
+    pixels[i + 3] = 0xff;
+  }
+
+  CDDSImage out;
+  ASSERT_TRUE(out.Create(file, 300, 200, 300 * 4, &pixels[0], 0, true));
+
+  CDDSImage in;
+  ASSERT_TRUE(in.ReadFile(file));
+  EXPECT_EQ(300U, in.GetWidth());
+  EXPECT_EQ(200U, in.GetHeight());
+  EXPECT_EQ((unsigned int)XB_FMT_DXT1, in.GetFormat());
+  // 300x200, 150x100, 75x50, 37x25, 18x12, 9x6, 4x3, 2x1, 1x1
+  EXPECT_EQ(9U, in.GetMipMapCount());
+  EXPECT_EQ(in.GetSize() + 7600U + 1976U + 560U + 120U + 48U + 8U + 8U + 8U, in.GetDataSize());
+
+  XFILE::CFile stat;
+  ASSERT_TRUE(stat.Open(file));
+  EXPECT_EQ(4 + 124 + (int64_t)in.GetDataSize(), stat.GetLength());
+  stat.Close();
+
+  // the smallest level is the colour of the image
+  unsigned char last[4 * 4 * 4];
+  ASSERT_TRUE(CDDSImage::Decompress(last, 1, 1, 16, in.GetData() + in.GetDataSize() - 8, XB_FMT_DXT1));
+  EXPECT_NEAR(0x40, last[0], 4);
+  EXPECT_NEAR(0x80, last[1], 4);
+  EXPECT_NEAR(0xc0, last[2], 4);
+
+  XFILE::CFile::Delete(file);
+}
+
+TEST(TestDDSImage, TextureKeepsMipMaps)
+{
+  std::string file = "special://temp/testddsimage.dds";
+  std::vector<unsigned char> pixels = MakeImage(256, 128);
+
+  // a tiny error allowance forces uncompressed ARGB, which any texture takes as is
+  CDDSImage out;
+  ASSERT_TRUE(out.Create(file, 256, 128, 256 * 4, &pixels[0], 0.0001, true));
+
+  CMemoryTexture texture;
+  ASSERT_TRUE(texture.Load(file));
+  EXPECT_EQ(256U, texture.GetWidth());
+  EXPECT_EQ(128U, texture.GetHeight());
+  EXPECT_EQ(8U, texture.GetMipMapCount());
+  EXPECT_EQ(0, memcmp(texture.GetPixels(), &pixels[0], pixels.size()));
+
+  XFILE::CFile::Delete(file);
+}
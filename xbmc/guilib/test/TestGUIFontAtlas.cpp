@@ -0,0 +1,115 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIFontAtlas.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestGUIFontAtlas, PacksRowsAndPages)
+{
+  CGUIFontAtlas atlas;
+  atlas.Reset(100, 20, 10, 2);
+
+  CGUIFontAtlas::Slot slot;
+  std::vector<uint32_t> evicted;
+  EXPECT_EQ(0, atlas.Allocate(60, 'a', 0, slot, evicted));
+  EXPECT_EQ(0U, slot.page);
+  EXPECT_EQ(0U, slot.x);
+  EXPECT_EQ(0U, slot.y);
+
+  // fills the rest of the first row
+  EXPECT_LE(0, atlas.Allocate(40, 'b', 0, slot, evicted));
+  EXPECT_EQ(60U, slot.x);
+  EXPECT_EQ(0U, slot.y);
+
+  // opens a second row, then a second page
+  EXPECT_LE(0, atlas.Allocate(50, 'c', 0, slot, evicted));
+  EXPECT_EQ(0U, slot.page);
+  EXPECT_EQ(10U, slot.y);
+  EXPECT_EQ(20U, atlas.GetUsedHeight(0));
+  EXPECT_LE(0, atlas.Allocate(60, 'd', 0, slot, evicted));
+  EXPECT_EQ(1U, slot.page);
+  EXPECT_EQ(0U, slot.y);
+
+  // too wide for a page
+  EXPECT_EQ(-1, atlas.Allocate(101, 'e', 0, slot, evicted));
+
+  EXPECT_EQ(2U, atlas.GetPageCount());
+  EXPECT_EQ(4U, atlas.GetGlyphCount());
+  EXPECT_TRUE(evicted.empty());
+}
+
+TEST(TestGUIFontAtlas, EvictsLeastRecentlyUsed)
+{
+  CGUIFontAtlas atlas;
+  atlas.Reset(100, 10, 10, 1);
+
+  CGUIFontAtlas::Slot slot;
+  std::vector<uint32_t> evicted;
+  unsigned int time = 0;
+  int a = atlas.Allocate(25, 'a', 0, slot, evicted);
+  int b = atlas.Allocate(25, 'b', 0, slot, evicted);
+  int c = atlas.Allocate(25, 'c', 0, slot, evicted);
+  int d = atlas.Allocate(25, 'd', 0, slot, evicted);
+  atlas.Touch(c, ++time);
+  atlas.Touch(a, ++time);
+  atlas.Touch(d, ++time);
+  atlas.Touch(b, ++time);
+
+  // c is the oldest
+  int e = atlas.Allocate(20, 'e', time + 1, slot, evicted);
+  ASSERT_EQ(1U, evicted.size());
+  EXPECT_EQ((uint32_t)'c', evicted[0]);
+  EXPECT_EQ(50U, slot.x);
+  atlas.Touch(e, ++time);
+
+  // a wide glyph needs glyphs evicted until two gaps join up
+  evicted.clear();
+  EXPECT_LE(0, atlas.Allocate(50, 'f', time + 1, slot, evicted));
+  ASSERT_EQ(3U, evicted.size());
+  EXPECT_EQ((uint32_t)'a', evicted[0]);
+  EXPECT_EQ((uint32_t)'d', evicted[1]);
+  EXPECT_EQ((uint32_t)'b', evicted[2]);
+  EXPECT_EQ(0U, slot.x);
+  EXPECT_EQ(4U, atlas.GetEvictions());
+  EXPECT_EQ(2U, atlas.GetGlyphCount());
+}
+
+TEST(TestGUIFontAtlas, KeepsRecentlyUsed)
+{
+  CGUIFontAtlas atlas;
+  atlas.Reset(100, 10, 10, 1);
+
+  CGUIFontAtlas::Slot slot;
+  std::vector<uint32_t> evicted;
+  int a = atlas.Allocate(50, 'a', 0, slot, evicted);
+  int b = atlas.Allocate(50, 'b', 0, slot, evicted);
+  atlas.Touch(a, 1);
+  atlas.Touch(b, 2);
+
+  // both glyphs are in use since time 1
+  EXPECT_EQ(-1, atlas.Allocate(50, 'c', 1, slot, evicted));
+  EXPECT_TRUE(evicted.empty());
+
+  // only b is
+  EXPECT_LE(0, atlas.Allocate(50, 'c', 2, slot, evicted));
+  ASSERT_EQ(1U, evicted.size());
+  EXPECT_EQ((uint32_t)'a', evicted[0]);
+}
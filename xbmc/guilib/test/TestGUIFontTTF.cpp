@@ -0,0 +1,241 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIFont.h"
+#include "guilib/GUIFontTTF.h"
+#include "guilib/Texture.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+// texture in system memory only
+class CMemoryTexture : public CBaseTexture
+{
+public:
+  CMemoryTexture(unsigned int width, unsigned int height)
+  : CBaseTexture(width, height, XB_FMT_A8)
+  {
+  }
+  virtual void CreateTextureObject() {}
+  virtual void DestroyTextureObject() {}
+  virtual void LoadToGPU() {}
+  virtual void BindToUnit(unsigned int unit) {}
+};
+
+// font that caches its characters without a render system
+class CTestFontTTF : public CGUIFontTTFBase
+{
+public:
+  typedef CGUIFontTTFBase::Character Character;
+  typedef CGUIFontTTFBase::VertexRun VertexRun;
+
+  CTestFontTTF(unsigned int maxPages)
+  : CGUIFontTTFBase("test")
+  {
+    m_maxPages = maxPages;
+  }
+
+  virtual void Begin() { m_nestedBeginCount++; }
+  virtual void End() { if (m_nestedBeginCount) m_nestedBeginCount--; }
+
+  Character *Get(character_t letter) { return GetCharacter(letter); }
+  void Render(const Character &ch) { RenderCharacter(0, 0, &ch, 0xffffffff, false); }
+  const std::vector<VertexRun> &GetVertexRuns() const { return m_vertexRuns; }
+  size_t GetVertexCount() const { return m_vertices.size(); }
+
+  /*! \brief check that no two cached characters share pixels, and all are within their page
+   */
+  bool CheckLayout() const
+  {
+    for (int i = 0; i < m_numChars; i++)
+    {
+      const Character &a = m_char[i];
+      if (a.atlasHandle < 0)
+        continue;
+      if (a.page >= m_pages.size() || a.right > m_textureWidth || a.bottom > m_pages[a.page].texture->GetHeight())
+        return false;
+      for (int j = i + 1; j < m_numChars; j++)
+      {
+        const Character &b = m_char[j];
+        if (b.atlasHandle < 0 || b.page != a.page)
+          continue;
+        if (a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom)
+          return false;
+      }
+    }
+    return true;
+  }
+
+protected:
+  virtual CBaseTexture* ReallocTexture(unsigned int page, unsigned int& newHeight)
+  {
+    newHeight = CBaseTexture::PadPow2(newHeight);
+    CBaseTexture *newTexture = new CMemoryTexture(m_textureWidth, newHeight);
+    memset(newTexture->GetPixels(), 0, newTexture->GetPitch() * newTexture->GetRows());
+    CBaseTexture *oldTexture = m_pages[page].texture;
+    if (oldTexture)
+    {
+      memcpy(newTexture->GetPixels(), oldTexture->GetPixels(), oldTexture->GetPitch() * oldTexture->GetRows());
+      delete oldTexture;
+    }
+    return newTexture;
+  }
+
+  virtual bool CopyCharToTexture(unsigned int page, FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
+  {
+    return true;
+  }
+
+  virtual void DeleteHardwareTexture() {}
+};
+
+// all characters in a set of unicode ranges, in each of the font styles
+vecText UnicodeCorpus()
+{
+  static const character_t ranges[][2] = {
+    { 0x0020, 0x024f }, // latin
+    { 0x0370, 0x03ff }, // greek
+    { 0x0400, 0x04ff }, // cyrillic
+    { 0x1e00, 0x1eff }, // latin extended additional
+    { 0x2000, 0x20cf }, // punctuation and currency
+    { 0x4e00, 0x4eff }, // cjk, missing from the font
+  };
+  vecText corpus;
+  for (character_t style = 0; style < 4; style++)
+  {
+    for (unsigned int i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++)
+    {
+      for (character_t c = ranges[i][0]; c <= ranges[i][1]; c++)
+        corpus.push_back((style << 24) | c);
+    }
+  }
+  return corpus;
+}
+
+// looks up the corpus several times, the cache has to stay within its pages without rebuilding
+void CheckCorpus(unsigned int maxPages, float size, unsigned int passes)
+{
+  CTestFontTTF font(maxPages);
+  ASSERT_TRUE(font.Load(XBMC_REF_FILE_PATH("addons/skin.confluence/fonts/Roboto-Regular.ttf"), size));
+
+  vecText corpus = UnicodeCorpus();
+  for (unsigned int pass = 0; pass < passes; pass++)
+  {
+    for (vecText::const_iterator it = corpus.begin(); it != corpus.end(); ++it)
+      font.Get(*it);
+  }
+
+  unsigned int pages, glyphs, evictions, rebuilds;
+  font.GetCacheStats(pages, glyphs, evictions, rebuilds);
+  EXPECT_EQ(0U, rebuilds) << "font size " << size << ", " << maxPages << " pages";
+  EXPECT_LE(pages, maxPages) << "font size " << size << ", " << maxPages << " pages";
+  EXPECT_TRUE(font.CheckLayout()) << "font size " << size << ", " << maxPages << " pages";
+}
+}
+
+TEST(TestGUIFontTTF, Prewarm)
+{
+  CTestFontTTF font(1);
+  ASSERT_TRUE(font.Load(XBMC_REF_FILE_PATH("addons/skin.confluence/fonts/Roboto-Regular.ttf"), 20.0f));
+
+  unsigned int pages, glyphs, evictions, rebuilds;
+  font.GetCacheStats(pages, glyphs, evictions, rebuilds);
+  EXPECT_EQ(1U, glyphs); // '.' is cached on load
+
+  font.Prewarm(L"abc.");
+  font.GetCacheStats(pages, glyphs, evictions, rebuilds);
+  EXPECT_EQ(4U, glyphs);
+}
+
+TEST(TestGUIFontTTF, EvictsLeastRecentlyUsed)
+{
+  CTestFontTTF font(1);
+  ASSERT_TRUE(font.Load(XBMC_REF_FILE_PATH("addons/skin.confluence/fonts/Roboto-Regular.ttf"), 80.0f));
+
+  // keep using 'A' while filling the page with other characters
+  const CTestFontTTF::Character first = *font.Get(L'A');
+  const vecText corpus = UnicodeCorpus();
+  for (vecText::const_iterator it = corpus.begin(); it != corpus.end(); ++it)
+  {
+    font.Get(*it);
+    ASSERT_TRUE(font.Get(L'A') != NULL);
+  }
+
+  unsigned int pages, glyphs, evictions, rebuilds;
+  font.GetCacheStats(pages, glyphs, evictions, rebuilds);
+  EXPECT_EQ(1U, pages);
+  EXPECT_LT(0U, evictions);
+  EXPECT_EQ(0U, rebuilds);
+  EXPECT_TRUE(font.CheckLayout());
+
+  // 'A' was never evicted, so it is still where it was first placed
+  const CTestFontTTF::Character *last = font.Get(L'A');
+  EXPECT_EQ(first.atlasHandle, last->atlasHandle);
+  EXPECT_EQ(first.left, last->left);
+  EXPECT_EQ(first.top, last->top);
+}
+
+TEST(TestGUIFontTTF, KeepsQuadOrderAcrossPages)
+{
+  CTestFontTTF font(4);
+  ASSERT_TRUE(font.Load(XBMC_REF_FILE_PATH("addons/skin.confluence/fonts/Roboto-Regular.ttf"), 80.0f));
+
+  // fill the first page until a character lands on the next one
+  const CTestFontTTF::Character first = *font.Get(L'A');
+  CTestFontTTF::Character second = first;
+  const vecText corpus = UnicodeCorpus();
+  for (vecText::const_iterator it = corpus.begin(); it != corpus.end() && second.page == first.page; ++it)
+  {
+    const CTestFontTTF::Character *ch = font.Get(*it);
+    if (ch && ch->right > ch->left && ch->bottom > ch->top)
+      second = *ch;
+  }
+  ASSERT_NE(first.page, second.page);
+
+  // as a shadow and its text: each quad is drawn in turn, not grouped by page
+  font.Begin();
+  font.Render(first);
+  font.Render(second);
+  font.Render(first);
+  font.Render(first);
+
+  const std::vector<CTestFontTTF::VertexRun> &runs = font.GetVertexRuns();
+  ASSERT_EQ(3U, runs.size());
+  EXPECT_EQ(first.page, runs[0].page);
+  EXPECT_EQ(0U, runs[0].start);
+  EXPECT_EQ(4U, runs[0].count);
+  EXPECT_EQ(second.page, runs[1].page);
+  EXPECT_EQ(4U, runs[1].start);
+  EXPECT_EQ(4U, runs[1].count);
+  EXPECT_EQ(first.page, runs[2].page);
+  EXPECT_EQ(8U, runs[2].start);
+  EXPECT_EQ(8U, runs[2].count);
+  EXPECT_EQ(16U, font.GetVertexCount());
+  font.End();
+}
+
+TEST(TestGUIFontTTF, CachesCorpus)
+{
+  CheckCorpus(4, 20.0f, 2);
+  CheckCorpus(4, 80.0f, 2);
+  CheckCorpus(1, 80.0f, 2);
+}
@@ -309,6 +309,7 @@ static const ActionMapping windows[] =
         {"pvrosdteletext"           , WINDOW_DIALOG_OSD_TELETEXT},
         {"systeminfo"               , WINDOW_SYSTEM_INFORMATION},
         {"testpattern"              , WINDOW_TEST_PATTERN},
+        {"scrollbenchmark"          , WINDOW_SCROLL_BENCHMARK},
         {"screencalibration"        , WINDOW_SCREEN_CALIBRATION},
         {"guicalibration"           , WINDOW_SCREEN_CALIBRATION}, // backward compat
         {"picturessettings"         , WINDOW_SETTINGS_MYPICTURES},
@@ -23,10 +23,13 @@
 
 namespace INFO
 {
+  unsigned int InfoBool::m_evaluations = 0;
+
   InfoBool::InfoBool(const std::string &expression, int context)
     : m_value(false),
       m_context(context),
       m_listItemDependent(false),
+      m_sources(INFO_SOURCE_ALL),
       m_expression(expression),
       m_dirty(true)
   {
@@ -27,6 +27,21 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*! \brief Sources of information that a condition depends on.
+ A condition only needs re-evaluation once one of its sources has signalled a change.
+ \sa CGUIInfoManager::SetSourcesChanged
+ */
+enum InfoSource
+{
+  INFO_SOURCE_NONE    = 0x00,   ///< constant for the lifetime of the condition
+  INFO_SOURCE_PLAYER  = 0x01,   ///< player, playlist and visualisation state
+  INFO_SOURCE_LIBRARY = 0x02,   ///< library contents
+  INFO_SOURCE_GUI     = 0x04,   ///< windows, controls, containers and listitems
+  INFO_SOURCE_TIME    = 0x08,   ///< wall clock
+  INFO_SOURCE_SKIN    = 0x10,   ///< skin settings
+  INFO_SOURCE_ALL     = 0xffff  ///< unknown dependencies, evaluated every frame
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -56,6 +71,7 @@ public:
     {
       Update(NULL);
       m_dirty = false;
+      m_evaluations++;
     }
     return m_value;
   }
@@ -73,15 +89,29 @@ public:
 
   const std::string &GetExpression() const { return m_expression; }
   bool ListItemDependent() const { return m_listItemDependent; }
+
+  /*! \brief Get the sources this info bool depends on
+   \return a combination of InfoSource flags
+   */
+  unsigned int GetSources() const { return m_sources; }
+
+  /*! \brief Number of cached evaluations performed since the counter was last reset
+   \sa ResetEvaluations
+   */
+  static unsigned int GetEvaluations() { return m_evaluations; }
+  static void ResetEvaluations() { m_evaluations = 0; }
 protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
   bool m_listItemDependent;    ///< do not cache if a listitem pointer is given
+  unsigned int m_sources;      ///< InfoSource flags this bool depends on
 
 private:
   std::string  m_expression;   ///< original expression
   bool         m_dirty;        ///< whether we need an update
+
+  static unsigned int m_evaluations; ///< evaluations of dirty bools, GUI thread only
 };
 
 typedef boost::shared_ptr<InfoBool> InfoPtr;
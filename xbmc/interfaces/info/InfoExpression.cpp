@@ -21,8 +21,10 @@
 #include "InfoExpression.h"
 #include <stack>
 #include "utils/log.h"
+#include "utils/StringUtils.h"
 #include "GUIInfoManager.h"
 #include <list>
+#include <algorithm>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/pointer_cast.hpp>
@@ -34,6 +36,7 @@ InfoSingle::InfoSingle(const std::string &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression, m_listItemDependent);
+  m_sources = g_infoManager.GetInfoSources(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -44,16 +47,55 @@ void InfoSingle::Update(const CGUIListItem *item)
 InfoExpression::InfoExpression(const std::string &expression, int context)
 : InfoBool(expression, context)
 {
+  // the sources of the expression are accumulated from its operands
+  m_sources = INFO_SOURCE_NONE;
   if (!Parse(expression))
   {
     CLog::Log(LOGERROR, "Error parsing boolean expression %s", expression.c_str());
-    m_expression_tree = boost::make_shared<InfoLeaf>(g_infoManager.Register("false", 0), false);
+    m_expression_tree = boost::make_shared<InfoLeaf>(g_infoManager.Register("false", 0), false, "false");
   }
+  else if (m_expression_tree->Type() != NODE_LEAF)
+    boost::static_pointer_cast<InfoAssociativeGroup>(m_expression_tree)->ShareSubgroups(m_context);
+  Compile();
 }
 
 void InfoExpression::Update(const CGUIListItem *item)
 {
-  m_value = m_expression_tree->Evaluate(item);
+  if (m_programDirty)
+    Compile();
+
+  bool value = false;
+  unsigned int size = m_program.size();
+  unsigned int pc = 0;
+  while (pc < size)
+  {
+    const Instruction &instruction = m_program[pc];
+    if (instruction.opcode == OPCODE_LEAF)
+    {
+      value = instruction.invert ^ instruction.info->Get(item);
+      pc++;
+    }
+    else if (value == (instruction.opcode == OPCODE_JUMP_IF_TRUE))
+    {
+      if (instruction.group)
+      {
+        /* Move this child to the head of its group so we evaluate faster next time */
+        instruction.group->Promote(instruction.child);
+        m_programDirty = true;
+      }
+      pc = instruction.target;
+    }
+    else
+      pc++;
+  }
+  m_value = value;
+}
+
+void InfoExpression::Compile()
+{
+  m_program.clear();
+  m_expression_tree->Compile(m_program);
+  m_programDirty = false;
 }
 
 /* Expressions are rewritten at parse time into a form which favours the
@@ -65,18 +107,40 @@ void InfoExpression::Update(const CGUIListItem *item)
  * evaluated in order to determine the value of the expression. The runtime
  * adaptability has the advantage of not being customised for any particular skin.
  *
- * The modifications to the expression at parse time fall into two groups:
+ * The modifications to the expression at parse time fall into three groups:
  * 1) Moving logical NOTs so that they are only applied to leaf nodes.
  *    For example, rewriting ![A+B]|C as !A|!B|C allows reordering such that
  *    any of the three leaves can be evaluated first.
  * 2) Combining adjacent AND or OR operations such that each path from the root
  *    to a leaf encounters a strictly alternating pattern of AND and OR
  *    operations. So [A|B]|[C|D+[[E|F]|G] becomes A|B|C|[D+[E|F|G]].
+ * 3) Replacing groups below the root by operands which are registered as
+ *    expressions of their own, so that the same group used by several
+ *    conditions is evaluated at most once per frame. The operands of a shared
+ *    group are sorted, so D+[G|F|E] shares [E|F|G] with the example above.
+ *
+ * The tree is then compiled into a flat program. Each operand is followed by
+ * a jump to the end of its group, taken if the operand decides the group (true
+ * for OR, false for AND). A taken jump moves the operand to the head of its
+ * group, and the program is recompiled before the next evaluation.
  */
 
-bool InfoExpression::InfoLeaf::Evaluate(const CGUIListItem *item)
+void InfoExpression::InfoLeaf::Compile(std::vector<Instruction> &program)
+{
+  Instruction instruction;
+  instruction.opcode = OPCODE_LEAF;
+  instruction.invert = m_invert;
+  instruction.info = m_info.get();
+  instruction.target = 0;
+  instruction.group = NULL;
+  program.push_back(instruction);
+}
+
+std::string InfoExpression::InfoLeaf::ToString() const
 {
-  return m_invert ^ m_info->Get(item);
+  std::string operand(m_operand);
+  StringUtils::Trim(operand);
+  return m_invert ? "!" + operand : operand;
 }
 
 InfoExpression::InfoAssociativeGroup::InfoAssociativeGroup(
@@ -99,27 +163,61 @@ void InfoExpression::InfoAssociativeGroup::Merge(boost::shared_ptr<InfoAssociati
   m_children.splice(m_children.end(), other->m_children);
 }
 
-bool InfoExpression::InfoAssociativeGroup::Evaluate(const CGUIListItem *item)
+void InfoExpression::InfoAssociativeGroup::ShareSubgroups(int context)
 {
-  /* Handle either AND or OR by using the relation
-   * A AND B == !(!A OR !B)
-   * to convert ANDs into ORs
-   */
-  std::list<InfoSubexpressionPtr>::iterator last = m_children.end();
-  std::list<InfoSubexpressionPtr>::iterator it = m_children.begin();
-  bool use_and = (m_type == NODE_AND);
-  bool result = use_and ^ (*it)->Evaluate(item);
-  while (!result && ++it != last)
+  for (InfoChildIterator it = m_children.begin(); it != m_children.end(); ++it)
   {
-    result = use_and ^ (*it)->Evaluate(item);
-    if (result)
-    {
-      /* Move this child to the head of the list so we evaluate faster next time */
-      m_children.push_front(*it);
-      m_children.erase(it);
-    }
+    if ((*it)->Type() == NODE_LEAF)
+      continue;
+    std::string subexpression = (*it)->ToString();
+    InfoPtr info = g_infoManager.Register(subexpression, context);
+    if (info)
+      *it = boost::make_shared<InfoLeaf>(info, false, subexpression);
+  }
+}
+
+void InfoExpression::InfoAssociativeGroup::Promote(InfoChildIterator child)
+{
+  m_children.splice(m_children.begin(), m_children, child);
+}
+
+void InfoExpression::InfoAssociativeGroup::Compile(std::vector<Instruction> &program)
+{
+  std::vector<unsigned int> jumps;
+  for (InfoChildIterator it = m_children.begin(); it != m_children.end(); ++it)
+  {
+    (*it)->Compile(program);
+
+    Instruction instruction;
+    instruction.opcode = m_type == NODE_AND ? OPCODE_JUMP_IF_FALSE : OPCODE_JUMP_IF_TRUE;
+    instruction.invert = false;
+    instruction.info = NULL;
+    instruction.target = 0;
+    instruction.group = it == m_children.begin() ? NULL : this;
+    instruction.child = it;
+    jumps.push_back(program.size());
+    program.push_back(instruction);
+  }
+  // all jumps leave the group
+  for (std::vector<unsigned int>::const_iterator it = jumps.begin(); it != jumps.end(); ++it)
+    program[*it].target = program.size();
+}
+
+std::string InfoExpression::InfoAssociativeGroup::ToString() const
+{
+  std::vector<std::string> children;
+  for (std::list<InfoSubexpressionPtr>::const_iterator it = m_children.begin(); it != m_children.end(); ++it)
+    children.push_back((*it)->ToString());
+  std::sort(children.begin(), children.end());
+
+  std::string result = "[";
+  for (std::vector<std::string>::const_iterator it = children.begin(); it != children.end(); ++it)
+  {
+    if (it != children.begin())
+      result += m_type == NODE_AND ? "+" : "|";
+    result += *it;
   }
-  return use_and ^ result;
+  return result + "]";
 }
 
 /* Expressions are parsed using the shunting-yard algorithm. Binary operators
@@ -251,9 +349,10 @@ bool InfoExpression::Parse(const std::string &expression)
           CLog::Log(LOGERROR, "Bad operand '%s'", operand.c_str());
           return false;
         }
-        /* Propagate any listItem dependency from the operand to the expression */
+        /* Propagate any listItem dependency and info sources from the operand to the expression */
         m_listItemDependent |= info->ListItemDependent();
-        nodes.push(boost::make_shared<InfoLeaf>(info, invert));
+        m_sources |= info->GetSources();
+        nodes.push(boost::make_shared<InfoLeaf>(info, invert, operand));
         /* Reuse operand string for next operand */
         operand.clear();
       }
@@ -302,9 +401,10 @@ bool InfoExpression::Parse(const std::string &expression)
       CLog::Log(LOGERROR, "Bad operand '%s'", operand.c_str());
       return false;
     }
-    /* Propagate any listItem dependency from the operand to the expression */
+    /* Propagate any listItem dependency and info sources from the operand to the expression */
     m_listItemDependent |= info->ListItemDependent();
-    nodes.push(boost::make_shared<InfoLeaf>(info, invert));
+    m_sources |= info->GetSources();
+    nodes.push(boost::make_shared<InfoLeaf>(info, invert, operand));
   }
   while (!operator_stack.empty())
     OperatorPop(operator_stack, invert, nodes);
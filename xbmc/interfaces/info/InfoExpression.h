@@ -43,6 +43,10 @@ private:
 };
 
 /*! \brief Class to wrap active boolean expressions
+
+ Expressions are parsed into a tree, nested groups are shared with other expressions by
+ registering them as conditions of their own, and the tree is then compiled into a flat
+ program of operands and short-circuit jumps that is run on every update.
  */
 class InfoExpression : public InfoBool
 {
@@ -51,6 +55,10 @@ public:
   virtual ~InfoExpression() {};
 
   virtual void Update(const CGUIListItem *item);
+
+  /*! \brief Number of instructions in the compiled program
+   */
+  unsigned int GetProgramSize() const { return m_program.size(); }
 private:
   typedef enum
   {
@@ -69,27 +77,51 @@ private:
     NODE_OR,
   } node_type_t;
 
+  typedef enum
+  {
+    OPCODE_LEAF,           // evaluate an operand
+    OPCODE_JUMP_IF_TRUE,   // leave an OR group
+    OPCODE_JUMP_IF_FALSE,  // leave an AND group
+  } opcode_t;
+
+  class InfoSubexpression;
+  class InfoAssociativeGroup;
+  typedef boost::shared_ptr<InfoSubexpression> InfoSubexpressionPtr;
+  typedef std::list<InfoSubexpressionPtr>::iterator InfoChildIterator;
+
+  // A single step of the compiled program
+  struct Instruction
+  {
+    opcode_t opcode;
+    bool invert;                  ///< leaf: invert the value of the operand
+    InfoBool *info;               ///< leaf: the operand, owned by the expression tree
+    unsigned int target;          ///< jump: instruction following the group
+    InfoAssociativeGroup *group;  ///< jump: group to reorder when taken, NULL for its first child
+    InfoChildIterator child;      ///< jump: child that decided the group
+  };
+
   // An abstract base class for nodes in the expression tree
   class InfoSubexpression
   {
   public:
     virtual ~InfoSubexpression(void) {}; // so we can destruct derived classes using a pointer to their base class
-    virtual bool Evaluate(const CGUIListItem *item) = 0;
+    virtual void Compile(std::vector<Instruction> &program) = 0;
+    virtual std::string ToString() const = 0;
     virtual node_type_t Type() const=0;
   };
 
-  typedef boost::shared_ptr<InfoSubexpression> InfoSubexpressionPtr;
-
   // A leaf node in the expression tree
   class InfoLeaf : public InfoSubexpression
   {
   public:
-    InfoLeaf(InfoPtr info, bool invert) : m_info(info), m_invert(invert) {};
-    virtual bool Evaluate(const CGUIListItem *item);
+    InfoLeaf(InfoPtr info, bool invert, const std::string &operand) : m_info(info), m_invert(invert), m_operand(operand) {};
+    virtual void Compile(std::vector<Instruction> &program);
+    virtual std::string ToString() const;
     virtual node_type_t Type() const { return NODE_LEAF; };
   private:
     InfoPtr m_info;
     bool m_invert;
+    std::string m_operand;  ///< operand as written, used to share subexpressions
   };
 
   // A branch node in the expression tree
@@ -99,7 +131,14 @@ private:
     InfoAssociativeGroup(node_type_t type, const InfoSubexpressionPtr &left, const InfoSubexpressionPtr &right);
     void AddChild(const InfoSubexpressionPtr &child);
     void Merge(boost::shared_ptr<InfoAssociativeGroup> other);
-    virtual bool Evaluate(const CGUIListItem *item);
+    /*! \brief Replace nested groups by leaves of registered, shared conditions
+     */
+    void ShareSubgroups(int context);
+    /*! \brief Move a child to the front of the group so it is evaluated first next time
+     */
+    void Promote(InfoChildIterator child);
+    virtual void Compile(std::vector<Instruction> &program);
+    virtual std::string ToString() const;
     virtual node_type_t Type() const { return m_type; };
   private:
     node_type_t m_type;
@@ -109,7 +148,10 @@ private:
   static operator_t GetOperator(char ch);
   static void OperatorPop(std::stack<operator_t> &operator_stack, bool &invert, std::stack<InfoSubexpressionPtr> &nodes);
   bool Parse(const std::string &expression);
+  void Compile();
   InfoSubexpressionPtr m_expression_tree;
+  std::vector<Instruction> m_program;
+  bool m_programDirty;          ///< the tree has been reordered since the program was compiled
 };
 
 };
@@ -0,0 +1,80 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIInfoManager.h"
+#include "interfaces/info/InfoExpression.h"
+#include "settings/SkinSettings.h"
+
+#include "gtest/gtest.h"
+
+using namespace INFO;
+
+static void SetSkinBool(const std::string &setting, bool value)
+{
+  CSkinSettings::Get().SetBool(CSkinSettings::Get().TranslateBool(setting), value);
+}
+
+TEST(TestInfoExpression, Evaluate)
+{
+  EXPECT_FALSE(g_infoManager.Register("true+false", 0)->Get());
+  EXPECT_TRUE(g_infoManager.Register("true|false", 0)->Get());
+  EXPECT_TRUE(g_infoManager.Register("![true+false]", 0)->Get());
+  EXPECT_TRUE(g_infoManager.Register("[false|true]+!false", 0)->Get());
+  EXPECT_FALSE(g_infoManager.Register("![true+[false|true]]|false", 0)->Get());
+}
+
+TEST(TestInfoExpression, Reorder)
+{
+  // the operand deciding an OR is moved to the front, values must not change with it
+  InfoPtr info = g_infoManager.Register("skin.hassetting(infotest1)|skin.hassetting(infotest2)|skin.hassetting(infotest3)", 0);
+  for (int i = 0; i < 8; i++)
+  {
+    SetSkinBool("infotest1", (i & 1) != 0);
+    SetSkinBool("infotest2", (i & 2) != 0);
+    SetSkinBool("infotest3", (i & 4) != 0);
+    g_infoManager.ResetCache();
+    EXPECT_EQ(i != 0, info->Get());
+  }
+}
+
+TEST(TestInfoExpression, ShareSubexpressions)
+{
+  InfoPtr first = g_infoManager.Register("skin.hassetting(infotest1)+[skin.hassetting(infotest3)|skin.hassetting(infotest2)]", 0);
+  InfoPtr second = g_infoManager.Register("skin.hassetting(infotest4)|[skin.hassetting(infotest2)|skin.hassetting(infotest3)]+true", 0);
+
+  // both expressions use the registered group, whose operands are sorted
+  InfoPtr group = g_infoManager.Register("[skin.hassetting(infotest2)|skin.hassetting(infotest3)]", 0);
+  ASSERT_TRUE(group);
+  EXPECT_EQ(4U, boost::static_pointer_cast<InfoExpression>(group)->GetProgramSize());
+  EXPECT_EQ(4U, boost::static_pointer_cast<InfoExpression>(first)->GetProgramSize());
+
+  SetSkinBool("infotest1", true);
+  SetSkinBool("infotest2", false);
+  SetSkinBool("infotest3", true);
+  SetSkinBool("infotest4", false);
+  g_infoManager.ResetCache();
+  EXPECT_TRUE(first->Get());
+  EXPECT_TRUE(second->Get());
+
+  // and it has already been evaluated through them
+  unsigned int evaluations = InfoBool::GetEvaluations();
+  EXPECT_TRUE(group->Get());
+  EXPECT_EQ(evaluations, InfoBool::GetEvaluations());
+}
@@ -57,6 +57,7 @@
 #include "guilib/LocalizeStrings.h"
 #include "utils/LegacyPathTranslation.h"
 #include "utils/log.h"
+#include "utils/LibraryIndex.h"
 #include "utils/TimeUtils.h"
 #include "TextureCache.h"
 #include "addons/AddonInstaller.h"
@@ -103,6 +104,7 @@ static void AnnounceUpdate(const std::string& content, int id)
 
 CMusicDatabase::CMusicDatabase(void)
 {
+  m_cacheArtists = false;
 }
 
 CMusicDatabase::~CMusicDatabase(void)
@@ -370,7 +372,30 @@ std::string GetArtistString(const VECARTISTCREDITS &credits)
 bool CMusicDatabase::AddAlbum(CAlbum& album)
 {
   BeginTransaction();
+  AddAlbumWithSongs(album);
+  CommitTransaction();
+  return true;
+}
 
+bool CMusicDatabase::AddAlbums(VECALBUMS& albums)
+{
+  if (albums.empty())
+    return true;
+
+  // one transaction (and one library count refresh) for the whole batch, and
+  // the artists shared between its albums and songs are only looked up once
+  BeginTransaction();
+  m_cacheArtists = true;
+  for (VECALBUMS::iterator album = albums.begin(); album != albums.end(); ++album)
+    AddAlbumWithSongs(*album);
+  m_cacheArtists = false;
+  m_artistCache.clear();
+
+  return CommitTransaction();
+}
+
+void CMusicDatabase::AddAlbumWithSongs(CAlbum& album)
+{
   album.idAlbum = AddAlbum(album.strAlbum,
                            album.strMusicBrainzAlbumID,
                            GetArtistString(album.artistCredits),
@@ -423,9 +448,6 @@ bool CMusicDatabase::AddAlbum(CAlbum& album)
                                                           albumArt != album.art.end();
                                                         ++albumArt)
     SetArtForItem(album.idAlbum, MediaTypeAlbum, albumArt->first, albumArt->second);
-
-  CommitTransaction();
-  return true;
 }
 
 bool CMusicDatabase::UpdateAlbum(CAlbum& album)
@@ -527,17 +549,21 @@ int CMusicDatabase::AddSong(const int idAlbum,
     bHasKaraoke = CKaraokeLyricsFactory::HasLyrics(strPathAndFileName);
 #endif
 
+    dbiplus::BindList params;
+    params.push_back(idAlbum);
     if (!strMusicBrainzTrackID.empty())
-      strSQL = PrepareSQL("SELECT * FROM song WHERE idAlbum = %i AND strMusicBrainzTrackID = '%s'",
-                          idAlbum,
-                          strMusicBrainzTrackID.c_str());
+    {
+      strSQL = "SELECT * FROM song WHERE idAlbum = ? AND strMusicBrainzTrackID = ?";
+      params.push_back(strMusicBrainzTrackID.c_str());
+    }
     else
-      strSQL = PrepareSQL("SELECT * FROM song WHERE idAlbum=%i AND strFileName='%s' AND strTitle='%s' AND strMusicBrainzTrackID IS NULL",
-                          idAlbum,
-                          strFileName.c_str(),
-                          strTitle.c_str());
+    {
+      strSQL = "SELECT * FROM song WHERE idAlbum=? AND strFileName=? AND strTitle=? AND strMusicBrainzTrackID IS NULL";
+      params.push_back(strFileName.c_str());
+      params.push_back(strTitle.c_str());
+    }
 
-    if (!m_pDS->query(strSQL.c_str()))
+    if (!m_pDS->query(strSQL, params))
       return -1;
 
     if (m_pDS->num_rows() == 0)
@@ -1030,6 +1056,23 @@ bool CMusicDatabase::UpdateArtist(const CArtist& artist)
 }
 
 int CMusicDatabase::AddArtist(const CStdString& strArtist, const CStdString& strMusicBrainzArtistID)
+{
+  if (!m_cacheArtists)
+    return AddArtistToDatabase(strArtist, strMusicBrainzArtistID);
+
+  // within a batch the same (MusicBrainz ID, name) always resolves to the same artist
+  CStdString cacheKey = strMusicBrainzArtistID + "|" + strArtist;
+  map<CStdString, int>::const_iterator it = m_artistCache.find(cacheKey);
+  if (it != m_artistCache.end())
+    return it->second;
+
+  int idArtist = AddArtistToDatabase(strArtist, strMusicBrainzArtistID);
+  if (idArtist >= 0)
+    m_artistCache.insert(pair<CStdString, int>(cacheKey, idArtist));
+  return idArtist;
+}
+
+int CMusicDatabase::AddArtistToDatabase(const CStdString& strArtist, const CStdString& strMusicBrainzArtistID)
 {
   CStdString strSQL;
   try
@@ -1041,9 +1084,10 @@ int CMusicDatabase::AddArtist(const CStdString& strArtist, const CStdString& str
     if (!strMusicBrainzArtistID.empty())
     {
       // 1.a) Match on a MusicBrainz ID
-      strSQL = PrepareSQL("SELECT * FROM artist WHERE strMusicBrainzArtistID = '%s'",
-                          strMusicBrainzArtistID.c_str());
-      m_pDS->query(strSQL.c_str());
+      dbiplus::BindList params;
+      params.push_back(strMusicBrainzArtistID.c_str());
+      strSQL = "SELECT * FROM artist WHERE strMusicBrainzArtistID = ?";
+      m_pDS->query(strSQL, params);
       if (m_pDS->num_rows() > 0)
       {
         int idArtist = (int)m_pDS->fv("idArtist").get_asInt();
@@ -1055,8 +1099,10 @@ int CMusicDatabase::AddArtist(const CStdString& strArtist, const CStdString& str
 
       // 1.b) No match on MusicBrainz ID. Look for a previously added artist with no MusicBrainz ID
       //     and update that if it exists.
-      strSQL = PrepareSQL("SELECT * FROM artist WHERE strArtist LIKE '%s' AND strMusicBrainzArtistID IS NULL", strArtist.c_str());
-      m_pDS->query(strSQL.c_str());
+      params.clear();
+      params.push_back(strArtist.c_str());
+      strSQL = "SELECT * FROM artist WHERE strArtist LIKE ? AND strMusicBrainzArtistID IS NULL";
+      m_pDS->query(strSQL, params);
       if (m_pDS->num_rows() > 0)
       {
         int idArtist = (int)m_pDS->fv("idArtist").get_asInt();
@@ -1076,10 +1122,10 @@ int CMusicDatabase::AddArtist(const CStdString& strArtist, const CStdString& str
     }
     else
     {
-      strSQL = PrepareSQL("SELECT * FROM artist WHERE strArtist LIKE '%s'",
-                          strArtist.c_str());
-
-      m_pDS->query(strSQL.c_str());
+      dbiplus::BindList params;
+      params.push_back(strArtist.c_str());
+      strSQL = "SELECT * FROM artist WHERE strArtist LIKE ?";
+      m_pDS->query(strSQL, params);
       if (m_pDS->num_rows() > 0)
       {
         int idArtist = (int)m_pDS->fv("idArtist").get_asInt();
@@ -2612,6 +2658,8 @@ int CMusicDatabase::Cleanup(bool bShowProgress /* = true */)
     pDlgProgress->Progress();
     pDlgProgress->Close();
   }
+  CLibraryIndex::Get().Clear();
+
   time = XbmcThreads::SystemClockMillis() - time;
   CLog::Log(LOGNOTICE, "%s: Cleaning musicdatabase done. Operation took %s", __FUNCTION__, StringUtils::SecondsToTimeString(time / 1000).c_str());
   ANNOUNCEMENT::CAnnouncementManager::Get().Announce(ANNOUNCEMENT::AudioLibrary, "xbmc", "OnCleanFinished");
@@ -3350,42 +3398,48 @@ bool CMusicDatabase::GetAlbumsByWhere(const CStdString &baseDir, const Filter &f
       strSQLExtra += DatabaseUtils::BuildLimitClause(sortDescription.limitEnd, sortDescription.limitStart);
     }
 
-    strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "albumview.*") + strSQLExtra;
+    DatabaseResults results;
+    if (!countOnly && g_advancedSettings.m_bMusicLibraryMemoryIndex &&
+        GetIndexedPage("albumview", MediaTypeAlbum, extFilter, sortDescription, results, total))
+      items.SetProperty("total", total);
+    else
+    {
+      strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "albumview.*") + strSQLExtra;
 
-    CLog::Log(LOGDEBUG, "%s query: %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    unsigned int time = XbmcThreads::SystemClockMillis();
-    if (!m_pDS->query(strSQL.c_str()))
-      return false;
-    CLog::Log(LOGDEBUG, "%s - query took %i ms",
-              __FUNCTION__, XbmcThreads::SystemClockMillis() - time); time = XbmcThreads::SystemClockMillis();
+      CLog::Log(LOGDEBUG, "%s query: %s", __FUNCTION__, strSQL.c_str());
+      // run query
+      unsigned int time = XbmcThreads::SystemClockMillis();
+      if (!m_pDS->query(strSQL.c_str()))
+        return false;
+      CLog::Log(LOGDEBUG, "%s - query took %i ms",
+                __FUNCTION__, XbmcThreads::SystemClockMillis() - time); time = XbmcThreads::SystemClockMillis();
 
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound <= 0)
-    {
-      m_pDS->close();
-      return true;
-    }
+      int iRowsFound = m_pDS->num_rows();
+      if (iRowsFound <= 0)
+      {
+        m_pDS->close();
+        return true;
+      }
 
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
+      // store the total value of items as a property
+      if (total < iRowsFound)
+        total = iRowsFound;
+      items.SetProperty("total", total);
 
-    if (countOnly)
-    {
-      CFileItemPtr pItem(new CFileItem());
-      pItem->SetProperty("total", total);
-      items.Add(pItem);
+      if (countOnly)
+      {
+        CFileItemPtr pItem(new CFileItem());
+        pItem->SetProperty("total", total);
+        items.Add(pItem);
 
-      m_pDS->close();
-      return true;
+        m_pDS->close();
+        return true;
+      }
+
+      results.reserve(iRowsFound);
+      if (!SortUtils::SortFromDataset(sortDescription, MediaTypeAlbum, m_pDS, results))
+        return false;
     }
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeAlbum, m_pDS, results))
-      return false;
 
     // get data from returned rows
     items.Reserve(results.size());
@@ -3463,29 +3517,35 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
       strSQLExtra += DatabaseUtils::BuildLimitClause(sortDescription.limitEnd, sortDescription.limitStart);
     }
 
-    strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "songview.*") + strSQLExtra;
+    DatabaseResults results;
+    if (g_advancedSettings.m_bMusicLibraryMemoryIndex &&
+        GetIndexedPage("songview", MediaTypeSong, extFilter, sortDescription, results, total))
+      items.SetProperty("total", total);
+    else
+    {
+      strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "songview.*") + strSQLExtra;
 
-    CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL.c_str()))
-      return false;
+      CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
+      // run query
+      if (!m_pDS->query(strSQL.c_str()))
+        return false;
 
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound == 0)
-    {
-      m_pDS->close();
-      return true;
-    }
+      int iRowsFound = m_pDS->num_rows();
+      if (iRowsFound == 0)
+      {
+        m_pDS->close();
+        return true;
+      }
 
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
-      return false;
+      // store the total value of items as a property
+      if (total < iRowsFound)
+        total = iRowsFound;
+      items.SetProperty("total", total);
+
+      results.reserve(iRowsFound);
+      if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
+        return false;
+    }
 
     // get data from returned rows
     items.Reserve(results.size());
@@ -5420,8 +5480,10 @@ bool CMusicDatabase::GetArtForItem(int mediaId, const string &mediaType, map<str
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS2.get()) return false; // using dataset 2 as we're likely called in loops on dataset 1
 
-    CStdString sql = PrepareSQL("SELECT type,url FROM art WHERE media_id=%i AND media_type='%s'", mediaId, mediaType.c_str());
-    m_pDS2->query(sql.c_str());
+    dbiplus::BindList params;
+    params.push_back(mediaId);
+    params.push_back(mediaType.c_str());
+    m_pDS2->query("SELECT type,url FROM art WHERE media_id=? AND media_type=?", params);
     while (!m_pDS2->eof())
     {
       art.insert(make_pair(m_pDS2->fv(0).get_asString(), m_pDS2->fv(1).get_asString()));
@@ -5439,8 +5501,11 @@ bool CMusicDatabase::GetArtForItem(int mediaId, const string &mediaType, map<str
 
 string CMusicDatabase::GetArtForItem(int mediaId, const string &mediaType, const string &artType)
 {
-  std::string query = PrepareSQL("SELECT url FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
-  return GetSingleValue(query, m_pDS2);
+  dbiplus::BindList params;
+  params.push_back(mediaId);
+  params.push_back(mediaType.c_str());
+  params.push_back(artType.c_str());
+  return GetSingleValue("SELECT url FROM art WHERE media_id=? AND media_type=? AND type=?", params, m_pDS2);
 }
 
 bool CMusicDatabase::GetArtistArtForItem(int mediaId, const std::string &mediaType, std::map<std::string, std::string> &art)
@@ -5450,8 +5515,11 @@ bool CMusicDatabase::GetArtistArtForItem(int mediaId, const std::string &mediaTy
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS2.get()) return false; // using dataset 2 as we're likely called in loops on dataset 1
 
-    CStdString sql = PrepareSQL("SELECT type,url FROM art WHERE media_id=(SELECT idArtist from %s_artist WHERE id%s=%i AND iOrder=0) AND media_type='artist'", mediaType.c_str(), mediaType.c_str(), mediaId);
-    m_pDS2->query(sql.c_str());
+    // the table name is part of the statement, so there is one cached statement per media type
+    CStdString sql = PrepareSQL("SELECT type,url FROM art WHERE media_id=(SELECT idArtist from %s_artist WHERE id%s=? AND iOrder=0) AND media_type='artist'", mediaType.c_str(), mediaType.c_str());
+    dbiplus::BindList params;
+    params.push_back(mediaId);
+    m_pDS2->query(sql, params);
     while (!m_pDS2->eof())
     {
       art.insert(make_pair(m_pDS2->fv(0).get_asString(), m_pDS2->fv(1).get_asString()));
@@ -5469,8 +5537,11 @@ bool CMusicDatabase::GetArtistArtForItem(int mediaId, const std::string &mediaTy
 
 string CMusicDatabase::GetArtistArtForItem(int mediaId, const string &mediaType, const string &artType)
 {
-  std::string query = PrepareSQL("SELECT url FROM art WHERE media_id=(SELECT idArtist from %s_artist WHERE id%s=%i AND iOrder=0) AND media_type='artist' AND type='%s'", mediaType.c_str(), mediaType.c_str(), mediaId, artType.c_str());
-  return GetSingleValue(query, m_pDS2);
+  std::string query = PrepareSQL("SELECT url FROM art WHERE media_id=(SELECT idArtist from %s_artist WHERE id%s=? AND iOrder=0) AND media_type='artist' AND type=?", mediaType.c_str(), mediaType.c_str());
+  dbiplus::BindList params;
+  params.push_back(mediaId);
+  params.push_back(artType.c_str());
+  return GetSingleValue(query, params, m_pDS2);
 }
 
 bool CMusicDatabase::GetFilter(CDbUrl &musicUrl, Filter &filter, SortDescription &sorting)
@@ -192,6 +192,13 @@ public:
   // Album
   /////////////////////////////////////////////////
   bool AddAlbum(CAlbum& album);
+  /*! \brief Add a batch of albums and all their nested entities in a single transaction
+   Used by the scanner so that a batch of albums costs one commit rather than one per album.
+   Artist lookups are cached for the duration of the batch.
+   \param albums the albums to add, ids are filled in as for AddAlbum
+   \return true if the batch was committed, false otherwise
+   */
+  bool AddAlbums(VECALBUMS& albums);
   /*! \brief Update an album and all its nested entities (artists, songs, infoSongs, etc)
    \param album the album to update
    \return true or false
@@ -464,6 +471,7 @@ protected:
   std::map<CStdString, int> m_pathCache;
   std::map<CStdString, int> m_thumbCache;
   std::map<CStdString, CAlbum> m_albumCache;
+  bool m_cacheArtists; ///< whether AddArtist may use m_artistCache, only true inside AddAlbums
 
   virtual void CreateTables();
   virtual void CreateAnalytics();
@@ -478,6 +486,9 @@ private:
    */
   virtual void CreateViews();
 
+  void AddAlbumWithSongs(CAlbum& album);
+  int  AddArtistToDatabase(const CStdString& strArtist, const CStdString& strMusicBrainzArtistID);
+
   CSong GetSongFromDataset();
   CSong GetSongFromDataset(const dbiplus::sql_record* const record, int offset = 0);
   CArtist GetArtistFromDataset(dbiplus::Dataset* pDS, int offset = 0, bool needThumb = true);
@@ -45,6 +45,7 @@
 #include "utils/StringUtils.h"
 #include "utils/TimeUtils.h"
 #include "utils/log.h"
+#include "utils/LibraryIndex.h"
 #include "utils/URIUtils.h"
 #include "TextureCache.h"
 #include "music/MusicThumbLoader.h"
@@ -62,6 +63,9 @@ using namespace MUSICDATABASEDIRECTORY;
 using namespace MUSIC_GRABBER;
 using namespace ADDON;
 
+// number of scanned songs queued up before they're written to the database in one transaction
+#define MUSIC_SCAN_BATCH_SONGS 500
+
 CMusicInfoScanner::CMusicInfoScanner() : CThread("MusicInfoScanner"), m_fileCountReader(this, "MusicFileCounter")
 {
   m_bRunning = false;
@@ -71,6 +75,7 @@ CMusicInfoScanner::CMusicInfoScanner() : CThread("MusicInfoScanner"), m_fileCoun
   m_currentItem=0;
   m_itemCount=0;
   m_flags = 0;
+  m_pendingSongs = 0;
 }
 
 CMusicInfoScanner::~CMusicInfoScanner()
@@ -150,6 +155,9 @@ void CMusicInfoScanner::Process()
         }
       }
 
+      // add whatever the last directories left queued, even if we were stopped
+      CommitPendingAlbums();
+
       if (commit)
       {
         g_infoManager.ResetLibraryBools();
@@ -252,6 +260,7 @@ void CMusicInfoScanner::Process()
   
   // we need to clear the musicdb cache and update any active lists
   CUtil::DeleteMusicDatabaseDirectoryCache();
+  CLibraryIndex::Get().Clear();
   CGUIMessage msg(GUI_MSG_SCAN_FINISHED, 0, 0, 0);
   g_windowManager.SendThreadMessage(msg);
   
@@ -472,8 +481,10 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
         OnDirectoryScanned(strDirectory);
     }
 
-    // save information about this folder
-    m_musicDatabase.SetPathHash(strDirectory, hash);
+    // save information about this folder once its albums are committed
+    m_pendingHashes.push_back(make_pair(strDirectory, hash));
+    if (m_pendingSongs >= MUSIC_SCAN_BATCH_SONGS)
+      CommitPendingAlbums();
   }
   else
   { // path is the same - no need to rescan
@@ -740,7 +751,53 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
   FileItemsToAlbums(scannedItems, albums, &songsMap);
   FindArtForAlbums(albums, items.GetPath());
 
+  // Queue the albums, they're added to the database in batches by CommitPendingAlbums()
   int numAdded = 0;
+  for (VECALBUMS::iterator album = albums.begin(); album != albums.end(); ++album)
+  {
+    album->strPath = strDirectory;
+    m_pendingAlbums.push_back(*album);
+    numAdded += album->songs.size();
+  }
+  m_pendingSongs += numAdded;
+
+  return numAdded;
+}
+
+void CMusicInfoScanner::CommitPendingAlbums()
+{
+  if (m_pendingAlbums.empty() && m_pendingHashes.empty())
+    return;
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  if (!m_musicDatabase.AddAlbums(m_pendingAlbums))
+  {
+    // the folders keep their old hashes, so they get rescanned next time
+    CLog::Log(LOGERROR, "%s failed to add %i songs in %u albums", __FUNCTION__,
+              m_pendingSongs, (unsigned int)m_pendingAlbums.size());
+    m_pendingAlbums.clear();
+    m_pendingHashes.clear();
+    m_pendingSongs = 0;
+    return;
+  }
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+  CLog::Log(LOGDEBUG, "%s added %i songs in %u albums in %u ms", __FUNCTION__,
+            m_pendingSongs, (unsigned int)m_pendingAlbums.size(), elapsed);
+
+  // only save the folder hashes once their songs are in, so an interrupted
+  // or failed batch gets rescanned next time
+  for (vector< pair<string, string> >::const_iterator hash = m_pendingHashes.begin(); hash != m_pendingHashes.end(); ++hash)
+    m_musicDatabase.SetPathHash(hash->first, hash->second);
+
+  VECALBUMS albums;
+  albums.swap(m_pendingAlbums);
+  m_pendingHashes.clear();
+  m_pendingSongs = 0;
+
+  map<string, int> albumsInPath;
+  for (VECALBUMS::const_iterator album = albums.begin(); album != albums.end(); ++album)
+    albumsInPath[album->strPath]++;
+
   ADDON::AddonPtr addon;
   ADDON::ScraperPtr albumScraper;
   ADDON::ScraperPtr artistScraper;
@@ -750,20 +807,16 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
   if(ADDON::CAddonMgr::Get().GetDefault(ADDON::ADDON_SCRAPER_ARTISTS, addon))
     artistScraper = boost::dynamic_pointer_cast<ADDON::CScraper>(addon);
 
-  // Add each album
   for (VECALBUMS::iterator album = albums.begin(); album != albums.end(); ++album)
   {
     if (m_bStop)
       break;
 
-    album->strPath = strDirectory;
-    m_musicDatabase.AddAlbum(*album);
-
     // Yuk - this is a kludgy way to do what we want to do, but it will work to sort
     // out artist fanart until we can restructure the artist fanart to work more
     // like the album fanart. This has to be done after we've added the album so
     // we have the artist IDs to update, but before we call UpdateDatabaseArtistInfo.
-    if (albums.size() == 1 &&
+    if (albumsInPath[album->strPath] == 1 &&
         album->artistCredits.size() > 0 &&
         !StringUtils::EqualsNoCase(album->artistCredits[0].GetArtist(), "various artists") &&
         !StringUtils::EqualsNoCase(album->artistCredits[0].GetArtist(), "various"))
@@ -771,7 +824,7 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
       CArtist artist;
       if (m_musicDatabase.GetArtist(album->artistCredits[0].GetArtistId(), artist))
       {
-        artist.strPath = URIUtils::GetParentPath(strDirectory);
+        artist.strPath = URIUtils::GetParentPath(album->strPath);
         m_musicDatabase.SetArtForItem(artist.idArtist, MediaTypeArtist, GetArtistArtwork(artist));
       }
     }
@@ -827,13 +880,10 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
         }
       }
     }
-    numAdded += album->songs.size();
   }
 
   if (m_handle)
     m_handle->SetTitle(g_localizeStrings.Get(505));
-
-  return numAdded;
 }
 
 void CMusicInfoScanner::FindArtForAlbums(VECALBUMS &albums, const CStdString &path)
@@ -177,6 +177,12 @@ protected:
    */
   int RetrieveMusicInfo(const CStdString& strDirectory, CFileItemList& items);
 
+  /*! \brief Add the albums queued by RetrieveMusicInfo to the database
+   Adds all pending albums in a single transaction, saves the hashes of the
+   folders they came from and then fetches artist art and online info for them.
+   */
+  void CommitPendingAlbums();
+
   /*! \brief Scan in the ID3/Ogg/FLAC tags for a bunch of FileItems
     Given a list of FileItems, scan in the tags for those FileItems
    and populate a new FileItemList with the files that were successfully scanned.
@@ -220,6 +226,9 @@ protected:
 
   std::set<std::string> m_pathsToScan;
   std::set<std::string> m_seenPaths;
+  VECALBUMS m_pendingAlbums;
+  std::vector<std::pair<std::string, std::string> > m_pendingHashes; ///< folder hashes to save with m_pendingAlbums
+  int m_pendingSongs;
   int m_flags;
   CThread m_fileCountReader;
 };
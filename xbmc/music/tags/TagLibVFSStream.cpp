@@ -42,7 +42,7 @@ TagLibVFSStream::TagLibVFSStream(const string& strFileName, bool readOnly)
   m_bIsOpen = true;
   if (readOnly)
   {
-    if (!m_file.Open(strFileName))
+    if (!m_file.Open(strFileName, READ_MMAP))
       m_bIsOpen = false;
   }
   else
@@ -0,0 +1,129 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "music/MusicDatabase.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#define TEST_ALBUM_TRACKS 10
+#define TEST_ARTISTS      5
+#define TEST_GENRES       3
+
+// synthetic tree: <artist>/<album>/<track>.mp3
+static void MakeAlbums(VECALBUMS& albums, int count)
+{
+  for (int a = 0; a < count; a++)
+  {
+    std::string artist = StringUtils::Format("Artist %i", a % TEST_ARTISTS);
+    std::string genre = StringUtils::Format("Genre %i", a % TEST_GENRES);
+
+    CAlbum album;
+    album.strAlbum = StringUtils::Format("Album %i", a);
+    album.strPath = StringUtils::Format("/music/%s/%s/", artist.c_str(), album.strAlbum.c_str());
+    album.artistCredits.push_back(CArtistCredit(artist, ""));
+    album.genre.push_back(genre);
+    album.iYear = 1950 + a % 60;
+    for (int t = 1; t <= TEST_ALBUM_TRACKS; t++)
+    {
+      CSong song;
+      song.strTitle = StringUtils::Format("Track %i", t);
+      song.strFileName = StringUtils::Format("%s%02i.mp3", album.strPath.c_str(), t);
+      song.artistCredits = album.artistCredits;
+      song.genre = album.genre;
+      song.iTrack = t;
+      song.iDuration = 180 + t;
+      song.iYear = album.iYear;
+      album.songs.push_back(song);
+    }
+    albums.push_back(album);
+  }
+}
+
+class CTestMusicDatabase : public CMusicDatabase
+{
+public:
+  // creates a fresh database with the current schema in special://temp and leaves it connected
+  bool Create(const std::string& name)
+  {
+    DatabaseSettings settings;
+    settings.type = "sqlite3";
+    settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    settings.name = name;
+    return Update(settings);
+  }
+
+  // the file Create() makes for a database of the given name
+  std::string GetFile(const std::string& name) const
+  {
+    return StringUtils::Format("special://temp/%s%d.db", name.c_str(), GetSchemaVersion());
+  }
+};
+
+class TestMusicDatabase : public testing::Test
+{
+protected:
+  virtual void TearDown()
+  {
+    CTestMusicDatabase db;
+    for (std::vector<std::string>::const_iterator name = m_names.begin(); name != m_names.end(); ++name)
+      XFILE::CFile::Delete(db.GetFile(*name));
+  }
+
+  // a database name no other test run uses, deleted again in TearDown()
+  std::string TempName()
+  {
+    m_names.push_back("MyMusicTest" + StringUtils::CreateUUID());
+    return m_names.back();
+  }
+
+  std::vector<std::string> m_names;
+};
+
+TEST_F(TestMusicDatabase, AddAlbumsMatchesAddAlbum)
+{
+  VECALBUMS single, batched;
+  MakeAlbums(single, 20);
+  batched = single;
+
+  CTestMusicDatabase db1, db2;
+  ASSERT_TRUE(db1.Create(TempName()));
+  ASSERT_TRUE(db2.Create(TempName()));
+
+  for (VECALBUMS::iterator album = single.begin(); album != single.end(); ++album)
+    EXPECT_TRUE(db1.AddAlbum(*album));
+  EXPECT_TRUE(db2.AddAlbums(batched));
+
+  EXPECT_EQ(db1.GetSongsCount(), db2.GetSongsCount());
+  EXPECT_EQ(20 * TEST_ALBUM_TRACKS, db2.GetSongsCount());
+  for (size_t i = 0; i < single.size(); i++)
+  {
+    EXPECT_EQ(single[i].idAlbum, batched[i].idAlbum);
+    EXPECT_EQ(single[i].artistCredits[0].GetArtistId(), batched[i].artistCredits[0].GetArtistId());
+    EXPECT_EQ(single[i].songs.back().idSong, batched[i].songs.back().idSong);
+  }
+  EXPECT_EQ(batched[0].artistCredits[0].GetArtistId(), db2.GetArtistByName("Artist 0"));
+}
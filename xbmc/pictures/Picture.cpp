@@ -109,6 +109,26 @@ bool CPicture::CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_
 }
 
 bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest)
+{
+  if (GetCacheSize(width, height, orientation, dest_width, dest_height))
+  {
+    bool success = false;
+    uint32_t *buffer = ResizeTexture(pixels, width, height, pitch, orientation, dest_width, dest_height);
+    if (buffer)
+    {
+      success = CreateThumbnailFromSurface((unsigned char*)buffer, dest_width, dest_height, dest_width * 4, dest);
+      delete[] buffer;
+    }
+    return success;
+  }
+  else
+  { // no orientation needed
+    return CreateThumbnailFromSurface(pixels, width, height, pitch, dest);
+  }
+  return false;
+}
+
+bool CPicture::GetCacheSize(uint32_t width, uint32_t height, int orientation, uint32_t &dest_width, uint32_t &dest_height)
 {
   // if no max width or height is specified, don't resize
   if (dest_width == 0)
@@ -131,35 +151,37 @@ bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, ui
 
   if (width > dest_width || height > dest_height || orientation)
   {
-    bool success = false;
-
     dest_width = std::min(width, dest_width);
     dest_height = std::min(height, dest_height);
-
-    // create a buffer large enough for the resulting image
     GetScale(width, height, dest_width, dest_height);
-    uint32_t *buffer = new uint32_t[dest_width * dest_height];
-    if (buffer)
+    return true;
+  }
+  dest_width = width;
+  dest_height = height;
+  return false;
+}
+
+uint32_t *CPicture::ResizeTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height)
+{
+  // create a buffer large enough for the resulting image
+  uint32_t *buffer = new uint32_t[dest_width * dest_height];
+  if (buffer)
+  {
+    if (ScaleImage(pixels, width, height, pitch,
+                   (uint8_t *)buffer, dest_width, dest_height, dest_width * 4))
     {
-      if (ScaleImage(pixels, width, height, pitch,
-                     (uint8_t *)buffer, dest_width, dest_height, dest_width * 4))
-      {
-        if (!orientation || OrientateImage(buffer, dest_width, dest_height, orientation))
-        {
-          success = CreateThumbnailFromSurface((unsigned char*)buffer, dest_width, dest_height, dest_width * 4, dest);
-        }
-      }
-      delete[] buffer;
+      if (!orientation || OrientateImage(buffer, dest_width, dest_height, orientation))
+        return buffer;
     }
-    return success;
+    delete[] buffer;
   }
-  else
-  { // no orientation needed
-    dest_width = width;
-    dest_height = height;
-    return CreateThumbnailFromSurface(pixels, width, height, pitch, dest);
-  }
-  return false;
+  return NULL;
+}
+
+void CPicture::GetMaxCacheSize(uint32_t &max_width, uint32_t &max_height)
+{
+  max_height = std::max(g_advancedSettings.m_imageRes, g_advancedSettings.m_fanartRes);
+  max_width = max_height * 16/9;
 }
 
 bool CPicture::CreateTiledThumb(const std::vector<std::string> &files, const std::string &thumb)
@@ -44,6 +44,36 @@ public:
   static bool CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest);
   static bool CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest);
 
+  /*! \brief Work out the size an image is cached at, see CacheTexture
+   \param width width of the image in pixels
+   \param height height of the image in pixels
+   \param orientation orientation of the image
+   \param dest_width [in/out] maximum width in pixels of cached version, 0 for no maximum - replaced with the cached width
+   \param dest_height [in/out] maximum height in pixels of cached version, 0 for no maximum - replaced with the cached height
+   \return true if the image needs resizing or orientating before it is cached, false otherwise
+   \sa ResizeTexture
+   */
+  static bool GetCacheSize(uint32_t width, uint32_t height, int orientation, uint32_t &dest_width, uint32_t &dest_height);
+
+  /*! \brief Resize and orientate an image to the size given by GetCacheSize
+   \param pixels the ARGB pixels of the image
+   \param width width of the image in pixels
+   \param height height of the image in pixels
+   \param pitch pitch of the image in bytes
+   \param orientation orientation of the image
+   \param dest_width [in/out] width as returned by GetCacheSize - replaced with the width after orientation
+   \param dest_height [in/out] height as returned by GetCacheSize - replaced with the height after orientation
+   \return the resulting pixels with a pitch of dest_width * 4, to be freed with delete[], NULL on failure
+   */
+  static uint32_t *ResizeTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height);
+
+  /*! \brief The largest size an image is cached at.
+   Images may be decoded at this size, as decoders such as libjpeg can downscale while decoding.
+   \param max_width [out] the maximum cached width
+   \param max_height [out] the maximum cached height
+   */
+  static void GetMaxCacheSize(uint32_t &max_width, uint32_t &max_height);
+
 private:
   static void GetScale(unsigned int width, unsigned int height, unsigned int &out_width, unsigned int &out_height);
   static bool ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
@@ -25,6 +25,7 @@
 #ifdef HAS_GL
 #include "system_gl.h"
 #include "GUIWindowTestPatternGL.h"
+#include "guilib/GUIRenderBatchGL.h"
 
 CGUIWindowTestPatternGL::CGUIWindowTestPatternGL(void) : CGUIWindowTestPattern()
 {
@@ -191,6 +192,7 @@ void CGUIWindowTestPatternGL::DrawCircle(int originX, int originY, int radius)
 
 void CGUIWindowTestPatternGL::BeginRender()
 {
+  CGUIRenderBatchGL::Get().Flush();
   glDisable(GL_TEXTURE_2D);
   glDisable(GL_BLEND);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -25,6 +25,7 @@
 
 #include "RenderSystemGL.h"
 #include "guilib/GraphicContext.h"
+#include "guilib/GUIRenderBatchGL.h"
 #include "settings/AdvancedSettings.h"
 #include "guilib/MatrixGLES.h"
 #include "settings/DisplaySettings.h"
@@ -241,6 +242,7 @@ bool CRenderSystemGL::ResetRenderSystem(int width, int height, bool fullScreen,
 
 bool CRenderSystemGL::DestroyRenderSystem()
 {
+  CGUIRenderBatchGL::Get().Reset();
   m_bRenderCreated = false;
 
   return true;
@@ -251,6 +253,8 @@ bool CRenderSystemGL::BeginRender()
   if (!m_bRenderCreated)
     return false;
 
+  CGUIRenderBatchGL::Get().BeginFrame();
+
   return true;
 }
 
@@ -259,6 +263,8 @@ bool CRenderSystemGL::EndRender()
   if (!m_bRenderCreated)
     return false;
 
+  CGUIRenderBatchGL::Get().Flush();
+
   return true;
 }
 
@@ -267,6 +273,8 @@ bool CRenderSystemGL::ClearBuffers(color_t color)
   if (!m_bRenderCreated)
     return false;
 
+  CGUIRenderBatchGL::Get().Flush();
+
   /* clear is not affected by stipple pattern, so we can only clear on first frame */
   if(m_stereoMode == RENDER_STEREO_MODE_INTERLACED && m_stereoView == RENDER_STEREO_VIEW_RIGHT)
     return true;
@@ -299,6 +307,8 @@ bool CRenderSystemGL::PresentRender(const CDirtyRegionList& dirty)
   if (!m_bRenderCreated)
     return false;
 
+  CGUIRenderBatchGL::Get().Flush();
+
   if (m_iVSyncMode != 0 && m_iSwapRate != 0)
   {
     int64_t curr, diff, freq;
@@ -395,6 +405,8 @@ void CRenderSystemGL::CaptureStateBlock()
   if (!m_bRenderCreated)
     return;
 
+  CGUIRenderBatchGL::Get().Flush();
+
   glMatrixProject.Push();
   glMatrixModview.Push();
   glMatrixTexture.Push();
@@ -431,6 +443,8 @@ void CRenderSystemGL::SetCameraPosition(const CPoint &camera, int screenWidth, i
   if (!m_bRenderCreated)
     return;
 
+  CGUIRenderBatchGL::Get().Flush();
+
   g_graphicsContext.BeginPaint();
 
   CPoint offset = camera - CPoint(screenWidth*0.5f, screenHeight*0.5f);
@@ -485,6 +499,8 @@ void CRenderSystemGL::ApplyHardwareTransform(const TransformMatrix &finalMatrix)
   if (!m_bRenderCreated)
     return;
 
+  CGUIRenderBatchGL::Get().Flush();
+
   glMatrixModview.Push();
   GLfloat matrix[4][4];
 
@@ -506,6 +522,8 @@ void CRenderSystemGL::RestoreHardwareTransform()
   if (!m_bRenderCreated)
     return;
 
+  CGUIRenderBatchGL::Get().Flush();
+
   glMatrixModview.PopLoad();
 }
 
@@ -571,6 +589,8 @@ void CRenderSystemGL::SetViewPort(CRect& viewPort)
   if (!m_bRenderCreated)
     return;
 
+  CGUIRenderBatchGL::Get().Flush();
+
   glScissor((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
   glViewport((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
   m_viewPort[0] = viewPort.x1;
@@ -583,6 +603,7 @@ void CRenderSystemGL::SetScissors(const CRect &rect)
 {
   if (!m_bRenderCreated)
     return;
+  CGUIRenderBatchGL::Get().Flush();
   GLint x1 = MathUtils::round_int(rect.x1);
   GLint y1 = MathUtils::round_int(rect.y1);
   GLint x2 = MathUtils::round_int(rect.x2);
@@ -652,6 +673,7 @@ static const GLubyte stipple_3d[] = {
 
 void CRenderSystemGL::SetStereoMode(RENDER_STEREO_MODE mode, RENDER_STEREO_VIEW view)
 {
+  CGUIRenderBatchGL::Get().Flush();
   CRenderSystemBase::SetStereoMode(mode, view);
 
   glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
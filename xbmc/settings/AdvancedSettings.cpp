@@ -256,6 +256,12 @@ void CAdvancedSettings::Initialize()
   m_fanartRes = 1080;
   m_imageRes = 720;
   m_useDDSFanart = false;
+  m_ddsMinSize = 360;
+#if defined(HAS_OMXPLAYER)
+  m_imageCachePipeline = false; // CTextureCacheJob has a hardware accelerated path
+#else
+  m_imageCachePipeline = true;
+#endif
 
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
@@ -272,6 +278,7 @@ void CAdvancedSettings::Initialize()
   m_bMusicLibraryAllItemsOnBottom = false;
   m_bMusicLibraryAlbumsSortByArtistThenYear = false;
   m_bMusicLibraryCleanOnUpdate = false;
+  m_bMusicLibraryMemoryIndex = false;
   m_iMusicLibraryRecentlyAddedItems = 25;
   m_strMusicLibraryAlbumFormat = "";
   m_strMusicLibraryAlbumFormatRight = "";
@@ -287,6 +294,7 @@ void CAdvancedSettings::Initialize()
   m_bVideoLibraryExportAutoThumbs = false;
   m_bVideoLibraryImportWatchedState = false;
   m_bVideoLibraryImportResumePoint = false;
+  m_bVideoLibraryMemoryIndex = false;
   m_bVideoScannerIgnoreErrors = false;
   m_iVideoLibraryDateAdded = 1; // prefer mtime over ctime and current time
 
@@ -373,6 +381,9 @@ void CAdvancedSettings::Initialize()
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_readBufferFactor = 1.0f;
+  // number of concurrent range readers used to fill the cache of seekable
+  // http/smb/nfs sources, 1 (default) reads the source sequentially
+  m_cacheReadThreads = 1;
   m_addonPackageFolderSize = 200;
 
   m_jsonOutputCompact = true;
@@ -384,6 +395,12 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  // printable ascii
+  m_guiFontPrewarm.clear();
+  for (char c = ' '; c <= '~'; c++)
+    m_guiFontPrewarm += c;
+  m_guiPrepareContainers = true;
+  m_guiPrefetchMemory = 64;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
 
@@ -757,6 +774,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "allitemsonbottom", m_bMusicLibraryAllItemsOnBottom);
     XMLUtils::GetBoolean(pElement, "albumssortbyartistthenyear", m_bMusicLibraryAlbumsSortByArtistThenYear);
     XMLUtils::GetBoolean(pElement, "cleanonupdate", m_bMusicLibraryCleanOnUpdate);
+    XMLUtils::GetBoolean(pElement, "memoryindex", m_bMusicLibraryMemoryIndex);
     XMLUtils::GetString(pElement, "albumformat", m_strMusicLibraryAlbumFormat);
     XMLUtils::GetString(pElement, "albumformatright", m_strMusicLibraryAlbumFormatRight);
     XMLUtils::GetString(pElement, "itemseparator", m_musicItemSeparator);
@@ -774,6 +792,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "exportautothumbs", m_bVideoLibraryExportAutoThumbs);
     XMLUtils::GetBoolean(pElement, "importwatchedstate", m_bVideoLibraryImportWatchedState);
     XMLUtils::GetBoolean(pElement, "importresumepoint", m_bVideoLibraryImportResumePoint);
+    XMLUtils::GetBoolean(pElement, "memoryindex", m_bVideoLibraryMemoryIndex);
     XMLUtils::GetInt(pElement, "dateadded", m_iVideoLibraryDateAdded);
   }
 
@@ -807,6 +826,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
     XMLUtils::GetUInt(pElement, "buffermode", m_networkBufferMode, 0, 3);
     XMLUtils::GetFloat(pElement, "readbufferfactor", m_readBufferFactor);
+    XMLUtils::GetUInt(pElement, "cachereadthreads", m_cacheReadThreads, 1, 8);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -1041,7 +1061,9 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetUInt(pRootElement, "imageres", m_imageRes, 0, 1080);
 #if !defined(TARGET_RASPBERRY_PI)
   XMLUtils::GetBoolean(pRootElement, "useddsfanart", m_useDDSFanart);
+  XMLUtils::GetUInt(pRootElement, "ddsminsize", m_ddsMinSize, 0, 4096);
 #endif
+  XMLUtils::GetBoolean(pRootElement, "imagecachepipeline", m_imageCachePipeline);
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", m_detectAsUdf);
 
@@ -1180,6 +1202,9 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetString(pElement, "fontprewarm",            m_guiFontPrewarm);
+    XMLUtils::GetBoolean(pElement, "preparecontainers",     m_guiPrepareContainers);
+    XMLUtils::GetInt(pElement, "prefetchmemory",            m_guiPrefetchMemory, 0, 1024);
   }
 
   // load in the settings overrides
@@ -253,6 +253,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
      */
     unsigned int GetThumbSize() const { return m_imageRes / 2; };
     bool m_useDDSFanart;
+    unsigned int m_ddsMinSize; ///< \brief images smaller than this in both dimensions get no .dds copy, see CTextureCache::UseDDS
+    bool m_imageCachePipeline; ///< \brief whether images are cached in the background by CTextureCachePipeline rather than one job at a time
 
     int m_sambaclienttimeout;
     CStdString m_sambadoscodepage;
@@ -270,6 +272,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_bMusicLibraryAllItemsOnBottom;
     bool m_bMusicLibraryAlbumsSortByArtistThenYear;
     bool m_bMusicLibraryCleanOnUpdate;
+    bool m_bMusicLibraryMemoryIndex;
     CStdString m_strMusicLibraryAlbumFormat;
     CStdString m_strMusicLibraryAlbumFormatRight;
     bool m_prioritiseAPEv2tags;
@@ -285,6 +288,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_bVideoLibraryExportAutoThumbs;
     bool m_bVideoLibraryImportWatchedState;
     bool m_bVideoLibraryImportResumePoint;
+    bool m_bVideoLibraryMemoryIndex;
 
     bool m_bVideoScannerIgnoreErrors;
     int m_iVideoLibraryDateAdded;
@@ -378,11 +382,15 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    CStdString m_guiFontPrewarm; ///< characters rendered to the font caches when a font is loaded
+    bool m_guiPrepareContainers; ///< prepare the layouts of list items in the background before they scroll into view
+    int  m_guiPrefetchMemory;    ///< MB of images loaded ahead of scrolling that may be kept around, 0 disables prefetching
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
     unsigned int m_networkBufferMode;
     float m_readBufferFactor;
+    unsigned int m_cacheReadThreads;
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
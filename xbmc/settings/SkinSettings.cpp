@@ -88,6 +88,8 @@ void CSkinSettings::SetString(int setting, const string &label)
   if (it != m_strings.end())
   {
     it->second.value = label;
+    lock.Leave();
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_SKIN);
     return;
   }
 
@@ -135,6 +137,8 @@ void CSkinSettings::SetBool(int setting, bool set)
   if (it != m_bools.end())
   {
     it->second.value = set;
+    lock.Leave();
+    g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_SKIN);
     return;
   }
 
@@ -153,6 +157,8 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value.clear();
+      lock.Leave();
+      g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_SKIN);
       return;
     }
   }
@@ -163,6 +169,8 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value = false;
+      lock.Leave();
+      g_infoManager.SetSourcesChanged(INFO::INFO_SOURCE_SKIN);
       return;
     }
   }
@@ -0,0 +1,287 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TextureCacheJob.h"
+#include "TextureCachePipeline.h"
+#include "TextureCache.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "guilib/Texture.h"
+#include "pictures/Picture.h"
+#include "profiles/Profile.h"
+#include "profiles/ProfilesManager.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/Settings.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <map>
+
+/* The tests cache a generated set of fanart, posters and logos */
+#define SAMPLES_PER_TYPE 2
+
+namespace
+{
+class CTestCallback : public ITextureCachePipelineCallback
+{
+public:
+  CTestCallback() : m_failed(0) {}
+
+  virtual bool OnCachingStart(CTextureCacheJob *job) { return true; }
+  virtual void OnCachingComplete(bool success, CTextureCacheJob *job)
+  {
+    CSingleLock lock(m_section);
+    if (success)
+      m_details[job->m_url] = job->m_details;
+    else
+      m_failed++;
+  }
+
+  CCriticalSection m_section;
+  std::map<std::string, CTextureDetails> m_details;
+  unsigned int m_failed;
+};
+
+class CCacheImageRunner : public CThread
+{
+public:
+  CCacheImageRunner(const std::vector<std::string> &images) : CThread("TestCacheImage"), m_images(images) {}
+
+  CEvent m_done;
+protected:
+  virtual void Process()
+  {
+    for (std::vector<std::string>::const_iterator i = m_images.begin(); i != m_images.end(); ++i)
+      CTextureCache::Get().CacheImage(*i);
+    m_done.Set();
+  }
+private:
+  std::vector<std::string> m_images;
+};
+
+/* Caches an image the way CTextureCacheJob::CacheTexture did before it was split into stages,
+   loading it at full size and resizing it in CPicture::CacheTexture. */
+bool CacheReference(const std::string &image, const std::string &dest, CTextureDetails &details)
+{
+  CBaseTexture *texture = CBaseTexture::LoadFromFile(image, 0, 0, CSettings::Get().GetBool("pictures.useexifrotation"), true);
+  if (!texture)
+    return false;
+  details.file = dest + (texture->HasAlpha() ? ".png" : ".jpg");
+  details.width = details.height = 0;
+  bool success = CPicture::CacheTexture(texture, details.width, details.height, details.file);
+  delete texture;
+  return success;
+}
+
+/* Mean difference per 8 bit channel between two images of the same size, 255 if they can't be compared.
+   Decoding at the cache size lets libjpeg downscale, so the stages don't give identical pixels. */
+double ImageDifference(const std::string &a, const std::string &b)
+{
+  CBaseTexture *textureA = CBaseTexture::LoadFromFile(a, 0, 0, false, true);
+  CBaseTexture *textureB = CBaseTexture::LoadFromFile(b, 0, 0, false, true);
+  double difference = 255.0;
+  if (textureA && textureB && textureA->GetWidth() == textureB->GetWidth() && textureA->GetHeight() == textureB->GetHeight())
+  {
+    uint64_t sum = 0;
+    for (unsigned int y = 0; y < textureA->GetHeight(); y++)
+    {
+      const unsigned char *rowA = textureA->GetPixels() + y * textureA->GetPitch();
+      const unsigned char *rowB = textureB->GetPixels() + y * textureB->GetPitch();
+      for (unsigned int x = 0; x < textureA->GetWidth() * 4; x++)
+        sum += abs((int)rowA[x] - (int)rowB[x]);
+    }
+    difference = (double)sum / (textureA->GetWidth() * textureA->GetHeight() * 4);
+  }
+  delete textureA;
+  delete textureB;
+  return difference;
+}
+
+bool WriteSample(const std::string &path, unsigned int width, unsigned int height, bool alpha, unsigned int seed)
+{
+  std::vector<uint32_t> pixels(width * height);
+  for (unsigned int y = 0; y < height; y++)
+  {
+    for (unsigned int x = 0; x < width; x++)
+    {
+      // smooth gradients with a little noise, so that the samples compress like real artwork
+      seed = seed * 1103515245 + 12345;
+      uint32_t noise = (seed >> 16) & 0x0f;
+      uint32_t r = (x * 255 / width + noise) & 0xff;
+      uint32_t g = (y * 255 / height + noise) & 0xff;
+      uint32_t b = ((x + y) * 127 / (width + height) + noise) & 0xff;
+      uint32_t a = alpha ? ((x / 32 + y / 32) % 2 ? 0xff : 0x40) : 0xff;
+      pixels[y * width + x] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+  }
+  return CPicture::CreateThumbnailFromSurface((const unsigned char *)&pixels[0], width, height, width * 4, path);
+}
+}
+
+class TestTextureCache : public testing::Test
+{
+protected:
+  TestTextureCache()
+  {
+    // jobs write to the thumbnails folder of the current profile
+    if (!CProfilesManager::Get().GetNumberOfProfiles())
+      CProfilesManager::Get().AddProfile(CProfile("special://temp/texturecache/"));
+    CProfilesManager::Get().CreateProfileFolders();
+
+    XFILE::CDirectory::Create("special://temp/texturesamples/");
+    for (unsigned int i = 0; i < SAMPLES_PER_TYPE; i++)
+    {
+      std::string fanart = StringUtils::Format("special://temp/texturesamples/fanart%u.jpg", i);
+      std::string poster = StringUtils::Format("special://temp/texturesamples/poster%u.jpg", i);
+      std::string logo = StringUtils::Format("special://temp/texturesamples/logo%u.png", i);
+      if (WriteSample(fanart, 1920, 1080, false, i))
+        m_images.push_back(fanart);
+      if (WriteSample(poster, 1000, 1500, false, i))
+        m_images.push_back(poster);
+      if (WriteSample(logo, 800, 310, true, i))
+        m_images.push_back(logo);
+    }
+  }
+
+  ~TestTextureCache()
+  {
+    for (std::vector<std::string>::const_iterator i = m_images.begin(); i != m_images.end(); ++i)
+      XFILE::CFile::Delete(*i);
+    ClearCache();
+  }
+
+  void ClearCache()
+  {
+    for (std::vector<std::string>::const_iterator i = m_images.begin(); i != m_images.end(); ++i)
+    {
+      std::string cached = CTextureCache::GetCachedPath(CTextureCache::GetCacheFile(*i));
+      XFILE::CFile::Delete(cached + ".jpg");
+      XFILE::CFile::Delete(cached + ".png");
+    }
+  }
+
+  std::vector<std::string> m_images;
+};
+
+TEST_F(TestTextureCache, PipelineMatchesCacheTexture)
+{
+  ASSERT_FALSE(m_images.empty());
+
+  std::map<std::string, CTextureDetails> reference;
+  for (std::vector<std::string>::const_iterator i = m_images.begin(); i != m_images.end(); ++i)
+  {
+    std::string dest = StringUtils::Format("special://temp/texturesamples/reference%u", (unsigned int)reference.size());
+    ASSERT_TRUE(CacheReference(*i, dest, reference[*i]));
+  }
+
+  CTestCallback callback;
+  CTextureCachePipeline pipeline(&callback);
+  pipeline.Start(1, 2, 1);
+  for (std::vector<std::string>::const_iterator i = m_images.begin(); i != m_images.end(); ++i)
+    EXPECT_TRUE(pipeline.AddJob(new CTextureCacheJob(*i)));
+  EXPECT_TRUE(pipeline.WaitForIdle(60000));
+  pipeline.Stop();
+
+  EXPECT_EQ(0U, callback.m_failed);
+  ASSERT_EQ(reference.size(), callback.m_details.size());
+  for (std::map<std::string, CTextureDetails>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+  {
+    const CTextureDetails &details = callback.m_details[i->first];
+    std::string cached = CTextureCache::GetCachedPath(details.file);
+    EXPECT_EQ(URIUtils::GetExtension(i->second.file), URIUtils::GetExtension(details.file));
+    EXPECT_EQ(i->second.width, details.width);
+    EXPECT_EQ(i->second.height, details.height);
+    EXPECT_TRUE(XFILE::CFile::Exists(cached));
+    EXPECT_LT(ImageDifference(i->second.file, cached), 4.0) << i->first;
+    XFILE::CFile::Delete(i->second.file);
+  }
+}
+
+TEST_F(TestTextureCache, CacheTextureReturnsFullSize)
+{
+  // callers of CacheImage() get the texture at the size they asked for, not the size it is cached at
+  std::string image = "special://temp/texturesamples/large.jpg";
+  ASSERT_TRUE(WriteSample(image, 3840, 2160, false, 0));
+  CBaseTexture *texture = NULL;
+  CTextureCacheJob job(image);
+  EXPECT_TRUE(job.CacheTexture(&texture));
+  ASSERT_TRUE(texture != NULL);
+  EXPECT_EQ(3840U, texture->GetWidth());
+  EXPECT_EQ(2160U, texture->GetHeight());
+  delete texture;
+
+  XFILE::CFile::Delete(CTextureCache::GetCachedPath(job.m_details.file));
+  XFILE::CFile::Delete(image);
+}
+
+TEST_F(TestTextureCache, CacheImageAfterPipelineStop)
+{
+  ASSERT_FALSE(m_images.empty());
+  bool pipelineSetting = g_advancedSettings.m_imageCachePipeline;
+  g_advancedSettings.m_imageCachePipeline = true;
+
+  // images under special://temp/ are taken to be cached already, so go by their real paths
+  std::vector<std::string> images;
+  for (std::vector<std::string>::const_iterator i = m_images.begin(); i != m_images.end(); ++i)
+    images.push_back(CSpecialProtocol::TranslatePath(*i));
+
+  // stop the pipeline with jobs queued and being worked on, as a skin reload does
+  CTextureCache::Get().Initialize();
+  for (std::vector<std::string>::const_iterator i = images.begin(); i != images.end(); ++i)
+    CTextureCache::Get().BackgroundCacheImage(*i);
+  CTextureCache::Get().Deinitialize();
+  CTextureCache::Get().Initialize();
+
+  // CacheImage waits for images that are being cached, so hangs on any the pipeline lost track of
+  CCacheImageRunner *runner = new CCacheImageRunner(images);
+  runner->Create();
+  bool done = runner->m_done.WaitMSec(60000);
+  EXPECT_TRUE(done);
+  if (done)
+  {
+    delete runner;
+    for (std::vector<std::string>::const_iterator i = images.begin(); i != images.end(); ++i)
+      CTextureCache::Get().ClearCachedImage(*i);
+  }
+  // else the runner is left hanging, deleting it would wait for it
+
+  CTextureCache::Get().Deinitialize();
+  g_advancedSettings.m_imageCachePipeline = pipelineSetting;
+}
+
+TEST_F(TestTextureCache, PipelineUnchangedHash)
+{
+  ASSERT_FALSE(m_images.empty());
+
+  CTextureCacheJob job(m_images[0]);
+  ASSERT_TRUE(job.Prepare());
+  EXPECT_TRUE(job.NeedsCaching());
+
+  CTextureCacheJob recache(m_images[0], job.m_details.hash);
+  ASSERT_TRUE(recache.Prepare());
+  EXPECT_FALSE(recache.NeedsCaching());
+}
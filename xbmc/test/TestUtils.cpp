@@ -230,6 +230,11 @@ std::vector<std::string> &CXBMCTestUtils::getGUISettingsFiles()
   return GUISettingsFiles;
 }
 
+std::vector<std::string> &CXBMCTestUtils::getPlayerBenchmarkFiles()
+{
+  return PlayerBenchmarkFiles;
+}
+
 static const char usage[] =
 "XBMC Test Suite\n"
 "Usage: xbmc-test [options]\n"
@@ -267,6 +272,13 @@ static const char usage[] =
 "    Add multiple GUI settings files from a ',' delimited string of\n"
 "    files to be loaded in test cases that use them.\n"
 "\n"
+"  --add-playerbenchmark-file [FILE]\n"
+"    Add a media file to be played by the DVDPlayerBenchmark of xbmc-benchmark.\n"
+"\n"
+"  --add-playerbenchmark-files [FILES]\n"
+"    Add multiple media files from a ',' delimited string of files to be\n"
+"    played by the DVDPlayerBenchmark of xbmc-benchmark.\n"
+"\n"
 "  --set-probability [PROBABILITY]\n"
 "    Set the probability variable used by the file corrupting functions.\n"
 "    The variable should be a double type from 0.0 to 1.0. Values given\n"
@@ -333,6 +345,18 @@ void CXBMCTestUtils::ParseArgs(int argc, char **argv)
       for (it = urls.begin(); it < urls.end(); it++)
         GUISettingsFiles.push_back(*it);
     }
+    else if (arg == "--add-playerbenchmark-file")
+    {
+      PlayerBenchmarkFiles.push_back(argv[++i]);
+    }
+    else if (arg == "--add-playerbenchmark-files")
+    {
+      arg = argv[++i];
+      std::vector<std::string> urls = StringUtils::Split(arg, ",");
+      std::vector<std::string>::iterator it;
+      for (it = urls.begin(); it < urls.end(); it++)
+        PlayerBenchmarkFiles.push_back(*it);
+    }
     else if (arg == "--set-probability")
     {
       probability = atof(argv[++i]);
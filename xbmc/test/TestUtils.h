@@ -76,6 +76,9 @@ public:
   /* Function to get GUI settings files. */
   std::vector<std::string> &getGUISettingsFiles();
 
+  /* Function to get the media files played by the DVDPlayerBenchmark of xbmc-benchmark. */
+  std::vector<std::string> &getPlayerBenchmarkFiles();
+
   /* Function used in creating a corrupted file. The parameters are a URL
    * to the original file to be corrupted and a suffix to append to the
    * path of the newly created file. This will return a XFILE::CFile
@@ -102,6 +105,8 @@ private:
   std::vector<std::string> AdvancedSettingsFiles;
   std::vector<std::string> GUISettingsFiles;
 
+  std::vector<std::string> PlayerBenchmarkFiles;
+
   double probability;
 };
 
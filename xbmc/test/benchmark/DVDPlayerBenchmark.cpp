@@ -0,0 +1,210 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDPlayer.h"
+#include "cores/IPlayerCallback.h"
+#include "cores/AudioEngine/AEFactory.h"
+#include "cores/VideoRenderers/RenderManager.h"
+#include "settings/Settings.h"
+#include "test/TestUtils.h"
+#include "threads/Event.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "FileItem.h"
+
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+
+#define PRESENT_INTERVAL 16    // ms between presents, a 60Hz display
+#define EXTRA_PLAY_TIME  60000 // ms a file may take on top of its duration
+#define MAX_DROPPED      5      // percentage of the decoded pictures that may be dropped
+
+/* The benchmark plays the files given with --add-playerbenchmark-file(s)
+ * through CDVDPlayer with the null renderer and the NULL audio sink, so it
+ * runs on machines without a display or sound card. For each file it reports
+ * demux, decode and present throughput, dropped frames, the a/v sync error
+ * distribution and the cpu time of every player thread.
+ *
+ * It takes as long as the files play, so it is part of the benchmark program
+ * rather than the test suite:
+ *   make benchmark
+ *   xbmc-benchmark --add-playerbenchmark-file <file>
+ * Each file has to play to its end, decode and output pictures, and drop no
+ * more than MAX_DROPPED percent of them.
+ */
+
+class BenchmarkCallback : public IPlayerCallback
+{
+public:
+  virtual void OnPlayBackEnded()   { m_ended.Set(); }
+  virtual void OnPlayBackStarted() {}
+  virtual void OnPlayBackStopped() { m_ended.Set(); }
+  virtual void OnQueueNextItem()   {}
+
+  CEvent m_ended;
+};
+
+// stands in for the GUI thread, presenting frames as they become due
+class BenchmarkPresenter : public CThread
+{
+public:
+  BenchmarkPresenter() : CThread("BenchPresenter"), m_cpuTime(0) {}
+
+  int64_t m_cpuTime;
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      g_renderManager.FrameMove();
+      g_renderManager.FrameFinish();
+      Sleep(PRESENT_INTERVAL);
+    }
+    m_cpuTime = GetAbsoluteUsage();
+  }
+};
+
+class DVDPlayerBenchmark : public testing::Test
+{
+protected:
+  DVDPlayerBenchmark()
+  {
+    m_files = CXBMCTestUtils::Instance().getPlayerBenchmarkFiles();
+    if (m_files.empty())
+      return;
+
+    m_audioDevice = CSettings::Get().GetString("audiooutput.audiodevice");
+    CSettings::Get().SetString("audiooutput.audiodevice", "NULL:NULL");
+    CAEFactory::LoadEngine();
+    CAEFactory::StartEngine();
+    g_renderManager.SetNullRenderer(true);
+  }
+
+  ~DVDPlayerBenchmark()
+  {
+    if (m_files.empty())
+      return;
+
+    g_renderManager.UnInit();
+    g_renderManager.SetNullRenderer(false);
+    CAEFactory::Shutdown();
+    CAEFactory::UnLoadEngine();
+    CSettings::Get().SetString("audiooutput.audiodevice", m_audioDevice);
+  }
+
+  std::vector<std::string> m_files;
+  std::string m_audioDevice;
+};
+
+static void Report(const std::string& file, const SDVDPlayerStats& stats, double wall, int presented, int skipped, int64_t presenterCpu)
+{
+  const SPlayerVideoStats& v = stats.video;
+  const SPlayerAudioStats& a = stats.audio;
+
+  std::cout << "File: " << file << std::endl;
+  std::cout << StringUtils::Format("  wall time:  %.2f s", wall) << std::endl;
+  std::cout << StringUtils::Format("  demux:      %u packets, %.2f MB, %.1f packets/s",
+                                   stats.demuxPackets, stats.demuxBytes / (1024.0 * 1024.0),
+                                   stats.demuxPackets / wall) << std::endl;
+  std::cout << StringUtils::Format("  decode:     %u frames, %.1f frames/s, %.1f frames/s decoder only",
+                                   v.decoded, v.decoded / wall,
+                                   v.decodeTime > 0.0 ? v.decoded / v.decodeTime : 0.0) << std::endl;
+  if (v.filtered)
+    std::cout << StringUtils::Format("  filter:     %u frames, %.2f ms per frame, longest %.2f ms",
+                                     v.filtered, v.filterTime * 1000.0 / v.filtered, v.filterTimeMax * 1000.0) << std::endl;
+  std::cout << StringUtils::Format("  present:    %d frames, %.1f frames/s", presented, presented / wall) << std::endl;
+  std::cout << StringUtils::Format("  dropped:    %u by the decoder or player, %d skipped by the renderer", v.dropped, skipped) << std::endl;
+
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < SYNC_ERROR_BUCKETS; i++)
+    count += a.syncErrors[i];
+  if (count)
+  {
+    double mean      = a.syncErrorSum / count;
+    double deviation = sqrt(std::max(a.syncErrorSquares / count - mean * mean, 0.0));
+    std::cout << StringUtils::Format("  a/v sync:   %u samples, mean %+.1f ms, deviation %.1f ms, max %.1f ms",
+                                     count, mean * 1000.0, deviation * 1000.0, a.syncErrorMax * 1000.0) << std::endl;
+    for (unsigned int i = 0; i < SYNC_ERROR_BUCKETS; i++)
+    {
+      std::string bucket = i < SYNC_ERROR_BUCKETS - 1
+                         ? StringUtils::Format("< %3d ms", SyncErrorBucketLimits[i])
+                         : StringUtils::Format(">=%3d ms", SyncErrorBucketLimits[i - 1]);
+      std::cout << StringUtils::Format("    %s: %5.1f%%", bucket.c_str(), 100.0 * a.syncErrors[i] / count) << std::endl;
+    }
+  }
+  else
+    std::cout << "  a/v sync:   no samples" << std::endl;
+
+  std::cout << StringUtils::Format("  cpu:        demux %.2f s, video %.2f s, audio %.2f s, present %.2f s",
+                                   stats.demuxCpuTime, v.cpuTime, a.cpuTime,
+                                   presenterCpu / 10000000.0) << std::endl;
+}
+
+TEST_F(DVDPlayerBenchmark, Play)
+{
+  ASSERT_FALSE(m_files.empty()) << "no files given with --add-playerbenchmark-file(s)";
+
+  for (std::vector<std::string>::iterator it = m_files.begin(); it != m_files.end(); ++it)
+  {
+    BenchmarkCallback callback;
+    BenchmarkPresenter presenter;
+    CDVDPlayer *player = new CDVDPlayer(callback);
+
+    presenter.Create();
+    int64_t start = CurrentHostCounter();
+
+    CFileItem item(*it, false);
+    CPlayerOptions options;
+    EXPECT_TRUE(player->OpenFile(item, options));
+
+    XbmcThreads::EndTime timeout((unsigned int)player->GetTotalTime() + EXTRA_PLAY_TIME);
+    bool ended = callback.m_ended.WaitMSec(timeout.MillisLeft());
+    EXPECT_TRUE(ended) << "timed out playing " << *it;
+    double wall = (double)(CurrentHostCounter() - start) / CurrentHostFrequency();
+
+    player->CloseFile();
+    presenter.StopThread();
+
+    // the player threads have all exited, so their cpu time is final
+    SDVDPlayerStats stats;
+    player->GetStats(stats);
+
+    // the render manager counts from the PreInit of the video player
+    int presented = 0, skipped = 0;
+    if (stats.video.decoded)
+    {
+      presented = g_renderManager.GetPresentedFrames();
+      skipped   = g_renderManager.GetSkippedFrames();
+    }
+    Report(*it, stats, wall, presented, skipped, presenter.m_cpuTime);
+
+    EXPECT_GT(stats.video.decoded, 0u) << *it;
+    EXPECT_GT(stats.video.output, 0u) << *it;
+    EXPECT_LE(stats.video.dropped * 100, stats.video.decoded * MAX_DROPPED) << *it;
+
+    delete player;
+  }
+}
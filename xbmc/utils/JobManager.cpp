@@ -258,6 +258,29 @@ void CJobManager::CancelJob(unsigned int jobID)
     it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
 }
 
+bool CJobManager::ChangePriority(unsigned int jobID, CJob::PRIORITY priority)
+{
+  CSingleLock lock(m_section);
+
+  for (unsigned int p = CJob::PRIORITY_LOW_PAUSABLE; p <= CJob::PRIORITY_HIGH; ++p)
+  {
+    JobQueue::iterator i = find(m_jobQueue[p].begin(), m_jobQueue[p].end(), jobID);
+    if (i != m_jobQueue[p].end())
+    {
+      if (p != (unsigned int)priority)
+      {
+        CWorkItem work = *i;
+        work.m_priority = priority;
+        m_jobQueue[p].erase(i);
+        m_jobQueue[priority].push_back(work);
+        StartWorkers(priority);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
 void CJobManager::StartWorkers(CJob::PRIORITY priority)
 {
   CSingleLock lock(m_section);
@@ -313,6 +336,12 @@ void CJobManager::UnPauseJobs()
   m_pauseJobs = false;
 }
 
+bool CJobManager::IsPaused() const
+{
+  CSingleLock lock(m_section);
+  return m_pauseJobs;
+}
+
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
   CSingleLock lock(m_section);
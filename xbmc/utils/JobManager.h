@@ -226,6 +226,16 @@ public:
    */
   void CancelJob(unsigned int jobID);
 
+  /*!
+   \brief Move a job that is still queued to another priority.
+   Useful when a job queued speculatively turns out to be needed right away.
+   \param jobID the id of the job, retrieved previously from AddJob()
+   \param priority the new priority of the job
+   \return true if the job was queued and has been moved, false if it is processing or done.
+   \sa AddJob()
+   */
+  bool ChangePriority(unsigned int jobID, CJob::PRIORITY priority);
+
   /*!
    \brief Cancel all remaining jobs, preparing for shutdown
    Should be called prior to destroying any objects that may be being used as callbacks
@@ -262,6 +272,13 @@ public:
    */
   void UnPauseJobs();
 
+  /*!
+   \brief Checks whether jobs with priority PRIORITY_LOW_PAUSABLE are currently paused
+   \return true if paused, false otherwise
+   \sa PauseJobs()
+   */
+  bool IsPaused() const;
+
   /*!
    \brief Checks to see if any jobs with specific priority are currently processing.
    \param priority to search for
@@ -0,0 +1,152 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "LibraryIndex.h"
+#include "LangInfo.h"
+#include "dbwrappers/dataset.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/DatabaseUtils.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+
+using namespace std;
+
+CLibraryIndex& CLibraryIndex::Get()
+{
+  static CLibraryIndex sLibraryIndex;
+  return sLibraryIndex;
+}
+
+bool CLibraryIndex::CanServe(const SortDescription &sorting)
+{
+  return sorting.sortBy != SortByNone && sorting.sortBy != SortByRandom &&
+        (sorting.limitStart > 0 || sorting.limitEnd > 0);
+}
+
+bool CLibraryIndex::GetPage(dbiplus::Database *db, const MediaType &mediaType, const std::string &view,
+                            const SortDescription &sorting, const std::vector<int> *filter,
+                            std::vector<int> &ids, int &total)
+{
+  if (db == NULL || !db->tracks_writes() || !CanServe(sorting))
+    return false;
+
+  // the order also depends on the articles ignored when sorting and on the language
+  string key = StringUtils::Format("%s/%s|%s|%s|%d|%d|%d|%s|%s", db->getHostName(), db->getDatabase(),
+                                   mediaType.c_str(), view.c_str(), (int)sorting.sortBy,
+                                   (int)sorting.sortOrder, (int)sorting.sortAttributes,
+                                   g_langInfo.GetLanguageLocale().c_str(),
+                                   (sorting.sortAttributes & SortAttributeIgnoreArticle) ?
+                                     StringUtils::Join(g_advancedSettings.m_vecTokens, ",").c_str() : "");
+  unsigned int generation = db->get_write_generation();
+
+  CSingleLock lock(m_critical);
+  SortColumns::iterator column = m_columns.find(key);
+  if (column == m_columns.end() || column->second.generation != generation)
+  {
+    // build outside of the lock, the view may be large
+    lock.Leave();
+    SortColumn newColumn;
+    newColumn.generation = generation;
+    if (!BuildColumn(db, mediaType, view, sorting, newColumn.ids))
+      return false;
+
+    lock.Enter();
+    column = m_columns.insert(make_pair(key, SortColumn())).first;
+    column->second.generation = newColumn.generation;
+    column->second.ids.swap(newColumn.ids);
+  }
+
+  const vector<int> *sorted = &column->second.ids;
+  vector<int> matching;
+  if (filter != NULL)
+  {
+    matching.reserve(filter->size());
+    for (vector<int>::const_iterator it = sorted->begin(); it != sorted->end(); ++it)
+    {
+      if (binary_search(filter->begin(), filter->end(), *it))
+        matching.push_back(*it);
+    }
+    sorted = &matching;
+  }
+
+  // same page semantics as SortUtils::Sort()
+  size_t count = sorted->size();
+  size_t start = 0, end = count;
+  if (sorting.limitStart > 0 && (size_t)sorting.limitStart < count)
+    start = sorting.limitStart;
+  if (sorting.limitEnd > (int)start && (size_t)sorting.limitEnd < count)
+    end = sorting.limitEnd;
+
+  ids.assign(sorted->begin() + start, sorted->begin() + end);
+  total = (int)count;
+  return true;
+}
+
+void CLibraryIndex::Clear()
+{
+  CSingleLock lock(m_critical);
+  m_columns.clear();
+}
+
+bool CLibraryIndex::BuildColumn(dbiplus::Database *db, const MediaType &mediaType, const std::string &view,
+                                const SortDescription &sorting, std::vector<int> &ids)
+{
+  int64_t start = CurrentHostCounter();
+
+  FieldList fields;
+  if (!DatabaseUtils::GetSelectFields(SortUtils::GetFieldsForSorting(sorting.sortBy), mediaType, fields))
+    fields.clear();
+  if (find(fields.begin(), fields.end(), FieldId) == fields.end())
+    fields.push_back(FieldId);
+
+  DatabaseResults results;
+  try
+  {
+    auto_ptr<dbiplus::Dataset> dataset(db->CreateDataset());
+    if (dataset.get() == NULL || !dataset->query("SELECT * FROM " + view))
+      return false;
+
+    if (!DatabaseUtils::GetDatabaseResults(mediaType, fields, dataset, results))
+      return false;
+    dataset->close();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to load %s", __FUNCTION__, view.c_str());
+    return false;
+  }
+
+  SortUtils::Sort(sorting.sortBy, sorting.sortOrder, sorting.sortAttributes, results);
+
+  ids.clear();
+  ids.reserve(results.size());
+  for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); ++it)
+    ids.push_back((int)it->at(FieldId).asInteger());
+
+  CLog::Log(LOGDEBUG, "%s - indexed %u items of %s sorted by %d in %.1f ms", __FUNCTION__,
+            (unsigned int)ids.size(), view.c_str(), (int)sorting.sortBy,
+            (CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency());
+  return true;
+}
@@ -0,0 +1,95 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "media/MediaType.h"
+#include "threads/CriticalSection.h"
+#include "utils/SortUtils.h"
+
+namespace dbiplus
+{
+  class Database;
+}
+
+/*!
+ \brief In-memory sort index of the library views.
+
+ For every database, view and sort description that has been listed a column
+ with the ids of all items of the view in sorted order is kept, so a sorted and
+ paged listing only has to fetch the rows of the requested page instead of
+ loading and sorting the whole view. Columns are rebuilt lazily from the view
+ whenever anything has been written to their database since they were built.
+ */
+class CLibraryIndex
+{
+public:
+  static CLibraryIndex& Get();
+
+  /*!
+   \brief Whether a listing with the given sort description can be served from the index.
+   Only sorted listings that are limited to a page are worth it, random orders can't be cached.
+   */
+  static bool CanServe(const SortDescription &sorting);
+
+  /*!
+   \brief Get the ids of the items of a sorted page of a library view.
+   \param db connection to the database holding the view, its writes must be tracked
+   \param mediaType media type of the items in the view
+   \param view name of the view holding the items
+   \param sorting sort description and page limits of the listing
+   \param filter ascending ids of the items matching the filter of the listing or NULL for all items
+   \param ids [out] ids of the items of the requested page in sort order
+   \param total [out] number of items matching the filter
+   \return true if the page could be served, false otherwise
+   */
+  bool GetPage(dbiplus::Database *db, const MediaType &mediaType, const std::string &view,
+               const SortDescription &sorting, const std::vector<int> *filter,
+               std::vector<int> &ids, int &total);
+
+  /*!
+   \brief Drop all columns, done when a library has been updated or cleaned and when the
+   databases change.
+   */
+  void Clear();
+
+protected:
+  CLibraryIndex() { }
+
+private:
+  CLibraryIndex(const CLibraryIndex&);
+  CLibraryIndex& operator=(const CLibraryIndex&);
+
+  typedef struct
+  {
+    unsigned int generation;
+    std::vector<int> ids;
+  } SortColumn;
+  typedef std::map<std::string, SortColumn> SortColumns;
+
+  static bool BuildColumn(dbiplus::Database *db, const MediaType &mediaType, const std::string &view,
+                          const SortDescription &sorting, std::vector<int> &ids);
+
+  SortColumns m_columns;
+  CCriticalSection m_critical;
+};
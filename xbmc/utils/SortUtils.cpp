@@ -23,11 +23,17 @@
 #include "Util.h"
 #include "XBDateTime.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/Thread.h"
 #include "utils/CharsetConverter.h"
+#include "utils/CPUInfo.h"
 #include "utils/StdString.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
+#include <algorithm>
+#include <locale>
+#include <set>
+
 using namespace std;
 
 string ArrayToString(SortAttribute attributes, const CVariant &variant, const string &seperator = " / ")
@@ -378,130 +384,273 @@ string ByDateTaken(SortAttribute attributes, const SortItem &values)
   return values.at(FieldDateTaken).asString();
 }
 
-bool preliminarySort(const SortItem &left, const SortItem &right, bool handleFolder, bool &result, std::wstring &labelLeft, std::wstring &labelRight)
+// a sort label folded into a sequence of integer keys, so that comparing two
+// labels neither allocates nor has to go through the locale like
+// StringUtils::AlphaNumericCompare() does. Every character is replaced by its
+// rank in the collation order of all characters of the list and every run of
+// up to 15 digits is packed together with its value into a single key.
+#define SORT_KEY_NUMBER       ((int64_t)1 << 62)
+#define SORT_KEY_DIGIT_SHIFT  50
+#define SORT_KEY_VALUE_MASK   (((int64_t)1 << SORT_KEY_DIGIT_SHIFT) - 1)
+
+// lists with at least this many items are sorted on multiple threads
+#define SORT_PARALLEL_MIN_ITEMS 8192
+
+typedef struct
+{
+  size_t index;                 // position of the item in the unsorted list
+  int64_t special;              // value of FieldSortSpecial or SortSpecialNone
+  int folder;                   // value of FieldFolder or -1 if the item has none
+  std::wstring label;           // label the item is sorted by
+  std::vector<int64_t> keys;    // the label folded into collation keys
+} SortKey;
+
+class SortKeyCollation
 {
-  // make sure both items have the necessary data to do the sorting
-  SortItem::const_iterator itLeftSort, itRightSort;
-  if ((itLeftSort = left.find(FieldSort)) == left.end())
+public:
+  // rank all characters used by the labels in the order of the current locale
+  SortKeyCollation(const vector<SortKey> &sortKeys)
   {
-    result = false;
-    return true;
+    set<wchar_t> used;
+    for (wchar_t digit = L'0'; digit <= L'9'; digit++)
+      used.insert(digit);
+    for (vector<SortKey>::const_iterator it = sortKeys.begin(); it != sortKeys.end(); ++it)
+    {
+      for (const wchar_t *c = it->label.c_str(); *c != 0; c++)
+        used.insert(Fold(*c));
+    }
+
+    vector<wchar_t> collated(used.begin(), used.end());
+    const collate<wchar_t>& coll = use_facet< collate<wchar_t> >(locale());
+    std::stable_sort(collated.begin(), collated.end(), Collate(coll));
+
+    int64_t rank = 0;
+    for (size_t i = 0; i < collated.size(); i++)
+    {
+      if (i > 0 && coll.compare(&collated[i - 1], &collated[i - 1] + 1, &collated[i], &collated[i] + 1) != 0)
+        rank++;
+      m_ranks[collated[i]] = rank;
+    }
+    for (int digit = 0; digit < 10; digit++)
+      m_digits[digit] = m_ranks[L'0' + digit];
   }
-  if ((itRightSort = right.find(FieldSort)) == right.end())
+
+  void Fold(SortKey &sortKey) const
   {
-    result = true;
-    return true;
+    sortKey.keys.clear();
+    sortKey.keys.reserve(sortKey.label.size());
+    const wchar_t *c = sortKey.label.c_str();
+    while (*c != 0)
+    {
+      if (*c >= L'0' && *c <= L'9')
+      {
+        // same as StringUtils::AlphaNumericCompare(), only up to 15 digits form a number
+        const wchar_t *start = c;
+        int64_t number = 0;
+        while (*c >= L'0' && *c <= L'9' && c < start + 15)
+          number = number * 10 + (*c++ - L'0');
+        sortKey.keys.push_back(SORT_KEY_NUMBER | ((int64_t)(*start - L'0') << SORT_KEY_DIGIT_SHIFT) | number);
+      }
+      else
+        sortKey.keys.push_back(m_ranks.find(Fold(*c++))->second);
+    }
   }
 
-  // look at special sorting behaviour
-  SortItem::const_iterator itLeft, itRight;
-  SortSpecial leftSortSpecial = SortSpecialNone;
-  SortSpecial rightSortSpecial = SortSpecialNone;
-  if ((itLeft = left.find(FieldSortSpecial)) != left.end() && itLeft->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    leftSortSpecial = (SortSpecial)itLeft->second.asInteger();
-  if ((itRight = right.find(FieldSortSpecial)) != right.end() && itRight->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    rightSortSpecial = (SortSpecial)itRight->second.asInteger();
-  
-  // one has a special sort
-  if (leftSortSpecial != rightSortSpecial)
+  // same result (sign) as StringUtils::AlphaNumericCompare() on the labels
+  int Compare(const SortKey &left, const SortKey &right) const
   {
-    // left should be sorted on top
-    // or right should be sorted on bottom
-    // => left is sorted above right
-    if (leftSortSpecial == SortSpecialOnTop ||
-        rightSortSpecial == SortSpecialOnBottom)
+    size_t count = min(left.keys.size(), right.keys.size());
+    for (size_t i = 0; i < count; i++)
     {
-      result = true;
-      return true;
+      int64_t l = left.keys[i];
+      int64_t r = right.keys[i];
+      if ((l & SORT_KEY_NUMBER) && (r & SORT_KEY_NUMBER))
+      {
+        l &= SORT_KEY_VALUE_MASK;
+        r &= SORT_KEY_VALUE_MASK;
+        if (l != r)
+          return l < r ? -1 : 1;
+        continue;
+      }
+
+      int64_t rankLeft = (l & SORT_KEY_NUMBER) ? m_digits[l >> SORT_KEY_DIGIT_SHIFT & 0xf] : l;
+      int64_t rankRight = (r & SORT_KEY_NUMBER) ? m_digits[r >> SORT_KEY_DIGIT_SHIFT & 0xf] : r;
+      if (rankLeft != rankRight)
+        return rankLeft < rankRight ? -1 : 1;
+
+      // a digit collating equal to another character, the keys don't line up anymore
+      if ((l ^ r) & SORT_KEY_NUMBER)
+      {
+        int64_t result = StringUtils::AlphaNumericCompare(left.label.c_str(), right.label.c_str());
+        return result < 0 ? -1 : (result > 0 ? 1 : 0);
+      }
     }
-    
-    // otherwise right is sorted above left
-    result = false;
-    return true;
+
+    if (right.keys.size() > count)
+      return -1;
+    if (left.keys.size() > count)
+      return 1;
+    return 0;
   }
-  // both have either sort on top or sort on bottom -> leave as-is
-  else if (leftSortSpecial != SortSpecialNone && leftSortSpecial == rightSortSpecial)
+
+private:
+  static wchar_t Fold(wchar_t c)
   {
-    result = false;
-    return true;
+    return (c >= L'A' && c <= L'Z') ? c + (L'a' - L'A') : c;
   }
 
-  if (handleFolder)
+  struct Collate
   {
-    itLeft = left.find(FieldFolder);
-    itRight = right.find(FieldFolder);
-    if (itLeft != left.end() && itRight != right.end() &&
-        itLeft->second.asBoolean() != itRight->second.asBoolean())
+    Collate(const collate<wchar_t> &coll) : m_coll(coll) { }
+    bool operator()(const wchar_t &left, const wchar_t &right) const
     {
-      result = itLeft->second.asBoolean();
-      return true;
+      return m_coll.compare(&left, &left + 1, &right, &right + 1) < 0;
     }
-  }
+    const collate<wchar_t> &m_coll;
+  };
 
-  labelLeft = itLeftSort->second.asWideString();
-  labelRight = itRightSort->second.asWideString();
-
-  return false;
-}
+  map<wchar_t, int64_t> m_ranks;
+  int64_t m_digits[10];
+};
 
-bool SorterAscending(const SortItem &left, const SortItem &right)
+// same ordering as the old SortItem comparators: special items first, then folders, then the label
+class SortKeyCompare
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+public:
+  SortKeyCompare(const SortKeyCollation &collation, SortOrder sortOrder, SortAttribute attributes)
+    : m_collation(collation),
+      m_descending(sortOrder == SortOrderDescending),
+      m_handleFolders(!(attributes & SortAttributeIgnoreFolders))
+  { }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+  bool operator()(const SortKey *left, const SortKey *right) const
+  {
+    // one has a special sort, left is sorted above right if left is
+    // sorted on top or right is sorted on bottom
+    if (left->special != right->special)
+      return left->special == SortSpecialOnTop || right->special == SortSpecialOnBottom;
+    // both have either sort on top or sort on bottom -> leave as-is
+    if (left->special != SortSpecialNone)
+      return false;
+
+    if (m_handleFolders && left->folder >= 0 && right->folder >= 0 && left->folder != right->folder)
+      return left->folder != 0;
+
+    int result = m_collation.Compare(*left, *right);
+    return m_descending ? result > 0 : result < 0;
+  }
+
+private:
+  const SortKeyCollation &m_collation;
+  bool m_descending;
+  bool m_handleFolders;
+};
 
-bool SorterDescending(const SortItem &left, const SortItem &right)
+class SortKeyJob : public IRunnable
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+public:
+  SortKeyJob(vector<SortKey*>::iterator begin, vector<SortKey*>::iterator end, const SortKeyCompare &compare)
+    : m_begin(begin), m_end(end), m_compare(compare)
+  { }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+  virtual void Run()
+  {
+    std::stable_sort(m_begin, m_end, m_compare);
+  }
 
-bool SorterIgnoreFoldersAscending(const SortItem &left, const SortItem &right)
+private:
+  vector<SortKey*>::iterator m_begin;
+  vector<SortKey*>::iterator m_end;
+  const SortKeyCompare &m_compare;
+};
+
+static void SortKeys(vector<SortKey*> &order, const SortKeyCompare &compare)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  size_t chunks = min((size_t)max(g_cpuInfo.getCPUCount(), 1), order.size() / (SORT_PARALLEL_MIN_ITEMS / 2));
+  if (order.size() < SORT_PARALLEL_MIN_ITEMS || chunks < 2)
+  {
+    std::stable_sort(order.begin(), order.end(), compare);
+    return;
+  }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+  // stable sort every chunk on its own thread and merge them in order,
+  // which gives the same result as a stable sort of the whole list
+  vector<size_t> bounds;
+  for (size_t chunk = 0; chunk <= chunks; chunk++)
+    bounds.push_back(order.size() * chunk / chunks);
 
-bool SorterIgnoreFoldersDescending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  vector<SortKeyJob*> jobs;
+  vector<CThread*> threads;
+  for (size_t chunk = 1; chunk < chunks; chunk++)
+  {
+    jobs.push_back(new SortKeyJob(order.begin() + bounds[chunk], order.begin() + bounds[chunk + 1], compare));
+    threads.push_back(new CThread(jobs.back(), "SortUtils"));
+    threads.back()->Create();
+  }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+  std::stable_sort(order.begin(), order.begin() + bounds[1], compare);
 
-bool SorterIndirectAscending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterAscending(*left, *right);
-}
+  for (size_t i = 0; i < threads.size(); i++)
+  {
+    threads[i]->WaitForThreadExit(0xFFFFFFFF);
+    delete threads[i];
+    delete jobs[i];
+  }
 
-bool SorterIndirectDescending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterDescending(*left, *right);
+  for (size_t chunk = 1; chunk < chunks; chunk++)
+    std::inplace_merge(order.begin(), order.begin() + bounds[chunk], order.begin() + bounds[chunk + 1], compare);
 }
 
-bool SorterIndirectIgnoreFoldersAscending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterIgnoreFoldersAscending(*left, *right);
-}
+static inline SortItem& GetSortItem(DatabaseResult &item) { return item; }
+static inline SortItem& GetSortItem(SortItemPtr &item) { return *item; }
 
-bool SorterIndirectIgnoreFoldersDescending(const SortItemPtr &left, const SortItemPtr &right)
+template<class T>
+static void SortByKeys(vector<T> &items, SortUtils::SortPreparator preparator, const Fields &sortingFields, SortOrder sortOrder, SortAttribute attributes)
 {
-  return SorterIgnoreFoldersDescending(*left, *right);
+  vector<SortKey> sortKeys(items.size());
+  for (size_t index = 0; index < items.size(); index++)
+  {
+    SortItem &item = GetSortItem(items[index]);
+
+    // add all fields to the item that are required for sorting if they are currently missing
+    for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
+    {
+      if (item.find(*field) == item.end())
+        item.insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
+    }
+
+    // Prepare the string used for sorting and store it under FieldSort
+    CStdStringW sortLabel;
+    g_charsetConverter.utf8ToW(preparator(attributes, item), sortLabel, false);
+    SortItem::const_iterator sort = item.insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel))).first;
+
+    SortKey &sortKey = sortKeys[index];
+    sortKey.index = index;
+    sortKey.label = sort->second.asWideString();
+
+    SortItem::const_iterator it;
+    sortKey.special = SortSpecialNone;
+    if ((it = item.find(FieldSortSpecial)) != item.end() && it->second.asInteger() <= (int64_t)SortSpecialOnBottom)
+      sortKey.special = it->second.asInteger();
+    sortKey.folder = (it = item.find(FieldFolder)) != item.end() ? (int)it->second.asBoolean() : -1;
+  }
+
+  SortKeyCollation collation(sortKeys);
+  vector<SortKey*> order;
+  order.reserve(sortKeys.size());
+  for (vector<SortKey>::iterator sortKey = sortKeys.begin(); sortKey != sortKeys.end(); ++sortKey)
+  {
+    collation.Fold(*sortKey);
+    order.push_back(&*sortKey);
+  }
+
+  // Do the sorting
+  SortKeys(order, SortKeyCompare(collation, sortOrder, attributes));
+
+  vector<T> sorted(items.size());
+  for (size_t index = 0; index < order.size(); index++)
+    std::swap(sorted[index], items[order[index]->index]);
+  items.swap(sorted);
 }
 
 map<SortBy, SortUtils::SortPreparator> fillPreparators()
@@ -643,27 +792,7 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
     // get the matching SortPreparator
     SortPreparator preparator = getPreparator(sortBy);
     if (preparator != NULL)
-    {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
-
-      // Prepare the string used for sorting and store it under FieldSort
-      for (DatabaseResults::iterator item = items.begin(); item != items.end(); ++item)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if (item->find(*field) == item->end())
-            item->insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        CStdStringW sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, *item), sortLabel, false);
-        item->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
-
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
-    }
+      SortByKeys(items, preparator, GetFieldsForSorting(sortBy), sortOrder, attributes);
   }
 
   if (limitStart > 0 && (size_t)limitStart < items.size())
@@ -682,27 +811,7 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
     // get the matching SortPreparator
     SortPreparator preparator = getPreparator(sortBy);
     if (preparator != NULL)
-    {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
-
-      // Prepare the string used for sorting and store it under FieldSort
-      for (SortItems::iterator item = items.begin(); item != items.end(); ++item)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if ((*item)->find(*field) == (*item)->end())
-            (*item)->insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        CStdStringW sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, **item), sortLabel, false);
-        (*item)->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
-
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorterIndirect(sortOrder, attributes));
-    }
+      SortByKeys(items, preparator, GetFieldsForSorting(sortBy), sortOrder, attributes);
   }
 
   if (limitStart > 0 && (size_t)limitStart < items.size())
@@ -754,22 +863,6 @@ const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
   return m_preparators[SortByNone];
 }
 
-SortUtils::Sorter SortUtils::getSorter(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIgnoreFoldersDescending : SorterIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterDescending : SorterAscending;
-}
-
-SortUtils::SorterIndirect SortUtils::getSorterIndirect(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIndirectIgnoreFoldersDescending : SorterIndirectIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterIndirectDescending : SorterIndirectAscending;
-}
-
 const Fields& SortUtils::GetFieldsForSorting(SortBy sortBy)
 {
   map<SortBy, Fields>::const_iterator it = m_sortingFields.find(sortBy);
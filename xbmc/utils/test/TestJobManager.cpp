@@ -168,6 +168,26 @@ TEST_F(TestJobManager, PauseLowPriorityJob)
   job->FinishAndStopBlocking();
 }
 
+TEST_F(TestJobManager, ChangePriority)
+{
+  JobControlPackage package;
+  BroadcastingJob *job = new BroadcastingJob(package);
+
+  // pausable jobs stay queued while paused
+  CJobManager::GetInstance().PauseJobs();
+  unsigned int id = CJobManager::GetInstance().AddJob(job, NULL, CJob::PRIORITY_LOW_PAUSABLE);
+  EXPECT_TRUE(CJobManager::GetInstance().ChangePriority(id, CJob::PRIORITY_NORMAL));
+
+  while (!package.ready)
+    package.jobCreatedCond.wait(package.jobCreatedMutex);
+  CJobManager::GetInstance().UnPauseJobs();
+
+  EXPECT_TRUE(CJobManager::GetInstance().IsProcessing(CJob::PRIORITY_NORMAL));
+  EXPECT_FALSE(CJobManager::GetInstance().ChangePriority(id, CJob::PRIORITY_LOW));
+
+  job->FinishAndStopBlocking();
+}
+
 TEST_F(TestJobManager, IsProcessing)
 {
   JobControlPackage package;
@@ -19,10 +19,70 @@
  */
 
 #include "utils/SortUtils.h"
+#include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
 #include "gtest/gtest.h"
 
+#define LARGE_ITEMS 30000 // sorted on several threads
+
+static const char *labels[] = {
+  "Episode 10", "episode 9", "Episode 09", "EPISODE 1", "Episode 000000000000000000012",
+  "The Movie", "the movie 2", "Movie (2012)", "Movie [2012]", "_Movie", "Ämovie", "Zebra",
+  "10 Things", "9 Songs", "", "a", "A", "1", "01", "b2b", "b10b"
+};
+
+static SortItemPtr NewItem(int index)
+{
+  const char *label = labels[index % (sizeof(labels) / sizeof(labels[0]))];
+  std::string title = StringUtils::Format("%s %d", label, index % 997);
+
+  SortItemPtr item(new SortItem());
+  (*item)[FieldId] = index;
+  (*item)[FieldLabel] = title;
+  (*item)[FieldTitle] = title;
+  (*item)[FieldSortTitle] = label;
+  (*item)[FieldPath] = StringUtils::Format("/media/%s/%d.mkv", label, index);
+  (*item)[FieldArtist] = CVariant(CVariant::VariantTypeArray);
+  (*item)[FieldArtist].push_back(labels[(index * 7) % (sizeof(labels) / sizeof(labels[0]))]);
+  (*item)[FieldAlbum] = label;
+  (*item)[FieldGenre] = label;
+  (*item)[FieldYear] = 1950 + index % 64;
+  (*item)[FieldTrackNumber] = index % 23;
+  (*item)[FieldSeason] = index % 7;
+  (*item)[FieldEpisodeNumber] = index % 31;
+  (*item)[FieldRating] = (index % 100) / 10.0f;
+  (*item)[FieldPlaycount] = index % 3;
+  (*item)[FieldSize] = (int64_t)index * 4096;
+  (*item)[FieldDateAdded] = StringUtils::Format("2014-%02d-%02d", 1 + index % 12, 1 + index % 28);
+  (*item)[FieldFolder] = index % 5 == 0;
+  return item;
+}
+
+// every item has to be sorted after its predecessor as StringUtils::AlphaNumericCompare() sees it
+static void CheckOrder(const SortItems &items, SortOrder sortOrder, bool folders)
+{
+  for (size_t i = 1; i < items.size(); i++)
+  {
+    const SortItem &prev = *items[i - 1];
+    const SortItem &next = *items[i];
+    if (folders && prev.at(FieldFolder).asBoolean() != next.at(FieldFolder).asBoolean())
+    {
+      EXPECT_TRUE(prev.at(FieldFolder).asBoolean());
+      continue;
+    }
+
+    int64_t result = StringUtils::AlphaNumericCompare(prev.at(FieldSort).asWideString().c_str(),
+                                                      next.at(FieldSort).asWideString().c_str());
+    if (sortOrder == SortOrderDescending)
+      result = -result;
+    ASSERT_LE(result, 0) << "items " << i - 1 << " and " << i;
+    // stable, equal items keep their order
+    if (result == 0)
+      ASSERT_LT(prev.at(FieldId).asInteger(), next.at(FieldId).asInteger());
+  }
+}
+
 TEST(TestSortUtils, Sort_SortBy)
 {
   SortItems items;
@@ -131,3 +191,41 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)4, fields.size());
 }
+
+TEST(TestSortUtils, SortKeysMatchAlphaNumericCompare)
+{
+  // small lists are sorted on one thread, large ones on several
+  for (int count = 100; count <= LARGE_ITEMS; count += LARGE_ITEMS - 100)
+  {
+    for (int order = SortOrderAscending; order <= SortOrderDescending; order++)
+    {
+      SortItems items;
+      for (int i = 0; i < count; i++)
+        items.push_back(NewItem(i));
+
+      SortUtils::Sort(SortByLabel, (SortOrder)order, SortAttributeNone, items);
+      ASSERT_EQ((size_t)count, items.size());
+      CheckOrder(items, (SortOrder)order, true);
+
+      items.clear();
+      for (int i = 0; i < count; i++)
+        items.push_back(NewItem(i));
+
+      SortUtils::Sort(SortByLabel, (SortOrder)order, SortAttributeIgnoreFolders, items);
+      CheckOrder(items, (SortOrder)order, false);
+    }
+  }
+}
+
+TEST(TestSortUtils, SortSpecial)
+{
+  SortItems items;
+  for (int i = 0; i < 10; i++)
+    items.push_back(NewItem(i));
+  (*items[3])[FieldSortSpecial] = SortSpecialOnBottom;
+  (*items[7])[FieldSortSpecial] = SortSpecialOnTop;
+
+  SortUtils::Sort(SortByLabel, SortOrderDescending, SortAttributeIgnoreFolders, items);
+  EXPECT_EQ(7, items.front()->at(FieldId).asInteger());
+  EXPECT_EQ(3, items.back()->at(FieldId).asInteger());
+}
@@ -53,6 +53,7 @@
 #include "guilib/LocalizeStrings.h"
 #include "utils/TimeUtils.h"
 #include "utils/log.h"
+#include "utils/LibraryIndex.h"
 #include "TextureCache.h"
 #include "addons/AddonInstaller.h"
 #include "interfaces/AnnouncementManager.h"
@@ -448,7 +449,6 @@ void CVideoDatabase::CreateViews()
 //********************************************************************************************************************************
 int CVideoDatabase::GetPathId(const CStdString& strPath)
 {
-  CStdString strSQL;
   try
   {
     int idPath=-1;
@@ -461,8 +461,9 @@ int CVideoDatabase::GetPathId(const CStdString& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL.c_str());
+    BindList params;
+    params.push_back(strPath1.c_str());
+    m_pDS->query("select idPath from path where strPath=?", params);
     if (!m_pDS->eof())
       idPath = m_pDS->fv("path.idPath").get_asInt();
 
@@ -471,7 +472,7 @@ int CVideoDatabase::GetPathId(const CStdString& strPath)
   }
   catch (...)
   {
-    CLog::Log(LOGERROR, "%s unable to getpath (%s)", __FUNCTION__, strSQL.c_str());
+    CLog::Log(LOGERROR, "%s unable to getpath (%s)", __FUNCTION__, strPath.c_str());
   }
   return -1;
 }
@@ -1027,9 +1028,10 @@ int CVideoDatabase::GetFileId(const CStdString& strFilenameAndPath)
     int idPath = GetPathId(strPath);
     if (idPath >= 0)
     {
-      CStdString strSQL;
-      strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-      m_pDS->query(strSQL.c_str());
+      BindList params;
+      params.push_back(strFileName.c_str());
+      params.push_back(idPath);
+      m_pDS->query("select idFile from files where strFileName=? and idPath=?", params);
       if (m_pDS->num_rows() > 0)
       {
         int idFile = m_pDS->fv("files.idFile").get_asInt();
@@ -3270,8 +3272,9 @@ bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
   auto_ptr<Dataset> pDS(m_pDB->CreateDataset());
   try
   {
-    CStdString strSQL = PrepareSQL("SELECT * FROM streamdetails WHERE idFile = %i", tag.m_iFileId);
-    pDS->query(strSQL);
+    BindList params;
+    params.push_back(tag.m_iFileId);
+    pDS->query("SELECT * FROM streamdetails WHERE idFile = ?", params);
 
     while (!pDS->eof())
     {
@@ -3841,8 +3844,10 @@ bool CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, map<
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS2.get()) return false; // using dataset 2 as we're likely called in loops on dataset 1
 
-    CStdString sql = PrepareSQL("SELECT type,url FROM art WHERE media_id=%i AND media_type='%s'", mediaId, mediaType.c_str());
-    m_pDS2->query(sql.c_str());
+    BindList params;
+    params.push_back(mediaId);
+    params.push_back(mediaType.c_str());
+    m_pDS2->query("SELECT type,url FROM art WHERE media_id=? AND media_type=?", params);
     while (!m_pDS2->eof())
     {
       art.insert(make_pair(m_pDS2->fv(0).get_asString(), m_pDS2->fv(1).get_asString()));
@@ -3860,8 +3865,11 @@ bool CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, map<
 
 string CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, const string &artType)
 {
-  std::string query = PrepareSQL("SELECT url FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
-  return GetSingleValue(query, m_pDS2);
+  BindList params;
+  params.push_back(mediaId);
+  params.push_back(mediaType.c_str());
+  params.push_back(artType.c_str());
+  return GetSingleValue("SELECT url FROM art WHERE media_id=? AND media_type=? AND type=?", params, m_pDS2);
 }
 
 bool CVideoDatabase::RemoveArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType)
@@ -6056,22 +6064,27 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
       strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
     }
 
-    strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
+    DatabaseResults results;
+    if (g_advancedSettings.m_bVideoLibraryMemoryIndex &&
+        GetIndexedPage("movie_view", MediaTypeMovie, extFilter, sortDescription, results, total))
+      items.SetProperty("total", total);
+    else
+    {
+      strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
-    int iRowsFound = RunQuery(strSQL);
-    if (iRowsFound <= 0)
-      return iRowsFound == 0;
+      int iRowsFound = RunQuery(strSQL);
+      if (iRowsFound <= 0)
+        return iRowsFound == 0;
 
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
+      // store the total value of items as a property
+      if (total < iRowsFound)
+        total = iRowsFound;
+      items.SetProperty("total", total);
 
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
-      return false;
+      results.reserve(iRowsFound);
+      if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
+        return false;
+    }
 
     // get data from returned rows
     items.Reserve(results.size());
@@ -8005,6 +8018,7 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const se
     Compress(false);
 
     CUtil::DeleteVideoDatabaseDirectoryCache();
+    CLibraryIndex::Get().Clear();
 
     time = XbmcThreads::SystemClockMillis() - time;
     CLog::Log(LOGNOTICE, "%s: Cleaning videodatabase done. Operation took %s", __FUNCTION__, StringUtils::SecondsToTimeString(time / 1000).c_str());
@@ -21,6 +21,7 @@
 #include "threads/SystemClock.h"
 #include "FileItem.h"
 #include "VideoInfoScanner.h"
+#include "VideoScanPrefetcher.h"
 #include "addons/AddonManager.h"
 #include "filesystem/DirectoryCache.h"
 #include "Util.h"
@@ -44,6 +45,7 @@
 #include "guilib/GUIWindowManager.h"
 #include "utils/TimeUtils.h"
 #include "utils/log.h"
+#include "utils/LibraryIndex.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 #include "video/VideoThumbLoader.h"
@@ -55,6 +57,11 @@ using namespace std;
 using namespace XFILE;
 using namespace ADDON;
 
+// number of directories fingerprinted in parallel, and how far the
+// fingerprinting may run ahead of the scan
+#define SCAN_PREFETCH_WORKERS 4
+#define SCAN_PREFETCH_WINDOW  32
+
 namespace VIDEO
 {
 
@@ -68,10 +75,15 @@ namespace VIDEO
     m_itemCount = 0;
     m_bClean = false;
     m_scanAll = false;
+    m_prefetcher = NULL;
+    m_prefetchNext = 0;
+    m_dirsScanned = 0;
+    m_dirsUnchanged = 0;
   }
 
   CVideoInfoScanner::~CVideoInfoScanner()
   {
+    delete m_prefetcher;
   }
 
   void CVideoInfoScanner::Process()
@@ -120,6 +132,12 @@ namespace VIDEO
       // result in unexpected behaviour.
       m_bCanInterrupt = false;
 
+      m_prefetcher = new CVideoScanPrefetcher(*this, SCAN_PREFETCH_WORKERS, SCAN_PREFETCH_WINDOW);
+      m_prefetchPaths.assign(m_pathsToScan.begin(), m_pathsToScan.end());
+      m_prefetchNext = 0;
+      m_dirsScanned = 0;
+      m_dirsUnchanged = 0;
+
       bool bCancelled = false;
       while (!bCancelled && m_pathsToScan.size())
       {
@@ -139,11 +157,16 @@ namespace VIDEO
            */
           CLog::Log(LOGWARNING, "%s directory '%s' does not exist - skipping scan%s.", __FUNCTION__, CURL::GetRedacted(directory).c_str(), m_bClean ? " and clean" : "");
           m_pathsToScan.erase(m_pathsToScan.begin());
+          m_prefetcher->Drop(directory);
         }
         else if (!DoScan(directory))
           bCancelled = true;
       }
 
+      CLog::Log(LOGDEBUG, "VideoInfoScanner: %u directories scanned, %u unchanged, %u fingerprinted ahead (%u waits)",
+                m_dirsScanned, m_dirsUnchanged, m_prefetcher->GetFingerprinted(), m_prefetcher->GetWaits());
+      m_prefetcher->Clear();
+
       if (!bCancelled)
       {
         if (m_bClean)
@@ -165,12 +188,17 @@ namespace VIDEO
     {
       CLog::Log(LOGERROR, "VideoInfoScanner: Exception while scanning.");
     }
+
+    delete m_prefetcher;
+    m_prefetcher = NULL;
+    m_prefetchPaths.clear();
     
     m_bRunning = false;
     ANNOUNCEMENT::CAnnouncementManager::Get().Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnScanFinished");
 
     // we need to clear the videodb cache and update any active lists
     CUtil::DeleteVideoDatabaseDirectoryCache();
+    CLibraryIndex::Get().Clear();
     CGUIMessage msg(GUI_MSG_SCAN_FINISHED, 0, 0, 0);
     g_windowManager.SendThreadMessage(msg);
     
@@ -266,6 +294,32 @@ namespace VIDEO
     return CFile::Exists(noMediaFile);
   }
 
+  void CVideoInfoScanner::PrefetchPaths()
+  {
+    while (m_prefetcher && m_prefetchNext < m_prefetchPaths.size() && !m_prefetcher->IsFull())
+    {
+      const CStdString &path = m_prefetchPaths[m_prefetchNext++];
+      if (m_pathsToScan.find(path) == m_pathsToScan.end())
+        continue; // already scanned
+
+      CVideoPathFingerprint *print = new CVideoPathFingerprint;
+      print->scraper = m_database.GetScraperForPath(path, print->settings, print->foundDirectly);
+      CONTENT_TYPE content = print->scraper ? print->scraper->Content() : CONTENT_NONE;
+
+      // only the paths DoScan() would stat or list
+      bool fingerprint = content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS ||
+                         (content == CONTENT_TVSHOWS && print->foundDirectly && !print->settings.parent_name_root);
+      if (!fingerprint || (!m_scanAll && print->settings.noupdate))
+      {
+        delete print;
+        continue;
+      }
+
+      m_database.GetPathHash(path, print->dbHash);
+      m_prefetcher->Queue(path, content, print);
+    }
+  }
+
   bool CVideoInfoScanner::DoScan(const CStdString& strDirectory)
   {
     if (m_handle)
@@ -287,8 +341,20 @@ namespace VIDEO
     bool foundDirectly = false;
     bool bSkip = false;
 
+    PrefetchPaths();
+    auto_ptr<CVideoPathFingerprint> print(m_prefetcher ? m_prefetcher->Take(strDirectory, m_bStop) : NULL);
+    m_dirsScanned++;
+
     SScanSettings settings;
-    ScraperPtr info = m_database.GetScraperForPath(strDirectory, settings, foundDirectly);
+    ScraperPtr info;
+    if (print.get())
+    {
+      info = print->scraper;
+      settings = print->settings;
+      foundDirectly = print->foundDirectly;
+    }
+    else
+      info = m_database.GetScraperForPath(strDirectory, settings, foundDirectly);
     CONTENT_TYPE content = info ? info->Content() : CONTENT_NONE;
 
     // exclude folders that match our exclude regexps
@@ -298,7 +364,7 @@ namespace VIDEO
     if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
       return true;
 
-    if (IsExcluded(strDirectory))
+    if (print.get() ? print->excluded : IsExcluded(strDirectory))
     {
       CLog::Log(LOGWARNING, "Skipping item '%s' with '.nomedia' file in parent directory, it won't be added to the library.", CURL::GetRedacted(strDirectory).c_str());
       return true;
@@ -317,11 +383,16 @@ namespace VIDEO
         m_handle->SetTitle(StringUtils::Format(g_localizeStrings.Get(str).c_str(), info->Name().c_str()));
       }
 
-      CStdString fastHash = GetFastHash(strDirectory, regexps);
+      CStdString fastHash = print.get() ? print->fastHash : GetFastHash(strDirectory, regexps);
       if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.empty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         hash = fastHash;
       }
+      else if (print.get() && print->listed)
+      { // folder was already fetched by the prefetcher
+        items.Assign(print->items);
+        hash = print->hash;
+      }
       else
       { // need to fetch the folder
         CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
@@ -338,6 +409,9 @@ namespace VIDEO
       { // hash matches - skipping
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change%s", CURL::GetRedacted(strDirectory).c_str(), !fastHash.empty() ? " (fasthash)" : "");
         bSkip = true;
+        m_dirsUnchanged++;
+        if (m_handle && m_prefetchPaths.size() > m_pathsToScan.size())
+          m_handle->SetPercentage((m_prefetchPaths.size() - m_pathsToScan.size()) * 100.f / m_prefetchPaths.size());
       }
       else if (hash.empty())
       { // directory empty or non-existent - add to clean list and skip
@@ -362,9 +436,17 @@ namespace VIDEO
 
       if (foundDirectly && !settings.parent_name_root)
       {
-        CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
-        items.SetPath(strDirectory);
-        GetPathHash(items, hash);
+        if (print.get() && print->listed)
+        {
+          items.Assign(print->items);
+          hash = print->hash;
+        }
+        else
+        {
+          CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
+          items.SetPath(strDirectory);
+          GetPathHash(items, hash);
+        }
         bSkip = true;
         if (!m_database.GetPathHash(strDirectory, dbHash) || dbHash != hash)
         {
@@ -727,6 +809,8 @@ namespace VIDEO
       set<CStdString>::iterator it = m_pathsToScan.find(item->GetPath());
       if (it != m_pathsToScan.end())
         m_pathsToScan.erase(it);
+      if (m_prefetcher)
+        m_prefetcher->Drop(item->GetPath());
 
       CStdString hash, dbHash;
       hash = GetRecursiveFastHash(item->GetPath(), regexps);
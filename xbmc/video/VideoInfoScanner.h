@@ -29,6 +29,8 @@ class CFileItemList;
 
 namespace VIDEO
 {
+  class CVideoScanPrefetcher;
+
   typedef struct SScanSettings
   {
     SScanSettings() { parent_name = parent_name_root = noupdate = exclude = false; recurse = 1;}
@@ -50,6 +52,7 @@ namespace VIDEO
 
   class CVideoInfoScanner : CThread
   {
+    friend class CVideoPathFingerprintJob;
   public:
     CVideoInfoScanner();
     virtual ~CVideoInfoScanner();
@@ -128,6 +131,11 @@ namespace VIDEO
     bool DoScan(const CStdString& strDirectory);
     bool IsExcluded(const CStdString& strDirectory) const;
 
+    /*! \brief Queue the next paths to scan for fingerprinting on the prefetcher workers
+     Looks up the scraper and hash of each path in the database so the workers only touch the filesystem.
+     */
+    void PrefetchPaths();
+
     INFO_RET RetrieveInfoForTvShow(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMovie(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMusicVideo(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
@@ -257,6 +265,12 @@ namespace VIDEO
     std::set<CStdString> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+
+    CVideoScanPrefetcher* m_prefetcher;
+    std::vector<CStdString> m_prefetchPaths;
+    size_t m_prefetchNext;
+    unsigned int m_dirsScanned;
+    unsigned int m_dirsUnchanged;
   };
 }
 
@@ -0,0 +1,190 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoScanPrefetcher.h"
+#include "filesystem/Directory.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+using namespace std;
+using namespace XFILE;
+
+namespace VIDEO
+{
+  class CVideoPathFingerprintJob : public CJob
+  {
+  public:
+    CVideoPathFingerprintJob(const CVideoInfoScanner &scanner, const CStdString &path,
+                             CONTENT_TYPE content, CVideoPathFingerprint *fingerprint)
+      : m_scanner(scanner), m_path(path), m_content(content), m_fingerprint(fingerprint)
+    {
+    }
+
+    virtual ~CVideoPathFingerprintJob()
+    {
+      // still set when the job was cancelled
+      delete m_fingerprint;
+    }
+
+    virtual const char *GetType() const { return "videofingerprint"; }
+
+    virtual bool DoWork()
+    {
+      CVideoPathFingerprint &print = *m_fingerprint;
+      print.excluded = m_scanner.IsExcluded(m_path);
+      if (print.excluded)
+        return true;
+
+      if (m_content == CONTENT_TVSHOWS)
+      {
+        CDirectory::GetDirectory(m_path, print.items, g_advancedSettings.m_videoExtensions);
+        print.items.SetPath(m_path);
+        CVideoInfoScanner::GetPathHash(print.items, print.hash);
+        print.listed = true;
+        return true;
+      }
+
+      const vector<string> &regexps = g_advancedSettings.m_moviesExcludeFromScanRegExps;
+      print.fastHash = m_scanner.GetFastHash(m_path, regexps);
+      if (!print.fastHash.empty() && print.fastHash == print.dbHash)
+        return true;
+
+      // same as CVideoInfoScanner::DoScan
+      CDirectory::GetDirectory(m_path, print.items, g_advancedSettings.m_videoExtensions);
+      print.items.Stack();
+      if (!m_scanner.CanFastHash(print.items, regexps) || print.fastHash.empty())
+        CVideoInfoScanner::GetPathHash(print.items, print.hash);
+      else
+        print.hash = print.fastHash;
+      print.listed = true;
+      return true;
+    }
+
+    CVideoPathFingerprint* Detach()
+    {
+      CVideoPathFingerprint *fingerprint = m_fingerprint;
+      m_fingerprint = NULL;
+      return fingerprint;
+    }
+
+    const CStdString &GetPath() const { return m_path; }
+
+  private:
+    const CVideoInfoScanner &m_scanner;
+    CStdString m_path;
+    CONTENT_TYPE m_content;
+    CVideoPathFingerprint *m_fingerprint;
+  };
+
+  CVideoScanPrefetcher::CVideoScanPrefetcher(const CVideoInfoScanner &scanner, unsigned int workers, unsigned int window)
+    : CJobQueue(false, workers, CJob::PRIORITY_NORMAL)
+    , m_scanner(scanner)
+    , m_window(window)
+    , m_fingerprinted(0)
+    , m_waits(0)
+  {
+  }
+
+  CVideoScanPrefetcher::~CVideoScanPrefetcher()
+  {
+    Clear();
+  }
+
+  bool CVideoScanPrefetcher::IsFull() const
+  {
+    CSingleLock lock(m_pathSection);
+    return m_paths.size() >= m_window;
+  }
+
+  void CVideoScanPrefetcher::Queue(const CStdString &path, CONTENT_TYPE content, CVideoPathFingerprint *fingerprint)
+  {
+    {
+      CSingleLock lock(m_pathSection);
+      if (m_paths.find(path) != m_paths.end())
+      {
+        delete fingerprint;
+        return;
+      }
+      m_paths[path] = NULL;
+    }
+    AddJob(new CVideoPathFingerprintJob(m_scanner, path, content, fingerprint));
+  }
+
+  CVideoPathFingerprint* CVideoScanPrefetcher::Take(const CStdString &path, const volatile bool &stop)
+  {
+    CSingleLock lock(m_pathSection);
+    map<CStdString, CVideoPathFingerprint*>::iterator it = m_paths.find(path);
+    if (it == m_paths.end())
+      return NULL;
+
+    if (!it->second)
+      m_waits++;
+    while (!it->second)
+    {
+      if (stop)
+        return NULL;
+      CSingleExit exit(m_pathSection);
+      m_pathDone.WaitMSec(100);
+    }
+
+    CVideoPathFingerprint *fingerprint = it->second;
+    m_paths.erase(it);
+    return fingerprint;
+  }
+
+  void CVideoScanPrefetcher::Drop(const CStdString &path)
+  {
+    CSingleLock lock(m_pathSection);
+    map<CStdString, CVideoPathFingerprint*>::iterator it = m_paths.find(path);
+    if (it == m_paths.end())
+      return;
+
+    delete it->second;
+    m_paths.erase(it);
+  }
+
+  void CVideoScanPrefetcher::Clear()
+  {
+    CancelJobs();
+
+    CSingleLock lock(m_pathSection);
+    for (map<CStdString, CVideoPathFingerprint*>::iterator it = m_paths.begin(); it != m_paths.end(); ++it)
+      delete it->second;
+    m_paths.clear();
+  }
+
+  void CVideoScanPrefetcher::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    CVideoPathFingerprintJob *printJob = (CVideoPathFingerprintJob *)job;
+    {
+      CSingleLock lock(m_pathSection);
+      map<CStdString, CVideoPathFingerprint*>::iterator it = m_paths.find(printJob->GetPath());
+      if (it != m_paths.end() && !it->second)
+      {
+        it->second = printJob->Detach();
+        m_fingerprinted++;
+      }
+    }
+    m_pathDone.Set();
+
+    CJobQueue::OnJobComplete(jobID, success, job);
+  }
+}
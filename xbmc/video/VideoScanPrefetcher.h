@@ -0,0 +1,107 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include "FileItem.h"
+#include "VideoInfoScanner.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
+
+namespace VIDEO
+{
+  /*! \brief Database lookup, listing and hashes of a library path, gathered ahead of the scan.
+   */
+  class CVideoPathFingerprint
+  {
+  public:
+    CVideoPathFingerprint() : foundDirectly(false), excluded(false), listed(false) {}
+
+    ADDON::ScraperPtr scraper;
+    SScanSettings     settings;
+    bool              foundDirectly;
+    CStdString        dbHash;        ///< hash in the database when the path was queued
+    bool              excluded;      ///< the path contains a .nomedia file
+    CStdString        fastHash;
+    CStdString        hash;          ///< full hash, only set when listed
+    bool              listed;        ///< whether items holds the directory listing
+    CFileItemList     items;
+  };
+
+  /*! \brief Fingerprints library paths on job workers ahead of CVideoInfoScanner.
+
+   The scanner thread looks up the scraper and stored hash of the next paths it is going
+   to scan and queues them here. The jobs stat and list the directories and compute their
+   hashes in parallel, which is where a rescan of a large library spends most of its time.
+   The scanner then takes the results in scan order. Only a bounded window of paths is
+   kept queued or in flight.
+   */
+  class CVideoScanPrefetcher : public CJobQueue
+  {
+  public:
+    CVideoScanPrefetcher(const CVideoInfoScanner &scanner, unsigned int workers, unsigned int window);
+    virtual ~CVideoScanPrefetcher();
+
+    /*! \brief Whether the window of queued paths is full.
+     */
+    bool IsFull() const;
+
+    /*! \brief Queue a path for fingerprinting.
+     \param path the directory to fingerprint.
+     \param content content of the path, determines what is listed.
+     \param fingerprint database information of the path. Ownership is taken.
+     */
+    void Queue(const CStdString &path, CONTENT_TYPE content, CVideoPathFingerprint *fingerprint);
+
+    /*! \brief Take the fingerprint of a path, waiting for it if it's still in flight.
+     \param path the directory to retrieve.
+     \param stop flag to abort the wait on.
+     \return the fingerprint, to be deleted by the caller, or NULL if the path wasn't queued.
+     */
+    CVideoPathFingerprint* Take(const CStdString &path, const volatile bool &stop);
+
+    /*! \brief Drop a queued path that won't be scanned, freeing its place in the window.
+     A job still in flight for it finishes, its result is discarded.
+     \param path the directory to drop.
+     */
+    void Drop(const CStdString &path);
+
+    /*! \brief Cancel outstanding jobs and drop all results.
+     */
+    void Clear();
+
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+    unsigned int GetFingerprinted() const { return m_fingerprinted; }
+    unsigned int GetWaits() const { return m_waits; }
+
+  private:
+    const CVideoInfoScanner &m_scanner;
+    unsigned int m_window;
+    unsigned int m_fingerprinted;
+    unsigned int m_waits;
+
+    // results by path, NULL while the job is in flight
+    std::map<CStdString, CVideoPathFingerprint*> m_paths;
+    CCriticalSection m_pathSection;
+    CEvent m_pathDone;
+  };
+}
@@ -0,0 +1,228 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/VideoDatabase.h"
+#include "FileItem.h"
+#include "dbwrappers/dataset.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/LibraryIndex.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#define TEST_MOVIES 60
+
+namespace
+{
+class CTestVideoDatabase : public CVideoDatabase
+{
+public:
+  // creates a fresh database with the current schema in special://temp and leaves it connected
+  bool Create(const std::string& name)
+  {
+    DatabaseSettings settings;
+    settings.type = "sqlite3";
+    settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    settings.name = name;
+    if (!Update(settings))
+      return false;
+    m_file = StringUtils::Format("special://temp/%s.db", m_pDB->getDatabase());
+    return true;
+  }
+
+  unsigned int GetWriteGeneration() const { return m_pDB->get_write_generation(); }
+
+  // runs a statement with bound parameters through the statement cache
+  void ExecuteBound(const std::string& sql, const std::string& value)
+  {
+    dbiplus::BindList params;
+    params.push_back(dbiplus::field_value(value.c_str()));
+    m_pDS->exec(sql, params);
+  }
+
+  std::string m_file; ///< the file Create() made
+};
+}
+
+class TestVideoDatabase : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    m_memoryIndex = g_advancedSettings.m_bVideoLibraryMemoryIndex;
+    m_tokens = g_advancedSettings.m_vecTokens;
+    CLibraryIndex::Get().Clear();
+
+    ASSERT_TRUE(m_db.Create("MyVideosTest" + StringUtils::CreateUUID()));
+
+    // titles out of id order, some with articles
+    for (int i = 0; i < TEST_MOVIES; i++)
+      AddMovie(StringUtils::Format("%s Movie %02i", i % 3 == 0 ? "The" : (i % 3 == 1 ? "A" : "Some"), (i * 37) % TEST_MOVIES));
+  }
+
+  virtual void TearDown()
+  {
+    g_advancedSettings.m_bVideoLibraryMemoryIndex = m_memoryIndex;
+    g_advancedSettings.m_vecTokens = m_tokens;
+    CLibraryIndex::Get().Clear();
+
+    m_db.Close();
+    if (!m_db.m_file.empty())
+      XFILE::CFile::Delete(m_db.m_file);
+  }
+
+  void AddMovie(const std::string& title)
+  {
+    CVideoInfoTag tag;
+    tag.m_strTitle = title;
+    tag.m_iYear = 2000;
+    std::string path = StringUtils::Format("/movies/%s.mkv", title.c_str());
+    std::map<std::string, std::string> artwork;
+    EXPECT_LT(0, m_db.SetDetailsForMovie(path, tag, artwork));
+  }
+
+  // paths of a page of the movie titles, from the index or sorted as usual
+  std::vector<std::string> GetPage(bool memoryIndex, const SortDescription& sorting, int& total)
+  {
+    g_advancedSettings.m_bVideoLibraryMemoryIndex = memoryIndex;
+
+    CFileItemList items;
+    CDatabase::Filter filter;
+    EXPECT_TRUE(m_db.GetMoviesByWhere("videodb://movies/titles/", filter, items, sorting));
+    total = (int)items.GetProperty("total").asInteger();
+
+    std::vector<std::string> titles;
+    for (int i = 0; i < items.Size(); i++)
+      titles.push_back(items[i]->GetVideoInfoTag()->m_strTitle);
+    return titles;
+  }
+
+  // the page served from the index must be the page the usual sort gives
+  void ExpectSamePage(const SortDescription& sorting)
+  {
+    int total, expectedTotal;
+    std::vector<std::string> expected = GetPage(false, sorting, expectedTotal);
+    std::vector<std::string> indexed = GetPage(true, sorting, total);
+    EXPECT_EQ(expectedTotal, total);
+    EXPECT_EQ(expected, indexed);
+  }
+
+  CTestVideoDatabase m_db;
+  bool m_memoryIndex;
+  std::vector<std::string> m_tokens;
+};
+
+TEST_F(TestVideoDatabase, IndexedPageMatchesSort)
+{
+  SortDescription sorting;
+  sorting.sortBy = SortByTitle;
+  sorting.limitStart = 10;
+  sorting.limitEnd = 25;
+
+  int total;
+  std::vector<std::string> page = GetPage(true, sorting, total);
+  EXPECT_EQ(TEST_MOVIES, total);
+  EXPECT_EQ(15U, page.size());
+  ExpectSamePage(sorting);
+
+  sorting.sortOrder = SortOrderDescending;
+  ExpectSamePage(sorting);
+
+  sorting.sortBy = SortByYear;
+  ExpectSamePage(sorting);
+}
+
+TEST_F(TestVideoDatabase, IndexedPageFollowsWrites)
+{
+  SortDescription sorting;
+  sorting.sortBy = SortByTitle;
+  sorting.limitStart = 0;
+  sorting.limitEnd = 5;
+  ExpectSamePage(sorting);
+
+  // sorts first, so the page changes
+  AddMovie("Aardvark");
+  int total;
+  std::vector<std::string> page = GetPage(true, sorting, total);
+  EXPECT_EQ(TEST_MOVIES + 1, total);
+  ASSERT_FALSE(page.empty());
+  EXPECT_EQ("Aardvark", page[0]);
+  ExpectSamePage(sorting);
+}
+
+TEST_F(TestVideoDatabase, IndexedPageFollowsSortTokens)
+{
+  SortDescription sorting;
+  sorting.sortBy = SortByTitle;
+  sorting.sortAttributes = SortAttributeIgnoreArticle;
+  sorting.limitStart = 0;
+  sorting.limitEnd = 20;
+
+  g_advancedSettings.m_vecTokens.clear();
+  g_advancedSettings.m_vecTokens.push_back("The ");
+  ExpectSamePage(sorting);
+
+  // the same listing with other articles ignored is ordered differently
+  g_advancedSettings.m_vecTokens.push_back("A ");
+  ExpectSamePage(sorting);
+}
+
+TEST_F(TestVideoDatabase, WriteGenerationFollowsChanges)
+{
+  unsigned int generation = m_db.GetWriteGeneration();
+
+  // statements that fail or change nothing leave the indexes alone
+  EXPECT_TRUE(m_db.ExecuteQuery("UPDATE movie SET c00='Nothing' WHERE idMovie < 0"));
+  EXPECT_FALSE(m_db.ExecuteQuery("UPDATE nosuchtable SET c00='Nothing'"));
+  EXPECT_EQ(generation, m_db.GetWriteGeneration());
+
+  m_db.BeginTransaction();
+  EXPECT_TRUE(m_db.ExecuteQuery("UPDATE movie SET c00='Rolled back'"));
+  m_db.RollbackTransaction();
+  EXPECT_EQ(generation, m_db.GetWriteGeneration());
+
+  // a transaction counts once, when it is committed
+  m_db.BeginTransaction();
+  EXPECT_TRUE(m_db.ExecuteQuery("UPDATE movie SET c07='2001'"));
+  EXPECT_TRUE(m_db.ExecuteQuery("UPDATE movie SET c07='2002'"));
+  EXPECT_EQ(generation, m_db.GetWriteGeneration());
+  EXPECT_TRUE(m_db.CommitTransaction());
+  EXPECT_EQ(generation + 1, m_db.GetWriteGeneration());
+
+  EXPECT_TRUE(m_db.ExecuteQuery("UPDATE movie SET c07='2003'"));
+  EXPECT_EQ(generation + 2, m_db.GetWriteGeneration());
+}
+
+TEST_F(TestVideoDatabase, BoundWriteGenerationFollowsChanges)
+{
+  unsigned int generation = m_db.GetWriteGeneration();
+
+  m_db.ExecuteBound("UPDATE movie SET c00=? WHERE idMovie < 0", "Nothing");
+  EXPECT_EQ(generation, m_db.GetWriteGeneration());
+
+  m_db.ExecuteBound("UPDATE movie SET c07=?", "2001");
+  EXPECT_EQ(generation + 1, m_db.GetWriteGeneration());
+}
@@ -31,6 +31,7 @@
 #include "guilib/GUITextLayout.h"
 #include "guilib/GUIWindowManager.h"
 #include "guilib/GUIControlProfiler.h"
+#include "guilib/GUIRenderBatchGL.h"
 #include "GUIInfoManager.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
@@ -115,6 +116,11 @@ void CGUIWindowDebugInfo::Process(unsigned int currentTime, CDirtyRegionList &di
     StringUtils::ToUpper(ucAppName);
     info = StringUtils::Format("LOG: %s%s.log\nMEM: %" PRIu64"/%" PRIu64" KB - FPS: %2.1f fps\nCPU: %s (CPU-%s %4.2f%%%s)", g_advancedSettings.m_logFolder.c_str(), lcAppName.c_str(),
                                stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(), strCores.c_str(), ucAppName.c_str(), dCPU, profiling.c_str());
+#endif
+#if defined(HAS_GL)
+    unsigned int drawCalls, stateChanges;
+    CGUIRenderBatchGL::Get().GetFrameStats(drawCalls, stateChanges);
+    info += StringUtils::Format("\nGUI: %u draw calls - %u state changes", drawCalls, stateChanges);
 #endif
   }
 
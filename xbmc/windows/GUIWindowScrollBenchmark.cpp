@@ -0,0 +1,195 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIWindowScrollBenchmark.h"
+#include "guilib/GUIFontManager.h"
+#include "guilib/GUITextLayout.h"
+#include "guilib/GUIWindowManager.h"
+#include "guilib/Key.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+
+#include <algorithm>
+#include <climits>
+
+#define MAX_FRAMES 10000
+
+CGUIWindowScrollBenchmark::CGUIWindowScrollBenchmark(void)
+    : CGUIDialog(WINDOW_SCROLL_BENCHMARK, "")
+{
+  m_needsScaling = false;
+  m_layout = NULL;
+  m_renderOrder = INT_MAX - 3;
+  m_windowID = WINDOW_INVALID;
+  m_controlID = 0;
+  m_running = false;
+  m_reversed = false;
+  m_selected = -1;
+  m_lastFrame = 0;
+}
+
+CGUIWindowScrollBenchmark::~CGUIWindowScrollBenchmark(void)
+{
+}
+
+bool CGUIWindowScrollBenchmark::OnMessage(CGUIMessage &message)
+{
+  if (message.GetMessage() == GUI_MSG_WINDOW_INIT)
+    Start();
+  else if (message.GetMessage() == GUI_MSG_WINDOW_DEINIT)
+  {
+    if (m_running)
+      Finish();
+    delete m_layout;
+    m_layout = NULL;
+  }
+  return CGUIDialog::OnMessage(message);
+}
+
+bool CGUIWindowScrollBenchmark::OnAction(const CAction &action)
+{
+  if (action.GetID() == ACTION_PREVIOUS_MENU || action.GetID() == ACTION_NAV_BACK)
+  {
+    Close();
+    return true;
+  }
+  // anything else would interfere with the measurement
+  return true;
+}
+
+void CGUIWindowScrollBenchmark::Start()
+{
+  m_running = false;
+  m_reversed = false;
+  m_selected = -1;
+  m_lastFrame = 0;
+  m_frameTimes.clear();
+
+  m_windowID = g_windowManager.GetActiveWindow();
+  CGUIWindow *window = g_windowManager.GetWindow(m_windowID);
+  CGUIControl *control = window ? window->GetFocusedControl() : NULL;
+  if (!control || !control->IsContainer())
+  {
+    m_result = "Scroll benchmark: the active window has no focused container";
+    CLog::Log(LOGNOTICE, "%s", m_result.c_str());
+    return;
+  }
+  m_controlID = control->GetID();
+  m_frameTimes.reserve(MAX_FRAMES);
+  m_running = true;
+  CLog::Log(LOGNOTICE, "Scroll benchmark: started on control %i of window %i", m_controlID, m_windowID);
+}
+
+bool CGUIWindowScrollBenchmark::Step()
+{
+  // look the control up each time, the window may have gone away
+  CGUIWindow *window = g_windowManager.GetWindow(m_windowID);
+  CGUIControl *control = window ? window->GetControl(m_controlID) : NULL;
+  if (!control || !control->IsContainer())
+    return false;
+
+  CGUIMessage selected(GUI_MSG_ITEM_SELECTED, GetID(), m_controlID);
+  control->OnMessage(selected);
+  int current = selected.GetParam1();
+  if (current == m_selected)
+  { // the last step didn't move, so we hit an end of the list
+    if (m_reversed)
+      return false;
+    m_reversed = true;
+  }
+  m_selected = current;
+
+  CGUIMessage select(GUI_MSG_ITEM_SELECT, GetID(), m_controlID, current + (m_reversed ? -1 : 1));
+  control->OnMessage(select);
+  return true;
+}
+
+void CGUIWindowScrollBenchmark::Finish()
+{
+  m_running = false;
+  if (m_frameTimes.empty())
+  {
+    m_result = "Scroll benchmark: no frames measured";
+    CLog::Log(LOGNOTICE, "%s", m_result.c_str());
+    return;
+  }
+
+  std::vector<float> sorted(m_frameTimes);
+  std::sort(sorted.begin(), sorted.end());
+  double total = 0;
+  for (std::vector<float>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+    total += *it;
+
+  // a frame is slow if it took half a refresh longer than it should
+  float fps = g_graphicsContext.GetFPS();
+  float budget = 1.5f * 1000.0f / (fps > 0.0f ? fps : 60.0f);
+  unsigned int slow = sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), budget);
+
+  m_result = StringUtils::Format("Scroll benchmark: %u frames - avg %.2f ms - 95%% %.2f ms - max %.2f ms - %u slow (> %.1f ms)",
+                                 (unsigned int)sorted.size(), total / sorted.size(), sorted[(sorted.size() - 1) * 95 / 100],
+                                 sorted.back(), slow, budget);
+  CLog::Log(LOGNOTICE, "%s", m_result.c_str());
+}
+
+void CGUIWindowScrollBenchmark::Process(unsigned int currentTime, CDirtyRegionList &dirtyregions)
+{
+  g_graphicsContext.SetRenderingResolution(g_graphicsContext.GetResInfo(), false);
+
+  if (m_running)
+  {
+    int64_t now = CurrentHostCounter();
+    if (m_lastFrame)
+      m_frameTimes.push_back((float)((now - m_lastFrame) * 1000.0 / CurrentHostFrequency()));
+    m_lastFrame = now;
+
+    if (!Step() || m_frameTimes.size() >= MAX_FRAMES)
+      Finish();
+  }
+
+  if (!m_layout)
+  {
+    CGUIFont *font13 = g_fontManager.GetDefaultFont();
+    CGUIFont *font13border = g_fontManager.GetDefaultFont(true);
+    if (font13)
+      m_layout = new CGUITextLayout(font13, true, 0, font13border);
+  }
+  if (!m_layout)
+    return;
+
+  CStdString info = m_running ? StringUtils::Format("Scroll benchmark: %u frames", (unsigned int)m_frameTimes.size()) : m_result;
+  info += "\nPress back to close";
+
+  float w, h;
+  if (m_layout->Update(info))
+    MarkDirtyRegion();
+  m_layout->GetTextExtent(w, h);
+
+  float x = 0.04f * g_graphicsContext.GetWidth();
+  float y = 0.96f * g_graphicsContext.GetHeight() - h;
+  m_renderRegion.SetRect(x, y, x+w, y+h);
+}
+
+void CGUIWindowScrollBenchmark::Render()
+{
+  g_graphicsContext.SetRenderingResolution(g_graphicsContext.GetResInfo(), false);
+  if (m_layout)
+    m_layout->RenderOutline(m_renderRegion.x1, m_renderRegion.y1, 0xffffffff, 0xff000000, 0, 0);
+}
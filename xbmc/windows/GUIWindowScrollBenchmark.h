@@ -0,0 +1,60 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "guilib/GUIDialog.h"
+
+#include <vector>
+
+class CGUITextLayout;
+
+/*!
+ \brief Scrolls the focused container of the active window and measures the frame times.
+
+ The container is stepped one item per frame to its end and back to the start, after which
+ the frame time statistics are shown and logged. Useful to compare the effect of changes
+ to the container and layout code on the GUI's smoothness.
+ */
+class CGUIWindowScrollBenchmark :
+      public CGUIDialog
+{
+public:
+  CGUIWindowScrollBenchmark();
+  virtual ~CGUIWindowScrollBenchmark();
+  virtual void Process(unsigned int currentTime, CDirtyRegionList &dirtyregions);
+  virtual void Render();
+  virtual bool OnMessage(CGUIMessage &message);
+  virtual bool OnAction(const CAction &action);
+private:
+  void Start();
+  bool Step();
+  void Finish();
+
+  CGUITextLayout *m_layout;
+  int m_windowID;
+  int m_controlID;
+  bool m_running;
+  bool m_reversed;
+  int m_selected;
+  int64_t m_lastFrame;
+  std::vector<float> m_frameTimes; ///< frame times in milliseconds
+  CStdString m_result;
+};